@@ -22,49 +22,14 @@ FocusScope {
     property var currentServer
 
     ListModel {
-        id: testRecommendedModel
+        id: recommendedModel
     }
 
-    // TODO: Replace dummy data with recommended servers list
     function updateServerData() {
-        testRecommendedModel.clear();
-
-        const data = [
-            {
-                countryCode: "ca",
-                cityName: "Toronto",
-                localizedCityName: "Toronto",
-                code: "tor"
-            },
-            {
-                countryCode: "ca",
-                cityName: "Montreal",
-                localizedCityName: "Montreal",
-                code: "mtr"
-            },
-            {
-                countryCode: "ca",
-                cityName: "Vancouver",
-                localizedCityName: "Vancouver",
-                code: "van"
-            },
-            {
-                countryCode: "us",
-                cityName: "New York City",
-                localizedCityName: "New York City",
-                code: "nyc"
-            },
-            {
-                countryCode: "us",
-                cityName: "Chicago",
-                localizedCityName: "Chicago",
-                code: "chi"
-            }
-        ];
-        const shuffledData = data.sort((a, b) => 0.5 - Math.random());
+        recommendedModel.clear();
 
-        shuffledData.forEach((d) => {
-            testRecommendedModel.append(d);
+        VPNServerCountryModel.recommendedLocations(5).forEach((location) => {
+            recommendedModel.append(location);
         });
     }
 
@@ -252,7 +217,7 @@ FocusScope {
 
                 Repeater {
                     id: recommendedRepeater
-                    model: testRecommendedModel
+                    model: recommendedModel
                     delegate: VPNClickableRow {
                         property string locationScore: VPNServerCountryModel.cityConnectionScore(countryCode, code)
                         property bool isAvailable: locationScore >= 0
@@ -0,0 +1,169 @@
+#! /usr/bin/env python3
+# This Source Code Form is subject to the terms of the Mozilla Public
+# License, v. 2.0. If a copy of the MPL was not distributed with this
+# file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+# Compiles the server name translations (servers.json) into the binary bundle
+# read by ServerI18N. All the integers are 32-bit little-endian:
+#
+#   header:       "MZSI", version, country count, city count, language count,
+#                 offset of the string pool
+#   countries:    (code, first city, city count) for each country, by code
+#   cities:       (name) for each city, by name within each country
+#   languages:    (code) for each language, by code
+#   translations: for each language, one string per country then one string
+#                 per city, or 0xFFFFFFFF if there is no translation
+#   string pool:  16-bit length + UTF-8 bytes for each string
+#
+# Strings are referred to by their offset in the pool, and sorted by their
+# UTF-8 bytes.
+
+import argparse
+import json
+import os
+import struct
+
+MAGIC = b"MZSI"
+VERSION = 1
+HEADER_SIZE = 24
+MISSING = 0xFFFFFFFF
+
+
+class StringPool:
+    def __init__(self):
+        self.data = bytearray()
+        self.offsets = {}
+
+    def add(self, string):
+        if string in self.offsets:
+            return self.offsets[string]
+
+        encoded = string.encode("utf-8")
+        if len(encoded) > 0xFFFF:
+            exit(f"String too long: {string[:32]}...")
+
+        offset = len(self.data)
+        self.data += struct.pack("<H", len(encoded)) + encoded
+        self.offsets[string] = offset
+        return offset
+
+
+def utf8(string):
+    return string.encode("utf-8")
+
+
+def compile_bundle(countries):
+    pool = StringPool()
+
+    # (code, languages, [(name, languages)])
+    entries = []
+    for country in countries:
+        code = country.get("countryCode")
+        if not code:
+            exit("Empty countryCode string")
+
+        cities = {}
+        for city in country.get("cities", []):
+            name = city.get("city")
+            if not name:
+                exit(f"Empty city string in {code}")
+            cities[name] = city.get("languages", {})
+
+        entries.append(
+            (
+                code,
+                country.get("languages", {}),
+                sorted(cities.items(), key=lambda item: utf8(item[0])),
+            )
+        )
+
+    entries.sort(key=lambda entry: utf8(entry[0]))
+    if len(set(entry[0] for entry in entries)) != len(entries):
+        exit("Duplicate country code")
+
+    languages = set()
+    for _, countryLanguages, cities in entries:
+        languages.update(countryLanguages.keys())
+        for _, cityLanguages in cities:
+            languages.update(cityLanguages.keys())
+    languages = sorted(languages, key=utf8)
+
+    countryTable = bytearray()
+    cityTable = bytearray()
+    items = []
+    cityCount = 0
+    for code, countryLanguages, cities in entries:
+        countryTable += struct.pack(
+            "<III", pool.add(code), cityCount, len(cities)
+        )
+        items.append(countryLanguages)
+        cityCount += len(cities)
+
+    for _, _, cities in entries:
+        for name, cityLanguages in cities:
+            cityTable += struct.pack("<I", pool.add(name))
+            items.append(cityLanguages)
+
+    languageTable = bytearray()
+    translationTable = bytearray()
+    for language in languages:
+        languageTable += struct.pack("<I", pool.add(language))
+        for item in items:
+            value = item.get(language)
+            translationTable += struct.pack(
+                "<I", pool.add(value) if value else MISSING
+            )
+
+    poolOffset = (
+        HEADER_SIZE
+        + len(countryTable)
+        + len(cityTable)
+        + len(languageTable)
+        + len(translationTable)
+    )
+    header = MAGIC + struct.pack(
+        "<IIIII", VERSION, len(entries), cityCount, len(languages), poolOffset
+    )
+    assert len(header) == HEADER_SIZE
+
+    return (
+        bytes(header)
+        + bytes(countryTable)
+        + bytes(cityTable)
+        + bytes(languageTable)
+        + bytes(translationTable)
+        + bytes(pool.data)
+    )
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(
+        description="Compile the server name translations into a binary bundle"
+    )
+    parser.add_argument(
+        "source", metavar="JSON", type=str, action="store", help="servers.json"
+    )
+    parser.add_argument(
+        "-o",
+        "--output",
+        metavar="FILE",
+        type=str,
+        action="store",
+        required=True,
+        help="Output file",
+    )
+    args = parser.parse_args()
+
+    with open(args.source, "r", encoding="utf-8") as file:
+        countries = json.load(file)
+
+    if not isinstance(countries, list):
+        exit("Invalid format (expected array)")
+
+    bundle = compile_bundle(countries)
+
+    outdir = os.path.dirname(args.output)
+    if outdir:
+        os.makedirs(outdir, exist_ok=True)
+    with open(args.output, "wb") as file:
+        file.write(bundle)
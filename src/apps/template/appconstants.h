@@ -16,7 +16,7 @@ constexpr const char* SETTINGS_APP_NAME = "FooBar";
 constexpr const char* NETWORK_USERAGENT_PREFIX = "FooBar";
 
 // The file name for the logging
-constexpr const char* LOG_FILE_NAME = "foobar.txt";
+constexpr const char* LOG_FILE_NAME = "foobar.log";
 
 #if defined(__APPLE__)
 // This is the name of the service to encrypt the settings file
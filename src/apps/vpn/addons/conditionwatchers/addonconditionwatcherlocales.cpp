@@ -40,9 +40,15 @@ AddonConditionWatcherLocales::~AddonConditionWatcherLocales() {
 }
 
 bool AddonConditionWatcherLocales::conditionApplied() const {
+  return matchesCurrentLanguage(m_locales);
+}
+
+// static
+bool AddonConditionWatcherLocales::matchesCurrentLanguage(
+    const QStringList& locales) {
   QString code = Localizer::instance()->languageCodeOrSystem();
   Q_ASSERT(!code.isEmpty());
 
   code = Localizer::majorLanguageCode(code);
-  return m_locales.contains(code.toLower());
+  return locales.contains(code.toLower());
 }
@@ -19,6 +19,9 @@ class AddonConditionWatcherLocales final : public AddonConditionWatcher {
 
   bool conditionApplied() const override;
 
+  // True if the current language is one of the (lowercase) locales.
+  static bool matchesCurrentLanguage(const QStringList& locales);
+
  private:
   AddonConditionWatcherLocales(QObject* parent, const QStringList& locales);
 
@@ -6,44 +6,30 @@
 
 #include <QDateTime>
 
+#include "addontimerwheel.h"
 #include "leakdetector.h"
-#include "mfbt/checkedint.h"
-#include "settingsholder.h"
 
 AddonConditionWatcherTime::AddonConditionWatcherTime(QObject* parent,
                                                      qint64 time, bool isStart)
     : AddonConditionWatcher(parent), m_time(time), m_isStart(isStart) {
   MZ_COUNT_CTOR(AddonConditionWatcherTime);
 
-  m_timer.setSingleShot(true);
-  connect(&m_timer, &QTimer::timeout, this, [this]() {
-    if (maybeStartTimer()) {
-      emit conditionChanged(m_isStart);
-    }
-  });
+  if (m_time <= QDateTime::currentSecsSinceEpoch()) {
+    return;
+  }
 
-  maybeStartTimer();
+  m_timerId = AddonTimerWheel::instance()->schedule(m_time, [this]() {
+    m_timerId = 0;
+    emit conditionChanged(m_isStart);
+  });
 }
 
 AddonConditionWatcherTime::~AddonConditionWatcherTime() {
   MZ_COUNT_DTOR(AddonConditionWatcherTime);
-}
 
-bool AddonConditionWatcherTime::conditionApplied() const {
-  return m_isStart != m_timer.isActive();
+  AddonTimerWheel::maybeCancel(m_timerId);
 }
 
-bool AddonConditionWatcherTime::maybeStartTimer() {
-  qint64 currentTime = QDateTime::currentSecsSinceEpoch();
-  if (m_time <= currentTime) {
-    return true;
-  }
-
-  CheckedInt<int> value(static_cast<int>(m_time - currentTime));
-  value *= 1000;
-
-  m_timer.start(value.isValid() ? value.value()
-                                : std::numeric_limits<int>::max());
-
-  return false;
+bool AddonConditionWatcherTime::conditionApplied() const {
+  return m_isStart != (m_timerId != 0);
 }
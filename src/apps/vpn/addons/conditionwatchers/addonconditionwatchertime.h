@@ -5,8 +5,6 @@
 #ifndef ADDONCONDITIONWATCHERTIME_H
 #define ADDONCONDITIONWATCHERTIME_H
 
-#include <QTimer>
-
 #include "addonconditionwatcher.h"
 
 class AddonConditionWatcherTime : public AddonConditionWatcher {
@@ -19,15 +17,12 @@ class AddonConditionWatcherTime : public AddonConditionWatcher {
 
   bool conditionApplied() const override;
 
- private:
-  // Return true if the timer does not need to run because the condition
-  // matches already.
-  bool maybeStartTimer();
-
  private:
   qint64 m_time = 0;
   bool m_isStart = false;
-  QTimer m_timer;
+
+  // The pending AddonTimerWheel deadline, or 0.
+  quint64 m_timerId = 0;
 };
 
 #endif  // ADDONCONDITIONWATCHERTIMESTART_H
@@ -5,8 +5,6 @@
 #ifndef ADDONCONDITIONWATCHERTIMEEND_H
 #define ADDONCONDITIONWATCHERTIMEEND_H
 
-#include <QTimer>
-
 #include "addonconditionwatchertime.h"
 
 class AddonConditionWatcherTimeEnd final : public AddonConditionWatcherTime {
@@ -6,8 +6,8 @@
 
 #include <QDateTime>
 
+#include "addontimerwheel.h"
 #include "leakdetector.h"
-#include "mfbt/checkedint.h"
 #include "settingsholder.h"
 
 // static
@@ -25,39 +25,26 @@ AddonConditionWatcherTriggerTimeSecs::AddonConditionWatcherTriggerTimeSecs(
     : AddonConditionWatcher(parent), m_triggerTimeSecs(triggerTimeSecs) {
   MZ_COUNT_CTOR(AddonConditionWatcherTriggerTimeSecs);
 
-  m_timer.setSingleShot(true);
-  connect(&m_timer, &QTimer::timeout, this, [this]() {
-    if (maybeStartTimer()) {
-      emit conditionChanged(true);
-    }
-  });
+  // Note: triggerTimeSecs is seconds!
+  qint64 deadline =
+      SettingsHolder::instance()->installationTime().toSecsSinceEpoch() +
+      m_triggerTimeSecs;
+  if (deadline <= QDateTime::currentSecsSinceEpoch()) {
+    return;
+  }
 
-  maybeStartTimer();
+  m_timerId = AddonTimerWheel::instance()->schedule(deadline, [this]() {
+    m_timerId = 0;
+    emit conditionChanged(true);
+  });
 }
 
 AddonConditionWatcherTriggerTimeSecs::~AddonConditionWatcherTriggerTimeSecs() {
   MZ_COUNT_DTOR(AddonConditionWatcherTriggerTimeSecs);
-}
 
-bool AddonConditionWatcherTriggerTimeSecs::conditionApplied() const {
-  return !m_timer.isActive();
+  AddonTimerWheel::maybeCancel(m_timerId);
 }
 
-bool AddonConditionWatcherTriggerTimeSecs::maybeStartTimer() {
-  QDateTime now = QDateTime::currentDateTime();
-  QDateTime installation = SettingsHolder::instance()->installationTime();
-
-  // Note: triggerTimeSecs is seconds!
-  CheckedInt<int> secs =
-      static_cast<int>(m_triggerTimeSecs - installation.secsTo(now));
-  if (secs.value() <= 0) {
-    return true;
-  }
-
-  m_timer.setSingleShot(true);
-  secs *= 1000;
-  m_timer.start(secs.isValid() ? secs.value()
-                               : std::numeric_limits<int>::max());
-
-  return false;
+bool AddonConditionWatcherTriggerTimeSecs::conditionApplied() const {
+  return m_timerId == 0;
 }
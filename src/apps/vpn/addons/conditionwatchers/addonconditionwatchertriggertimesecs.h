@@ -5,8 +5,6 @@
 #ifndef ADDONCONDITIONWATCHERTRIGGERTIMESECS_H
 #define ADDONCONDITIONWATCHERTRIGGERTIMESECS_H
 
-#include <QTimer>
-
 #include "addonconditionwatcher.h"
 
 class AddonConditionWatcherTriggerTimeSecs final
@@ -24,13 +22,11 @@ class AddonConditionWatcherTriggerTimeSecs final
  private:
   AddonConditionWatcherTriggerTimeSecs(QObject* parent, qint64 time);
 
-  // Return true if the timer does not need to run because the condition
-  // matches already.
-  bool maybeStartTimer();
-
  private:
   qint64 m_triggerTimeSecs = 0;
-  QTimer m_timer;
+
+  // The pending AddonTimerWheel deadline, or 0.
+  quint64 m_timerId = 0;
 };
 
 #endif  // ADDONCONDITIONWATCHERTRIGGERTIMESECS_H
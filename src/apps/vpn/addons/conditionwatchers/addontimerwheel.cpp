@@ -0,0 +1,304 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "addontimerwheel.h"
+
+#include <QDateTime>
+#include <QGuiApplication>
+#include <algorithm>
+#include <limits>
+
+#include "leakdetector.h"
+#include "logger.h"
+
+namespace {
+Logger logger("AddonTimerWheel");
+AddonTimerWheel* s_instance = nullptr;
+}  // namespace
+
+// static
+AddonTimerWheel* AddonTimerWheel::instance() {
+  if (!s_instance) {
+    s_instance = new AddonTimerWheel(QCoreApplication::instance());
+  }
+  return s_instance;
+}
+
+AddonTimerWheel::AddonTimerWheel(QObject* parent) : QObject(parent) {
+  MZ_COUNT_CTOR(AddonTimerWheel);
+
+  m_current = QDateTime::currentSecsSinceEpoch();
+
+  m_timer.setSingleShot(true);
+  m_timer.setTimerType(Qt::VeryCoarseTimer);
+  connect(&m_timer, &QTimer::timeout, this,
+          [this]() { advanceTo(QDateTime::currentSecsSinceEpoch()); });
+
+  QGuiApplication* app =
+      qobject_cast<QGuiApplication*>(QCoreApplication::instance());
+  if (app) {
+    connect(app, &QGuiApplication::applicationStateChanged, this,
+            [this](Qt::ApplicationState state) {
+              setSuspended(state == Qt::ApplicationSuspended);
+            });
+  }
+}
+
+AddonTimerWheel::~AddonTimerWheel() {
+  MZ_COUNT_DTOR(AddonTimerWheel);
+
+  if (s_instance == this) {
+    s_instance = nullptr;
+  }
+}
+
+quint64 AddonTimerWheel::schedule(qint64 deadline,
+                                  std::function<void()>&& callback) {
+  quint64 id = ++m_lastId;
+
+  Entry& entry = m_entries[id];
+  entry.m_deadline = deadline;
+  entry.m_callback = std::move(callback);
+  place(id, entry);
+
+  emit pendingCountChanged();
+  rearm();
+  return id;
+}
+
+void AddonTimerWheel::cancel(quint64 id) {
+  auto i = m_entries.find(id);
+  if (i == m_entries.end()) {
+    return;
+  }
+
+  unplace(i.value(), id);
+  m_entries.erase(i);
+
+  emit pendingCountChanged();
+  rearm();
+}
+
+// static
+void AddonTimerWheel::maybeCancel(quint64 id) {
+  if (id && s_instance) {
+    s_instance->cancel(id);
+  }
+}
+
+void AddonTimerWheel::setSuspended(bool suspended) {
+  if (m_suspended == suspended) {
+    return;
+  }
+
+  m_suspended = suspended;
+
+  if (m_suspended) {
+    logger.debug() << "Suspended with" << pendingCount() << "timers pending";
+    m_timer.stop();
+    return;
+  }
+
+  advanceTo(QDateTime::currentSecsSinceEpoch());
+}
+
+// static
+int AddonTimerWheel::digit(qint64 time, int level) {
+  return static_cast<int>((time >> (SLOT_BITS * level)) & (SLOTS - 1));
+}
+
+void AddonTimerWheel::place(quint64 id, Entry& entry) {
+  qint64 deadline = entry.m_deadline;
+
+  if (deadline <= m_current) {
+    entry.m_level = -1;
+    m_due.append(id);
+    return;
+  }
+
+  if ((deadline >> (SLOT_BITS * LEVELS)) !=
+      (m_current >> (SLOT_BITS * LEVELS))) {
+    entry.m_level = LEVELS;
+    m_overflow.insert(id);
+    return;
+  }
+
+  for (int level = LEVELS - 1; level >= 0; --level) {
+    if (digit(deadline, level) != digit(m_current, level)) {
+      entry.m_level = level;
+      entry.m_slot = digit(deadline, level);
+      m_slots[level][entry.m_slot].insert(id);
+      return;
+    }
+  }
+
+  Q_ASSERT(false);
+}
+
+void AddonTimerWheel::unplace(const Entry& entry, quint64 id) {
+  if (entry.m_level < 0) {
+    m_due.removeOne(id);
+  } else if (entry.m_level == LEVELS) {
+    m_overflow.remove(id);
+  } else {
+    m_slots[entry.m_level][entry.m_slot].remove(id);
+  }
+}
+
+void AddonTimerWheel::rebase(qint64 now) {
+  m_current = now;
+
+  m_due.clear();
+  m_overflow.clear();
+  for (auto& level : m_slots) {
+    for (QSet<quint64>& slot : level) {
+      slot.clear();
+    }
+  }
+
+  for (auto i = m_entries.begin(); i != m_entries.end(); ++i) {
+    place(i.key(), i.value());
+  }
+}
+
+bool AddonTimerWheel::firstSlot(int* level, int* slot) const {
+  // The slots up to the current digit of each level are always empty.
+  for (int l = 0; l < LEVELS; ++l) {
+    for (int s = digit(m_current, l) + 1; s < SLOTS; ++s) {
+      if (!m_slots[l][s].isEmpty()) {
+        *level = l;
+        *slot = s;
+        return true;
+      }
+    }
+  }
+
+  if (!m_overflow.isEmpty()) {
+    *level = LEVELS;
+    *slot = 0;
+    return true;
+  }
+
+  return false;
+}
+
+qint64 AddonTimerWheel::slotTime(int level, int slot) const {
+  if (level == LEVELS) {
+    int shift = SLOT_BITS * LEVELS;
+    return ((m_current >> shift) + 1) << shift;
+  }
+
+  int shift = SLOT_BITS * (level + 1);
+  return ((m_current >> shift) << shift) |
+         (static_cast<qint64>(slot) << (SLOT_BITS * level));
+}
+
+void AddonTimerWheel::advanceTo(qint64 now) {
+  // The wheel only moves forward. When the clock goes back (a manual change,
+  // an NTP correction), the slots and the due entries are relative to a time
+  // which has not come yet.
+  if (now < m_current) {
+    logger.debug() << "The clock went back by" << m_current - now << "seconds";
+    rebase(now);
+  }
+
+  QList<quint64> due;
+  due.swap(m_due);
+
+  // Move to the time of each non-empty slot in turn. The entries of a slot
+  // are either due, or go down to a lower level.
+  int level = 0;
+  int slot = 0;
+  while (now > m_current && firstSlot(&level, &slot)) {
+    qint64 time = slotTime(level, slot);
+    if (time > now) {
+      break;
+    }
+
+    m_current = time;
+
+    QSet<quint64> ids;
+    ids.swap(level == LEVELS ? m_overflow : m_slots[level][slot]);
+
+    for (quint64 id : ids) {
+      Entry& entry = m_entries[id];
+      if (entry.m_deadline <= m_current) {
+        entry.m_level = -1;
+        due.append(id);
+      } else {
+        place(id, entry);
+      }
+    }
+  }
+
+  m_current = std::max(m_current, now);
+
+  std::sort(due.begin(), due.end(), [this](quint64 a, quint64 b) {
+    qint64 deadlineA = m_entries[a].m_deadline;
+    qint64 deadlineB = m_entries[b].m_deadline;
+    return deadlineA != deadlineB ? deadlineA < deadlineB : a < b;
+  });
+
+  for (quint64 id : due) {
+    // A previous callback may have cancelled this one.
+    auto i = m_entries.find(id);
+    if (i == m_entries.end()) {
+      continue;
+    }
+
+    std::function<void()> callback = std::move(i->m_callback);
+    m_entries.erase(i);
+    callback();
+  }
+
+  if (!due.isEmpty()) {
+    logger.debug() << due.count() << "timers fired," << pendingCount()
+                   << "pending";
+    emit pendingCountChanged();
+  }
+
+  rearm();
+}
+
+qint64 AddonTimerWheel::nextDeadline() const {
+  int level = 0;
+  int slot = 0;
+  if (!firstSlot(&level, &slot)) {
+    return -1;
+  }
+
+  // The first slot of the lowest level holds the nearest deadline.
+  const QSet<quint64>& ids =
+      level == LEVELS ? m_overflow : m_slots[level][slot];
+
+  qint64 deadline = std::numeric_limits<qint64>::max();
+  for (quint64 id : ids) {
+    deadline = std::min(deadline, m_entries.constFind(id)->m_deadline);
+  }
+  return deadline;
+}
+
+void AddonTimerWheel::rearm() {
+  if (m_suspended) {
+    m_timer.stop();
+    return;
+  }
+
+  if (!m_due.isEmpty()) {
+    m_timer.start(0);
+    return;
+  }
+
+  qint64 deadline = nextDeadline();
+  if (deadline < 0) {
+    m_timer.stop();
+    return;
+  }
+
+  // The timer may fire a bit early: advanceTo() then does nothing, and the
+  // timer is armed again.
+  qint64 msecs = deadline * 1000 - QDateTime::currentMSecsSinceEpoch();
+  m_timer.start(static_cast<int>(
+      qBound<qint64>(0, msecs, std::numeric_limits<int>::max())));
+}
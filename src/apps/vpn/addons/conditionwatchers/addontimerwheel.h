@@ -0,0 +1,105 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef ADDONTIMERWHEEL_H
+#define ADDONTIMERWHEEL_H
+
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QSet>
+#include <QTimer>
+#include <functional>
+
+// The deadlines of all the time-based addon condition watchers.
+//
+// Deadlines are wall-clock times, in seconds since the epoch, kept in a
+// hierarchical timer wheel: each level has 64 slots, and a level covers 64
+// times the range of the level below it. A deadline is stored at the level
+// of the most significant 6-bit digit in which it differs from the current
+// time, and moves down a level each time that digit is reached. Scheduling,
+// cancelling and firing are O(1), whatever the number of deadlines.
+//
+// A single coarse QTimer wakes the event loop at the nearest deadline, and
+// all the deadlines of the same second fire together. The timer is stopped
+// while the application is suspended: the deadlines which passed in the
+// meantime fire when it is active again. If the wall clock goes back, the
+// wheel is rebuilt around the new time.
+class AddonTimerWheel final : public QObject {
+  Q_OBJECT
+  Q_DISABLE_COPY_MOVE(AddonTimerWheel)
+
+  Q_PROPERTY(int pendingCount READ pendingCount NOTIFY pendingCountChanged)
+
+ public:
+  static AddonTimerWheel* instance();
+
+  explicit AddonTimerWheel(QObject* parent = nullptr);
+  ~AddonTimerWheel();
+
+  // Calls `callback` once, at `deadline` or as soon as possible after it.
+  // Returns an ID for cancel(), never 0.
+  quint64 schedule(qint64 deadline, std::function<void()>&& callback);
+  void cancel(quint64 id);
+
+  // Cancels the timer, unless the ID is 0 or the wheel is already gone.
+  static void maybeCancel(quint64 id);
+
+  int pendingCount() const { return static_cast<int>(m_entries.count()); }
+
+  bool isSuspended() const { return m_suspended; }
+  void setSuspended(bool suspended);
+
+  // Fires everything due by `now`. This is called by the timer, with the
+  // current time, and by tests.
+  void advanceTo(qint64 now);
+
+ signals:
+  void pendingCountChanged();
+
+ private:
+  static constexpr int SLOT_BITS = 6;
+  static constexpr int SLOTS = 1 << SLOT_BITS;
+  static constexpr int LEVELS = 6;
+
+  struct Entry {
+    qint64 m_deadline = 0;
+    std::function<void()> m_callback;
+    // -1 when the entry is due, LEVELS when it is too far in the future.
+    int m_level = -1;
+    int m_slot = 0;
+  };
+
+  void place(quint64 id, Entry& entry);
+  void unplace(const Entry& entry, quint64 id);
+
+  // Places all the entries again, relative to `now`.
+  void rebase(qint64 now);
+
+  static int digit(qint64 time, int level);
+
+  // The first non-empty slot, from the lowest level. Returns false if the
+  // wheel is empty.
+  bool firstSlot(int* level, int* slot) const;
+
+  // When the current time reaches a slot.
+  qint64 slotTime(int level, int slot) const;
+
+  qint64 nextDeadline() const;
+  void rearm();
+
+ private:
+  qint64 m_current = 0;
+  quint64 m_lastId = 0;
+
+  QHash<quint64, Entry> m_entries;
+  QSet<quint64> m_slots[LEVELS][SLOTS];
+  QSet<quint64> m_overflow;
+  QList<quint64> m_due;
+
+  QTimer m_timer;
+  bool m_suspended = false;
+};
+
+#endif  // ADDONTIMERWHEEL_H
@@ -6,7 +6,9 @@
 
 #include <QCoreApplication>
 #include <QCryptographicHash>
+#include <QDateTime>
 #include <QDir>
+#include <QFile>
 #include <QFileInfo>
 #include <QJsonArray>
 #include <QJsonDocument>
@@ -19,6 +21,7 @@
 #include "addondirectory.h"
 #include "addonindex.h"
 #include "addons/addonmessage.h"
+#include "addons/conditionwatchers/addonconditionwatcherlocales.h"
 #include "appconstants.h"
 #include "feature.h"
 #include "leakdetector.h"
@@ -36,6 +39,16 @@ constexpr const char* MVPN_ENV_SKIP_ADDON_SIGNATURE =
 namespace {
 Logger logger("AddonManager");
 AddonManager* s_instance = nullptr;
+
+QJsonObject manifestConditions(const QString& manifestFileName) {
+  QFile file(manifestFileName);
+  if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+    return QJsonObject();
+  }
+
+  QJsonObject obj = QJsonDocument::fromJson(file.readAll()).object();
+  return obj["conditions"].toObject();
+}
 }  // namespace
 
 // static
@@ -81,6 +94,9 @@ void AddonManager::initialize() {
   // Listen for updates in the addons list
   connect(&m_addonIndex, &AddonIndex::indexUpdated, this,
           &AddonManager::updateAddonsList);
+
+  connect(SettingsHolder::instance(), &SettingsHolder::languageCodeChanged,
+          this, &AddonManager::mountPendingAddons);
 }
 
 void AddonManager::updateIndex(bool status, const QByteArray& index,
@@ -125,12 +141,22 @@ void AddonManager::updateAddonsList(bool status, QList<AddonData> addons) {
     removeAddon(addonId);
   }
 
+  // Verify the new addons all together.
+  QList<AddonData> newAddons;
+  for (const AddonData& addonData : addons) {
+    if (!m_addons.contains(addonData.m_addonId)) {
+      newAddons.append(addonData);
+    }
+  }
+  QSet<QString> verifiedAddons = m_verifier.verify(newAddons);
+
   bool taskAdded = false;
 
   // Fetch new addons
   for (const AddonData& addonData : addons) {
     if (!m_addons.contains(addonData.m_addonId) &&
-        validateAndLoad(addonData.m_addonId, addonData.m_sha256)) {
+        validateAndLoad(addonData.m_addonId, addonData.m_sha256,
+                        verifiedAddons.contains(addonData.m_addonId))) {
       continue;
     }
 
@@ -214,8 +240,7 @@ void AddonManager::unload(const QString& addonId) {
 
     QDir dir;
     if (m_addonDirectory.getDirectory(&dir)) {
-      QString addonFileName(QString("%1.rcc").arg(addonId));
-      QString addonFilePath(dir.filePath(addonFileName));
+      QString addonFilePath(dir.filePath(AddonVerifier::fileName(addonId)));
       QResource::unregisterResource(addonFilePath, mountPath(addonId));
     }
 
@@ -223,6 +248,7 @@ void AddonManager::unload(const QString& addonId) {
   }
 
   m_addons.remove(addonId);
+  m_pendingAddons.remove(addonId);
   emit countChanged();
 }
 
@@ -237,12 +263,12 @@ void AddonManager::retranslate() {
 
 // static
 void AddonManager::removeAddon(const QString& addonId) {
-  QString addonFileName(QString("%1.rcc").arg(addonId));
-  instance()->m_addonDirectory.deleteFile(addonFileName);
+  instance()->m_verifier.forget(addonId);
+  instance()->m_addonDirectory.deleteFile(AddonVerifier::fileName(addonId));
 }
 
 bool AddonManager::validateAndLoad(const QString& addonId,
-                                   const QByteArray& sha256, bool checkSha256) {
+                                   const QByteArray& sha256, bool verified) {
   logger.debug() << "Load addon" << addonId;
 
 #ifdef MZ_WASM
@@ -259,30 +285,27 @@ bool AddonManager::validateAndLoad(const QString& addonId,
 
   m_addons.insert(addonId, {QByteArray(), addonId, nullptr});
 
-  QString addonFileName(QString("%1.rcc").arg(addonId));
+  // The hash is checked by AddonVerifier.
+  if (!verified) {
+    return false;
+  }
 
   QDir dir;
   if (!m_addonDirectory.getDirectory(&dir)) {
     return false;
   }
-  QString addonFilePath(dir.filePath(addonFileName));
+  QString addonFilePath(dir.filePath(AddonVerifier::fileName(addonId)));
 
-  // Hash validation
-  if (checkSha256) {
-    QByteArray addonFileContents;
-
-    if (!m_addonDirectory.readFile(addonFileName, &addonFileContents)) {
-      return false;
-    }
+  m_addons[addonId].m_sha256 = sha256;
 
-    if (QCryptographicHash::hash(addonFileContents,
-                                 QCryptographicHash::Sha256) != sha256) {
-      logger.warning() << "Addon hash does not match" << addonFilePath;
-      return false;
-    }
+  // If we already know that the addon cannot be enabled, we do not mount it.
+  QJsonObject conditions;
+  bool conditionsKnown = m_verifier.conditions(addonId, sha256, &conditions);
+  if (conditionsKnown && !canBeMounted(addonId, conditions)) {
+    logger.debug() << "Addon" << addonId << "not mounted";
+    return true;
   }
 
-  m_addons[addonId].m_sha256 = sha256;
   QString addonMountPath = mountPath(addonId);
 
   if (!QResource::registerResource(addonFilePath, addonMountPath)) {
@@ -290,7 +313,12 @@ bool AddonManager::validateAndLoad(const QString& addonId,
     return false;
   }
 
-  if (!loadManifest(QString(":%1/manifest.json").arg(addonMountPath))) {
+  QString manifestFileName(QString(":%1/manifest.json").arg(addonMountPath));
+  if (!conditionsKnown) {
+    m_verifier.setConditions(addonId, manifestConditions(manifestFileName));
+  }
+
+  if (!loadManifest(manifestFileName)) {
     QResource::unregisterResource(addonFilePath, addonMountPath);
     return false;
   }
@@ -316,12 +344,14 @@ void AddonManager::storeAndLoadAddon(const QByteArray& addonData,
     return;
   }
 
-  QString addonFileName(QString("%1.rcc").arg(addonId));
-  if (!m_addonDirectory.writeToFile(addonFileName, addonData)) {
+  if (!m_addonDirectory.writeToFile(AddonVerifier::fileName(addonId),
+                                    addonData)) {
     return;
   }
 
-  if (!validateAndLoad(addonId, sha256, false)) {
+  m_verifier.remember(addonId, sha256);
+
+  if (!validateAndLoad(addonId, sha256, true)) {
     logger.warning() << "Unable to load the addon";
   }
 }
@@ -439,6 +469,48 @@ void AddonManager::reinstateMessages() const {
   settingsHolder->clearAddonSettings(ADDON_MESSAGE_SETTINGS_GROUP);
 }
 
+bool AddonManager::canBeMounted(const QString& addonId,
+                                const QJsonObject& conditions) {
+  if (!Addon::evaluateConditions(conditions)) {
+    return false;
+  }
+
+  // Once the end time has passed, the addon is never enabled again.
+  if (conditions.contains("end_time") &&
+      conditions["end_time"].toInteger() <=
+          QDateTime::currentSecsSinceEpoch()) {
+    return false;
+  }
+
+  QStringList locales;
+  for (const QJsonValue& value : conditions["locales"].toArray()) {
+    locales.append(value.toString().toLower());
+  }
+
+  if (!locales.isEmpty() &&
+      !AddonConditionWatcherLocales::matchesCurrentLanguage(locales)) {
+    m_pendingAddons.insert(addonId);
+    return false;
+  }
+
+  return true;
+}
+
+void AddonManager::mountPendingAddons() {
+  QSet<QString> pendingAddons;
+  pendingAddons.swap(m_pendingAddons);
+
+  for (const QString& addonId : pendingAddons) {
+    if (!m_addons.contains(addonId) || m_addons[addonId].m_addon) {
+      continue;
+    }
+
+    QByteArray sha256 = m_addons[addonId].m_sha256;
+    m_addons.remove(addonId);
+    validateAndLoad(addonId, sha256, true);
+  }
+}
+
 // static
 QString AddonManager::mountPath(const QString& addonId) {
   return QString("/addons/%1").arg(addonId);
@@ -451,6 +523,7 @@ void AddonManager::refreshAddons() {
 
 void AddonManager::reset() {
   m_addonDirectory.reset();
+  m_verifier.reset();
 
   QStringList addonIds;
   for (QMap<QString, AddonData>::const_iterator i(m_addons.constBegin());
@@ -8,8 +8,10 @@
 #include <QAbstractListModel>
 #include <QJSValue>
 #include <QMap>
+#include <QSet>
 
 #include "addonindex.h"
+#include "addonverifier.h"
 #include "addons/addon.h"  // required for the signal
 
 class AddonManager final : public QAbstractListModel {
@@ -78,7 +80,10 @@ class AddonManager final : public QAbstractListModel {
   void refreshAddons();
 
   bool validateAndLoad(const QString& addonId, const QByteArray& sha256,
-                       bool checkSha256 = true);
+                       bool verified);
+
+  bool canBeMounted(const QString& addonId, const QJsonObject& conditions);
+  void mountPendingAddons();
 
   static void removeAddon(const QString& addonId);
 
@@ -109,6 +114,10 @@ class AddonManager final : public QAbstractListModel {
 
   AddonIndex m_addonIndex;
   AddonDirectory m_addonDirectory;
+  AddonVerifier m_verifier;
+
+  // Verified addons which are not mounted until the language changes.
+  QSet<QString> m_pendingAddons;
 };
 
 #endif  // ADDONMANAGER_H
@@ -0,0 +1,263 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "addonverifier.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QSemaphore>
+#include <QThreadPool>
+
+#ifdef Q_OS_UNIX
+#  include <sys/stat.h>
+#endif
+
+#include "addondirectory.h"
+#include "leakdetector.h"
+#include "logger.h"
+
+namespace {
+Logger logger("AddonVerifier");
+}  // namespace
+
+AddonVerifier::AddonVerifier() {
+  MZ_COUNT_CTOR(AddonVerifier);
+  load();
+}
+
+AddonVerifier::~AddonVerifier() { MZ_COUNT_DTOR(AddonVerifier); }
+
+// static
+QString AddonVerifier::fileName(const QString& addonId) {
+  return QString("%1.rcc").arg(addonId);
+}
+
+QSet<QString> AddonVerifier::verify(const QList<AddonData>& addons) {
+  QSet<QString> verified;
+
+  QDir dir;
+  if (!AddonDirectory::getDirectory(&dir)) {
+    return verified;
+  }
+
+  struct Job {
+    QString m_addonId;
+    QByteArray m_sha256;
+    QString m_filePath;
+    FileIdentity m_identity;
+    QByteArray m_hash;
+  };
+
+  QList<Job> jobs;
+  for (const AddonData& addonData : addons) {
+    QString filePath = dir.filePath(fileName(addonData.m_addonId));
+    FileIdentity fileIdentity = identity(filePath);
+    if (!fileIdentity.isValid()) {
+      continue;
+    }
+
+    auto i = m_entries.constFind(addonData.m_addonId);
+    if (i != m_entries.constEnd() && i->m_sha256 == addonData.m_sha256 &&
+        i->m_identity == fileIdentity) {
+      verified.insert(addonData.m_addonId);
+      continue;
+    }
+
+    jobs.append({addonData.m_addonId, addonData.m_sha256, filePath,
+                 fileIdentity, QByteArray()});
+  }
+
+  if (jobs.isEmpty()) {
+    return verified;
+  }
+
+  logger.debug() << "Hashing" << jobs.count() << "addons";
+
+#ifdef MZ_WASM
+  for (Job& job : jobs) {
+    job.m_hash = hashFile(job.m_filePath);
+  }
+#else
+  // Each job writes only its own slot: the list is not touched until all of
+  // them are done.
+  QSemaphore done;
+  for (Job& job : jobs) {
+    QThreadPool::globalInstance()->start([&job, &done]() {
+      job.m_hash = hashFile(job.m_filePath);
+      done.release();
+    });
+  }
+  done.acquire(static_cast<int>(jobs.count()));
+#endif
+
+  for (const Job& job : jobs) {
+    if (job.m_hash != job.m_sha256) {
+      logger.warning() << "Addon hash does not match" << job.m_filePath;
+      m_entries.remove(job.m_addonId);
+      continue;
+    }
+
+    Entry& entry = m_entries[job.m_addonId];
+    if (entry.m_sha256 != job.m_sha256) {
+      entry.m_conditions = QJsonObject();
+      entry.m_hasConditions = false;
+    }
+    entry.m_sha256 = job.m_sha256;
+    entry.m_identity = job.m_identity;
+
+    verified.insert(job.m_addonId);
+  }
+
+  save();
+  return verified;
+}
+
+void AddonVerifier::remember(const QString& addonId,
+                             const QByteArray& sha256) {
+  QDir dir;
+  if (!AddonDirectory::getDirectory(&dir)) {
+    return;
+  }
+
+  FileIdentity fileIdentity = identity(dir.filePath(fileName(addonId)));
+  if (!fileIdentity.isValid()) {
+    return;
+  }
+
+  Entry entry;
+  entry.m_sha256 = sha256;
+  entry.m_identity = fileIdentity;
+  m_entries.insert(addonId, entry);
+
+  save();
+}
+
+void AddonVerifier::forget(const QString& addonId) {
+  if (m_entries.remove(addonId)) {
+    save();
+  }
+}
+
+bool AddonVerifier::conditions(const QString& addonId,
+                               const QByteArray& sha256,
+                               QJsonObject* conditions) const {
+  auto i = m_entries.constFind(addonId);
+  if (i == m_entries.constEnd() || i->m_sha256 != sha256 ||
+      !i->m_hasConditions) {
+    return false;
+  }
+
+  *conditions = i->m_conditions;
+  return true;
+}
+
+void AddonVerifier::setConditions(const QString& addonId,
+                                  const QJsonObject& conditions) {
+  auto i = m_entries.find(addonId);
+  if (i == m_entries.end()) {
+    return;
+  }
+
+  if (i->m_hasConditions && i->m_conditions == conditions) {
+    return;
+  }
+
+  i->m_conditions = conditions;
+  i->m_hasConditions = true;
+  save();
+}
+
+// static
+AddonVerifier::FileIdentity AddonVerifier::identity(const QString& filePath) {
+  FileIdentity fileIdentity;
+
+  QFileInfo info(filePath);
+  if (!info.exists()) {
+    return fileIdentity;
+  }
+
+  fileIdentity.m_size = info.size();
+  fileIdentity.m_modified = info.lastModified().toMSecsSinceEpoch();
+
+#ifdef Q_OS_UNIX
+  struct stat st;
+  if (stat(QFile::encodeName(filePath).constData(), &st) == 0) {
+    fileIdentity.m_inode = static_cast<quint64>(st.st_ino);
+  }
+#endif
+
+  return fileIdentity;
+}
+
+// static
+QByteArray AddonVerifier::hashFile(const QString& filePath) {
+  QFile file(filePath);
+  if (!file.open(QIODevice::ReadOnly)) {
+    return QByteArray();
+  }
+
+  QCryptographicHash hash(QCryptographicHash::Sha256);
+  if (!hash.addData(&file)) {
+    return QByteArray();
+  }
+
+  return hash.result();
+}
+
+void AddonVerifier::load() {
+  QByteArray content;
+  if (!AddonDirectory::readFile(ADDON_VERIFIED_INDEX_FILENAME, &content)) {
+    return;
+  }
+
+  QJsonDocument json = QJsonDocument::fromJson(content);
+  if (!json.isObject()) {
+    logger.warning() << "Invalid verified-hash index";
+    return;
+  }
+
+  QJsonObject obj = json.object();
+  for (auto i = obj.constBegin(); i != obj.constEnd(); ++i) {
+    QJsonObject entryObj = i.value().toObject();
+
+    Entry entry;
+    entry.m_sha256 =
+        QByteArray::fromHex(entryObj["sha256"].toString().toLocal8Bit());
+    entry.m_identity.m_size = entryObj["size"].toInteger(-1);
+    entry.m_identity.m_modified = entryObj["modified"].toInteger();
+    entry.m_identity.m_inode = entryObj["inode"].toString().toULongLong();
+    entry.m_hasConditions = entryObj.contains("conditions");
+    entry.m_conditions = entryObj["conditions"].toObject();
+
+    if (entry.m_sha256.isEmpty() || !entry.m_identity.isValid()) {
+      continue;
+    }
+
+    m_entries.insert(i.key(), entry);
+  }
+}
+
+void AddonVerifier::save() const {
+  QJsonObject obj;
+  for (auto i = m_entries.constBegin(); i != m_entries.constEnd(); ++i) {
+    QJsonObject entryObj;
+    entryObj["sha256"] = QString(i->m_sha256.toHex());
+    entryObj["size"] = i->m_identity.m_size;
+    entryObj["modified"] = i->m_identity.m_modified;
+    // JSON numbers are doubles: the inode does not always fit.
+    entryObj["inode"] = QString::number(i->m_identity.m_inode);
+    if (i->m_hasConditions) {
+      entryObj["conditions"] = i->m_conditions;
+    }
+    obj[i.key()] = entryObj;
+  }
+
+  AddonDirectory::writeToFile(
+      ADDON_VERIFIED_INDEX_FILENAME,
+      QJsonDocument(obj).toJson(QJsonDocument::Compact));
+}
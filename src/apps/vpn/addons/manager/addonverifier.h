@@ -0,0 +1,78 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef ADDONVERIFIER_H
+#define ADDONVERIFIER_H
+
+#include <QHash>
+#include <QJsonObject>
+#include <QList>
+#include <QSet>
+#include <QString>
+
+#include "addonindex.h"
+
+constexpr const char* ADDON_VERIFIED_INDEX_FILENAME = "verified.json";
+
+// Checks the addon files against the SHA-256 hashes of the addon index.
+//
+// The files are hashed in parallel on the global thread pool. Each verified
+// file is recorded in a verified-hash index, together with its size,
+// modification time and inode: as long as these do not change, the file is
+// not read again on the next launch. The index also keeps the conditions of
+// the addon manifest, so that the addon manager can decide whether to mount
+// an addon before touching its file.
+class AddonVerifier final {
+ public:
+  AddonVerifier();
+  ~AddonVerifier();
+
+  // Returns the IDs of the addons whose file matches the expected hash.
+  QSet<QString> verify(const QList<AddonData>& addons);
+
+  // Records a file just written by us, without reading it back.
+  void remember(const QString& addonId, const QByteArray& sha256);
+  void forget(const QString& addonId);
+
+  // The conditions of the addon manifest, if known.
+  bool conditions(const QString& addonId, const QByteArray& sha256,
+                  QJsonObject* conditions) const;
+  void setConditions(const QString& addonId, const QJsonObject& conditions);
+
+  // Drops the in-memory index. The file goes away with the addon directory.
+  void reset() { m_entries.clear(); }
+
+  static QString fileName(const QString& addonId);
+
+ private:
+  struct FileIdentity {
+    qint64 m_size = -1;
+    qint64 m_modified = 0;
+    quint64 m_inode = 0;
+
+    bool isValid() const { return m_size >= 0; }
+    bool operator==(const FileIdentity& other) const {
+      return m_size == other.m_size && m_modified == other.m_modified &&
+             m_inode == other.m_inode;
+    }
+  };
+
+  struct Entry {
+    QByteArray m_sha256;
+    FileIdentity m_identity;
+    QJsonObject m_conditions;
+    bool m_hasConditions = false;
+  };
+
+  static FileIdentity identity(const QString& filePath);
+  static QByteArray hashFile(const QString& filePath);
+
+  void load();
+  void save() const;
+
+ private:
+  QHash<QString, Entry> m_entries;
+};
+
+#endif  // ADDONVERIFIER_H
@@ -20,7 +20,7 @@ constexpr const char* SETTINGS_APP_NAME = "vpn";
 constexpr const char* NETWORK_USERAGENT_PREFIX = "MozillaVPN";
 
 // The file name for the logging
-constexpr const char* LOG_FILE_NAME = "mozillavpn.txt";
+constexpr const char* LOG_FILE_NAME = "mozillavpn.log";
 
 // Number of msecs for the captive-portal block alert.
 constexpr uint32_t CAPTIVE_PORTAL_ALERT_MSEC = 4000;
@@ -49,6 +49,15 @@ constexpr uint32_t BENCHMARK_MAX_DURATION_PING = 3000;
 constexpr uint32_t BENCHMARK_MAX_DURATION_TRANSFER = 15000;
 constexpr uint32_t BENCHMARK_THRESHOLD_SPEED_FAST = 25000000;    // 25 Megabit
 constexpr uint32_t BENCHMARK_THRESHOLD_SPEED_MEDIUM = 10000000;  // 10 Megabit
+// Uplinks are usually much slower than downlinks.
+constexpr uint32_t BENCHMARK_THRESHOLD_UPLOAD_SPEED_FAST = 5000000;    // 5 Mbit
+constexpr uint32_t BENCHMARK_THRESHOLD_UPLOAD_SPEED_MEDIUM = 2000000;  // 2 Mbit
+// A single TCP stream does not fill a fast link.
+constexpr int BENCHMARK_STREAMS = 4;
+// The throughput is sampled at each interval; the samples of the first
+// seconds, while TCP ramps up, are not counted.
+constexpr uint32_t BENCHMARK_SAMPLE_INTERVAL = 250;
+constexpr uint32_t BENCHMARK_WARMUP_DURATION = 2000;
 constexpr const char* BENCHMARK_DOWNLOAD_URL =
     "https://archive.mozilla.org/pub/vpn/speedtest/50m.data";
 
@@ -340,14 +340,14 @@ SETTING_STRINGLIST(recentConnectionsDeprecated,        // getter
                    true                                // remove when reset
 )
 
-SETTING_BYTEARRAY(servers,        // getter
-                  setServers,     // setter
-                  removeServers,  // remover
-                  hasServers,     // has
-                  "servers",      // key
-                  "",             // default value
-                  false,          // user setting
-                  true            // remove when reset
+SETTING_BLOB(servers,        // getter
+             setServers,     // setter
+             removeServers,  // remover
+             hasServers,     // has
+             "servers",      // key
+             "",             // default value
+             false,          // user setting
+             true            // remove when reset
 )
 
 SETTING_BYTEARRAY(serverData,        // getter
@@ -360,6 +360,16 @@ SETTING_BYTEARRAY(serverData,        // getter
                   true               // remove when reset
 )
 
+SETTING_BYTEARRAY(serverLatencyHistory,        // getter
+                  setServerLatencyHistory,     // setter
+                  removeServerLatencyHistory,  // remover
+                  hasServerLatencyHistory,     // has
+                  "serverLatencyHistory",      // key
+                  "",                          // default value
+                  false,                       // user setting
+                  true                         // remove when reset
+)
+
 SETTING_BOOL(serverSwitchNotification,        // getter
              setServerSwitchNotification,     // setter
              removeServerSwitchNotification,  // remover
@@ -10,6 +10,13 @@
 
 constexpr int32_t CAPTIVEPORTAL_LOOKUPTIMER = 5000;
 
+// How long a verdict is trusted for a network we have seen recently.
+constexpr int64_t CAPTIVEPORTAL_NOPORTAL_CACHE_MSEC = 5 * 60 * 1000;
+constexpr int64_t CAPTIVEPORTAL_PORTAL_CACHE_MSEC = 30 * 1000;
+
+// Networks remembered at most.
+constexpr int32_t CAPTIVEPORTAL_CACHE_MAX_NETWORKS = 32;
+
 constexpr const char* CAPTIVEPORTAL_HOST = "detectportal.firefox.com";
 constexpr const char* CAPTIVEPORTAL_URL_IPV4 = "http://%1/success.txt";
 constexpr const char* CAPTIVEPORTAL_URL_IPV6 = "http://[%1]/success.txt";
@@ -0,0 +1,76 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "captiveportalcache.h"
+
+#include <QDeadlineTimer>
+
+#include "captiveportal.h"
+#include "leakdetector.h"
+
+CaptivePortalCache::CaptivePortalCache() { MZ_COUNT_CTOR(CaptivePortalCache); }
+
+CaptivePortalCache::~CaptivePortalCache() {
+  MZ_COUNT_DTOR(CaptivePortalCache);
+}
+
+void CaptivePortalCache::insert(
+    const QString& networkId, CaptivePortalRequest::CaptivePortalResult result,
+    qint64 now) {
+  if (networkId.isEmpty()) {
+    return;
+  }
+
+  // A failure tells nothing about the network, and does not invalidate what
+  // we knew.
+  if (result == CaptivePortalRequest::CaptivePortalResult::Failure) {
+    return;
+  }
+
+  removeExpired(now);
+
+  if (!m_verdicts.contains(networkId) &&
+      m_verdicts.count() >= CAPTIVEPORTAL_CACHE_MAX_NETWORKS) {
+    // Forget the verdict which expires first.
+    auto oldest = m_verdicts.begin();
+    for (auto i = m_verdicts.begin(); i != m_verdicts.end(); ++i) {
+      if (i->m_expiresAt < oldest->m_expiresAt) {
+        oldest = i;
+      }
+    }
+    m_verdicts.erase(oldest);
+  }
+
+  qint64 ttl =
+      result == CaptivePortalRequest::CaptivePortalResult::PortalDetected
+          ? CAPTIVEPORTAL_PORTAL_CACHE_MSEC
+          : CAPTIVEPORTAL_NOPORTAL_CACHE_MSEC;
+  m_verdicts.insert(networkId, Verdict{result, now + ttl});
+}
+
+CaptivePortalRequest::CaptivePortalResult CaptivePortalCache::lookup(
+    const QString& networkId, qint64 now) const {
+  auto i = m_verdicts.constFind(networkId);
+  if (networkId.isEmpty() || i == m_verdicts.constEnd() ||
+      i->m_expiresAt <= now) {
+    return CaptivePortalRequest::CaptivePortalResult::Failure;
+  }
+
+  return i->m_result;
+}
+
+void CaptivePortalCache::removeExpired(qint64 now) {
+  for (auto i = m_verdicts.begin(); i != m_verdicts.end();) {
+    if (i->m_expiresAt <= now) {
+      i = m_verdicts.erase(i);
+    } else {
+      ++i;
+    }
+  }
+}
+
+// static
+qint64 CaptivePortalCache::now() {
+  return QDeadlineTimer::current().deadline();
+}
@@ -0,0 +1,56 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef CAPTIVEPORTALCACHE_H
+#define CAPTIVEPORTALCACHE_H
+
+#include <QHash>
+#include <QString>
+
+#include "captiveportalrequest.h"
+
+// The last captive portal verdicts, per network.
+//
+// A network seen recently does not need to be probed again: its verdict is
+// reused until it expires. A portal usually goes away when the user logs in,
+// so PortalDetected expires much sooner than NoPortal. Failures are never
+// stored. The time is passed by the caller, in msec: now() in the app.
+class CaptivePortalCache final {
+  Q_DISABLE_COPY_MOVE(CaptivePortalCache)
+
+ public:
+  CaptivePortalCache();
+  ~CaptivePortalCache();
+
+  // An empty network ID means that we do not know the network: nothing is
+  // stored.
+  void insert(const QString& networkId,
+              CaptivePortalRequest::CaptivePortalResult result, qint64 now);
+
+  // Returns Failure if there is no fresh verdict for the network.
+  CaptivePortalRequest::CaptivePortalResult lookup(const QString& networkId,
+                                                   qint64 now) const;
+
+  void remove(const QString& networkId) { m_verdicts.remove(networkId); }
+
+  void clear() { m_verdicts.clear(); }
+
+  // A monotonic clock, in msec.
+  static qint64 now();
+
+  int count() const { return static_cast<int>(m_verdicts.count()); }
+
+ private:
+  void removeExpired(qint64 now);
+
+ private:
+  struct Verdict {
+    CaptivePortalRequest::CaptivePortalResult m_result;
+    qint64 m_expiresAt;
+  };
+
+  QHash<QString, Verdict> m_verdicts;
+};
+
+#endif  // CAPTIVEPORTALCACHE_H
@@ -121,6 +121,20 @@ void CaptivePortalDetection::detectCaptivePortal() {
 
   logger.debug() << "Captive portal detection started";
 
+  // Only an activation may reuse what we know about the network. An
+  // instability is exactly when a portal may have appeared (for instance, an
+  // expired session), and we do not detect again until the connection is
+  // stable: let's probe.
+  QString networkId = vpn->networkWatcher()->currentNetworkId();
+  if (state == Controller::StateOn) {
+    m_cache.remove(networkId);
+  }
+
+  // A cached verdict is not a detection: if the connection becomes unstable,
+  // we must probe.
+  m_cachedVerdict = m_cache.lookup(networkId, CaptivePortalCache::now()) !=
+                    CaptivePortalRequest::CaptivePortalResult::Failure;
+
 #if defined(MZ_LINUX) || defined(MZ_MACOS) || defined(MZ_WINDOWS)
   m_impl.reset(new CaptivePortalDetectionImpl());
 #else
@@ -145,6 +159,7 @@ void CaptivePortalDetection::settingsChanged() {
     captivePortalMonitor()->stop();
     captivePortalBackgroundMonitor()->stop();
     m_impl.reset();
+    m_cache.clear();
   }
 }
 
@@ -152,7 +167,9 @@ void CaptivePortalDetection::detectionCompleted(
     CaptivePortalRequest::CaptivePortalResult detected) {
   logger.debug() << "Detection completed:" << detected;
   m_impl.reset();
-  m_shouldRun = false;
+  if (!m_cachedVerdict) {
+    m_shouldRun = false;
+  }
   switch (detected) {
     case CaptivePortalRequest::CaptivePortalResult::NoPortal:
     case CaptivePortalRequest::CaptivePortalResult::Failure:
@@ -7,6 +7,7 @@
 
 #include <QObject>
 
+#include "captiveportalcache.h"
 #include "captiveportalrequest.h"
 
 class CaptivePortalDetectionImpl;
@@ -27,6 +28,8 @@ class CaptivePortalDetection final : public QObject {
   void detectCaptivePortal();
   void captivePortalDetected();
 
+  CaptivePortalCache* cache() { return &m_cache; }
+
  signals:
   void captivePortalPresent();
 
@@ -49,6 +52,7 @@ class CaptivePortalDetection final : public QObject {
  private:
   bool m_active = false;
   bool m_shouldRun = true;
+  bool m_cachedVerdict = false;
 
   // Don't use it directly. Use captivePortalMonitor().
   CaptivePortalMonitor* m_captivePortalMonitor = nullptr;
@@ -59,6 +63,9 @@ class CaptivePortalDetection final : public QObject {
   CaptivePortalNotifier* m_captivePortalNotifier = nullptr;
 
   QScopedPointer<CaptivePortalDetectionImpl> m_impl;
+
+  // The verdicts of the last detections, per network.
+  CaptivePortalCache m_cache;
 };
 
 #endif  // CAPTIVEPORTALDETECTION_H
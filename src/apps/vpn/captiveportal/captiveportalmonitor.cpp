@@ -48,7 +48,9 @@ void CaptivePortalMonitor::maybeCheck() {
 void CaptivePortalMonitor::check() {
   logger.debug() << "Checking the internet connectivity";
 
-  CaptivePortalRequestTask* task = new CaptivePortalRequestTask(false);
+  // The monitor looks for changes on the current network: it always probes,
+  // and keeps the cached verdict up to date.
+  CaptivePortalRequestTask* task = new CaptivePortalRequestTask(false, false);
   connect(task, &CaptivePortalRequestTask::operationCompleted, this,
           [this](CaptivePortalRequest::CaptivePortalResult result) {
             logger.debug() << "Captive portal detection:" << result;
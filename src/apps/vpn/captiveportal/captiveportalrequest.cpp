@@ -34,12 +34,13 @@ void CaptivePortalRequest::run() {
     emit completed(NoPortal);
     return;
   }
+  m_requests.clear();
   m_running = 0;
-  m_success = 0;
+  m_completed = false;
 
   // We do not care which request succeeds.
-  // Let's make 1 request for any available IP addresses. The first one will
-  // delete all the others.
+  // Let's make 1 request for any available IP addresses, in parallel. The
+  // first conclusive answer wins and aborts all the others.
 
   for (const QString& address : ipv4Addresses) {
     QUrl url(QString(CAPTIVEPORTAL_URL_IPV4).arg(address));
@@ -64,7 +65,7 @@ void CaptivePortalRequest::createRequest(const QUrl& url) {
             logger.info() << "Portal Detected -> Redirect to "
                           << logger.sensitive(url.toString());
             request->abort();
-            onResult(PortalDetected);
+            onResult(request, PortalDetected);
           });
   connect(
       request, &NetworkRequest::requestFailed, this,
@@ -74,7 +75,7 @@ void CaptivePortalRequest::createRequest(const QUrl& url) {
         }
 
         logger.warning() << "Captive portal request failed:" << error;
-        onResult(Failure);
+        onResult(request, Failure);
       });
 
   connect(
@@ -89,41 +90,59 @@ void CaptivePortalRequest::createRequest(const QUrl& url) {
         if (request->statusCode() != 200) {
           logger.debug() << "Captive portal detected. Expected 200, received:"
                          << request->statusCode();
-          onResult(PortalDetected);
+          onResult(request, PortalDetected);
           return;
         }
 
         if (QString(data).trimmed() == CAPTIVEPORTAL_REQUEST_CONTENT) {
           logger.debug() << "No captive portal!";
-          onResult(NoPortal);
+          onResult(request, NoPortal);
           return;
         }
 
         logger.debug() << "Captive portal detected. Content does not match.";
-        onResult(PortalDetected);
+        onResult(request, PortalDetected);
       });
 
+  m_requests.append(request);
   m_running++;
 }
 
-void CaptivePortalRequest::onResult(CaptivePortalResult portalDetected) {
+void CaptivePortalRequest::onResult(NetworkRequest* request,
+                                    CaptivePortalResult portalDetected) {
+  if (m_completed) {
+    return;
+  }
+
   Q_ASSERT(m_running > 0);
   m_running--;
-  if (portalDetected == NoPortal) {
-    m_success++;
-  }
+  m_requests.removeAll(request);
 
-  // If any request detects a portal, we can terminate immediately.
-  if (portalDetected == PortalDetected) {
-    deleteLater();
-    emit completed(portalDetected);
+  // A portal intercepts all the plain HTTP requests: any conclusive answer is
+  // the answer for the whole network.
+  if (portalDetected != Failure) {
+    complete(portalDetected);
     return;
   }
 
-  // Otherwise, we are complete after all the workers have terminated.
+  // Otherwise, we have failed after all the workers have failed.
   if (m_running == 0) {
-    deleteLater();
-    emit completed((m_success > 0) ? NoPortal : Failure);
-    return;
+    complete(Failure);
   }
 }
+
+void CaptivePortalRequest::complete(CaptivePortalResult portalDetected) {
+  m_completed = true;
+
+  // Their late answers would not change anything.
+  QList<QPointer<NetworkRequest>> requests;
+  requests.swap(m_requests);
+  for (const QPointer<NetworkRequest>& request : requests) {
+    if (request) {
+      request->abort();
+    }
+  }
+
+  deleteLater();
+  emit completed(portalDetected);
+}
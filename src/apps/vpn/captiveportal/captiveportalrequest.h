@@ -5,9 +5,12 @@
 #ifndef CAPTIVEPORTALREQUEST_H
 #define CAPTIVEPORTALREQUEST_H
 
+#include <QList>
 #include <QObject>
+#include <QPointer>
 #include <QUrl>
 
+class NetworkRequest;
 class Task;
 
 class CaptivePortalRequest final : public QObject {
@@ -28,12 +31,14 @@ class CaptivePortalRequest final : public QObject {
 
  private:
   void createRequest(const QUrl& url);
-  void nextStep();
-  void onResult(CaptivePortalResult portalDetected);
+  void onResult(NetworkRequest* request, CaptivePortalResult portalDetected);
+  void complete(CaptivePortalResult portalDetected);
 
  private:
+  // The requests still running. They delete themselves when they finish.
+  QList<QPointer<NetworkRequest>> m_requests;
   int m_running = 0;
-  int m_success = 0;
+  bool m_completed = false;
 };
 
 #endif  // CAPTIVEPORTALREQUEST_H
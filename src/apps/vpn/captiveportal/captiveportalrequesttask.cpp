@@ -7,19 +7,30 @@
 #include <QTimer>
 
 #include "captiveportal.h"
+#include "captiveportalcache.h"
+#include "captiveportaldetection.h"
 #include "captiveportalrequest.h"
 #include "leakdetector.h"
 #include "logger.h"
+#include "mozillavpn.h"
 #include "networkmanager.h"
 #include "networkrequest.h"
+#include "networkwatcher.h"
 #include "settingsholder.h"
 
 namespace {
 Logger logger("CaptivePortalRequestTask");
+
+CaptivePortalCache* cache() {
+  return MozillaVPN::instance()->captivePortalDetection()->cache();
 }
+}  // namespace
 
-CaptivePortalRequestTask::CaptivePortalRequestTask(bool retryOnFailure)
-    : Task("CaptivePortalRequestTask"), m_retryOnFailure(retryOnFailure) {
+CaptivePortalRequestTask::CaptivePortalRequestTask(bool retryOnFailure,
+                                                   bool useCachedVerdict)
+    : Task("CaptivePortalRequestTask"),
+      m_retryOnFailure(retryOnFailure),
+      m_useCachedVerdict(useCachedVerdict) {
   MZ_COUNT_CTOR(CaptivePortalRequestTask);
 }
 
@@ -28,6 +39,20 @@ CaptivePortalRequestTask::~CaptivePortalRequestTask() {
 }
 
 void CaptivePortalRequestTask::run() {
+  m_networkId = MozillaVPN::instance()->networkWatcher()->currentNetworkId();
+
+  if (m_useCachedVerdict) {
+    CaptivePortalRequest::CaptivePortalResult cached =
+        cache()->lookup(m_networkId, CaptivePortalCache::now());
+    if (cached != CaptivePortalRequest::CaptivePortalResult::Failure) {
+      logger.debug() << "Cached captive portal verdict:" << cached;
+      m_completed = true;
+      emit operationCompleted(cached);
+      emit completed();
+      return;
+    }
+  }
+
   // If we can't confirm in 30s that we are not behind
   // a captive-portal, handle this like no portal exists
   QTimer::singleShot(30 * 1000, this, [this]() {
@@ -43,6 +68,7 @@ void CaptivePortalRequestTask::createRequest() {
   connect(request, &CaptivePortalRequest::completed, this,
           [this](CaptivePortalRequest::CaptivePortalResult detected) {
             logger.debug() << "Captive portal detection:" << detected;
+            cache()->insert(m_networkId, detected, CaptivePortalCache::now());
             onResult(detected);
           });
 
@@ -15,7 +15,12 @@ class CaptivePortalRequestTask final : public Task {
   Q_DISABLE_COPY_MOVE(CaptivePortalRequestTask)
 
  public:
-  CaptivePortalRequestTask(bool retryOnFailure = true);
+  // With `useCachedVerdict`, a recent verdict for the current network is
+  // reused instead of probing again. The verdicts found by probing are
+  // always cached. CaptivePortalDetection drops the cached verdict when the
+  // connection becomes unstable.
+  CaptivePortalRequestTask(bool retryOnFailure = true,
+                           bool useCachedVerdict = true);
   ~CaptivePortalRequestTask();
 
   void run() override;
@@ -29,7 +34,11 @@ class CaptivePortalRequestTask final : public Task {
 
  private:
   const bool m_retryOnFailure = true;
+  const bool m_useCachedVerdict = true;
   bool m_completed = false;
+
+  // The network probed, as it was when the task started.
+  QString m_networkId;
 };
 
 #endif  // CAPTIVEPORTALREQUESTTASK_H
@@ -41,6 +41,8 @@ target_sources(mozillavpn PRIVATE
     ${CMAKE_CURRENT_SOURCE_DIR}/apps/vpn/daemon/daemon.cpp
     ${CMAKE_CURRENT_SOURCE_DIR}/apps/vpn/daemon/daemon.h
     ${CMAKE_CURRENT_SOURCE_DIR}/apps/vpn/daemon/dnsutils.h
+    ${CMAKE_CURRENT_SOURCE_DIR}/apps/vpn/daemon/endpointresolver.cpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/apps/vpn/daemon/endpointresolver.h
     ${CMAKE_CURRENT_SOURCE_DIR}/apps/vpn/daemon/interfaceconfig.h
     ${CMAKE_CURRENT_SOURCE_DIR}/apps/vpn/daemon/iputils.h
     ${CMAKE_CURRENT_SOURCE_DIR}/apps/vpn/daemon/wireguardutils.h
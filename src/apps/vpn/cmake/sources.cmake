@@ -54,12 +54,16 @@ target_sources(mozillavpn-sources INTERFACE
     ${CMAKE_CURRENT_SOURCE_DIR}/apps/vpn/addons/conditionwatchers/addonconditionwatchertimestart.h
     ${CMAKE_CURRENT_SOURCE_DIR}/apps/vpn/addons/conditionwatchers/addonconditionwatchertriggertimesecs.cpp
     ${CMAKE_CURRENT_SOURCE_DIR}/apps/vpn/addons/conditionwatchers/addonconditionwatchertriggertimesecs.h
+    ${CMAKE_CURRENT_SOURCE_DIR}/apps/vpn/addons/conditionwatchers/addontimerwheel.cpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/apps/vpn/addons/conditionwatchers/addontimerwheel.h
     ${CMAKE_CURRENT_SOURCE_DIR}/apps/vpn/addons/manager/addondirectory.cpp
     ${CMAKE_CURRENT_SOURCE_DIR}/apps/vpn/addons/manager/addondirectory.h
     ${CMAKE_CURRENT_SOURCE_DIR}/apps/vpn/addons/manager/addonindex.cpp
     ${CMAKE_CURRENT_SOURCE_DIR}/apps/vpn/addons/manager/addonindex.h
     ${CMAKE_CURRENT_SOURCE_DIR}/apps/vpn/addons/manager/addonmanager.cpp
     ${CMAKE_CURRENT_SOURCE_DIR}/apps/vpn/addons/manager/addonmanager.h
+    ${CMAKE_CURRENT_SOURCE_DIR}/apps/vpn/addons/manager/addonverifier.cpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/apps/vpn/addons/manager/addonverifier.h
     ${CMAKE_CURRENT_SOURCE_DIR}/apps/vpn/appconstants.cpp
     ${CMAKE_CURRENT_SOURCE_DIR}/apps/vpn/appconstants.h
     ${CMAKE_CURRENT_SOURCE_DIR}/apps/vpn/appimageprovider.h
@@ -78,6 +82,8 @@ target_sources(mozillavpn-sources INTERFACE
     ${CMAKE_CURRENT_SOURCE_DIR}/apps/vpn/authenticationlistener.h
     ${CMAKE_CURRENT_SOURCE_DIR}/apps/vpn/captiveportal/captiveportal.cpp
     ${CMAKE_CURRENT_SOURCE_DIR}/apps/vpn/captiveportal/captiveportal.h
+    ${CMAKE_CURRENT_SOURCE_DIR}/apps/vpn/captiveportal/captiveportalcache.cpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/apps/vpn/captiveportal/captiveportalcache.h
     ${CMAKE_CURRENT_SOURCE_DIR}/apps/vpn/captiveportal/captiveportaldetection.cpp
     ${CMAKE_CURRENT_SOURCE_DIR}/apps/vpn/captiveportal/captiveportaldetection.h
     ${CMAKE_CURRENT_SOURCE_DIR}/apps/vpn/captiveportal/captiveportaldetectionimpl.cpp
@@ -128,6 +134,8 @@ target_sources(mozillavpn-sources INTERFACE
     ${CMAKE_CURRENT_SOURCE_DIR}/apps/vpn/composer/composerblocktitle.h
     ${CMAKE_CURRENT_SOURCE_DIR}/apps/vpn/composer/composerblockunorderedlist.cpp
     ${CMAKE_CURRENT_SOURCE_DIR}/apps/vpn/composer/composerblockunorderedlist.h
+    ${CMAKE_CURRENT_SOURCE_DIR}/apps/vpn/connectionbenchmark/benchmarksamples.cpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/apps/vpn/connectionbenchmark/benchmarksamples.h
     ${CMAKE_CURRENT_SOURCE_DIR}/apps/vpn/connectionbenchmark/benchmarktask.cpp
     ${CMAKE_CURRENT_SOURCE_DIR}/apps/vpn/connectionbenchmark/benchmarktask.h
     ${CMAKE_CURRENT_SOURCE_DIR}/apps/vpn/connectionbenchmark/benchmarktaskping.cpp
@@ -164,6 +172,8 @@ target_sources(mozillavpn-sources INTERFACE
     ${CMAKE_CURRENT_SOURCE_DIR}/apps/vpn/inspector/inspectorhandler.h
     ${CMAKE_CURRENT_SOURCE_DIR}/apps/vpn/inspector/inspectoritempicker.cpp
     ${CMAKE_CURRENT_SOURCE_DIR}/apps/vpn/inspector/inspectoritempicker.h
+    ${CMAKE_CURRENT_SOURCE_DIR}/apps/vpn/inspector/inspectorpropertywaiter.cpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/apps/vpn/inspector/inspectorpropertywaiter.h
     ${CMAKE_CURRENT_SOURCE_DIR}/apps/vpn/inspector/inspectorutils.cpp
     ${CMAKE_CURRENT_SOURCE_DIR}/apps/vpn/inspector/inspectorutils.h
     ${CMAKE_CURRENT_SOURCE_DIR}/apps/vpn/inspector/inspectorwebsocketconnection.cpp
@@ -205,6 +215,8 @@ target_sources(mozillavpn-sources INTERFACE
     ${CMAKE_CURRENT_SOURCE_DIR}/apps/vpn/models/servercountrymodel.h
     ${CMAKE_CURRENT_SOURCE_DIR}/apps/vpn/models/serverdata.cpp
     ${CMAKE_CURRENT_SOURCE_DIR}/apps/vpn/models/serverdata.h
+    ${CMAKE_CURRENT_SOURCE_DIR}/apps/vpn/models/serverlatencyhistory.cpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/apps/vpn/models/serverlatencyhistory.h
     ${CMAKE_CURRENT_SOURCE_DIR}/apps/vpn/models/subscriptiondata.cpp
     ${CMAKE_CURRENT_SOURCE_DIR}/apps/vpn/models/subscriptiondata.h
     ${CMAKE_CURRENT_SOURCE_DIR}/apps/vpn/models/supportcategorymodel.cpp
@@ -222,6 +234,8 @@ target_sources(mozillavpn-sources INTERFACE
     ${CMAKE_CURRENT_SOURCE_DIR}/apps/vpn/notificationhandler.h
     ${CMAKE_CURRENT_SOURCE_DIR}/apps/vpn/pinghelper.cpp
     ${CMAKE_CURRENT_SOURCE_DIR}/apps/vpn/pinghelper.h
+    ${CMAKE_CURRENT_SOURCE_DIR}/apps/vpn/pingscanner.cpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/apps/vpn/pingscanner.h
     ${CMAKE_CURRENT_SOURCE_DIR}/apps/vpn/pingsender.cpp
     ${CMAKE_CURRENT_SOURCE_DIR}/apps/vpn/pingsender.h
     ${CMAKE_CURRENT_SOURCE_DIR}/apps/vpn/pingsenderfactory.cpp
@@ -306,6 +320,8 @@ target_sources(mozillavpn-sources INTERFACE
     ${CMAKE_CURRENT_SOURCE_DIR}/apps/vpn/tutorial/tutorialstepbefore.h
     ${CMAKE_CURRENT_SOURCE_DIR}/apps/vpn/tutorial/tutorialstepnext.cpp
     ${CMAKE_CURRENT_SOURCE_DIR}/apps/vpn/tutorial/tutorialstepnext.h
+    ${CMAKE_CURRENT_SOURCE_DIR}/apps/vpn/update/resumabledownload.cpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/apps/vpn/update/resumabledownload.h
     ${CMAKE_CURRENT_SOURCE_DIR}/apps/vpn/update/updater.cpp
     ${CMAKE_CURRENT_SOURCE_DIR}/apps/vpn/update/updater.h
     ${CMAKE_CURRENT_SOURCE_DIR}/apps/vpn/update/versionapi.cpp
@@ -340,5 +356,7 @@ if(NOT CMAKE_CROSSCOMPILING)
         ${CMAKE_CURRENT_SOURCE_DIR}/apps/vpn/server/serverconnection.h
         ${CMAKE_CURRENT_SOURCE_DIR}/apps/vpn/server/serverhandler.cpp
         ${CMAKE_CURRENT_SOURCE_DIR}/apps/vpn/server/serverhandler.h
+        ${CMAKE_CURRENT_SOURCE_DIR}/apps/vpn/server/serverlistcache.cpp
+        ${CMAKE_CURRENT_SOURCE_DIR}/apps/vpn/server/serverlistcache.h
        )
 endif()
@@ -6,7 +6,12 @@
 #define COLLATOR_H
 
 #include <QCollator>
+#include <QList>
 #include <QObject>
+#include <QStringList>
+#include <algorithm>
+#include <numeric>
+#include <vector>
 
 class Collator final : public QObject {
   Q_OBJECT
@@ -18,8 +23,51 @@ class Collator final : public QObject {
 
   int compare(const QString& a, const QString& b);
 
+  // Sorts `list` by the string `name` returns for each item. The names, and
+  // their collation keys where the platform has them, are computed once per
+  // item instead of twice per comparison.
+  template <typename T, typename NameFunc>
+  void sort(QList<T>& list, NameFunc name);
+
  private:
   QCollator m_collator;
 };
 
+template <typename T, typename NameFunc>
+void Collator::sort(QList<T>& list, NameFunc name) {
+  std::vector<qsizetype> order(list.count());
+  std::iota(order.begin(), order.end(), 0);
+
+#if defined(MZ_IOS) || defined(MZ_WASM)
+  QStringList names;
+  names.reserve(list.count());
+  for (const T& item : list) {
+    names.append(name(item));
+  }
+
+  std::stable_sort(order.begin(), order.end(),
+                   [this, &names](qsizetype a, qsizetype b) {
+                     return compare(names.at(a), names.at(b)) < 0;
+                   });
+#else
+  std::vector<QCollatorSortKey> keys;
+  keys.reserve(list.count());
+  for (const T& item : list) {
+    keys.push_back(m_collator.sortKey(name(item)));
+  }
+
+  std::stable_sort(order.begin(), order.end(),
+                   [&keys](qsizetype a, qsizetype b) {
+                     return keys[a].compare(keys[b]) < 0;
+                   });
+#endif
+
+  QList<T> sorted;
+  sorted.reserve(list.count());
+  for (qsizetype i : order) {
+    sorted.append(std::move(list[i]));
+  }
+  list.swap(sorted);
+}
+
 #endif  // COLLATOR_H
@@ -0,0 +1,94 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "benchmarksamples.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace {
+quint64 bitsPerSec(qint64 bytes, qint64 msecs) {
+  if (bytes <= 0 || msecs <= 0) {
+    return 0;
+  }
+
+  return static_cast<quint64>(static_cast<double>(bytes) * 8 * 1000 /
+                              static_cast<double>(msecs));
+}
+}  // namespace
+
+quint64 BenchmarkSamples::percentile(int percent) const {
+  if (m_values.isEmpty()) {
+    return 0;
+  }
+
+  QList<quint64> sorted = m_values;
+  std::sort(sorted.begin(), sorted.end());
+
+  // Nearest rank: the smallest value with at least `percent`% of the samples
+  // less than or equal to it.
+  qsizetype rank = (qBound(0, percent, 100) * sorted.count() + 99) / 100;
+  return sorted.at(qMax<qsizetype>(rank, 1) - 1);
+}
+
+void BenchmarkLoadedLatency::addPing(qint64 msec) {
+  if (m_loaded && msec >= 0) {
+    m_samples.add(static_cast<quint64>(msec));
+  }
+}
+
+void BenchmarkLoadedLatency::clear() {
+  m_loaded = false;
+  m_samples.clear();
+}
+
+quint16 BenchmarkLoadedLatency::percentile(int percent) const {
+  return static_cast<quint16>(qMin<quint64>(
+      m_samples.percentile(percent), std::numeric_limits<quint16>::max()));
+}
+
+BenchmarkThroughput::BenchmarkThroughput(qint64 intervalMsec,
+                                         qint64 warmUpMsec)
+    : m_intervalMsec(intervalMsec), m_warmUpMsec(warmUpMsec) {}
+
+void BenchmarkThroughput::start(qint64 nowMsec) {
+  m_startMsec = nowMsec;
+  m_lastSampleMsec = nowMsec;
+  m_endMsec = nowMsec;
+  m_lastSampleBytes = 0;
+  m_bytes = 0;
+  m_samples.clear();
+}
+
+void BenchmarkThroughput::sample(qint64 nowMsec) {
+  m_endMsec = nowMsec;
+
+  qint64 elapsed = nowMsec - m_lastSampleMsec;
+  if (elapsed * 2 < m_intervalMsec) {
+    return;
+  }
+
+  if (m_lastSampleMsec - m_startMsec >= m_warmUpMsec) {
+    m_samples.add(::bitsPerSec(m_bytes - m_lastSampleBytes, elapsed));
+  }
+
+  m_lastSampleMsec = nowMsec;
+  m_lastSampleBytes = m_bytes;
+}
+
+quint64 BenchmarkThroughput::bitsPerSec() const {
+  if (m_samples.isEmpty()) {
+    return ::bitsPerSec(m_bytes, m_endMsec - m_startMsec);
+  }
+
+  return m_samples.median();
+}
+
+quint64 BenchmarkThroughput::percentile(int percent) const {
+  if (m_samples.isEmpty()) {
+    return bitsPerSec();
+  }
+
+  return m_samples.percentile(percent);
+}
@@ -0,0 +1,88 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef BENCHMARKSAMPLES_H
+#define BENCHMARKSAMPLES_H
+
+#include <QList>
+
+// A series of measurements, and their percentiles.
+class BenchmarkSamples final {
+ public:
+  void add(quint64 value) { m_values.append(value); }
+  void clear() { m_values.clear(); }
+
+  bool isEmpty() const { return m_values.isEmpty(); }
+  int count() const { return static_cast<int>(m_values.count()); }
+
+  // The nearest-rank percentile, `percent` between 0 and 100. Returns 0 if
+  // there are no samples.
+  quint64 percentile(int percent) const;
+  quint64 median() const { return percentile(50); }
+
+ private:
+  QList<quint64> m_values;
+};
+
+// The latency under load: the round-trip time of each ping answered while
+// the transfers run. Every ping counts once, so the spikes of bufferbloat
+// show in the percentiles, where a moving average would smooth them out.
+class BenchmarkLoadedLatency final {
+ public:
+  // Whether the transfers are running. The pings answered otherwise are
+  // ignored.
+  void setLoaded(bool loaded) { m_loaded = loaded; }
+  bool isLoaded() const { return m_loaded; }
+
+  void addPing(qint64 msec);
+  void clear();
+
+  int count() const { return m_samples.count(); }
+  quint16 median() const { return percentile(50); }
+  quint16 percentile(int percent) const;
+
+ private:
+  bool m_loaded = false;
+  BenchmarkSamples m_samples;
+};
+
+// The throughput of a transfer over time.
+//
+// The bytes transferred are counted as they arrive, and sample() turns the
+// bytes of each interval into a bits-per-second sample. The intervals which
+// start during the warm-up (TCP slow start, the first requests still being
+// set up) are not counted.
+class BenchmarkThroughput final {
+ public:
+  BenchmarkThroughput(qint64 intervalMsec, qint64 warmUpMsec);
+
+  void start(qint64 nowMsec);
+  void addBytes(qint64 bytes) { m_bytes += bytes; }
+
+  // Ends the current interval. An interval shorter than half the sampling
+  // interval is merged into the next one.
+  void sample(qint64 nowMsec);
+
+  qint64 bytes() const { return m_bytes; }
+  const BenchmarkSamples& samples() const { return m_samples; }
+
+  // The median of the samples. If the transfer was over before the end of
+  // the warm-up, the average over the whole transfer.
+  quint64 bitsPerSec() const;
+  quint64 percentile(int percent) const;
+
+ private:
+  const qint64 m_intervalMsec;
+  const qint64 m_warmUpMsec;
+
+  qint64 m_startMsec = 0;
+  qint64 m_lastSampleMsec = 0;
+  qint64 m_lastSampleBytes = 0;
+  qint64 m_endMsec = 0;
+  qint64 m_bytes = 0;
+
+  BenchmarkSamples m_samples;
+};
+
+#endif  // BENCHMARKSAMPLES_H
@@ -25,17 +25,24 @@ Logger logger("BenchmarkTaskTransfer");
 
 BenchmarkTaskTransfer::BenchmarkTaskTransfer(const QString& name,
                                              BenchmarkType type,
-                                             const QUrl& url)
+                                             const QUrl& url, int streams)
     : BenchmarkTask(name, AppConstants::BENCHMARK_MAX_DURATION_TRANSFER),
       m_type(type),
       m_dnsLookup(QDnsLookup::A, url.host()),
-      m_url(url) {
+      m_url(url),
+      m_streams(qMax(streams, 1)),
+      m_throughput(AppConstants::BENCHMARK_SAMPLE_INTERVAL,
+                   AppConstants::BENCHMARK_WARMUP_DURATION) {
   MZ_COUNT_CTOR(BenchmarkTaskTransfer);
 
   connect(this, &BenchmarkTask::stateChanged, this,
           &BenchmarkTaskTransfer::handleState);
   connect(&m_dnsLookup, &QDnsLookup::finished, this,
           &BenchmarkTaskTransfer::dnsLookupFinished);
+
+  m_sampleTimer.setInterval(AppConstants::BENCHMARK_SAMPLE_INTERVAL);
+  connect(&m_sampleTimer, &QTimer::timeout, this,
+          [this]() { m_throughput.sample(m_elapsedTimer.elapsed()); });
 }
 
 BenchmarkTaskTransfer::~BenchmarkTaskTransfer() {
@@ -51,23 +58,32 @@ void BenchmarkTaskTransfer::handleState(BenchmarkTask::State state) {
 #    error Check if QT added support for QDnsLookup::lookup() on Android
 #  endif
 
-    createNetworkRequest();
+    for (int i = 0; i < m_streams; ++i) {
+      createNetworkRequest();
+    }
+    startSampling();
 #else
     // Start DNS resolution
     m_dnsLookup.setNameserver(QHostAddress(MULLVAD_DEFAULT_DNS));
     m_dnsLookup.lookup();
 #endif
-
-    m_elapsedTimer.start();
   } else if (state == BenchmarkTask::StateInactive) {
-    for (NetworkRequest* request : m_requests) {
+    m_dnsLookup.abort();
+
+    // Each aborted request removes itself from the list.
+    const QList<NetworkRequest*> requests = m_requests;
+    for (NetworkRequest* request : requests) {
       request->abort();
     }
-    m_requests.clear();
-    m_dnsLookup.abort();
   }
 }
 
+void BenchmarkTaskTransfer::startSampling() {
+  m_elapsedTimer.start();
+  m_throughput.start(0);
+  m_sampleTimer.start();
+}
+
 void BenchmarkTaskTransfer::createNetworkRequest() {
   logger.debug() << "Create network request";
 
@@ -148,11 +164,12 @@ void BenchmarkTaskTransfer::connectNetworkRequest(NetworkRequest* request) {
     }
   }
   connect(request, &NetworkRequest::requestFailed, this,
-          &BenchmarkTaskTransfer::transferReady);
-  connect(request, &NetworkRequest::requestCompleted, this,
-          [&](const QByteArray& data) {
-            transferReady(QNetworkReply::NoError, data);
+          [this, request](QNetworkReply::NetworkError error) {
+            transferReady(request, error);
           });
+  connect(request, &NetworkRequest::requestCompleted, this, [this, request]() {
+    transferReady(request, QNetworkReply::NoError);
+  });
 
   logger.debug() << "Starting request";
   m_requests.append(request);
@@ -178,12 +195,18 @@ void BenchmarkTaskTransfer::dnsLookupFinished() {
   }
 
   logger.debug() << "DNS Lookup Finished";
-  for (const QDnsHostAddressRecord& record : m_dnsLookup.hostAddressRecords()) {
+  const QList<QDnsHostAddressRecord> records =
+      m_dnsLookup.hostAddressRecords();
+  for (const QDnsHostAddressRecord& record : records) {
     logger.debug() << "Host record:" << record.value().toString();
-    createNetworkRequestWithRecord(record);
   }
 
-  m_elapsedTimer.start();
+  // The streams are spread over the addresses.
+  for (int i = 0; i < m_streams; ++i) {
+    createNetworkRequestWithRecord(records.at(i % records.count()));
+  }
+
+  startSampling();
   guard.dismiss();
 }
 
@@ -200,13 +223,15 @@ void BenchmarkTaskTransfer::transferProgressed(qint64 bytesSent,
   switch (m_type) {
     case BenchmarkDownload: {
       // Count and discard downloaded data
-      m_bytesTransferred += reply->skip(bytesTotal);
+      m_throughput.addBytes(reply->skip(bytesTotal));
       break;
     }
     case BenchmarkUpload: {
-      Q_UNUSED(reply);
-      if (bytesSent > 0) {
-        m_bytesTransferred = bytesSent;
+      // The progress of each stream is cumulative.
+      qint64& uploaded = m_uploadedBytes[reply];
+      if (bytesSent > uploaded) {
+        m_throughput.addBytes(bytesSent - uploaded);
+        uploaded = bytesSent;
       }
       break;
     }
@@ -217,33 +242,41 @@ void BenchmarkTaskTransfer::transferProgressed(qint64 bytesSent,
   }
 }
 
-void BenchmarkTaskTransfer::transferReady(QNetworkReply::NetworkError error,
-                                          const QByteArray& data) {
+void BenchmarkTaskTransfer::transferReady(NetworkRequest* request,
+                                          QNetworkReply::NetworkError error) {
   logger.debug() << "Transfer ready" << error;
-  Q_UNUSED(data);
 
-  NetworkRequest* request = qobject_cast<NetworkRequest*>(QObject::sender());
-  m_requests.removeOne(request);
+  if (!m_requests.removeOne(request)) {
+    return;
+  }
+
+  if (error != QNetworkReply::NoError &&
+      error != QNetworkReply::OperationCanceledError &&
+      error != QNetworkReply::TimeoutError) {
+    m_hasUnexpectedError = true;
+  }
 
-  quint64 bitsPerSec = 0;
-  double msecs = static_cast<double>(m_elapsedTimer.elapsed());
-  if (m_bytesTransferred > 0 && msecs > 0) {
-    bitsPerSec = static_cast<quint64>(
-        static_cast<double>(m_bytesTransferred * 8) / (msecs / 1000.00));
+  if (!m_requests.isEmpty() || m_finished) {
+    return;
   }
 
-  bool hasUnexpectedError = (error != QNetworkReply::NoError &&
-                             error != QNetworkReply::OperationCanceledError &&
-                             error != QNetworkReply::TimeoutError)
+  m_finished = true;
+  m_sampleTimer.stop();
+  m_throughput.sample(m_elapsedTimer.elapsed());
+
+  quint64 bitsPerSec = m_throughput.bitsPerSec();
+  bool hasUnexpectedError = m_hasUnexpectedError
 #ifndef MZ_WASM
                             || bitsPerSec == 0
 #endif
       ;
 
-  logger.debug() << "Transfer completed" << bitsPerSec << "baud";
+  logger.debug() << "Transfer completed" << bitsPerSec << "baud over"
+                 << m_streams << "streams, p10"
+                 << m_throughput.percentile(10) << "p90"
+                 << m_throughput.percentile(90) << "from"
+                 << m_throughput.samples().count() << "samples";
 
-  if (m_requests.isEmpty()) {
-    emit finished(bitsPerSec, hasUnexpectedError);
-    emit completed();
-  }
+  emit finished(bitsPerSec, hasUnexpectedError);
+  emit completed();
 }
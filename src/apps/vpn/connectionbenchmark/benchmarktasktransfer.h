@@ -7,9 +7,13 @@
 
 #include <QDnsLookup>
 #include <QElapsedTimer>
+#include <QHash>
 #include <QNetworkReply>
+#include <QTimer>
 #include <QUrl>
 
+#include "appconstants.h"
+#include "benchmarksamples.h"
 #include "benchmarktask.h"
 
 class NetworkRequest;
@@ -25,11 +29,18 @@ class BenchmarkTaskTransfer : public BenchmarkTask {
     BenchmarkUpload,
   };
 
-  explicit BenchmarkTaskTransfer(const QString& name, BenchmarkType type,
-                                 const QUrl& url);
+  // The transfer runs over `streams` parallel connections, to fill links
+  // which a single TCP stream cannot.
+  explicit BenchmarkTaskTransfer(
+      const QString& name, BenchmarkType type, const QUrl& url,
+      int streams = AppConstants::BENCHMARK_STREAMS);
   virtual ~BenchmarkTaskTransfer();
 
+  // The throughput samples of all the streams together.
+  const BenchmarkThroughput& throughput() const { return m_throughput; }
+
  signals:
+  // `bitsPerSec` is the median of the throughput samples.
   void finished(quint64 bitsPerSec, bool hasUnexpectedError);
 
  private:
@@ -40,16 +51,26 @@ class BenchmarkTaskTransfer : public BenchmarkTask {
   void handleState(BenchmarkTask::State state);
   void transferProgressed(qint64 bytesTransferred, qint64 bytesTotal,
                           QNetworkReply* reply);
-  void transferReady(QNetworkReply::NetworkError error, const QByteArray& data);
+  void transferReady(NetworkRequest* request,
+                     QNetworkReply::NetworkError error);
+  void startSampling();
 
  private:
   BenchmarkType m_type;
   QDnsLookup m_dnsLookup;
   QList<NetworkRequest*> m_requests;
   const QUrl m_url;
+  const int m_streams;
+
+  // The bytes uploaded so far by each stream.
+  QHash<QNetworkReply*, qint64> m_uploadedBytes;
 
-  qint64 m_bytesTransferred = 0;
+  BenchmarkThroughput m_throughput;
   QElapsedTimer m_elapsedTimer;
+  QTimer m_sampleTimer;
+
+  bool m_hasUnexpectedError = false;
+  bool m_finished = false;
 };
 
 #endif  // BENCHMARKTASKTRANSFER_H
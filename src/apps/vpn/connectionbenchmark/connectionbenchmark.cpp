@@ -37,12 +37,13 @@ void ConnectionBenchmark::initialize() {
           &ConnectionBenchmark::handleControllerState);
   connect(vpn->connectionHealth(), &ConnectionHealth::stabilityChanged, this,
           &ConnectionBenchmark::handleStabilityChange);
+  connect(vpn->connectionHealth(), &ConnectionHealth::pingSentAndReceived,
+          this, &ConnectionBenchmark::handlePingReceived);
 }
 
 void ConnectionBenchmark::setConnectionSpeed() {
   logger.debug() << "Set connection speed";
 
-  // TODO: Take uploadBps for calculating speed into account
   if (m_downloadBps >= AppConstants::BENCHMARK_THRESHOLD_SPEED_FAST) {
     m_speed = SpeedFast;
   } else if (m_downloadBps >= AppConstants::BENCHMARK_THRESHOLD_SPEED_MEDIUM) {
@@ -51,6 +52,23 @@ void ConnectionBenchmark::setConnectionSpeed() {
     m_speed = SpeedSlow;
   }
 
+  // The connection is only as fast as its slowest direction.
+  if (Feature::get(Feature::Feature_benchmarkUpload)->isSupported()) {
+    Speed uploadSpeed = SpeedSlow;
+    if (m_uploadBps >= AppConstants::BENCHMARK_THRESHOLD_UPLOAD_SPEED_FAST) {
+      uploadSpeed = SpeedFast;
+    } else if (m_uploadBps >=
+               AppConstants::BENCHMARK_THRESHOLD_UPLOAD_SPEED_MEDIUM) {
+      uploadSpeed = SpeedMedium;
+    }
+    m_speed = qMin(m_speed, uploadSpeed);
+  }
+
+  logger.debug() << "Latency under load" << loadedLatency() << "p90"
+                 << loadedLatencyP90() << "from" << m_loadedLatency.count()
+                 << "pings";
+  emit loadedLatencyChanged();
+
   emit speedChanged();
   setState(StateReady);
 }
@@ -75,6 +93,8 @@ void ConnectionBenchmark::start() {
 
   setState(StateRunning);
 
+  m_loadedLatency.clear();
+
   // Create ping benchmark
   BenchmarkTaskPing* pingTask = new BenchmarkTaskPing();
   connect(pingTask, &BenchmarkTaskPing::finished, this,
@@ -87,9 +107,12 @@ void ConnectionBenchmark::start() {
   // Create download benchmark
   BenchmarkTaskTransfer* downloadTask = new BenchmarkTaskTransfer(
       "BenchmarkTaskDownload", BenchmarkTaskTransfer::BenchmarkDownload,
-      m_downloadUrl);
+      m_downloadUrl, m_streams);
   connect(downloadTask, &BenchmarkTaskTransfer::finished, this,
-          &ConnectionBenchmark::downloadBenchmarked);
+          [this, downloadTask](quint64, bool hasUnexpectedError) {
+            downloadBenchmarked(downloadTask->throughput(),
+                                hasUnexpectedError);
+          });
   connect(downloadTask->sentinel(), &BenchmarkTaskSentinel::sentinelDestroyed,
           this,
           [this, downloadTask]() { m_benchmarkTasks.removeOne(downloadTask); });
@@ -100,11 +123,12 @@ void ConnectionBenchmark::start() {
   if (Feature::get(Feature::Feature_benchmarkUpload)->isSupported()) {
     BenchmarkTaskTransfer* uploadTask = new BenchmarkTaskTransfer(
         "BenchmarkTaskUpload", BenchmarkTaskTransfer::BenchmarkUpload,
-        m_uploadUrl);
-    Q_UNUSED(uploadTask);
+        m_uploadUrl, m_streams);
 
     connect(uploadTask, &BenchmarkTaskTransfer::finished, this,
-            &ConnectionBenchmark::uploadBenchmarked);
+            [this, uploadTask](quint64, bool hasUnexpectedError) {
+              uploadBenchmarked(uploadTask->throughput(), hasUnexpectedError);
+            });
     connect(uploadTask->sentinel(), &BenchmarkTask::destroyed, this,
             [this, uploadTask]() { m_benchmarkTasks.removeOne(uploadTask); });
     m_benchmarkTasks.append(uploadTask);
@@ -134,22 +158,29 @@ void ConnectionBenchmark::reset() {
   stop();
 
   m_downloadBps = 0;
+  m_downloadBpsP10 = 0;
+  m_downloadBpsP90 = 0;
   m_uploadBps = 0;
+  m_uploadBpsP10 = 0;
+  m_uploadBpsP90 = 0;
   m_pingLatency = 0;
+  m_loadedLatency.clear();
 
   setState(StateInitial);
 }
 
-void ConnectionBenchmark::downloadBenchmarked(quint64 bitsPerSec,
-                                              bool hasUnexpectedError) {
-  logger.debug() << "Benchmarked download" << bitsPerSec;
+void ConnectionBenchmark::downloadBenchmarked(
+    const BenchmarkThroughput& throughput, bool hasUnexpectedError) {
+  logger.debug() << "Benchmarked download" << throughput.bitsPerSec();
 
   if (hasUnexpectedError) {
     setState(StateError);
     return;
   }
 
-  m_downloadBps = bitsPerSec;
+  m_downloadBps = throughput.bitsPerSec();
+  m_downloadBpsP10 = throughput.percentile(10);
+  m_downloadBpsP90 = throughput.percentile(90);
   emit downloadBpsChanged();
 
   if (!Feature::get(Feature::Feature_benchmarkUpload)->isSupported()) {
@@ -165,16 +196,18 @@ void ConnectionBenchmark::pingBenchmarked(quint64 pingLatency) {
   emit pingLatencyChanged();
 }
 
-void ConnectionBenchmark::uploadBenchmarked(quint64 bitsPerSec,
-                                            bool hasUnexpectedError) {
-  logger.debug() << "Benchmarked upload" << bitsPerSec;
+void ConnectionBenchmark::uploadBenchmarked(
+    const BenchmarkThroughput& throughput, bool hasUnexpectedError) {
+  logger.debug() << "Benchmarked upload" << throughput.bitsPerSec();
 
   if (hasUnexpectedError) {
     setState(StateError);
     return;
   }
 
-  m_uploadBps = bitsPerSec;
+  m_uploadBps = throughput.bitsPerSec();
+  m_uploadBpsP10 = throughput.percentile(10);
+  m_uploadBpsP90 = throughput.percentile(90);
   emit uploadBpsChanged();
 
   if (Feature::get(Feature::Feature_benchmarkUpload)->isSupported()) {
@@ -183,6 +216,21 @@ void ConnectionBenchmark::uploadBenchmarked(quint64 bitsPerSec,
   }
 }
 
+void ConnectionBenchmark::handlePingReceived(qint64 msec) {
+  m_loadedLatency.setLoaded(m_state == StateRunning && isTransferRunning());
+  m_loadedLatency.addPing(msec);
+}
+
+bool ConnectionBenchmark::isTransferRunning() const {
+  for (BenchmarkTask* task : m_benchmarkTasks) {
+    if (qobject_cast<BenchmarkTaskTransfer*>(task) &&
+        task->state() == BenchmarkTask::StateActive) {
+      return true;
+    }
+  }
+  return false;
+}
+
 void ConnectionBenchmark::handleControllerState() {
   if (m_state == StateInitial || m_state == StateReady) {
     return;
@@ -10,6 +10,7 @@
 #include <QUrl>
 
 #include "appconstants.h"
+#include "benchmarksamples.h"
 #include "benchmarktask.h"
 
 class ConnectionHealth;
@@ -22,11 +23,22 @@ class ConnectionBenchmark final : public QObject {
                  downloadUrlChanged)
   Q_PROPERTY(QString uploadUrl READ uploadUrl WRITE setUploadUrl NOTIFY
                  uploadUrlChanged)
+  Q_PROPERTY(int streams READ streams WRITE setStreams NOTIFY streamsChanged)
   Q_PROPERTY(State state READ state NOTIFY stateChanged);
   Q_PROPERTY(Speed speed READ speed NOTIFY speedChanged);
   Q_PROPERTY(quint64 downloadBps READ downloadBps NOTIFY downloadBpsChanged);
+  Q_PROPERTY(
+      quint64 downloadBpsP10 READ downloadBpsP10 NOTIFY downloadBpsChanged);
+  Q_PROPERTY(
+      quint64 downloadBpsP90 READ downloadBpsP90 NOTIFY downloadBpsChanged);
   Q_PROPERTY(quint16 pingLatency READ pingLatency NOTIFY pingLatencyChanged);
+  Q_PROPERTY(quint16 loadedLatency READ loadedLatency NOTIFY
+                 loadedLatencyChanged);
+  Q_PROPERTY(quint16 loadedLatencyP90 READ loadedLatencyP90 NOTIFY
+                 loadedLatencyChanged);
   Q_PROPERTY(quint64 uploadBps READ uploadBps NOTIFY uploadBpsChanged);
+  Q_PROPERTY(quint64 uploadBpsP10 READ uploadBpsP10 NOTIFY uploadBpsChanged);
+  Q_PROPERTY(quint64 uploadBpsP90 READ uploadBpsP90 NOTIFY uploadBpsChanged);
 
  public:
   ConnectionBenchmark();
@@ -55,8 +67,24 @@ class ConnectionBenchmark final : public QObject {
   State state() const { return m_state; }
   Speed speed() const { return m_speed; }
   quint16 pingLatency() const { return m_pingLatency; }
+
+  // The median throughput over all the streams, and its percentiles.
   quint64 downloadBps() const { return m_downloadBps; }
+  quint64 downloadBpsP10() const { return m_downloadBpsP10; }
+  quint64 downloadBpsP90() const { return m_downloadBpsP90; }
   quint64 uploadBps() const { return m_uploadBps; }
+  quint64 uploadBpsP10() const { return m_uploadBpsP10; }
+  quint64 uploadBpsP90() const { return m_uploadBpsP90; }
+
+  // The round-trip times of the pings answered while the transfers run.
+  quint16 loadedLatency() const { return m_loadedLatency.median(); }
+  quint16 loadedLatencyP90() const { return m_loadedLatency.percentile(90); }
+
+  int streams() const { return m_streams; }
+  void setStreams(int streams) {
+    m_streams = qMax(streams, 1);
+    emit streamsChanged();
+  }
 
   QString downloadUrl() const { return m_downloadUrl.toString(); }
   void setDownloadUrl(QString url) {
@@ -72,17 +100,24 @@ class ConnectionBenchmark final : public QObject {
 
  signals:
   void downloadBpsChanged();
+  void loadedLatencyChanged();
   void pingLatencyChanged();
   void uploadBpsChanged();
   void speedChanged();
   void stateChanged();
   void downloadUrlChanged();
   void uploadUrlChanged();
+  void streamsChanged();
 
  private:
-  void downloadBenchmarked(quint64 bitsPerSec, bool hasUnexpectedError);
+  void downloadBenchmarked(const BenchmarkThroughput& throughput,
+                           bool hasUnexpectedError);
   void pingBenchmarked(quint64 pingLatencyLatency);
-  void uploadBenchmarked(quint64 bitsPerSec, bool hasUnexpectedError);
+  void uploadBenchmarked(const BenchmarkThroughput& throughput,
+                         bool hasUnexpectedError);
+
+  void handlePingReceived(qint64 msec);
+  bool isTransferRunning() const;
 
   void handleControllerState();
   void handleStabilityChange();
@@ -94,14 +129,21 @@ class ConnectionBenchmark final : public QObject {
   QUrl m_downloadUrl = QUrl(AppConstants::BENCHMARK_DOWNLOAD_URL);
   QUrl m_uploadUrl = QUrl(AppConstants::benchmarkUploadUrl());
 
+  int m_streams = AppConstants::BENCHMARK_STREAMS;
+
   QList<BenchmarkTask*> m_benchmarkTasks;
 
   State m_state = StateInitial;
   Speed m_speed = SpeedSlow;
 
   quint64 m_downloadBps = 0;
+  quint64 m_downloadBpsP10 = 0;
+  quint64 m_downloadBpsP90 = 0;
   quint16 m_pingLatency = 0;
+  BenchmarkLoadedLatency m_loadedLatency;
   quint64 m_uploadBps = 0;
+  quint64 m_uploadBpsP10 = 0;
+  quint64 m_uploadBpsP90 = 0;
 };
 
 #endif  // CONNECTIONBENCHMARK_H
@@ -59,7 +59,7 @@ ConnectionHealth::ConnectionHealth() : m_dnsPingSender(QHostAddress()) {
           &ConnectionHealth::healthCheckup);
 
   connect(&m_pingHelper, &PingHelper::pingSentAndReceived, this,
-          &ConnectionHealth::pingSentAndReceived);
+          &ConnectionHealth::pingCompleted);
 
   connect(qApp, &QApplication::applicationStateChanged, this,
           &ConnectionHealth::applicationStateChanged);
@@ -181,11 +181,9 @@ void ConnectionHealth::connectionStateChanged() {
   }
 }
 
-void ConnectionHealth::pingSentAndReceived(qint64 msec) {
+void ConnectionHealth::pingCompleted(qint64 msec) {
 #ifdef MZ_DEBUG
   logger.debug() << "Ping answer received in msec:" << msec;
-#else
-  Q_UNUSED(msec);
 #endif
 
   // If a ping has been received, we have signal. Restart the timers.
@@ -194,6 +192,7 @@ void ConnectionHealth::pingSentAndReceived(qint64 msec) {
 
   healthCheckup();
   emit pingReceived();
+  emit pingSentAndReceived(msec);
 }
 
 void ConnectionHealth::dnsPingReceived(quint16 sequence) {
@@ -46,6 +46,8 @@ class ConnectionHealth final : public QObject {
   void stabilityChanged();
   void unsettledChanged();
   void pingReceived();
+  // The round-trip time of each ping, unlike latency() which is averaged.
+  void pingSentAndReceived(qint64 msec);
 
  private:
   void stop();
@@ -53,7 +55,7 @@ class ConnectionHealth final : public QObject {
                    const QString& deviceIpv4Address);
   void startIdle();
 
-  void pingSentAndReceived(qint64 msec);
+  void pingCompleted(qint64 msec);
   void dnsPingReceived(quint16 sequence);
 
   void setStability(ConnectionStability stability);
@@ -24,6 +24,28 @@ Logger logger("Daemon");
 
 Daemon* s_daemon = nullptr;
 
+QList<QHostAddress> dnsResolvers(const InterfaceConfig& config) {
+  QList<QHostAddress> resolvers;
+  resolvers.append(QHostAddress(config.m_dnsServer));
+
+  // If the DNS is not the Gateway, it's a user defined DNS
+  // thus, not add any other :)
+  if (config.m_dnsServer == config.m_serverIpv4Gateway) {
+    resolvers.append(QHostAddress(config.m_serverIpv6Gateway));
+  }
+  return resolvers;
+}
+
+// Whether the wireguard peer of the two configurations is the same, down to
+// its endpoint and allowed IPs.
+bool samePeer(const InterfaceConfig& a, const InterfaceConfig& b) {
+  return a.m_serverPublicKey == b.m_serverPublicKey &&
+         a.m_serverIpv4AddrIn == b.m_serverIpv4AddrIn &&
+         a.m_serverIpv6AddrIn == b.m_serverIpv6AddrIn &&
+         a.m_serverPort == b.m_serverPort &&
+         a.m_allowedIPAddressRanges == b.m_allowedIPAddressRanges;
+}
+
 }  // namespace
 
 Daemon::Daemon(QObject* parent) : QObject(parent) {
@@ -74,7 +96,6 @@ bool Daemon::activate(const InterfaceConfig& config) {
       if (!switchServer(config)) {
         return false;
       }
-      m_connections[config.m_hopindex] = ConnectionState(config);
       m_handshakeTimer.start(HANDSHAKE_POLL_MSEC);
       return true;
     }
@@ -100,13 +121,7 @@ bool Daemon::activate(const InterfaceConfig& config) {
 
   // Configure routing for excluded addresses.
   for (const QString& i : config.m_excludedAddresses) {
-    QHostAddress address(i);
-    if (m_excludedAddrSet.contains(address)) {
-      m_excludedAddrSet[address]++;
-      continue;
-    }
-    wgutils()->addExclusionRoute(address);
-    m_excludedAddrSet[address] = 1;
+    addExcludedAddress(QHostAddress(i));
   }
 
   // Add the peer to this interface.
@@ -116,16 +131,8 @@ bool Daemon::activate(const InterfaceConfig& config) {
   }
 
   if ((config.m_hopindex == 0) && supportDnsUtils()) {
-    QList<QHostAddress> resolvers;
-    resolvers.append(QHostAddress(config.m_dnsServer));
-
-    // If the DNS is not the Gateway, it's a user defined DNS
-    // thus, not add any other :)
-    if (config.m_dnsServer == config.m_serverIpv4Gateway) {
-      resolvers.append(QHostAddress(config.m_serverIpv6Gateway));
-    }
-
-    if (!dnsutils()->updateResolvers(wgutils()->interfaceName(), resolvers)) {
+    if (!dnsutils()->updateResolvers(wgutils()->interfaceName(),
+                                     dnsResolvers(config))) {
       return false;
     }
   }
@@ -140,10 +147,13 @@ bool Daemon::activate(const InterfaceConfig& config) {
   }
 
   // set routing
-  for (const IPAddress& ip : config.m_allowedIPAddressRanges) {
-    if (!wgutils()->updateRoutePrefix(ip, config.m_hopindex)) {
+  QList<bool> results = wgutils()->updateRoutePrefixes(
+      config.m_allowedIPAddressRanges, config.m_hopindex);
+  for (qsizetype i = 0; i < results.count(); ++i) {
+    if (!results.at(i)) {
       logger.debug() << "Routing configuration failed for"
-                     << logger.sensitive(ip.toString());
+                     << logger.sensitive(
+                            config.m_allowedIPAddressRanges.at(i).toString());
       return false;
     }
   }
@@ -329,9 +339,8 @@ bool Daemon::deactivate(bool emitSignals) {
   for (const ConnectionState& state : m_connections) {
     const InterfaceConfig& config = state.m_config;
     logger.debug() << "Deleting routes for hop" << config.m_hopindex;
-    for (const IPAddress& ip : config.m_allowedIPAddressRanges) {
-      wgutils()->deleteRoutePrefix(ip, config.m_hopindex);
-    }
+    wgutils()->deleteRoutePrefixes(config.m_allowedIPAddressRanges,
+                                   config.m_hopindex);
     wgutils()->deletePeer(config);
   }
 
@@ -384,46 +393,61 @@ bool Daemon::switchServer(const InterfaceConfig& config) {
   logger.debug() << "Switching server for hop" << config.m_hopindex;
 
   Q_ASSERT(m_connections.contains(config.m_hopindex));
-  const InterfaceConfig& lastConfig =
+  const InterfaceConfig lastConfig =
       m_connections.value(config.m_hopindex).m_config;
 
-  // Configure routing for new excluded addresses.
+  // Only the difference between the installed configuration and the new one
+  // is applied. Whatever the new peer needs is added before the peer is
+  // swapped, and what only the old peer used is removed afterwards, so the
+  // traffic never finds itself without a route into the tunnel.
   for (const QString& i : config.m_excludedAddresses) {
-    QHostAddress address(i);
-    if (m_excludedAddrSet.contains(address)) {
-      m_excludedAddrSet[address]++;
-      continue;
+    if (!lastConfig.m_excludedAddresses.contains(i)) {
+      addExcludedAddress(QHostAddress(i));
     }
-    wgutils()->addExclusionRoute(address);
-    m_excludedAddrSet[address] = 1;
   }
 
-  // Activate the new peer and its routes.
-  if (!wgutils()->updatePeer(config)) {
+  QList<IPAddress> newRoutes;
+  for (const IPAddress& ip : config.m_allowedIPAddressRanges) {
+    if (!lastConfig.m_allowedIPAddressRanges.contains(ip)) {
+      newRoutes.append(ip);
+    }
+  }
+
+  QList<IPAddress> staleRoutes;
+  for (const IPAddress& ip : lastConfig.m_allowedIPAddressRanges) {
+    if (!config.m_allowedIPAddressRanges.contains(ip)) {
+      staleRoutes.append(ip);
+    }
+  }
+
+  logger.debug() << "Routes to add:" << newRoutes.count()
+                 << "to remove:" << staleRoutes.count();
+
+  // Activate the new peer and its routes. With the same public key, the peer
+  // is updated in place.
+  if (!samePeer(config, lastConfig) && !wgutils()->updatePeer(config)) {
     logger.error() << "Server switch failed to update the wireguard interface";
     return false;
   }
-  for (const IPAddress& ip : config.m_allowedIPAddressRanges) {
-    if (!wgutils()->updateRoutePrefix(ip, config.m_hopindex)) {
-      logger.error() << "Server switch failed to update the routing table";
-      break;
-    }
+  if (wgutils()
+          ->updateRoutePrefixes(newRoutes, config.m_hopindex)
+          .contains(false)) {
+    logger.error() << "Server switch failed to update the routing table";
   }
 
-  // Remove routing entries for the old peer.
-  for (const QString& i : lastConfig.m_excludedAddresses) {
-    QHostAddress address(i);
-    Q_ASSERT(m_excludedAddrSet.contains(address));
-    if (m_excludedAddrSet[address] > 1) {
-      m_excludedAddrSet[address]--;
-      continue;
+  if ((config.m_hopindex == 0) && supportDnsUtils() &&
+      (dnsResolvers(config) != dnsResolvers(lastConfig))) {
+    if (!dnsutils()->updateResolvers(wgutils()->interfaceName(),
+                                     dnsResolvers(config))) {
+      logger.error() << "Server switch failed to update the DNS resolvers";
     }
-    wgutils()->deleteExclusionRoute(address);
-    m_excludedAddrSet.remove(address);
   }
-  for (const IPAddress& ip : lastConfig.m_allowedIPAddressRanges) {
-    if (!config.m_allowedIPAddressRanges.contains(ip)) {
-      wgutils()->deleteRoutePrefix(ip, config.m_hopindex);
+
+  // Remove the routing entries used only by the old peer.
+  wgutils()->deleteRoutePrefixes(staleRoutes, config.m_hopindex);
+  for (const QString& i : lastConfig.m_excludedAddresses) {
+    if (!config.m_excludedAddresses.contains(i)) {
+      removeExcludedAddress(QHostAddress(i));
     }
   }
 
@@ -438,6 +462,25 @@ bool Daemon::switchServer(const InterfaceConfig& config) {
   return true;
 }
 
+void Daemon::addExcludedAddress(const QHostAddress& address) {
+  if (m_excludedAddrSet.contains(address)) {
+    m_excludedAddrSet[address]++;
+    return;
+  }
+  wgutils()->addExclusionRoute(address);
+  m_excludedAddrSet[address] = 1;
+}
+
+void Daemon::removeExcludedAddress(const QHostAddress& address) {
+  Q_ASSERT(m_excludedAddrSet.contains(address));
+  if (m_excludedAddrSet[address] > 1) {
+    m_excludedAddrSet[address]--;
+    return;
+  }
+  wgutils()->deleteExclusionRoute(address);
+  m_excludedAddrSet.remove(address);
+}
+
 QJsonObject Daemon::getStatus() {
   Q_ASSERT(wgutils() != nullptr);
   QJsonObject json;
@@ -64,6 +64,11 @@ class Daemon : public QObject {
 
   void checkHandshake();
 
+  // Exclusion routes are reference-counted: the same address can be excluded
+  // by several hops.
+  void addExcludedAddress(const QHostAddress& address);
+  void removeExcludedAddress(const QHostAddress& address);
+
   class ConnectionState {
    public:
     ConnectionState(){};
@@ -0,0 +1,120 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "endpointresolver.h"
+
+#include <QTimer>
+
+#include "leakdetector.h"
+#include "logger.h"
+
+namespace {
+Logger logger("EndpointResolver");
+}
+
+EndpointResolver::EndpointResolver(QObject* parent) : QObject(parent) {
+  MZ_COUNT_CTOR(EndpointResolver);
+}
+
+EndpointResolver::~EndpointResolver() {
+  MZ_COUNT_DTOR(EndpointResolver);
+  cancelAll();
+}
+
+#ifdef UNIT_TEST
+void EndpointResolver::testOverrideRetryDelay(int initialMsec, int maxMsec) {
+  m_initialDelay = initialMsec;
+  m_maxDelay = maxMsec;
+}
+
+void EndpointResolver::testOverrideLookup(
+    std::function<QHostInfo(const QString&)>&& lookup) {
+  m_testLookup = std::move(lookup);
+}
+#endif
+
+void EndpointResolver::resolve(const QString& hostname) {
+  if (m_lookups.contains(hostname)) {
+    return;
+  }
+
+  m_retries[hostname] = 0;
+  lookup(hostname);
+}
+
+void EndpointResolver::lookup(const QString& hostname) {
+#ifdef UNIT_TEST
+  if (m_testLookup) {
+    m_lookups[hostname] = 0;
+    QTimer::singleShot(0, this, [this, hostname]() {
+      if (m_lookups.contains(hostname)) {
+        lookupCompleted(hostname, m_testLookup(hostname));
+      }
+    });
+    return;
+  }
+#endif
+
+  int id = QHostInfo::lookupHost(
+      hostname, this, [this, hostname](const QHostInfo& info) {
+        lookupCompleted(hostname, info);
+      });
+  m_lookups[hostname] = id;
+}
+
+void EndpointResolver::lookupCompleted(const QString& hostname,
+                                       const QHostInfo& info) {
+  if (!m_lookups.contains(hostname)) {
+    // Cancelled.
+    return;
+  }
+
+  if (info.error() == QHostInfo::NoError && !info.addresses().isEmpty()) {
+    m_lookups.remove(hostname);
+    m_retries.remove(hostname);
+    emit resolved(hostname, info.addresses().first());
+    return;
+  }
+
+  // HostNotFound covers EAI_NONAME, EAI_FAIL and EAI_NODATA: there is no
+  // point in retrying later. Anything else is potentially transient.
+  int retries = m_retries.value(hostname);
+  if (info.error() == QHostInfo::HostNotFound ||
+      retries >= ENDPOINT_LOOKUP_RETRIES) {
+    logger.error() << "Failed to resolve the address endpoint:"
+                   << info.errorString();
+    m_lookups.remove(hostname);
+    m_retries.remove(hostname);
+    emit failed(hostname);
+    return;
+  }
+
+  int delay = m_initialDelay;
+  for (int i = 0; i < retries; ++i) {
+    delay = std::min(m_maxDelay, delay * 6 / 5);
+  }
+  m_retries[hostname] = retries + 1;
+
+  logger.warning() << "Trying again in" << (delay / 1000.0) << "seconds";
+
+  // Keep the hostname in m_lookups, so that a cancellation during the delay
+  // is noticed.
+  m_lookups[hostname] = -1;
+  QTimer::singleShot(delay, this, [this, hostname]() {
+    if (m_lookups.value(hostname) == -1) {
+      lookup(hostname);
+    }
+  });
+}
+
+void EndpointResolver::cancelAll() {
+  for (int id : m_lookups) {
+    if (id >= 0) {
+      QHostInfo::abortHostLookup(id);
+    }
+  }
+
+  m_lookups.clear();
+  m_retries.clear();
+}
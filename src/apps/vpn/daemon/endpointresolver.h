@@ -0,0 +1,68 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef ENDPOINTRESOLVER_H
+#define ENDPOINTRESOLVER_H
+
+#include <QHash>
+#include <QHostAddress>
+#include <QHostInfo>
+#include <QObject>
+#include <functional>
+
+constexpr int ENDPOINT_LOOKUP_RETRIES = 15;
+constexpr int ENDPOINT_LOOKUP_INITIAL_DELAY_MSEC = 1000;
+constexpr int ENDPOINT_LOOKUP_MAX_DELAY_MSEC = 20000;
+
+// Resolves the hostnames of the WireGuard endpoints without blocking the
+// event loop.
+//
+// Transient failures are retried with a growing delay, up to
+// ENDPOINT_LOOKUP_RETRIES times. HostNotFound is final. Either resolved() or
+// failed() is emitted once per resolve(), unless it is cancelled.
+class EndpointResolver final : public QObject {
+  Q_OBJECT
+  Q_DISABLE_COPY_MOVE(EndpointResolver)
+
+ public:
+  explicit EndpointResolver(QObject* parent);
+  ~EndpointResolver();
+
+  // Does nothing if the hostname is already being resolved.
+  void resolve(const QString& hostname);
+
+  bool isResolving(const QString& hostname) const {
+    return m_lookups.contains(hostname);
+  }
+
+  // Nothing is emitted for the cancelled lookups.
+  void cancelAll();
+
+#ifdef UNIT_TEST
+  void testOverrideRetryDelay(int initialMsec, int maxMsec);
+  void testOverrideLookup(std::function<QHostInfo(const QString&)>&& lookup);
+#endif
+
+ signals:
+  void resolved(const QString& hostname, const QHostAddress& address);
+  void failed(const QString& hostname);
+
+ private:
+  void lookup(const QString& hostname);
+  void lookupCompleted(const QString& hostname, const QHostInfo& info);
+
+ private:
+  // Hostname -> ID of the lookup, or -1 while waiting to retry.
+  QHash<QString, int> m_lookups;
+  QHash<QString, int> m_retries;
+
+  int m_initialDelay = ENDPOINT_LOOKUP_INITIAL_DELAY_MSEC;
+  int m_maxDelay = ENDPOINT_LOOKUP_MAX_DELAY_MSEC;
+
+#ifdef UNIT_TEST
+  std::function<QHostInfo(const QString&)> m_testLookup;
+#endif
+};
+
+#endif  // ENDPOINTRESOLVER_H
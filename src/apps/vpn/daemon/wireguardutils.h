@@ -44,6 +44,28 @@ class WireguardUtils : public QObject {
   virtual bool updateRoutePrefix(const IPAddress& prefix, int hopindex) = 0;
   virtual bool deleteRoutePrefix(const IPAddress& prefix, int hopindex) = 0;
 
+  // Program the routes of several prefixes at once, and return one result
+  // per prefix, with the same meaning as for a single prefix. Backends able
+  // to batch their requests should override these.
+  virtual QList<bool> updateRoutePrefixes(const QList<IPAddress>& prefixes,
+                                          int hopindex) {
+    QList<bool> results;
+    results.reserve(prefixes.count());
+    for (const IPAddress& prefix : prefixes) {
+      results.append(updateRoutePrefix(prefix, hopindex));
+    }
+    return results;
+  }
+  virtual QList<bool> deleteRoutePrefixes(const QList<IPAddress>& prefixes,
+                                          int hopindex) {
+    QList<bool> results;
+    results.reserve(prefixes.count());
+    for (const IPAddress& prefix : prefixes) {
+      results.append(deleteRoutePrefix(prefix, hopindex));
+    }
+    return results;
+  }
+
   virtual bool addExclusionRoute(const QHostAddress& address) = 0;
   virtual bool deleteExclusionRoute(const QHostAddress& address) = 0;
 };
@@ -9,6 +9,7 @@
 
 #include "constants.h"
 #include "feature.h"
+#include "glean/eventqueue.h"
 #include "glean/generated/metrics.h"
 #include "glean/generated/pings.h"
 #include "leakdetector.h"
@@ -99,6 +100,8 @@ void VPNGlean::initialize() {
     auto dataPath = gleanDirectory.absolutePath();
 
 #if defined(UNIT_TEST)
+    // The events recorded so far belong to the storage being cleared.
+    EventQueue::flush();
     glean_test_reset_glean(uploadEnabled, dataPath.toLocal8Bit());
 #elif defined(MZ_IOS) && not(defined(BUILD_QMAKE))
     new IOSGleanBridge(uploadEnabled, appChannel);
@@ -122,6 +125,7 @@ void VPNGlean::setUploadEnabled(bool isTelemetryEnabled) {
 // static
 void VPNGlean::shutdown() {
 #if not(defined(MZ_WASM) || defined(BUILD_QMAKE))
+  EventQueue::shutdown();
   glean_shutdown();
 #endif
 }
@@ -17,6 +17,7 @@
 #include <QQuickWindow>
 #include <QScreen>
 #include <QTest>
+#include <QUrl>
 #include <functional>
 
 #include "addons/manager/addonmanager.h"
@@ -26,6 +27,7 @@
 #include "feature.h"
 #include "frontend/navigator.h"
 #include "inspectoritempicker.h"
+#include "inspectorpropertywaiter.h"
 #include "inspectorutils.h"
 #include "leakdetector.h"
 #include "localizer.h"
@@ -37,9 +39,11 @@
 #include "notificationhandler.h"
 #include "profileflow.h"
 #include "qmlengineholder.h"
+#include "qmlpath.h"
 #include "serveri18n.h"
 #include "settingsholder.h"
 #include "task.h"
+#include "taskscheduler.h"
 #include "urlopener.h"
 #include "websocket/pushmessage.h"
 
@@ -58,6 +62,8 @@
 namespace {
 Logger logger("InspectorHandler");
 
+constexpr int WAIT_FOR_TIMEOUT_MSEC = 5000;
+
 bool s_forwardNetwork = false;
 bool s_mockFreeTrial = false;
 bool s_forceRTL = false;
@@ -87,6 +93,8 @@ struct InspectorCommand {
   int32_t m_arguments;
   std::function<QJsonObject(InspectorHandler*, const QList<QByteArray>&)>
       m_callback;
+  // When the callback returns an empty object, it sends the reply later.
+  bool m_deferred = false;
 };
 
 static QList<InspectorCommand> s_commands{
@@ -288,6 +296,46 @@ static QList<InspectorCommand> s_commands{
           return obj;
         }},
 
+    InspectorCommand{
+        "wait_for",
+        "Wait for a property of an object to have a value (percent-encoded)",
+        3,
+        [](InspectorHandler* handler, const QList<QByteArray>& arguments) {
+          QJsonObject obj;
+
+          if (!QmlPath(arguments[1]).isValid()) {
+            obj["error"] = "Invalid path";
+            return obj;
+          }
+
+          InspectorPropertyWaiter* waiter = new InspectorPropertyWaiter(
+              arguments[1], arguments[2],
+              QUrl::fromPercentEncoding(arguments[3]), handler);
+          if (waiter->matches()) {
+            delete waiter;
+            obj["value"] = true;
+            return obj;
+          }
+
+          QObject::connect(
+              waiter, &InspectorPropertyWaiter::completed, handler,
+              [handler, waiter](bool matched, const QString& value) {
+                QJsonObject obj;
+                obj["type"] = "wait_for";
+                obj["value"] = matched;
+                if (!matched) {
+                  obj["current"] = value;
+                }
+                handler->send(
+                    QJsonDocument(obj).toJson(QJsonDocument::Compact));
+                waiter->deleteLater();
+              });
+
+          waiter->start(WAIT_FOR_TIMEOUT_MSEC);
+          return obj;
+        },
+        true},
+
     InspectorCommand{"click", "Click on an object", 1,
                      [](InspectorHandler*, const QList<QByteArray>& arguments) {
                        QJsonObject obj;
@@ -526,6 +574,48 @@ static QList<InspectorCommand> s_commands{
           return obj;
         }},
 
+    InspectorCommand{
+        "log_level",
+        "Set the log level of a class, or of everything with '*' (class, "
+        "level)",
+        2,
+        [](InspectorHandler*, const QList<QByteArray>& arguments) {
+          QJsonObject obj;
+
+          QString className = arguments[1];
+          QString levelName = arguments[2];
+
+          LogLevel level;
+          if (!Logger::parseLogLevel(levelName, level)) {
+            obj["error"] = QString("Invalid log level: %1").arg(levelName);
+            return obj;
+          }
+
+          SettingsHolder* settingsHolder = SettingsHolder::instance();
+          if (className == "*") {
+            settingsHolder->setLogLevel(levelName);
+            return obj;
+          }
+
+          QStringList overrides;
+          for (const QString& entry : settingsHolder->logLevelOverrides()) {
+            if (!entry.startsWith(className + ":")) {
+              overrides.append(entry);
+            }
+          }
+          overrides.append(QString("%1:%2").arg(className, levelName));
+          settingsHolder->setLogLevelOverrides(overrides);
+          return obj;
+        }},
+
+    InspectorCommand{"task_metrics",
+                     "Retrieve the queue-wait and run time of the tasks", 0,
+                     [](InspectorHandler*, const QList<QByteArray>&) {
+                       QJsonObject obj;
+                       obj["value"] = TaskScheduler::metrics();
+                       return obj;
+                     }},
+
     InspectorCommand{"settings_filename", "Get the setting filename", 0,
                      [](InspectorHandler*, const QList<QByteArray>&) {
                        QJsonObject obj;
@@ -896,6 +986,10 @@ void InspectorHandler::recv(const QByteArray& command) {
       }
 
       QJsonObject obj = command.m_callback(this, parts);
+      if (command.m_deferred && obj.isEmpty()) {
+        return;
+      }
+
       obj["type"] = command.m_commandName;
       send(QJsonDocument(obj).toJson(QJsonDocument::Compact));
       return;
@@ -0,0 +1,103 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "inspectorpropertywaiter.h"
+
+#include <QMetaMethod>
+#include <QMetaProperty>
+
+#include "inspectorutils.h"
+#include "leakdetector.h"
+#include "logger.h"
+#include "qmlpathindex.h"
+
+namespace {
+Logger logger("InspectorPropertyWaiter");
+
+constexpr int WAIT_FOR_POLL_MSEC = 250;
+}  // namespace
+
+InspectorPropertyWaiter::InspectorPropertyWaiter(const QString& path,
+                                                 const QByteArray& property,
+                                                 const QString& value,
+                                                 QObject* parent)
+    : QObject(parent), m_path(path), m_property(property), m_value(value) {
+  MZ_COUNT_CTOR(InspectorPropertyWaiter);
+
+  connect(&m_pollTimer, &QTimer::timeout, this,
+          &InspectorPropertyWaiter::check);
+
+  m_timeoutTimer.setSingleShot(true);
+  connect(&m_timeoutTimer, &QTimer::timeout, this, [this]() {
+    logger.debug() << "Timeout for" << m_path << m_property;
+    m_done = true;
+    m_pollTimer.stop();
+    emit completed(false, m_lastValue);
+  });
+}
+
+InspectorPropertyWaiter::~InspectorPropertyWaiter() {
+  MZ_COUNT_DTOR(InspectorPropertyWaiter);
+}
+
+bool InspectorPropertyWaiter::matches() {
+  QObject* object = InspectorUtils::queryObject(m_path);
+  if (object != m_object) {
+    watch(object);
+  }
+
+  if (!object) {
+    m_lastValue.clear();
+    return false;
+  }
+
+  m_lastValue = object->property(m_property).toString();
+  return m_lastValue == m_value;
+}
+
+void InspectorPropertyWaiter::start(int timeoutMsec) {
+  QmlPathIndex* index = InspectorUtils::index();
+  if (index) {
+    connect(index, &QmlPathIndex::changed, this,
+            &InspectorPropertyWaiter::check);
+  }
+
+  m_pollTimer.start(WAIT_FOR_POLL_MSEC);
+  m_timeoutTimer.start(timeoutMsec);
+}
+
+void InspectorPropertyWaiter::check() {
+  if (m_done || !matches()) {
+    return;
+  }
+
+  m_done = true;
+  m_pollTimer.stop();
+  m_timeoutTimer.stop();
+  emit completed(true, m_lastValue);
+}
+
+void InspectorPropertyWaiter::watch(QObject* object) {
+  disconnect(m_notifyConnection);
+  m_object = object;
+
+  if (!object) {
+    return;
+  }
+
+  const QMetaObject* metaObject = object->metaObject();
+  int propertyId = metaObject->indexOfProperty(m_property);
+  if (propertyId < 0) {
+    return;
+  }
+
+  QMetaProperty property = metaObject->property(propertyId);
+  if (!property.hasNotifySignal()) {
+    return;
+  }
+
+  m_notifyConnection = connect(
+      object, property.notifySignal(), this,
+      staticMetaObject.method(staticMetaObject.indexOfSlot("check()")));
+}
@@ -0,0 +1,58 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef INSPECTORPROPERTYWAITER_H
+#define INSPECTORPROPERTYWAITER_H
+
+#include <QByteArray>
+#include <QObject>
+#include <QPointer>
+#include <QString>
+#include <QTimer>
+
+// Waits until a property of the object at a QmlPath has a given value, for
+// the `wait_for` inspector command.
+//
+// The property is checked again when its notify signal is emitted, and the
+// path when the objectName index changes. A slow timer catches what neither
+// of them signals, such as a property filter in the path.
+class InspectorPropertyWaiter final : public QObject {
+  Q_OBJECT
+  Q_DISABLE_COPY_MOVE(InspectorPropertyWaiter)
+
+ public:
+  InspectorPropertyWaiter(const QString& path, const QByteArray& property,
+                          const QString& value, QObject* parent);
+  ~InspectorPropertyWaiter();
+
+  // Checks the property once, without waiting.
+  bool matches();
+
+  void start(int timeoutMsec);
+
+ signals:
+  // `value` is the last value seen, when the wait timed out.
+  void completed(bool matched, const QString& value);
+
+ private slots:
+  void check();
+
+ private:
+  void watch(QObject* object);
+
+ private:
+  QString m_path;
+  QByteArray m_property;
+  QString m_value;
+  QString m_lastValue;
+
+  QPointer<QObject> m_object;
+  QMetaObject::Connection m_notifyConnection;
+
+  QTimer m_pollTimer;
+  QTimer m_timeoutTimer;
+  bool m_done = false;
+};
+
+#endif  // INSPECTORPROPERTYWAITER_H
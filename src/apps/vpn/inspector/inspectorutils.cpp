@@ -4,11 +4,19 @@
 
 #include "inspectorutils.h"
 
+#include <QPointer>
 #include <QQmlApplicationEngine>
 #include <QQuickItem>
 
+#include "constants.h"
 #include "qmlengineholder.h"
 #include "qmlpath.h"
+#include "qmlpathindex.h"
+
+namespace {
+// The index belongs to the engine.
+QPointer<QmlPathIndex> s_index;
+}  // namespace
 
 // static
 QObject* InspectorUtils::findObject(const QString& name) {
@@ -91,5 +99,21 @@ QObject* InspectorUtils::queryObject(const QString& path) {
     return nullptr;
   }
 
-  return qmlPath.evaluate(engine);
+  return qmlPath.evaluate(engine, index());
+}
+
+// static
+QmlPathIndex* InspectorUtils::index() {
+  if (s_index || Constants::inProduction()) {
+    return s_index;
+  }
+
+  QQmlApplicationEngine* engine = qobject_cast<QQmlApplicationEngine*>(
+      QmlEngineHolder::instance()->engine());
+  if (!engine) {
+    return nullptr;
+  }
+
+  s_index = new QmlPathIndex(engine);
+  return s_index;
 }
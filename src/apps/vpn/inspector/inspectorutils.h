@@ -7,11 +7,17 @@
 
 #include <QObject>
 
+class QmlPathIndex;
+
 class InspectorUtils final {
  public:
   static QObject* findObject(const QString& name);
 
   static QObject* queryObject(const QString& path);
+
+  // The objectName index used by queryObject(). Not available in production,
+  // where the queries are too rare to pay for it.
+  static QmlPathIndex* index();
 };
 
 #endif  // INSPECTORUTILS_H
@@ -90,22 +90,9 @@ const QList<QString> ServerCountry::serversFromCityName(
   return QList<QString>();
 }
 
-namespace {
-
-bool sortCityCallback(const ServerCity& a, const ServerCity& b,
-                      const QString& countryCode, Collator* collator) {
-  Q_ASSERT(collator);
-  return collator->compare(
-             ServerI18N::translateCityName(countryCode, a.name()),
-             ServerI18N::translateCityName(countryCode, b.name())) < 0;
-}
-
-}  // anonymous namespace
-
 void ServerCountry::sortCities() {
   Collator collator;
-
-  std::sort(m_cities.begin(), m_cities.end(),
-            std::bind(sortCityCallback, std::placeholders::_1,
-                      std::placeholders::_2, m_code, &collator));
+  collator.sort(m_cities, [this](const ServerCity& city) {
+    return ServerI18N::translateCityName(m_code, city.name());
+  });
 }
@@ -4,10 +4,15 @@
 
 #include "servercountrymodel.h"
 
+#include <QDataStream>
+#include <QDateTime>
 #include <QJsonArray>
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QRandomGenerator>
+#include <QtMath>
+#include <algorithm>
+#include <cmath>
 
 #include "appconstants.h"
 #include "collator.h"
@@ -22,7 +27,35 @@
 
 namespace {
 Logger logger("ServerCountryModel");
+
+constexpr const quint8 LATENCY_HISTORY_VERSION = 1;
+
+// Without a measurement, the latency of a city is estimated from its
+// distance: light covers ~200km per msec in fiber, and routes are rarely
+// straight.
+constexpr const double EARTH_RADIUS_KM = 6371;
+constexpr const double FIBER_KM_PER_MSEC = 200;
+constexpr const double ROUTE_STRETCH = 1.5;
+
+// Added to estimated latencies, so that a measured city wins over one which
+// is only expected to be as fast.
+constexpr const double UNMEASURED_PENALTY_MSEC = 20;
+
+// The score is multiplied by (1 + LOSS_PENALTY * loss rate).
+constexpr const double LOSS_PENALTY = 4;
+
+// Subtracted for each doubling of the number of available servers.
+constexpr const double SERVER_COUNT_BONUS_MSEC = 5;
+
+void toUnitVector(double latitude, double longitude, double& x, double& y,
+                  double& z) {
+  double lat = latitude * M_PI / 180.0;
+  double lon = longitude * M_PI / 180.0;
+  x = qCos(lat) * qCos(lon);
+  y = qCos(lat) * qSin(lon);
+  z = qSin(lat);
 }
+}  // namespace
 
 ServerCountryModel::ServerCountryModel() { MZ_COUNT_CTOR(ServerCountryModel); }
 
@@ -32,6 +65,8 @@ bool ServerCountryModel::fromSettings() {
   SettingsHolder* settingsHolder = SettingsHolder::instance();
   Q_ASSERT(settingsHolder);
 
+  loadLatencyHistory();
+
   logger.debug() << "Reading the server list from settings";
 
   const QByteArray json = settingsHolder->servers();
@@ -66,6 +101,7 @@ bool ServerCountryModel::fromJsonInternal(const QByteArray& s) {
   m_rawJson = "";
   m_countries.clear();
   m_servers.clear();
+  m_cityVectors.clear();
 
   QJsonDocument doc = QJsonDocument::fromJson(s);
   if (!doc.isObject()) {
@@ -120,18 +156,42 @@ bool ServerCountryModel::fromJsonInternal(const QByteArray& s) {
         if (!server.fromJson(serverValue.toObject())) {
           return false;
         }
+
+        auto history = m_latencyHistory.constFind(server.publicKey());
+        if (history != m_latencyHistory.cend() && history->hasLatency()) {
+          server.setLatency(history->ewma());
+        }
+
         m_servers[server.publicKey()] = server;
       }
     }
   }
 
   sortCountries();
+  buildCityVectors();
 
   endResetModel();
 
   return true;
 }
 
+void ServerCountryModel::buildCityVectors() {
+  m_cityVectors.clear();
+
+  for (const ServerCountry& country : m_countries) {
+    for (const ServerCity& city : country.cities()) {
+      CityVector vector;
+      vector.countryCode = country.code();
+      vector.cityName = city.name();
+      vector.cityCode = city.code();
+      vector.servers = city.servers();
+      toUnitVector(city.latitude(), city.longitude(), vector.x, vector.y,
+                   vector.z);
+      m_cityVectors.append(vector);
+    }
+  }
+}
+
 QHash<int, QByteArray> ServerCountryModel::roleNames() const {
   QHash<int, QByteArray> roles;
   roles[NameRole] = "name";
@@ -202,12 +262,22 @@ int ServerCountryModel::cityConnectionScore(const ServerCity& city) const {
   qint64 now = QDateTime::currentSecsSinceEpoch();
   int score = Poor;
   int activeServerCount = 0;
+  int measuredServerCount = 0;
   uint32_t sumLatencyMsec = 0;
+  double sumLossRate = 0;
   for (const QString& pubkey : city.servers()) {
     const Server& server = m_servers[pubkey];
-    if (server.cooldownTimeout() <= now) {
+    if (server.cooldownTimeout() > now) {
+      continue;
+    }
+    activeServerCount++;
+
+    // Servers that have never replied must not drag the average down.
+    auto history = m_latencyHistory.constFind(pubkey);
+    if (history != m_latencyHistory.cend() && history->hasLatency()) {
       sumLatencyMsec += server.latency();
-      activeServerCount++;
+      sumLossRate += history->lossRate();
+      measuredServerCount++;
     }
   }
 
@@ -220,14 +290,15 @@ int ServerCountryModel::cityConnectionScore(const ServerCity& city) const {
   if (!Feature::get(Feature::Feature_serverConnectionScore)->isSupported()) {
     return NoData;
   }
-  // In the unlikely event that the sum of the latencies is zero, then we
-  // haven't actually measured anything and have nothing to report.
-  if (sumLatencyMsec == 0) {
+  // If we haven't actually measured anything, we have nothing to report.
+  if (measuredServerCount == 0) {
     return NoData;
   }
 
-  // Increase the score if the location has less than 100ms of latency.
-  if ((sumLatencyMsec / activeServerCount) < 100) {
+  // Increase the score if the location has less than 100ms of latency and
+  // loses less than 10% of the probes.
+  if ((sumLatencyMsec / measuredServerCount) < 100 &&
+      (sumLossRate / measuredServerCount) < 0.1) {
     score++;
   }
 
@@ -272,43 +343,116 @@ QStringList ServerCountryModel::pickRandom() const {
 
 // Select the city that we think is going to perform the best
 QStringList ServerCountryModel::pickBest(const Location& location) const {
-  double latitude = location.latitude();
-  double longitude = location.longitude();
-  if (qIsNaN(latitude) || qIsNaN(longitude)) {
-    // If we don't know the client's location, just pick at random.
+  QList<CityRecommendation> best =
+      recommendedCities(location.latitude(), location.longitude(), 1);
+  if (best.isEmpty()) {
+    // If we know neither the client's location, nor any latency, just pick
+    // at random.
     return pickRandom();
   }
 
-  // We rank cities using the distance between two points on a great circle,
-  // which is given by:
-  //    d = acos(sin(lat1)*sin(lat2) + cos(lat1)*cos(lat2)*cos(long1-long2))
-  //
-  // TODO: Include other ranking data, such as latency and number of servers.
-  QString bestCountry;
-  QString bestCity;
-  double clientSin = qSin(latitude * M_PI / 180.0);
-  double clientCos = qCos(latitude * M_PI / 180.0);
-  double bestDistance = M_2_PI;
-  for (const ServerCountry& country : m_countries) {
-    for (const ServerCity& city : country.cities()) {
-      double citySin = qSin(city.latitude() * M_PI / 180.0);
-      double cityCos = qCos(city.latitude() * M_PI / 180.0);
-      double diffCos = qCos((city.longitude() - longitude) * M_PI / 180.0);
-      double distance =
-          qAcos(clientSin * citySin + clientCos * cityCos * diffCos);
-
-      if (distance < bestDistance) {
-        bestCountry = country.code();
-        bestCity = city.name();
-        bestDistance = distance;
+  return QStringList({best[0].countryCode, best[0].cityName});
+}
+
+QList<ServerCountryModel::CityRecommendation>
+ServerCountryModel::recommendedCities(double latitude, double longitude,
+                                      qsizetype count) const {
+  bool hasLocation = !qIsNaN(latitude) && !qIsNaN(longitude);
+  double clientX = 0;
+  double clientY = 0;
+  double clientZ = 0;
+  if (hasLocation) {
+    toUnitVector(latitude, longitude, clientX, clientY, clientZ);
+  }
+
+  qint64 now = QDateTime::currentSecsSinceEpoch();
+
+  QList<CityRecommendation> results;
+  for (const CityVector& city : m_cityVectors) {
+    double totalWeight = 0;
+    double activeWeight = 0;
+    int activeServers = 0;
+    double latencySum = 0;
+    double lossSum = 0;
+    double measuredWeight = 0;
+
+    for (const QString& pubkey : city.servers) {
+      auto server = m_servers.constFind(pubkey);
+      if (server == m_servers.cend()) {
+        continue;
+      }
+
+      // Servers without a weight still count, a little.
+      double weight = qMax<double>(server->weight(), 1);
+      totalWeight += weight;
+      if (server->cooldownTimeout() > now) {
+        continue;
+      }
+
+      activeWeight += weight;
+      activeServers++;
+
+      auto history = m_latencyHistory.constFind(pubkey);
+      if (history != m_latencyHistory.cend() && history->hasLatency()) {
+        latencySum += weight * server->latency();
+        lossSum += weight * history->lossRate();
+        measuredWeight += weight;
       }
     }
+
+    if (activeServers == 0) {
+      continue;
+    }
+
+    double score;
+    if (measuredWeight > 0) {
+      score = latencySum / measuredWeight;
+      score *= 1 + LOSS_PENALTY * (lossSum / measuredWeight);
+    } else if (hasLocation) {
+      double dot = clientX * city.x + clientY * city.y + clientZ * city.z;
+      double distanceKm = qAcos(qBound(-1.0, dot, 1.0)) * EARTH_RADIUS_KM;
+      score = 2 * distanceKm * ROUTE_STRETCH / FIBER_KM_PER_MSEC +
+              UNMEASURED_PENALTY_MSEC;
+    } else {
+      continue;
+    }
+
+    // A city with part of its servers on cooldown is likely overloaded.
+    score /= activeWeight / totalWeight;
+    score -= SERVER_COUNT_BONUS_MSEC * std::log2(activeServers);
+
+    results.append({city.countryCode, city.cityName, city.cityCode, score});
   }
 
-  if (bestCountry.isEmpty() || bestCity.isEmpty()) {
-    return pickRandom();
+  auto compare = [](const CityRecommendation& a,
+                    const CityRecommendation& b) { return a.score < b.score; };
+
+  count = qBound<qsizetype>(0, count, results.count());
+  std::partial_sort(results.begin(), results.begin() + count, results.end(),
+                    compare);
+  results.resize(count);
+  return results;
+}
+
+QVariantList ServerCountryModel::recommendedLocations(int count) const {
+  QVariantList list;
+  for (const CityRecommendation& city :
+       recommendedCities(m_clientLatitude, m_clientLongitude, count)) {
+    QVariantMap obj;
+    obj["countryCode"] = city.countryCode;
+    obj["cityName"] = city.cityName;
+    obj["localizedCityName"] =
+        ServerI18N::translateCityName(city.countryCode, city.cityName);
+    obj["code"] = city.cityCode;
+    obj["score"] = city.score;
+    list.append(obj);
   }
-  return QStringList({bestCountry, bestCity});
+  return list;
+}
+
+void ServerCountryModel::setClientLocation(const Location& location) {
+  m_clientLatitude = location.latitude();
+  m_clientLongitude = location.longitude();
 }
 
 bool ServerCountryModel::exists(const QString& countryCode,
@@ -377,9 +521,99 @@ void ServerCountryModel::retranslate() {
 
 void ServerCountryModel::setServerLatency(const QString& publicKey,
                                           unsigned int msec) {
+  auto server = m_servers.find(publicKey);
+  if (server == m_servers.end()) {
+    return;
+  }
+
+  ServerLatencyHistory& history = m_latencyHistory[publicKey];
+  history.addSample(msec);
+  server->setLatency(history.ewma());
+}
+
+void ServerCountryModel::setServerLatencyLost(const QString& publicKey) {
   if (m_servers.contains(publicKey)) {
-    m_servers[publicKey].setLatency(msec);
+    m_latencyHistory[publicKey].addLoss();
+  }
+}
+
+void ServerCountryModel::loadLatencyHistory() {
+  SettingsHolder* settingsHolder = SettingsHolder::instance();
+  Q_ASSERT(settingsHolder);
+
+  m_latencyHistory.clear();
+  m_latencyHistoryTimestamp = 0;
+
+  QByteArray data = settingsHolder->serverLatencyHistory();
+  if (data.isEmpty()) {
+    return;
+  }
+
+  QDataStream stream(data);
+  quint8 version = 0;
+  stream >> version;
+  if (version != LATENCY_HISTORY_VERSION) {
+    logger.info() << "Ignoring latency history version"
+                  << static_cast<int>(version);
+    return;
+  }
+
+  qint64 timestamp = 0;
+  quint32 count = 0;
+  stream >> timestamp >> count;
+
+  QHash<QString, ServerLatencyHistory> histories;
+  for (quint32 i = 0; i < count && stream.status() == QDataStream::Ok; ++i) {
+    QString publicKey;
+    ServerLatencyHistory history;
+    stream >> publicKey >> history;
+    histories.insert(publicKey, history);
   }
+
+  if (stream.status() != QDataStream::Ok) {
+    logger.error() << "Corrupted latency history";
+    return;
+  }
+
+  logger.debug() << "Latency history loaded for" << histories.count()
+                 << "servers";
+  m_latencyHistory = histories;
+  m_latencyHistoryTimestamp = timestamp;
+
+  for (auto i = m_servers.begin(); i != m_servers.end(); ++i) {
+    auto history = m_latencyHistory.constFind(i.key());
+    if (history != m_latencyHistory.cend() && history->hasLatency()) {
+      i->setLatency(history->ewma());
+    }
+  }
+}
+
+void ServerCountryModel::saveLatencyHistory() {
+  SettingsHolder* settingsHolder = SettingsHolder::instance();
+  Q_ASSERT(settingsHolder);
+
+  // Forget about the servers which are gone.
+  if (!m_servers.isEmpty()) {
+    m_latencyHistory.removeIf(
+        [this](const QHash<QString, ServerLatencyHistory>::iterator& i) {
+          return !m_servers.contains(i.key());
+        });
+  }
+
+  m_latencyHistoryTimestamp = QDateTime::currentMSecsSinceEpoch();
+
+  QByteArray data;
+  {
+    QDataStream stream(&data, QIODevice::WriteOnly);
+    stream << LATENCY_HISTORY_VERSION << m_latencyHistoryTimestamp
+           << static_cast<quint32>(m_latencyHistory.count());
+    for (auto i = m_latencyHistory.cbegin(); i != m_latencyHistory.cend();
+         ++i) {
+      stream << i.key() << i.value();
+    }
+  }
+
+  settingsHolder->setServerLatencyHistory(data);
 }
 
 void ServerCountryModel::setServerCooldown(const QString& publicKey) {
@@ -409,23 +643,11 @@ void ServerCountryModel::setCooldownForAllServersInACity(
   }
 }
 
-namespace {
-
-bool sortCountryCallback(const ServerCountry& a, const ServerCountry& b,
-                         Collator* collator) {
-  Q_ASSERT(collator);
-  return collator->compare(
-             ServerI18N::translateCountryName(a.code(), a.name()),
-             ServerI18N::translateCountryName(b.code(), b.name())) < 0;
-}
-
-}  // anonymous namespace
-
 void ServerCountryModel::sortCountries() {
   Collator collator;
-  std::sort(m_countries.begin(), m_countries.end(),
-            std::bind(sortCountryCallback, std::placeholders::_1,
-                      std::placeholders::_2, &collator));
+  collator.sort(m_countries, [](const ServerCountry& country) {
+    return ServerI18N::translateCountryName(country.code(), country.name());
+  });
 
   for (ServerCountry& country : m_countries) {
     country.sortCities();
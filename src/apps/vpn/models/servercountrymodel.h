@@ -8,8 +8,10 @@
 #include <QAbstractListModel>
 #include <QByteArray>
 #include <QObject>
+#include <QtNumeric>
 
 #include "servercountry.h"
+#include "serverlatencyhistory.h"
 
 class Location;
 
@@ -46,6 +48,27 @@ class ServerCountryModel final : public QAbstractListModel {
   Q_INVOKABLE QStringList pickRandom() const;
   QStringList pickBest(const Location& location) const;
 
+  struct CityRecommendation {
+    QString countryCode;
+    QString cityName;
+    QString cityCode;
+    // Estimated msec: lower is better.
+    double score;
+  };
+
+  // Ranks the cities by measured latency, falling back to the distance from
+  // the client, adjusted by packet loss, cooldown state and server count.
+  // Pass NaN coordinates if the client location is not known.
+  QList<CityRecommendation> recommendedCities(double latitude,
+                                              double longitude,
+                                              qsizetype count) const;
+
+  // Top-K recommendations for the last known client location, as a list of
+  // {countryCode, cityName, localizedCityName, code, score} objects.
+  Q_INVOKABLE QVariantList recommendedLocations(int count) const;
+
+  void setClientLocation(const Location& location);
+
   bool exists(const QString& countryCode, const QString& cityName) const;
 
   const QList<Server> servers(const QString& countryCode,
@@ -63,6 +86,16 @@ class ServerCountryModel final : public QAbstractListModel {
 
   void retranslate();
   void setServerLatency(const QString& publicKey, unsigned int msec);
+  void setServerLatencyLost(const QString& publicKey);
+  ServerLatencyHistory serverLatencyHistory(const QString& publicKey) const {
+    return m_latencyHistory.value(publicKey);
+  }
+
+  void loadLatencyHistory();
+  void saveLatencyHistory();
+  // When the history was last saved, in msecs since epoch. 0 if never.
+  qint64 latencyHistoryTimestamp() const { return m_latencyHistoryTimestamp; }
+
   void setServerCooldown(const QString& publicKey);
   void setCooldownForAllServersInACity(const QString& countryCode,
                                        const QString& cityCode);
@@ -87,6 +120,7 @@ class ServerCountryModel final : public QAbstractListModel {
   [[nodiscard]] bool fromJsonInternal(const QByteArray& data);
 
   void sortCountries();
+  void buildCityVectors();
   int cityConnectionScore(const ServerCity& city) const;
 
  private:
@@ -94,6 +128,27 @@ class ServerCountryModel final : public QAbstractListModel {
 
   QList<ServerCountry> m_countries;
   QHash<QString, Server> m_servers;
+
+  // The position of each city on the unit sphere, computed once when the
+  // server list is loaded.
+  struct CityVector {
+    QString countryCode;
+    QString cityName;
+    QString cityCode;
+    QList<QString> servers;
+    double x;
+    double y;
+    double z;
+  };
+  QList<CityVector> m_cityVectors;
+
+  double m_clientLatitude = qQNaN();
+  double m_clientLongitude = qQNaN();
+
+  // Kept apart from m_servers, which is rebuilt when the server list
+  // changes.
+  QHash<QString, ServerLatencyHistory> m_latencyHistory;
+  qint64 m_latencyHistoryTimestamp = 0;
 };
 
 #endif  // SERVERCOUNTRYMODEL_H
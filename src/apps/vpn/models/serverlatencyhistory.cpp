@@ -0,0 +1,121 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "serverlatencyhistory.h"
+
+#include <QDataStream>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+void ServerLatencyHistory::addSample(uint32_t msec) {
+  // Anything above 65 seconds is not a latency worth telling apart.
+  quint16 sample = static_cast<quint16>(std::min<uint32_t>(msec, LOST - 1));
+
+  if (m_sortedCount == 0) {
+    m_ewma = sample;
+  } else {
+    m_ewma += EWMA_ALPHA * (sample - m_ewma);
+  }
+
+  push(sample);
+}
+
+void ServerLatencyHistory::addLoss() { push(LOST); }
+
+void ServerLatencyHistory::push(quint16 sample) {
+  if (m_count == CAPACITY) {
+    quint16 evicted = m_samples[m_head];
+    if (evicted == LOST) {
+      --m_lossCount;
+    } else {
+      removeSorted(evicted);
+    }
+
+    m_samples[m_head] = sample;
+    m_head = (m_head + 1) % CAPACITY;
+  } else {
+    m_samples[(m_head + m_count) % CAPACITY] = sample;
+    ++m_count;
+  }
+
+  if (sample == LOST) {
+    ++m_lossCount;
+  } else {
+    insertSorted(sample);
+  }
+}
+
+void ServerLatencyHistory::removeSorted(quint16 sample) {
+  quint16* end = m_sorted + m_sortedCount;
+  quint16* pos = std::lower_bound(m_sorted, end, sample);
+  Q_ASSERT(pos != end && *pos == sample);
+
+  std::memmove(pos, pos + 1, (end - pos - 1) * sizeof(quint16));
+  --m_sortedCount;
+}
+
+void ServerLatencyHistory::insertSorted(quint16 sample) {
+  Q_ASSERT(m_sortedCount < CAPACITY);
+
+  quint16* end = m_sorted + m_sortedCount;
+  quint16* pos = std::upper_bound(m_sorted, end, sample);
+
+  std::memmove(pos + 1, pos, (end - pos) * sizeof(quint16));
+  *pos = sample;
+  ++m_sortedCount;
+}
+
+double ServerLatencyHistory::lossRate() const {
+  if (m_count == 0) {
+    return 0;
+  }
+  return static_cast<double>(m_lossCount) / m_count;
+}
+
+uint32_t ServerLatencyHistory::ewma() const {
+  return static_cast<uint32_t>(std::lround(m_ewma));
+}
+
+uint32_t ServerLatencyHistory::percentile(int p) const {
+  if (m_sortedCount == 0) {
+    return 0;
+  }
+
+  int rank = static_cast<int>(std::ceil(p * m_sortedCount / 100.0));
+  return m_sorted[std::clamp(rank - 1, 0, m_sortedCount - 1)];
+}
+
+QDataStream& operator<<(QDataStream& stream,
+                        const ServerLatencyHistory& history) {
+  stream << history.m_count;
+  for (int i = 0; i < history.m_count; ++i) {
+    stream << history.m_samples[(history.m_head + i) %
+                                ServerLatencyHistory::CAPACITY];
+  }
+  stream << history.m_ewma;
+  return stream;
+}
+
+QDataStream& operator>>(QDataStream& stream, ServerLatencyHistory& history) {
+  history = ServerLatencyHistory();
+
+  quint8 count = 0;
+  stream >> count;
+  for (int i = 0; i < count && stream.status() == QDataStream::Ok; ++i) {
+    quint16 sample;
+    stream >> sample;
+    history.push(sample);
+  }
+
+  double ewma = 0;
+  stream >> ewma;
+  if (stream.status() != QDataStream::Ok) {
+    history = ServerLatencyHistory();
+    return stream;
+  }
+
+  history.m_ewma = history.hasLatency() ? ewma : 0;
+  return stream;
+}
@@ -0,0 +1,70 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef SERVERLATENCYHISTORY_H
+#define SERVERLATENCYHISTORY_H
+
+#include <QtGlobal>
+
+class QDataStream;
+
+// The most recent round-trip time samples of a server.
+//
+// The samples are kept in a small ring, together with a sorted copy of the
+// received ones, so that the EWMA, the percentiles and the loss rate are
+// updated incrementally when a sample comes in and are O(1) to read.
+class ServerLatencyHistory final {
+ public:
+  static constexpr int CAPACITY = 16;
+
+  // Smoothing factor of the moving average: the weight of the new sample.
+  static constexpr double EWMA_ALPHA = 0.25;
+
+  void addSample(uint32_t msec);
+  void addLoss();
+
+  bool isEmpty() const { return m_count == 0; }
+  bool hasLatency() const { return m_sortedCount > 0; }
+
+  int sampleCount() const { return m_count; }
+  int lossCount() const { return m_lossCount; }
+
+  // Between 0 and 1.
+  double lossRate() const;
+
+  uint32_t ewma() const;
+
+  // Nearest-rank percentile of the received samples. Returns 0 if there are
+  // none.
+  uint32_t percentile(int p) const;
+  uint32_t p50() const { return percentile(50); }
+  uint32_t p95() const { return percentile(95); }
+
+  friend QDataStream& operator<<(QDataStream& stream,
+                                 const ServerLatencyHistory& history);
+  friend QDataStream& operator>>(QDataStream& stream,
+                                 ServerLatencyHistory& history);
+
+ private:
+  void push(quint16 sample);
+  void removeSorted(quint16 sample);
+  void insertSorted(quint16 sample);
+
+ private:
+  // Marks a lost probe in the ring.
+  static constexpr quint16 LOST = 0xFFFF;
+
+  quint16 m_samples[CAPACITY] = {};
+  quint16 m_sorted[CAPACITY] = {};
+
+  // Index of the oldest sample.
+  quint8 m_head = 0;
+  quint8 m_count = 0;
+  quint8 m_sortedCount = 0;
+  quint8 m_lossCount = 0;
+
+  double m_ewma = 0;
+};
+
+#endif  // SERVERLATENCYHISTORY_H
@@ -122,14 +122,21 @@ MozillaVPN::MozillaVPN() : m_private(new Private()) {
   s_instance = this;
 
   connect(&m_periodicOperationsTimer, &QTimer::timeout, []() {
-    TaskScheduler::scheduleTask(new TaskGroup(
+    TaskGroup* group = new TaskGroup(
         {new TaskAccount(ErrorHandler::DoNotPropagateError),
          new TaskServers(ErrorHandler::DoNotPropagateError),
          new TaskCaptivePortalLookup(ErrorHandler::DoNotPropagateError),
          new TaskHeartbeat(), new TaskGetFeatureList(), new TaskAddonIndex(),
          new TaskGetSubscriptionDetails(
              TaskGetSubscriptionDetails::NoAuthenticationFlow,
-             ErrorHandler::PropagateError)}));
+             ErrorHandler::PropagateError)});
+
+    // If this is still queued when the next refresh is scheduled, there is
+    // no point in running it.
+    group->setPriority(Task::PriorityBackground);
+    group->setDeadlineMsec(AppConstants::schedulePeriodicTaskTimerMsec());
+
+    TaskScheduler::scheduleTask(group);
   });
 
   connect(this, &MozillaVPN::stateChanged, [this]() {
@@ -185,6 +192,10 @@ MozillaVPN::MozillaVPN() : m_private(new Private()) {
           &m_private->m_captivePortalDetection,
           &CaptivePortalDetection::settingsChanged);
 
+  connect(&m_private->m_location, &Location::changed, this, [this]() {
+    m_private->m_serverCountryModel.setClientLocation(m_private->m_location);
+  });
+
   if (!Feature::get(Feature::Feature_webPurchase)->isSupported()) {
     ProductsHandler::createInstance();
   }
@@ -47,21 +47,7 @@ NetworkRequest::NetworkRequest(Task* parent, int status,
   MZ_COUNT_CTOR(NetworkRequest);
   logger.debug() << "Network request created by" << parent->name();
 
-  m_request.setAttribute(QNetworkRequest::Http2AllowedAttribute, false);
-  m_request.setRawHeader("User-Agent", NetworkManager::userAgent());
-  m_request.setMaximumRedirectsAllowed(REQUEST_MAX_REDIRECTS);
-  m_request.setAttribute(QNetworkRequest::RedirectPolicyAttribute,
-                         QNetworkRequest::SameOriginRedirectPolicy);
-
-  // Let's use "glean-enabled" as an indicator for DNT/GPC too.
-  if (!SettingsHolder::instance()->gleanEnabled()) {
-    // Do-Not-Track:
-    // https://datatracker.ietf.org/doc/html/draft-mayer-do-not-track-00
-    m_request.setRawHeader("DNT", "1");
-    // Global Privacy Control: https://globalprivacycontrol.github.io/gpc-spec/
-    m_request.setRawHeader("Sec-GPC", "1");
-  }
-  m_request.setOriginatingObject(parent);
+  initializeRequest(m_request, parent);
 
   if (setAuthorizationHeader) {
     if (SettingsHolder::instance()->token().isEmpty()) {
@@ -81,10 +67,6 @@ NetworkRequest::NetworkRequest(Task* parent, int status,
   connect(&m_timer, &QTimer::timeout, this, &NetworkRequest::maybeDeleteLater);
 
   NetworkManager::instance()->increaseNetworkRequestCount();
-
-#ifndef QT_NO_SSL
-  enableSSLIntervention();
-#endif
 }
 
 NetworkRequest::~NetworkRequest() {
@@ -106,6 +88,42 @@ QString NetworkRequest::apiBaseUrl() {
   return AppConstants::getStagingServerAddress();
 }
 
+// static
+void NetworkRequest::initializeRequest(QNetworkRequest& request,
+                                       Task* parent) {
+  request.setAttribute(QNetworkRequest::Http2AllowedAttribute, false);
+  request.setRawHeader("User-Agent", NetworkManager::userAgent());
+  request.setMaximumRedirectsAllowed(REQUEST_MAX_REDIRECTS);
+  request.setAttribute(QNetworkRequest::RedirectPolicyAttribute,
+                       QNetworkRequest::SameOriginRedirectPolicy);
+
+  // Let's use "glean-enabled" as an indicator for DNT/GPC too.
+  if (!SettingsHolder::instance()->gleanEnabled()) {
+    // Do-Not-Track:
+    // https://datatracker.ietf.org/doc/html/draft-mayer-do-not-track-00
+    request.setRawHeader("DNT", "1");
+    // Global Privacy Control: https://globalprivacycontrol.github.io/gpc-spec/
+    request.setRawHeader("Sec-GPC", "1");
+  }
+  request.setOriginatingObject(parent);
+
+#ifndef QT_NO_SSL
+  enableSSLIntervention(request);
+#endif
+}
+
+// static
+QNetworkRequest NetworkRequest::requestForDownload(Task* parent,
+                                                   const QUrl& url) {
+  Q_ASSERT(parent);
+
+  QNetworkRequest request(url);
+  initializeRequest(request, parent);
+  request.setAttribute(QNetworkRequest::RedirectPolicyAttribute,
+                       QNetworkRequest::NoLessSafeRedirectPolicy);
+  return request;
+}
+
 // static
 NetworkRequest* NetworkRequest::createForGetUrl(Task* parent,
                                                 const QString& url,
@@ -1249,7 +1267,8 @@ void NetworkRequest::sslErrors(const QList<QSslError>& errors) {
   }
 }
 
-void NetworkRequest::enableSSLIntervention() {
+// static
+void NetworkRequest::enableSSLIntervention(QNetworkRequest& request) {
   if (s_intervention_certs.isEmpty()) {
     s_intervention_certs = QSslConfiguration::systemCaCertificates();
     QDirIterator certFolder(":/certs");
@@ -1272,6 +1291,6 @@ void NetworkRequest::enableSSLIntervention() {
   }
   auto conf = QSslConfiguration::defaultConfiguration();
   conf.addCaCertificates(s_intervention_certs);
-  m_request.setSslConfiguration(conf);
+  request.setSslConfiguration(conf);
 }
 #endif
@@ -157,6 +157,11 @@ class NetworkRequest final : public QObject {
                                                const QString& productId);
 #endif
 
+  // For the downloads which are read by the caller (e.g. streamed to disk):
+  // a request with the same headers, redirect policy and SSL configuration as
+  // ours. The caller owns the reply, and accounts for it in NetworkManager.
+  static QNetworkRequest requestForDownload(Task* parent, const QUrl& url);
+
   void disableTimeout();
 
   int statusCode() const;
@@ -176,6 +181,8 @@ class NetworkRequest final : public QObject {
  private:
   NetworkRequest(Task* parent, int status, bool setAuthorizationHeader);
 
+  static void initializeRequest(QNetworkRequest& request, Task* parent);
+
   void deleteRequest();
   void getRequest();
   void postRequest(const QByteArray& body);
@@ -216,7 +223,7 @@ class NetworkRequest final : public QObject {
   QTimer m_timer;
 
 #ifndef QT_NO_SSL
-  void enableSSLIntervention();
+  static void enableSSLIntervention(QNetworkRequest& request);
 #endif
 
   QNetworkReply* m_reply = nullptr;
@@ -71,7 +71,9 @@ void NetworkWatcher::initialize() {
   connect(m_impl, &NetworkWatcherImpl::unsecuredNetwork, this,
           &NetworkWatcher::unsecuredNetwork);
   connect(m_impl, &NetworkWatcherImpl::networkChanged, this,
-          &NetworkWatcher::networkChange);
+          &NetworkWatcher::networkChanged);
+  connect(m_impl, &NetworkWatcherImpl::transportChanged, this,
+          [this]() { m_networkId.clear(); });
 
   m_impl->initialize();
 
@@ -108,6 +110,11 @@ void NetworkWatcher::settingsChanged() {
   }
 }
 
+void NetworkWatcher::networkChanged(const QString& networkId) {
+  m_networkId = networkId.trimmed();
+  emit networkChange();
+}
+
 void NetworkWatcher::unsecuredNetwork(const QString& networkName,
                                       const QString& networkId) {
   logger.debug() << "Unsecured network:" << logger.sensitive(networkName)
@@ -171,3 +178,11 @@ QString NetworkWatcher::getCurrentTransport() {
   return QString(metaEnum.valueToKey(type))
       .remove("TransportType_", Qt::CaseSensitive);
 }
+
+QString NetworkWatcher::currentNetworkId() {
+  if (!m_impl || m_networkId.isEmpty()) {
+    return QString();
+  }
+
+  return getCurrentTransport() + "/" + m_networkId;
+}
@@ -28,12 +28,18 @@ class NetworkWatcher final : public QObject {
 
   QString getCurrentTransport();
 
+  // Identifies the network we are connected to, to remember what we know
+  // about it. Empty if the platform does not tell us which network it is.
+  QString currentNetworkId();
+
  signals:
   void networkChange();
 
  private:
   void settingsChanged();
 
+  void networkChanged(const QString& networkId);
+
   void notificationClicked(NotificationHandler::Message message);
 
  private:
@@ -45,6 +51,10 @@ class NetworkWatcher final : public QObject {
 
   QMap<QString, QElapsedTimer> m_networks;
 
+  // The BSSID of the current WiFi network, if known. Cleared when we leave
+  // it, or when the transport changes.
+  QString m_networkId;
+
   // This is used to connect NotificationHandler lazily.
   bool m_firstNotification = true;
 };
@@ -39,7 +39,8 @@ class NetworkWatcherImpl : public QObject {
  signals:
   // Fires when the Device Connects to an unsecured Network
   void unsecuredNetwork(const QString& networkName, const QString& networkId);
-  // Fires on when the connected WIFI Changes
+  // Fires on when the connected WIFI Changes, with an empty BSSID when we
+  // disconnect from it.
   // TODO: Only windows-networkwatcher has this, the other plattforms should
   // too.
   void networkChanged(QString newBSSID);
@@ -0,0 +1,238 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "pingscanner.h"
+
+#include <cmath>
+#include <limits>
+
+#include "leakdetector.h"
+#include "logger.h"
+
+static_assert((65536 % PingScanner::MAX_IN_FLIGHT) == 0,
+              "The sequence slots must wrap together with the sequence");
+
+namespace {
+Logger logger("PingScanner");
+
+constexpr const int SLOT_MASK = PingScanner::MAX_IN_FLIGHT - 1;
+}  // namespace
+
+PingScanner::PingScanner(QObject* parent) : QObject(parent) {
+  MZ_COUNT_CTOR(PingScanner);
+
+  m_slots.resize(MAX_IN_FLIGHT);
+
+  m_timer.setSingleShot(true);
+  connect(&m_timer, &QTimer::timeout, this, &PingScanner::maybeSendPings);
+}
+
+PingScanner::~PingScanner() { MZ_COUNT_DTOR(PingScanner); }
+
+void PingScanner::start(PingSender* sender, const QList<Target>& targets) {
+  Q_ASSERT(sender);
+  stop();
+
+  logger.debug() << "Scanning" << targets.count() << "targets";
+
+  m_sender = sender;
+  m_targets = targets;
+  m_nextTarget = 0;
+
+  m_clock.start();
+  m_tokens = MAX_BURST;
+  m_lastRefill = 0;
+
+  connect(m_sender, &PingSender::recvPing, this, &PingScanner::recvPing);
+
+  maybeSendPings();
+}
+
+void PingScanner::stop() {
+  m_timer.stop();
+
+  if (m_sender) {
+    disconnect(m_sender, nullptr, this, nullptr);
+    m_sender = nullptr;
+  }
+
+  m_targets.clear();
+  m_retryQueue.clear();
+  for (Slot& slot : m_slots) {
+    slot.target = -1;
+  }
+
+  // The sequence number is not reset, so that late replies from a previous
+  // scan cannot be mistaken for the new ones.
+  m_oldestSequence = m_nextSequence;
+  m_inFlight = 0;
+}
+
+bool PingScanner::hasPendingTargets() const {
+  return !m_retryQueue.isEmpty() || m_nextTarget < m_targets.count();
+}
+
+bool PingScanner::isWindowFull() const {
+  return static_cast<quint16>(m_nextSequence - m_oldestSequence) >=
+         MAX_IN_FLIGHT;
+}
+
+void PingScanner::advanceOldestSequence() {
+  while (m_oldestSequence != m_nextSequence &&
+         m_slots[m_oldestSequence & SLOT_MASK].target < 0) {
+    ++m_oldestSequence;
+  }
+}
+
+void PingScanner::refillTokens(qint64 now) {
+  if (m_pacingRate == 0) {
+    m_tokens = MAX_IN_FLIGHT;
+    return;
+  }
+
+  m_tokens += static_cast<double>(now - m_lastRefill) * m_pacingRate / 1000;
+  m_tokens = std::min(m_tokens, static_cast<double>(MAX_BURST));
+  m_lastRefill = now;
+}
+
+void PingScanner::expirePings(qint64 now) {
+  advanceOldestSequence();
+
+  while (m_inFlight > 0) {
+    Slot& slot = m_slots[m_oldestSequence & SLOT_MASK];
+    Q_ASSERT(slot.target >= 0);
+
+    // Slots are filled in transmit order: the oldest one expires first.
+    if (slot.sentAt + m_timeoutMsec > now) {
+      break;
+    }
+
+    QString key = m_targets.at(slot.target).key;
+    logger.debug() << "Target" << logger.keys(key) << "timeout"
+                   << slot.retries;
+
+    if (slot.retries < m_maxRetries) {
+      m_retryQueue.append(qMakePair(slot.target, slot.retries + 1));
+    }
+
+    slot.target = -1;
+    --m_inFlight;
+    advanceOldestSequence();
+
+    emit pingTimedOut(key);
+    if (!m_sender) {
+      return;
+    }
+  }
+}
+
+void PingScanner::maybeSendPings() {
+  if (!m_sender) {
+    return;
+  }
+
+  qint64 now = m_clock.elapsed();
+  expirePings(now);
+  if (!m_sender) {
+    return;
+  }
+
+  refillTokens(now);
+
+  QList<PingSender::PingRequest> batch;
+  while (m_tokens >= 1 && !isWindowFull()) {
+    int target;
+    int retries;
+    if (!m_retryQueue.isEmpty()) {
+      QPair<int, int> retry = m_retryQueue.takeFirst();
+      target = retry.first;
+      retries = retry.second;
+    } else if (m_nextTarget < m_targets.count()) {
+      target = m_nextTarget++;
+      retries = 0;
+    } else {
+      break;
+    }
+
+    Slot& slot = m_slots[m_nextSequence & SLOT_MASK];
+    Q_ASSERT(slot.target < 0);
+    slot.target = target;
+    slot.retries = retries;
+    slot.sentAt = now;
+    slot.sequence = m_nextSequence;
+
+    batch.append({m_targets.at(target).address, m_nextSequence});
+
+    ++m_nextSequence;
+    ++m_inFlight;
+    m_tokens -= 1;
+  }
+
+  if (!batch.isEmpty()) {
+    // The state must be consistent at this point: a sender is allowed to
+    // deliver replies synchronously.
+    m_sender->sendPings(batch);
+    if (!m_sender) {
+      return;
+    }
+  }
+
+  scheduleNextRun(now);
+}
+
+void PingScanner::scheduleNextRun(qint64 now) {
+  bool pending = hasPendingTargets();
+  if (m_inFlight == 0 && !pending) {
+    logger.debug() << "Scan completed";
+    stop();
+    emit finished();
+    return;
+  }
+
+  qint64 wait = std::numeric_limits<qint64>::max();
+  if (m_inFlight > 0) {
+    const Slot& oldest = m_slots[m_oldestSequence & SLOT_MASK];
+    wait = oldest.sentAt + m_timeoutMsec - now;
+  }
+
+  // If the window is full, a reply or a timeout will wake us up.
+  if (pending && !isWindowFull()) {
+    qint64 tokenWait = 0;
+    if (m_pacingRate > 0 && m_tokens < 1) {
+      tokenWait = static_cast<qint64>(
+          std::ceil((1 - m_tokens) * 1000 / m_pacingRate));
+    }
+    wait = std::min(wait, tokenWait);
+  }
+
+  m_timer.start(static_cast<int>(std::max<qint64>(wait, 0)));
+}
+
+void PingScanner::recvPing(quint16 sequence) {
+  Slot& slot = m_slots[sequence & SLOT_MASK];
+  if (slot.target < 0 || slot.sequence != sequence) {
+    // A duplicate, or a reply that arrived after its timeout.
+    return;
+  }
+
+  bool wasFull = isWindowFull();
+
+  qint64 latency = m_clock.elapsed() - slot.sentAt;
+  QString key = m_targets.at(slot.target).key;
+
+  slot.target = -1;
+  --m_inFlight;
+  advanceOldestSequence();
+
+  emit latencyMeasured(key, static_cast<uint>(latency));
+  if (!m_sender) {
+    return;
+  }
+
+  // Replies often come in bursts. Instead of sending one ping per reply,
+  // let the event loop deliver them all and then refill the window at once.
+  if (m_inFlight == 0 || (wasFull && hasPendingTargets())) {
+    m_timer.start(0);
+  }
+}
@@ -0,0 +1,102 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef PINGSCANNER_H
+#define PINGSCANNER_H
+
+#include <QElapsedTimer>
+#include <QHostAddress>
+#include <QList>
+#include <QObject>
+#include <QTimer>
+
+#include "pingsender.h"
+
+// Measures the round-trip time to a (possibly large) list of hosts.
+//
+// Pings are paced with a token bucket and sent in batches through
+// PingSender::sendPings(). In-flight pings live in a ring indexed by their
+// sequence number, so matching a reply, or expiring the oldest ping, is O(1)
+// whatever the number of targets.
+class PingScanner final : public QObject {
+  Q_OBJECT
+  Q_DISABLE_COPY_MOVE(PingScanner)
+
+ public:
+  struct Target {
+    QString key;
+    QHostAddress address;
+  };
+
+  // The number of sequence slots. This is also the max number of pings in
+  // flight. It must be a power of two which divides 65536.
+  static constexpr int MAX_IN_FLIGHT = 1024;
+
+  // Pings sent back-to-back before the pacing rate kicks in.
+  static constexpr int MAX_BURST = 32;
+
+  explicit PingScanner(QObject* parent = nullptr);
+  ~PingScanner();
+
+  // Pings per second. 0 means no pacing at all.
+  void setPacingRate(uint pingsPerSecond) { m_pacingRate = pingsPerSecond; }
+  void setTimeoutMsec(uint msec) { m_timeoutMsec = msec; }
+  void setMaxRetries(int retries) { m_maxRetries = retries; }
+
+  // The scanner does not take the ownership of the sender.
+  void start(PingSender* sender, const QList<Target>& targets);
+  void stop();
+
+  bool isActive() const { return m_sender != nullptr; }
+
+ signals:
+  void latencyMeasured(const QString& key, uint msec);
+  void pingTimedOut(const QString& key);
+  void finished();
+
+ private:
+  void maybeSendPings();
+  void expirePings(qint64 now);
+  void advanceOldestSequence();
+  void refillTokens(qint64 now);
+  bool hasPendingTargets() const;
+  bool isWindowFull() const;
+  void scheduleNextRun(qint64 now);
+
+  void recvPing(quint16 sequence);
+
+ private:
+  struct Slot {
+    // -1 when the slot is free.
+    int target = -1;
+    int retries = 0;
+    qint64 sentAt = 0;
+    quint16 sequence = 0;
+  };
+
+  PingSender* m_sender = nullptr;
+  QList<Target> m_targets;
+
+  // The next target to ping for the first time.
+  int m_nextTarget = 0;
+
+  // Targets whose ping timed out and must be sent again, with the retry count.
+  QList<QPair<int, int>> m_retryQueue;
+
+  QList<Slot> m_slots;
+  quint16 m_nextSequence = 0;
+  quint16 m_oldestSequence = 0;
+  int m_inFlight = 0;
+
+  uint m_pacingRate = 0;
+  uint m_timeoutMsec = 5000;
+  int m_maxRetries = 2;
+
+  QElapsedTimer m_clock;
+  double m_tokens = 0;
+  qint64 m_lastRefill = 0;
+  QTimer m_timer;
+};
+
+#endif  // PINGSCANNER_H
@@ -7,6 +7,7 @@
 
 #include <QElapsedTimer>
 #include <QHostAddress>
+#include <QList>
 #include <QObject>
 
 class PingSender : public QObject {
@@ -20,6 +21,19 @@ class PingSender : public QObject {
 
   virtual void sendPing(const QHostAddress& destination, quint16 sequence) = 0;
 
+  struct PingRequest {
+    QHostAddress destination;
+    quint16 sequence;
+  };
+
+  // Send a batch of pings at once. Senders which can hand several packets to
+  // the kernel in a single call should override this.
+  virtual void sendPings(const QList<PingRequest>& requests) {
+    for (const PingRequest& request : requests) {
+      sendPing(request.destination, request.sequence);
+    }
+  }
+
   static quint16 inetChecksum(const void* data, size_t length);
 
  signals:
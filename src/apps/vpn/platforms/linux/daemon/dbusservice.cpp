@@ -33,6 +33,8 @@ DBusService::DBusService(QObject* parent) : Daemon(parent) {
   MZ_COUNT_CTOR(DBusService);
 
   m_wgutils = new WireguardUtilsLinux(this);
+  connect(m_wgutils, &WireguardUtilsLinux::backendFailure, this,
+          &DBusService::monitorBackendFailure);
 
   if (!removeInterfaceIfExists()) {
     qFatal("Interface `%s` exists and cannot be removed. Cannot proceed!",
@@ -136,6 +138,13 @@ bool DBusService::deactivate(bool emitSignals) {
   return Daemon::deactivate(emitSignals);
 }
 
+void DBusService::monitorBackendFailure() {
+  logger.warning() << "The WireGuard backend failed";
+
+  emit backendFailure();
+  deactivate();
+}
+
 QString DBusService::status() {
   return QString(QJsonDocument(getStatus()).toJson(QJsonDocument::Compact));
 }
@@ -53,6 +53,8 @@ class DBusService final : public Daemon {
   bool removeInterfaceIfExists();
 
  private slots:
+  void monitorBackendFailure();
+
   void appLaunched(const QString& cgroup, const QString& appId, int rootpid);
   void appTerminated(const QString& cgroup, const QString& appId);
 
@@ -10,7 +10,6 @@
 #include <linux/rtnetlink.h>
 #include <mntent.h>
 #include <net/if.h>
-#include <netdb.h>
 #include <sys/ioctl.h>
 #include <sys/socket.h>
 #include <sys/stat.h>
@@ -52,6 +51,17 @@ constexpr const char* VPN_BLOCK_CGROUP = "/mozvpn.block";
 constexpr uint32_t VPN_EXCLUDE_CLASS_ID = 0x00110011;
 constexpr uint32_t VPN_BLOCK_CLASS_ID = 0x00220022;
 
+/* Route updates are sent to the kernel in batches of one sendmsg() each.
+ * rtnetlink handles the requests within sendmsg(), and the acknowledgements
+ * of a batch are read right after it: at most one batch of them is queued.
+ * With NETLINK_CAP_ACK, an acknowledgement is a single small skb, charged
+ * far less than NETLINK_ACK_SPACE to the receive buffer, which is sized for
+ * a full batch. If it overflows anyway, recv() reports ENOBUFS.
+ */
+constexpr int NETLINK_BATCH_SIZE = 64;
+constexpr int NETLINK_ACK_SPACE = 4096;
+constexpr int NETLINK_RCVBUF_SIZE = NETLINK_BATCH_SIZE * NETLINK_ACK_SPACE;
+
 static void nlmsg_append_attr(struct nlmsghdr* nlmsg, size_t maxlen,
                               int attrtype, const void* attrdata,
                               size_t attrlen);
@@ -86,10 +96,31 @@ WireguardUtilsLinux::WireguardUtilsLinux(QObject* parent)
     logger.warning() << "Failed to bind netlink socket:" << strerror(errno);
   }
 
+  // Acknowledgements without a copy of the request.
+  int one = 1;
+  if (setsockopt(m_nlsock, SOL_NETLINK, NETLINK_CAP_ACK, &one,
+                 sizeof(one)) != 0) {
+    logger.warning() << "Failed to cap netlink acks:" << strerror(errno);
+  }
+
+  // The daemon runs as root: it can go beyond net.core.rmem_max.
+  int rcvbuf = NETLINK_RCVBUF_SIZE;
+  if (setsockopt(m_nlsock, SOL_SOCKET, SO_RCVBUFFORCE, &rcvbuf,
+                 sizeof(rcvbuf)) != 0) {
+    logger.warning() << "Failed to size the netlink socket:" << strerror(errno);
+    setsockopt(m_nlsock, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+  }
+
   m_notifier = new QSocketNotifier(m_nlsock, QSocketNotifier::Read, this);
   connect(m_notifier, &QSocketNotifier::activated, this,
           &WireguardUtilsLinux::nlsockReady);
 
+  m_endpointResolver = new EndpointResolver(this);
+  connect(m_endpointResolver, &EndpointResolver::resolved, this,
+          &WireguardUtilsLinux::endpointResolved);
+  connect(m_endpointResolver, &EndpointResolver::failed, this,
+          &WireguardUtilsLinux::endpointFailed);
+
   // Most kernels cannot simultaneously support traffic classification with
   // both the net_cls (v1) and unified (v2) cgroups simultaneously. If both
   // are present, the net_cls traffic classifiers take priority.
@@ -207,13 +238,21 @@ bool WireguardUtilsLinux::updatePeer(const InterfaceConfig& config) {
   }
   device->first_peer = device->last_peer = peer;
 
+  // Server entries almost always hold a numeric address. Otherwise, don't
+  // block the event loop on the resolver: the peer is added when the lookup
+  // completes.
+  QHostAddress endpoint;
+  if (!endpointAddress(config.m_serverIpv4AddrIn, endpoint)) {
+    resolveEndpoint(config);
+    return true;
+  }
+
   logger.debug() << "Adding peer" << logger.keys(config.m_serverPublicKey);
 
   // Public Key
   wg_key_from_base64(peer->public_key, qPrintable(config.m_serverPublicKey));
   // Endpoint
-  if (!setPeerEndpoint(&peer->endpoint.addr, config.m_serverIpv4AddrIn,
-                       config.m_serverPort)) {
+  if (!setPeerEndpoint(&peer->endpoint.addr, endpoint, config.m_serverPort)) {
     logger.error() << "Failed to set peer endpoint for hop"
                    << config.m_hopindex;
     return false;
@@ -242,8 +281,9 @@ bool WireguardUtilsLinux::updatePeer(const InterfaceConfig& config) {
   }
 
   // Update the firewall to mark inbound traffic from the server.
-  GoString goAddress = {.p = qPrintable(config.m_serverIpv4AddrIn),
-                        .n = (ptrdiff_t)config.m_serverIpv4AddrIn.length()};
+  QByteArray endpointString = endpoint.toString().toLocal8Bit();
+  GoString goAddress = {.p = endpointString.constData(),
+                        .n = (ptrdiff_t)endpointString.length()};
   NetfilterMarkInbound(goAddress, config.m_serverPort);
 
   // Set/update peer
@@ -276,6 +316,11 @@ bool WireguardUtilsLinux::deletePeer(const InterfaceConfig& config) {
   }
   device->first_peer = device->last_peer = peer;
 
+  // The peer may still be waiting for its endpoint.
+  m_pendingPeers.removeIf([&config](const InterfaceConfig& pending) {
+    return pending.m_serverPublicKey == config.m_serverPublicKey;
+  });
+
   logger.debug() << "Removing peer" << logger.keys(config.m_serverPublicKey);
 
   // Public Key
@@ -283,8 +328,13 @@ bool WireguardUtilsLinux::deletePeer(const InterfaceConfig& config) {
   wg_key_from_base64(peer->public_key, qPrintable(config.m_serverPublicKey));
 
   // Clear firewall settings for this server.
-  GoString goAddress = {.p = qPrintable(config.m_serverIpv4AddrIn),
-                        .n = (ptrdiff_t)config.m_serverIpv4AddrIn.length()};
+  QHostAddress endpoint;
+  QByteArray endpointString = config.m_serverIpv4AddrIn.toLocal8Bit();
+  if (endpointAddress(config.m_serverIpv4AddrIn, endpoint)) {
+    endpointString = endpoint.toString().toLocal8Bit();
+  }
+  GoString goAddress = {.p = endpointString.constData(),
+                        .n = (ptrdiff_t)endpointString.length()};
   NetfilterClearInbound(goAddress);
 
   // Set/update device
@@ -299,6 +349,9 @@ bool WireguardUtilsLinux::deletePeer(const InterfaceConfig& config) {
 }
 
 bool WireguardUtilsLinux::deleteInterface() {
+  cancelEndpointLookups();
+  m_resolvedEndpoints.clear();
+
   // Clear firewall rules
   NetfilterClearTables();
 
@@ -361,6 +414,20 @@ bool WireguardUtilsLinux::deleteRoutePrefix(const IPAddress& prefix,
   return rtmSendRoute(RTM_DELROUTE, flags, prefix, hopindex);
 }
 
+QList<bool> WireguardUtilsLinux::updateRoutePrefixes(
+    const QList<IPAddress>& prefixes, int hopindex) {
+  logger.debug() << "Adding" << prefixes.count() << "routes";
+  const int flags = NLM_F_REQUEST | NLM_F_CREATE | NLM_F_REPLACE | NLM_F_ACK;
+  return rtmSendRoutes(RTM_NEWROUTE, flags, prefixes, hopindex);
+}
+
+QList<bool> WireguardUtilsLinux::deleteRoutePrefixes(
+    const QList<IPAddress>& prefixes, int hopindex) {
+  logger.debug() << "Removing" << prefixes.count() << "routes";
+  const int flags = NLM_F_REQUEST | NLM_F_ACK;
+  return rtmSendRoutes(RTM_DELROUTE, flags, prefixes, hopindex);
+}
+
 bool WireguardUtilsLinux::addExclusionRoute(const QHostAddress& address) {
   logger.debug() << "Adding exclusion route for"
                  << logger.sensitive(address.toString());
@@ -376,21 +443,116 @@ bool WireguardUtilsLinux::deleteExclusionRoute(const QHostAddress& address) {
 
 bool WireguardUtilsLinux::rtmSendRoute(int action, int flags,
                                        const IPAddress& prefix, int hopindex) {
-  constexpr size_t rtm_max_size = sizeof(struct rtmsg) +
-                                  2 * RTA_SPACE(sizeof(uint32_t)) +
-                                  RTA_SPACE(sizeof(struct in6_addr));
   int index = if_nametoindex(WG_INTERFACE);
   if (index <= 0) {
     logger.error() << "if_nametoindex() failed:" << strerror(errno);
     return false;
   }
 
-  wg_allowedip ip;
-  if (!buildAllowedIp(&ip, prefix)) {
+  QByteArray buffer;
+  int seq = rtmAppendRoute(buffer, action, flags, prefix, hopindex, index);
+  if (seq < 0) {
     logger.warning() << "Invalid destination prefix";
     return false;
   }
 
+  struct sockaddr_nl nladdr;
+  memset(&nladdr, 0, sizeof(nladdr));
+  nladdr.nl_family = AF_NETLINK;
+  ssize_t result = sendto(m_nlsock, buffer.constData(), buffer.size(), 0,
+                          (struct sockaddr*)&nladdr, sizeof(nladdr));
+  if (result != buffer.size()) {
+    return false;
+  }
+
+  // The acknowledgement is read by nlsockReady().
+  m_pendingRoutes.insert(seq, prefix);
+  return true;
+}
+
+QList<bool> WireguardUtilsLinux::rtmSendRoutes(int action, int flags,
+                                               const QList<IPAddress>& prefixes,
+                                               int hopindex) {
+  QList<bool> results(prefixes.count(), false);
+  if (prefixes.isEmpty()) {
+    return results;
+  }
+
+  int index = if_nametoindex(WG_INTERFACE);
+  if (index <= 0) {
+    logger.error() << "if_nametoindex() failed:" << strerror(errno);
+    return results;
+  }
+
+  struct sockaddr_nl nladdr;
+  memset(&nladdr, 0, sizeof(nladdr));
+  nladdr.nl_family = AF_NETLINK;
+
+  for (qsizetype offset = 0; offset < prefixes.count();
+       offset += NETLINK_BATCH_SIZE) {
+    qsizetype end =
+        std::min<qsizetype>(offset + NETLINK_BATCH_SIZE, prefixes.count());
+
+    // Sequence number -> index of the prefix.
+    QHash<quint32, qsizetype> batch;
+    QByteArray buffer;
+    for (qsizetype i = offset; i < end; ++i) {
+      int seq = rtmAppendRoute(buffer, action, flags, prefixes.at(i),
+                               hopindex, index);
+      if (seq < 0) {
+        logger.warning() << "Invalid destination prefix";
+        continue;
+      }
+      batch.insert(seq, i);
+    }
+    if (batch.isEmpty()) {
+      continue;
+    }
+
+    struct iovec iov;
+    iov.iov_base = buffer.data();
+    iov.iov_len = buffer.size();
+
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_name = &nladdr;
+    msg.msg_namelen = sizeof(nladdr);
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+
+    ssize_t result = sendmsg(m_nlsock, &msg, 0);
+    if (result != buffer.size()) {
+      logger.error() << "Failed to send the route batch:" << strerror(errno);
+      continue;
+    }
+
+    for (auto i = batch.cbegin(); i != batch.cend(); ++i) {
+      m_pendingRoutes.insert(i.key(), prefixes.at(i.value()));
+    }
+
+    // The acknowledgements are already queued (see NETLINK_BATCH_SIZE), and
+    // reading them does not block. One which is not there yet is settled by
+    // nlsockReady(), and the prefix counts as installed until then.
+    QHash<quint32, int> acks = nlsockRead();
+    for (auto i = batch.cbegin(); i != batch.cend(); ++i) {
+      results[i.value()] = (acks.value(i.key(), 0) == 0);
+    }
+  }
+
+  return results;
+}
+
+int WireguardUtilsLinux::rtmAppendRoute(QByteArray& buffer, int action,
+                                        int flags, const IPAddress& prefix,
+                                        int hopindex, int ifindex) {
+  constexpr size_t rtm_max_size = sizeof(struct rtmsg) +
+                                  2 * RTA_SPACE(sizeof(uint32_t)) +
+                                  RTA_SPACE(sizeof(struct in6_addr));
+  wg_allowedip ip;
+  if (!buildAllowedIp(&ip, prefix)) {
+    return -1;
+  }
+
   char buf[NLMSG_SPACE(rtm_max_size)];
   struct nlmsghdr* nlmsg = reinterpret_cast<struct nlmsghdr*>(buf);
   struct rtmsg* rtm = static_cast<struct rtmsg*>(NLMSG_DATA(nlmsg));
@@ -420,14 +582,11 @@ bool WireguardUtilsLinux::rtmSendRoute(int action, int flags,
   } else {
     nlmsg_append_attr(nlmsg, sizeof(buf), RTA_DST, &ip.ip4, sizeof(ip.ip4));
   }
-  nlmsg_append_attr32(nlmsg, sizeof(buf), RTA_OIF, index);
+  nlmsg_append_attr32(nlmsg, sizeof(buf), RTA_OIF, ifindex);
 
-  struct sockaddr_nl nladdr;
-  memset(&nladdr, 0, sizeof(nladdr));
-  nladdr.nl_family = AF_NETLINK;
-  size_t result = sendto(m_nlsock, buf, nlmsg->nlmsg_len, 0,
-                         (struct sockaddr*)&nladdr, sizeof(nladdr));
-  return (result == nlmsg->nlmsg_len);
+  // Messages in a batch must start on an aligned boundary.
+  buffer.append(buf, NLMSG_ALIGN(nlmsg->nlmsg_len));
+  return nlmsg->nlmsg_seq;
 }
 
 // PRIVATE METHODS
@@ -446,63 +605,100 @@ QStringList WireguardUtilsLinux::currentInterfaces() {
   return devices;
 }
 
-bool WireguardUtilsLinux::setPeerEndpoint(struct sockaddr* sa,
-                                          const QString& address, int port) {
-  QString portString = QString::number(port);
-
-  struct addrinfo hints;
-  memset(&hints, 0, sizeof(hints));
-  hints.ai_family = AF_UNSPEC;
-  hints.ai_socktype = SOCK_DGRAM;
-  hints.ai_protocol = IPPROTO_UDP;
-
-  struct addrinfo* resolved = nullptr;
-  auto guard = qScopeGuard([&] { freeaddrinfo(resolved); });
-  int retries = 15;
-
-  for (unsigned int timeout = 1000000;;
-       timeout = std::min((unsigned int)20000000, timeout * 6 / 5)) {
-    int rv = getaddrinfo(address.toLocal8Bit(), portString.toLocal8Bit(),
-                         &hints, &resolved);
-    if (!rv) {
-      break;
+bool WireguardUtilsLinux::endpointAddress(const QString& address,
+                                          QHostAddress& result) const {
+  // Numeric fast path: no resolver involved.
+  if (result.setAddress(address)) {
+    return true;
+  }
+
+  auto cached = m_resolvedEndpoints.constFind(address);
+  if (cached != m_resolvedEndpoints.cend()) {
+    result = cached.value();
+    return true;
+  }
+
+  return false;
+}
+
+void WireguardUtilsLinux::resolveEndpoint(const InterfaceConfig& config) {
+  logger.debug() << "Resolving the endpoint for hop" << config.m_hopindex;
+
+  // Replace an older configuration of the same hop.
+  m_pendingPeers.removeIf([&config](const InterfaceConfig& pending) {
+    return pending.m_hopindex == config.m_hopindex;
+  });
+  m_pendingPeers.append(config);
+
+  m_endpointResolver->resolve(config.m_serverIpv4AddrIn);
+}
+
+void WireguardUtilsLinux::endpointResolved(const QString& hostname,
+                                           const QHostAddress& address) {
+  m_resolvedEndpoints[hostname] = address;
+
+  QList<InterfaceConfig> ready;
+  for (auto i = m_pendingPeers.begin(); i != m_pendingPeers.end();) {
+    if (i->m_serverIpv4AddrIn == hostname) {
+      ready.append(*i);
+      i = m_pendingPeers.erase(i);
+    } else {
+      ++i;
     }
+  }
 
-    /* The set of return codes that are "permanent failures". All other
-     * possibilities are potentially transient.
-     *
-     * This is according to https://sourceware.org/glibc/wiki/NameResolver which
-     * states: "From the perspective of the application that calls getaddrinfo()
-     * it perhaps doesn't matter that much since EAI_FAIL, EAI_NONAME and
-     * EAI_NODATA are all permanent failure codes and the causes are all
-     * permanent failures in the sense that there is no point in retrying
-     * later."
-     *
-     * So this is what we do, except FreeBSD removed EAI_NODATA some time ago,
-     * so that's conditional.
-     */
-    if (rv == EAI_NONAME || rv == EAI_FAIL ||
-#ifdef EAI_NODATA
-        rv == EAI_NODATA ||
-#endif
-        (retries >= 0 && !retries--)) {
-      logger.error() << "Failed to resolve the address endpoint";
-      return false;
+  for (const InterfaceConfig& config : ready) {
+    if (!updatePeer(config)) {
+      logger.error() << "Failed to add the peer for hop" << config.m_hopindex;
+      emit backendFailure();
+      return;
     }
+  }
+}
 
-    logger.warning() << "Trying again in" << (timeout / 1000000.0) << "seconds";
-    usleep(timeout);
+void WireguardUtilsLinux::endpointFailed(const QString& hostname) {
+  qsizetype count =
+      m_pendingPeers.removeIf([&hostname](const InterfaceConfig& pending) {
+        return pending.m_serverIpv4AddrIn == hostname;
+      });
+  if (count == 0) {
+    return;
   }
 
-  if ((resolved->ai_family == AF_INET &&
-       resolved->ai_addrlen == sizeof(struct sockaddr_in)) ||
-      (resolved->ai_family == AF_INET6 &&
-       resolved->ai_addrlen == sizeof(struct sockaddr_in6))) {
-    memcpy(sa, resolved->ai_addr, resolved->ai_addrlen);
+  // updatePeer() has already succeeded for these peers: the activation
+  // cannot complete without them.
+  logger.error() << "Unable to add" << count << "peers without an endpoint";
+  emit backendFailure();
+}
+
+void WireguardUtilsLinux::cancelEndpointLookups() {
+  m_endpointResolver->cancelAll();
+  m_pendingPeers.clear();
+}
+
+bool WireguardUtilsLinux::setPeerEndpoint(struct sockaddr* sa,
+                                          const QHostAddress& address,
+                                          int port) {
+  if (address.protocol() == QAbstractSocket::IPv4Protocol) {
+    struct sockaddr_in* sin = reinterpret_cast<struct sockaddr_in*>(sa);
+    memset(sin, 0, sizeof(*sin));
+    sin->sin_family = AF_INET;
+    sin->sin_port = htons(port);
+    sin->sin_addr.s_addr = htonl(address.toIPv4Address());
     return true;
   }
 
-  logger.error() << "Invalid endpoint" << address;
+  if (address.protocol() == QAbstractSocket::IPv6Protocol) {
+    struct sockaddr_in6* sin6 = reinterpret_cast<struct sockaddr_in6*>(sa);
+    memset(sin6, 0, sizeof(*sin6));
+    sin6->sin6_family = AF_INET6;
+    sin6->sin6_port = htons(port);
+    Q_IPV6ADDR ipv6 = address.toIPv6Address();
+    memcpy(&sin6->sin6_addr, &ipv6, sizeof(sin6->sin6_addr));
+    return true;
+  }
+
+  logger.error() << "Invalid endpoint" << address.toString();
   return false;
 }
 
@@ -654,28 +850,57 @@ bool WireguardUtilsLinux::rtmSendExclude(int action, int flags,
   return true;
 }
 
-void WireguardUtilsLinux::nlsockReady() {
-  char buf[1024];
-  ssize_t len = recv(m_nlsock, buf, sizeof(buf), MSG_DONTWAIT);
-  if (len <= 0) {
-    return;
-  }
+void WireguardUtilsLinux::nlsockReady() { nlsockRead(); }
 
-  struct nlmsghdr* nlmsg = (struct nlmsghdr*)buf;
-  while (NLMSG_OK(nlmsg, len)) {
-    if (nlmsg->nlmsg_type == NLMSG_DONE) {
-      return;
+QHash<quint32, int> WireguardUtilsLinux::nlsockRead() {
+  QHash<quint32, int> acks;
+  char buf[8192];
+
+  // Read until the socket is empty: the notifier fires once for all of it.
+  while (true) {
+    ssize_t len = recv(m_nlsock, buf, sizeof(buf), MSG_DONTWAIT);
+    if (len < 0 && errno == EINTR) {
+      continue;
     }
-    if (nlmsg->nlmsg_type != NLMSG_ERROR) {
-      nlmsg = NLMSG_NEXT(nlmsg, len);
+    if (len < 0 && errno == ENOBUFS) {
+      // Some acknowledgements were dropped, and we cannot tell which.
+      logger.error() << "Lost the acknowledgements of"
+                     << m_pendingRoutes.count() << "route requests";
+      m_pendingRoutes.clear();
       continue;
     }
-    struct nlmsgerr* err = static_cast<struct nlmsgerr*>(NLMSG_DATA(nlmsg));
-    if (err->error != 0) {
-      logger.debug() << "Netlink request failed:" << strerror(-err->error);
+    if (len <= 0) {
+      break;
+    }
+
+    struct nlmsghdr* nlmsg = (struct nlmsghdr*)buf;
+    for (; NLMSG_OK(nlmsg, len); nlmsg = NLMSG_NEXT(nlmsg, len)) {
+      if (nlmsg->nlmsg_type != NLMSG_ERROR) {
+        continue;
+      }
+
+      struct nlmsgerr* err = static_cast<struct nlmsgerr*>(NLMSG_DATA(nlmsg));
+      acks.insert(nlmsg->nlmsg_seq, err->error);
+
+      auto route = m_pendingRoutes.find(nlmsg->nlmsg_seq);
+      if (route != m_pendingRoutes.end()) {
+        if (err->error != 0) {
+          logger.warning() << "Route to"
+                           << logger.sensitive(route->toString())
+                           << "rejected:" << strerror(-err->error);
+        }
+        m_pendingRoutes.erase(route);
+        continue;
+      }
+
+      if (err->error != 0) {
+        logger.warning() << "Netlink request" << nlmsg->nlmsg_seq
+                         << "failed:" << strerror(-err->error);
+      }
     }
-    nlmsg = NLMSG_NEXT(nlmsg, len);
   }
+
+  return acks;
 }
 
 // static
@@ -5,11 +5,13 @@
 #ifndef WIREGUARDUTILSLINUX_H
 #define WIREGUARDUTILSLINUX_H
 
+#include <QHash>
 #include <QHostAddress>
 #include <QObject>
 #include <QSocketNotifier>
 #include <QStringList>
 
+#include "daemon/endpointresolver.h"
 #include "daemon/wireguardutils.h"
 
 class WireguardUtilsLinux final : public WireguardUtils {
@@ -28,6 +30,10 @@ class WireguardUtilsLinux final : public WireguardUtils {
 
   bool updateRoutePrefix(const IPAddress& prefix, int hopindex) override;
   bool deleteRoutePrefix(const IPAddress& prefix, int hopindex) override;
+  QList<bool> updateRoutePrefixes(const QList<IPAddress>& prefixes,
+                                  int hopindex) override;
+  QList<bool> deleteRoutePrefixes(const QList<IPAddress>& prefixes,
+                                  int hopindex) override;
 
   bool addExclusionRoute(const QHostAddress& address) override;
   bool deleteExclusionRoute(const QHostAddress& address) override;
@@ -36,13 +42,31 @@ class WireguardUtilsLinux final : public WireguardUtils {
   void resetCgroup(const QString& cgroup);
   void resetAllCgroups();
 
+ signals:
+  // A peer could not be added after updatePeer() returned: the connection
+  // cannot be established.
+  void backendFailure();
+
  private:
   QStringList currentInterfaces();
-  bool setPeerEndpoint(struct sockaddr* sa, const QString& address, int port);
+  bool endpointAddress(const QString& address, QHostAddress& result) const;
+  void resolveEndpoint(const InterfaceConfig& config);
+  void endpointResolved(const QString& hostname, const QHostAddress& address);
+  void endpointFailed(const QString& hostname);
+  void cancelEndpointLookups();
+  bool setPeerEndpoint(struct sockaddr* sa, const QHostAddress& address,
+                       int port);
   bool addPeerPrefix(struct wg_peer* peer, const IPAddress& prefix);
   bool rtmSendRule(int action, int flags, int addrfamily);
   bool rtmSendRoute(int action, int flags, const IPAddress& prefix,
                     int hopindex);
+  QList<bool> rtmSendRoutes(int action, int flags,
+                            const QList<IPAddress>& prefixes, int hopindex);
+  int rtmAppendRoute(QByteArray& buffer, int action, int flags,
+                     const IPAddress& prefix, int hopindex, int ifindex);
+  // Reads the pending netlink replies without blocking, and returns the
+  // error code of each acknowledged request, by sequence number.
+  QHash<quint32, int> nlsockRead();
   bool rtmSendExclude(int action, int flags, const QHostAddress& address);
   static bool setupCgroupClass(const QString& path, unsigned long classid);
   static bool moveCgroupProcs(const QString& src, const QString& dest);
@@ -52,10 +76,20 @@ class WireguardUtilsLinux final : public WireguardUtils {
   int m_nlseq = 0;
   QSocketNotifier* m_notifier = nullptr;
 
+  // The route requests waiting for their acknowledgement, by sequence
+  // number.
+  QHash<quint32, IPAddress> m_pendingRoutes;
+
   int m_cgroupVersion = 0;
   QString m_cgroupNetClass;
   QString m_cgroupUnified;
 
+  // Endpoints given as hostnames are resolved in the background. Meanwhile,
+  // the peers waiting for them are kept here and added once resolved.
+  EndpointResolver* m_endpointResolver = nullptr;
+  QHash<QString, QHostAddress> m_resolvedEndpoints;
+  QList<InterfaceConfig> m_pendingPeers;
+
  private slots:
   void nlsockReady();
 };
@@ -21,7 +21,12 @@
 
 namespace {
 Logger logger("LinuxPingSender");
-}
+
+// The max number of packets handed to sendmmsg() or read by recvmmsg().
+constexpr const int PING_BATCH_SIZE = 32;
+
+constexpr const int PING_PACKET_SIZE = 2048;
+}  // namespace
 
 int LinuxPingSender::createSocket() {
   // Try creating an ICMP socket. This would be the ideal choice, but it can
@@ -92,6 +97,8 @@ LinuxPingSender::LinuxPingSender(const QHostAddress& source, QObject* parent)
     return;
   }
 
+  m_recvBuffer.resize(PING_BATCH_SIZE * PING_PACKET_SIZE);
+
   m_notifier = new QSocketNotifier(m_socket, QSocketNotifier::Read, this);
   if (m_ident) {
     connect(m_notifier, &QSocketNotifier::activated, this,
@@ -130,17 +137,111 @@ void LinuxPingSender::sendPing(const QHostAddress& dest, quint16 sequence) {
   }
 }
 
-void LinuxPingSender::icmpSocketReady() {
-  socklen_t slen = 0;
-  unsigned char data[2048];
-  int rc = recvfrom(m_socket, data, sizeof(data), MSG_DONTWAIT, NULL, &slen);
-  if (rc <= 0) {
-    logger.error() << "recvfrom failed:" << strerror(errno);
-    return;
+void LinuxPingSender::sendPings(const QList<PingRequest>& requests) {
+  struct sockaddr_in addrs[PING_BATCH_SIZE];
+  struct icmphdr packets[PING_BATCH_SIZE];
+  struct iovec iovs[PING_BATCH_SIZE];
+  struct mmsghdr msgs[PING_BATCH_SIZE];
+
+  for (qsizetype offset = 0; offset < requests.count();
+       offset += PING_BATCH_SIZE) {
+    int count = static_cast<int>(
+        qMin<qsizetype>(requests.count() - offset, PING_BATCH_SIZE));
+
+    memset(addrs, 0, sizeof(addrs));
+    memset(packets, 0, sizeof(packets));
+    memset(msgs, 0, sizeof(msgs));
+
+    for (int i = 0; i < count; ++i) {
+      const PingRequest& request = requests.at(offset + i);
+
+      addrs[i].sin_family = AF_INET;
+      addrs[i].sin_addr.s_addr =
+          qToBigEndian<quint32>(request.destination.toIPv4Address());
+
+      packets[i].type = ICMP_ECHO;
+      packets[i].un.echo.id = htons(m_ident);
+      packets[i].un.echo.sequence = htons(request.sequence);
+      packets[i].checksum = inetChecksum(&packets[i], sizeof(packets[i]));
+
+      iovs[i].iov_base = &packets[i];
+      iovs[i].iov_len = sizeof(packets[i]);
+
+      msgs[i].msg_hdr.msg_name = &addrs[i];
+      msgs[i].msg_hdr.msg_namelen = sizeof(addrs[i]);
+      msgs[i].msg_hdr.msg_iov = &iovs[i];
+      msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    // sendmmsg() may stop early: a failure is only reported if nothing at
+    // all has been sent, so skip the offending packet and carry on.
+    int sent = 0;
+    while (sent < count) {
+      int rc = sendmmsg(m_socket, msgs + sent, count - sent, 0);
+      if (rc < 0) {
+        logger.error() << "failed to send:" << strerror(errno);
+        rc = 1;
+      }
+      sent += rc;
+    }
+  }
+}
+
+void LinuxPingSender::recvPackets(
+    const std::function<void(const unsigned char*, int)>& callback) {
+  struct iovec iovs[PING_BATCH_SIZE];
+  struct mmsghdr msgs[PING_BATCH_SIZE];
+  unsigned char* buffer = reinterpret_cast<unsigned char*>(m_recvBuffer.data());
+
+  for (int i = 0; i < PING_BATCH_SIZE; ++i) {
+    iovs[i].iov_base = buffer + i * PING_PACKET_SIZE;
+    iovs[i].iov_len = PING_PACKET_SIZE;
   }
 
+  // Drain the socket: a full batch means more replies may be waiting.
+  bool first = true;
+  for (;;) {
+    memset(msgs, 0, sizeof(msgs));
+    for (int i = 0; i < PING_BATCH_SIZE; ++i) {
+      msgs[i].msg_hdr.msg_iov = &iovs[i];
+      msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    int rc = recvmmsg(m_socket, msgs, PING_BATCH_SIZE, MSG_DONTWAIT, nullptr);
+    if (rc <= 0) {
+      if (first || (errno != EAGAIN && errno != EWOULDBLOCK)) {
+        logger.error() << "recvmmsg failed:" << strerror(errno);
+      }
+      return;
+    }
+    first = false;
+
+    for (int i = 0; i < rc; ++i) {
+      callback(buffer + i * PING_PACKET_SIZE,
+               static_cast<int>(msgs[i].msg_len));
+    }
+
+    if (rc < PING_BATCH_SIZE) {
+      return;
+    }
+  }
+}
+
+void LinuxPingSender::icmpSocketReady() {
+  recvPackets([this](const unsigned char* data, int length) {
+    parseIcmpPacket(data, length);
+  });
+}
+
+void LinuxPingSender::rawSocketReady() {
+  recvPackets([this](const unsigned char* data, int length) {
+    parseRawPacket(data, length);
+  });
+}
+
+void LinuxPingSender::parseIcmpPacket(const unsigned char* data, int length) {
   struct icmphdr packet;
-  if (rc >= (int)sizeof(packet)) {
+  if (length >= (int)sizeof(packet)) {
     memcpy(&packet, data, sizeof(packet));
     if (packet.type == ICMP_ECHOREPLY) {
       emit recvPing(htons(packet.un.echo.sequence));
@@ -148,30 +249,22 @@ void LinuxPingSender::icmpSocketReady() {
   }
 }
 
-void LinuxPingSender::rawSocketReady() {
-  socklen_t slen = 0;
-  unsigned char data[2048];
-  int rc = recvfrom(m_socket, data, sizeof(data), MSG_DONTWAIT, NULL, &slen);
-  if (rc <= 0) {
-    logger.error() << "recvfrom failed:" << strerror(errno);
-    return;
-  }
-
+void LinuxPingSender::parseRawPacket(const unsigned char* data, int length) {
   // Check the IP header
-  const struct iphdr* ip = (struct iphdr*)data;
+  const struct iphdr* ip = (const struct iphdr*)data;
   int iphdrlen = ip->ihl * 4;
-  if (rc < iphdrlen || iphdrlen < (int)sizeof(struct iphdr)) {
-    logger.error() << "malformed IP packet:" << strerror(errno);
+  if (length < iphdrlen || iphdrlen < (int)sizeof(struct iphdr)) {
+    logger.error() << "malformed IP packet";
     return;
   }
 
   // Check the ICMP packet
   struct icmphdr packet;
-  if (inetChecksum(data + iphdrlen, rc - iphdrlen) != 0) {
+  if (inetChecksum(data + iphdrlen, length - iphdrlen) != 0) {
     logger.warning() << "invalid checksum";
     return;
   }
-  if (rc >= (iphdrlen + (int)sizeof(packet))) {
+  if (length >= (iphdrlen + (int)sizeof(packet))) {
     memcpy(&packet, data + iphdrlen, sizeof(packet));
     quint16 id = htons(m_ident);
     if ((packet.type == ICMP_ECHOREPLY) && (packet.un.echo.id == id)) {
@@ -5,7 +5,9 @@
 #ifndef LINUXPINGSENDER_H
 #define LINUXPINGSENDER_H
 
+#include <QByteArray>
 #include <QObject>
+#include <functional>
 
 #include "pingsender.h"
 
@@ -22,9 +24,14 @@ class LinuxPingSender final : public PingSender {
   bool isValid() override { return (m_socket >= 0); };
 
   void sendPing(const QHostAddress& dest, quint16 sequence) override;
+  void sendPings(const QList<PingRequest>& requests) override;
 
  private:
   int createSocket();
+  void recvPackets(
+      const std::function<void(const unsigned char*, int)>& callback);
+  void parseIcmpPacket(const unsigned char* data, int length);
+  void parseRawPacket(const unsigned char* data, int length);
 
  private slots:
   void rawSocketReady();
@@ -34,6 +41,7 @@ class LinuxPingSender final : public PingSender {
   QSocketNotifier* m_notifier = nullptr;
   int m_socket = -1;
   quint16 m_ident = 0;
+  QByteArray m_recvBuffer;
 };
 
 #endif  // LINUXPINGSENDER_H
@@ -77,6 +77,15 @@ void WindowsNetworkWatcher::processWlan(PWLAN_NOTIFICATION_DATA data) {
     return;
   }
 
+  if (data->NotificationCode == wlan_notification_msm_disconnected) {
+    // Whatever comes next, it is not this WiFi network anymore.
+    if (!m_lastBSSID.isEmpty()) {
+      m_lastBSSID.clear();
+      emit networkChanged(QString());
+    }
+    return;
+  }
+
   if (data->NotificationCode != wlan_notification_msm_connected) {
     logger.debug() << "The wlan code is not MSM connected";
     return;
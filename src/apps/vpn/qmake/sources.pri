@@ -18,9 +18,11 @@ SOURCES += \
         apps/vpn/addons/conditionwatchers/addonconditionwatcherlocales.cpp \
         apps/vpn/addons/conditionwatchers/addonconditionwatchertime.cpp \
         apps/vpn/addons/conditionwatchers/addonconditionwatchertriggertimesecs.cpp \
+        apps/vpn/addons/conditionwatchers/addontimerwheel.cpp \
         apps/vpn/addons/manager/addondirectory.cpp \
         apps/vpn/addons/manager/addonindex.cpp \
         apps/vpn/addons/manager/addonmanager.cpp \
+        apps/vpn/addons/manager/addonverifier.cpp \
         apps/vpn/appconstants.cpp \
         apps/vpn/apppermission.cpp \
         apps/vpn/authenticationlistener.cpp \
@@ -29,6 +31,7 @@ SOURCES += \
         apps/vpn/authenticationinapp/authenticationinappsession.cpp \
         apps/vpn/authenticationinapp/incrementaldecoder.cpp \
         apps/vpn/captiveportal/captiveportal.cpp \
+        apps/vpn/captiveportal/captiveportalcache.cpp \
         apps/vpn/captiveportal/captiveportaldetection.cpp \
         apps/vpn/captiveportal/captiveportaldetectionimpl.cpp \
         apps/vpn/captiveportal/captiveportalmonitor.cpp \
@@ -54,6 +57,7 @@ SOURCES += \
         apps/vpn/composer/composerblocktitle.cpp \
         apps/vpn/composer/composerblockorderedlist.cpp \
         apps/vpn/composer/composerblockunorderedlist.cpp \
+        apps/vpn/connectionbenchmark/benchmarksamples.cpp \
         apps/vpn/connectionbenchmark/benchmarktask.cpp \
         apps/vpn/connectionbenchmark/benchmarktaskping.cpp \
         apps/vpn/connectionbenchmark/benchmarktasktransfer.cpp \
@@ -72,6 +76,7 @@ SOURCES += \
         apps/vpn/imageproviderfactory.cpp \
         apps/vpn/inspector/inspectorhandler.cpp \
         apps/vpn/inspector/inspectoritempicker.cpp \
+        apps/vpn/inspector/inspectorpropertywaiter.cpp \
         apps/vpn/inspector/inspectorutils.cpp \
         apps/vpn/inspector/inspectorwebsocketconnection.cpp \
         apps/vpn/inspector/inspectorwebsocketserver.cpp \
@@ -92,6 +97,7 @@ SOURCES += \
         apps/vpn/models/servercountry.cpp \
         apps/vpn/models/servercountrymodel.cpp \
         apps/vpn/models/serverdata.cpp \
+        apps/vpn/models/serverlatencyhistory.cpp \
         apps/vpn/models/subscriptiondata.cpp \
         apps/vpn/models/supportcategorymodel.cpp \
         apps/vpn/models/user.cpp \
@@ -100,6 +106,7 @@ SOURCES += \
         apps/vpn/networkwatcher.cpp \
         apps/vpn/notificationhandler.cpp \
         apps/vpn/pinghelper.cpp \
+        apps/vpn/pingscanner.cpp \
         apps/vpn/pingsender.cpp \
         apps/vpn/pingsenderfactory.cpp \
         apps/vpn/platforms/dummy/dummyapplistprovider.cpp \
@@ -142,6 +149,7 @@ SOURCES += \
         apps/vpn/tutorial/tutorialstep.cpp \
         apps/vpn/tutorial/tutorialstepbefore.cpp \
         apps/vpn/tutorial/tutorialstepnext.cpp \
+        apps/vpn/update/resumabledownload.cpp \
         apps/vpn/update/updater.cpp \
         apps/vpn/update/versionapi.cpp \
         apps/vpn/update/webupdater.cpp \
@@ -167,9 +175,11 @@ HEADERS += \
         apps/vpn/addons/conditionwatchers/addonconditionwatchertimeend.h \
         apps/vpn/addons/conditionwatchers/addonconditionwatchertimestart.h \
         apps/vpn/addons/conditionwatchers/addonconditionwatchertriggertimesecs.h \
+        apps/vpn/addons/conditionwatchers/addontimerwheel.h \
         apps/vpn/addons/manager/addondirectory.h \
         apps/vpn/addons/manager/addonindex.h \
         apps/vpn/addons/manager/addonmanager.h \
+        apps/vpn/addons/manager/addonverifier.h \
         apps/vpn/appconstants.h \
         apps/vpn/appimageprovider.h \
         apps/vpn/apppermission.h \
@@ -180,6 +190,7 @@ HEADERS += \
         apps/vpn/authenticationinapp/authenticationinappsession.h \
         apps/vpn/authenticationinapp/incrementaldecoder.h \
         apps/vpn/captiveportal/captiveportal.h \
+        apps/vpn/captiveportal/captiveportalcache.h \
         apps/vpn/captiveportal/captiveportaldetection.h \
         apps/vpn/captiveportal/captiveportaldetectionimpl.h \
         apps/vpn/captiveportal/captiveportalmonitor.h \
@@ -205,6 +216,7 @@ HEADERS += \
         apps/vpn/composer/composerblocktitle.h \
         apps/vpn/composer/composerblockorderedlist.h \
         apps/vpn/composer/composerblockunorderedlist.h \
+        apps/vpn/connectionbenchmark/benchmarksamples.h \
         apps/vpn/connectionbenchmark/benchmarktask.h \
         apps/vpn/connectionbenchmark/benchmarktaskping.h \
         apps/vpn/connectionbenchmark/benchmarktasksentinel.h \
@@ -225,6 +237,7 @@ HEADERS += \
         apps/vpn/imageproviderfactory.h \
         apps/vpn/inspector/inspectorhandler.h \
         apps/vpn/inspector/inspectoritempicker.h \
+        apps/vpn/inspector/inspectorpropertywaiter.h \
         apps/vpn/inspector/inspectorutils.h \
         apps/vpn/inspector/inspectorwebsocketconnection.h \
         apps/vpn/inspector/inspectorwebsocketserver.h \
@@ -244,6 +257,7 @@ HEADERS += \
         apps/vpn/models/servercountry.h \
         apps/vpn/models/servercountrymodel.h \
         apps/vpn/models/serverdata.h \
+        apps/vpn/models/serverlatencyhistory.h \
         apps/vpn/models/subscriptiondata.h \
         apps/vpn/models/supportcategorymodel.h \
         apps/vpn/models/user.h \
@@ -253,6 +267,7 @@ HEADERS += \
         apps/vpn/networkwatcherimpl.h \
         apps/vpn/notificationhandler.h \
         apps/vpn/pinghelper.h \
+        apps/vpn/pingscanner.h \
         apps/vpn/pingsender.h \
         apps/vpn/pingsenderfactory.h \
         apps/vpn/platforms/dummy/dummyapplistprovider.h \
@@ -295,6 +310,7 @@ HEADERS += \
         apps/vpn/tutorial/tutorialstep.h \
         apps/vpn/tutorial/tutorialstepbefore.h \
         apps/vpn/tutorial/tutorialstepnext.h \
+        apps/vpn/update/resumabledownload.h \
         apps/vpn/update/updater.h \
         apps/vpn/update/versionapi.h \
         apps/vpn/update/webupdater.h \
@@ -16,6 +16,7 @@
 #include "localizer.h"
 #include "logger.h"
 #include "mozillavpn.h"
+#include "serverlistcache.h"
 #include "settingsholder.h"
 
 constexpr uint32_t MAX_MSG_SIZE = 1024 * 1024;
@@ -29,59 +30,6 @@ struct RequestType {
   std::function<QJsonObject(const QJsonObject&)> m_callback;
 };
 
-void serializeServerCountry(ServerCountryModel* model, QJsonObject& obj) {
-  QJsonArray countries;
-
-  for (const ServerCountry& country : model->countries()) {
-    QJsonObject countryObj;
-    countryObj["name"] = country.name();
-    countryObj["code"] = country.code();
-
-    QJsonArray cities;
-    for (const ServerCity& city : country.cities()) {
-      QJsonObject cityObj;
-      cityObj["name"] = city.name();
-      cityObj["code"] = city.code();
-      cityObj["latitude"] = city.latitude();
-      cityObj["longitude"] = city.longitude();
-
-      QJsonArray servers;
-      for (const QString& pubkey : city.servers()) {
-        const Server server = model->server(pubkey);
-        if (!server.initialized()) {
-          continue;
-        }
-
-        QJsonObject serverObj;
-        serverObj["hostname"] = server.hostname();
-        serverObj["ipv4_gateway"] = server.ipv4Gateway();
-        serverObj["ipv6_gateway"] = server.ipv6Gateway();
-        serverObj["weight"] = (double)server.weight();
-
-        const QString& socksName = server.socksName();
-        if (!socksName.isEmpty()) {
-          serverObj["socksName"] = socksName;
-        }
-
-        uint32_t multihopPort = server.multihopPort();
-        if (multihopPort) {
-          serverObj["multihopPort"] = (double)multihopPort;
-        }
-
-        servers.append(serverObj);
-      }
-
-      cityObj["servers"] = servers;
-      cities.append(cityObj);
-    }
-
-    countryObj["cities"] = cities;
-    countries.append(countryObj);
-  }
-
-  obj["countries"] = countries;
-}
-
 QJsonObject serializeStatus() {
   MozillaVPN* vpn = MozillaVPN::instance();
 
@@ -125,17 +73,6 @@ static QList<RequestType> s_types{
                   return QJsonObject();
                 }},
 
-    RequestType{"servers",
-                [](const QJsonObject&) {
-                  QJsonObject servers;
-                  serializeServerCountry(
-                      MozillaVPN::instance()->serverCountryModel(), servers);
-
-                  QJsonObject obj;
-                  obj["servers"] = servers;
-                  return obj;
-                }},
-
     RequestType{"disabled_apps",
                 [](const QJsonObject&) {
                   QJsonArray apps;
@@ -159,8 +96,11 @@ static QList<RequestType> s_types{
 
 }  // namespace
 
-ServerConnection::ServerConnection(QObject* parent, QTcpSocket* connection)
-    : QObject(parent), m_connection(connection) {
+ServerConnection::ServerConnection(QObject* parent, QTcpSocket* connection,
+                                   ServerListCache* serverListCache)
+    : QObject(parent),
+      m_connection(connection),
+      m_serverListCache(serverListCache) {
   MZ_COUNT_CTOR(ServerConnection);
 
 #if !defined(MZ_ANDROID) && !defined(MZ_IOS)
@@ -271,6 +211,14 @@ void ServerConnection::processMessage(const QByteArray& message) {
   QJsonObject obj = json.object();
   QString typeName = obj["t"].toString();
 
+  // The server list is cached already serialized, and can be sent as a
+  // delta from the version the client has.
+  if (typeName == "servers") {
+    Q_ASSERT(m_serverListCache);
+    writeData(m_serverListCache->response(obj["version"].toString()));
+    return;
+  }
+
   for (const RequestType& type : s_types) {
     if (typeName == type.m_name) {
       QJsonObject responseObj = type.m_callback(obj);
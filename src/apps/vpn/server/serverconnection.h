@@ -9,13 +9,15 @@
 #include <QObject>
 
 class QTcpSocket;
+class ServerListCache;
 
 class ServerConnection final : public QObject {
   Q_OBJECT
   Q_DISABLE_COPY_MOVE(ServerConnection)
 
  public:
-  ServerConnection(QObject* parent, QTcpSocket* connection);
+  ServerConnection(QObject* parent, QTcpSocket* connection,
+                   ServerListCache* serverListCache);
   ~ServerConnection();
 
  private:
@@ -29,6 +31,7 @@ class ServerConnection final : public QObject {
 
  private:
   QTcpSocket* m_connection;
+  ServerListCache* m_serverListCache;
 
   enum {
     // Reading the length of the body. This step consists in the reading of 4
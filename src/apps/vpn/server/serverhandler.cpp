@@ -9,6 +9,7 @@
 
 #include "leakdetector.h"
 #include "logger.h"
+#include "mozillavpn.h"
 #include "serverconnection.h"
 
 namespace {
@@ -17,7 +18,8 @@ Logger logger("ServerHandler");
 
 constexpr int SERVER_PORT = 8754;
 
-ServerHandler::ServerHandler() {
+ServerHandler::ServerHandler()
+    : m_serverListCache(MozillaVPN::instance()->serverCountryModel()) {
   MZ_COUNT_CTOR(ServerHandler);
 
   logger.debug() << "Creating the server";
@@ -37,6 +39,7 @@ void ServerHandler::newConnectionReceived() {
   QTcpSocket* child = nextPendingConnection();
   Q_ASSERT(child);
 
-  ServerConnection* connection = new ServerConnection(this, child);
+  ServerConnection* connection =
+      new ServerConnection(this, child, &m_serverListCache);
   connect(child, &QTcpSocket::disconnected, connection, &QObject::deleteLater);
 }
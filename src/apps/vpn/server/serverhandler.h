@@ -7,6 +7,8 @@
 
 #include <QTcpServer>
 
+#include "serverlistcache.h"
+
 class ServerHandler final : public QTcpServer {
   Q_OBJECT
   Q_DISABLE_COPY_MOVE(ServerHandler)
@@ -17,6 +19,9 @@ class ServerHandler final : public QTcpServer {
 
  private:
   void newConnectionReceived();
+
+ private:
+  ServerListCache m_serverListCache;
 };
 
 #endif  // SERVERHANDLER_H
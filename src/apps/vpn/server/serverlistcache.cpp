@@ -0,0 +1,235 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "serverlistcache.h"
+
+#include <QCryptographicHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <algorithm>
+
+#include "leakdetector.h"
+#include "logger.h"
+#include "models/servercountrymodel.h"
+
+namespace {
+Logger logger("ServerListCache");
+
+// How many previous versions can be the base of a delta.
+constexpr qsizetype SERVER_LIST_HISTORY = 4;
+
+// The version tag is a prefix of the SHA-256 of the list, in hex.
+constexpr qsizetype SERVER_LIST_VERSION_LENGTH = 16;
+
+QJsonObject serializeCountry(ServerCountryModel* model,
+                             const ServerCountry& country) {
+  QJsonObject countryObj;
+  countryObj["name"] = country.name();
+  countryObj["code"] = country.code();
+
+  QJsonArray cities;
+  for (const ServerCity& city : country.cities()) {
+    QJsonObject cityObj;
+    cityObj["name"] = city.name();
+    cityObj["code"] = city.code();
+    cityObj["latitude"] = city.latitude();
+    cityObj["longitude"] = city.longitude();
+
+    QJsonArray servers;
+    for (const QString& pubkey : city.servers()) {
+      const Server server = model->server(pubkey);
+      if (!server.initialized()) {
+        continue;
+      }
+
+      QJsonObject serverObj;
+      serverObj["hostname"] = server.hostname();
+      serverObj["ipv4_gateway"] = server.ipv4Gateway();
+      serverObj["ipv6_gateway"] = server.ipv6Gateway();
+      serverObj["weight"] = (double)server.weight();
+
+      const QString& socksName = server.socksName();
+      if (!socksName.isEmpty()) {
+        serverObj["socksName"] = socksName;
+      }
+
+      uint32_t multihopPort = server.multihopPort();
+      if (multihopPort) {
+        serverObj["multihopPort"] = (double)multihopPort;
+      }
+
+      servers.append(serverObj);
+    }
+
+    cityObj["servers"] = servers;
+    cities.append(cityObj);
+  }
+
+  countryObj["cities"] = cities;
+  return countryObj;
+}
+
+// The keys are in the order QJsonDocument would write them.
+QByteArray message(const QByteArray& key, const QByteArray& value,
+                   const QString& version) {
+  return "{\"" + key + "\":" + value + ",\"t\":\"servers\",\"version\":\"" +
+         version.toLatin1() + "\"}";
+}
+
+}  // namespace
+
+ServerListCache::ServerListCache(ServerCountryModel* model, QObject* parent)
+    : QObject(parent), m_model(model) {
+  MZ_COUNT_CTOR(ServerListCache);
+  Q_ASSERT(m_model);
+
+  connect(m_model, &ServerCountryModel::changed, this,
+          &ServerListCache::invalidate);
+}
+
+ServerListCache::~ServerListCache() { MZ_COUNT_DTOR(ServerListCache); }
+
+const QString& ServerListCache::version() {
+  if (!m_valid) {
+    rebuild();
+  }
+  return m_version;
+}
+
+QByteArray ServerListCache::response(const QString& version) {
+  if (!m_valid) {
+    rebuild();
+  }
+
+  if (version.isEmpty()) {
+    return m_fullResponse;
+  }
+
+  if (version == m_version) {
+    return m_notModifiedResponse;
+  }
+
+  auto i = m_deltaResponses.constFind(version);
+  if (i != m_deltaResponses.constEnd()) {
+    return i.value();
+  }
+
+  QByteArray response = delta(version);
+  if (response.isEmpty()) {
+    return m_fullResponse;
+  }
+
+  m_deltaResponses.insert(version, response);
+  return response;
+}
+
+void ServerListCache::invalidate() {
+  if (!m_valid) {
+    return;
+  }
+
+  // The current list becomes one the clients may have.
+  m_history.prepend({m_version, m_countryHashes});
+  if (m_history.length() > SERVER_LIST_HISTORY) {
+    m_history.removeLast();
+  }
+
+  m_valid = false;
+  m_deltaResponses.clear();
+}
+
+void ServerListCache::rebuild() {
+  m_countryCodes.clear();
+  m_countries.clear();
+  m_countryHashes.clear();
+
+  QByteArray countries = "[";
+  for (const ServerCountry& country : m_model->countries()) {
+    QByteArray countryJson =
+        QJsonDocument(serializeCountry(m_model, country))
+            .toJson(QJsonDocument::Compact);
+
+    if (!m_countryCodes.isEmpty()) {
+      countries.append(',');
+    }
+    countries.append(countryJson);
+
+    m_countryCodes.append(country.code());
+    m_countryHashes.insert(
+        country.code(),
+        QCryptographicHash::hash(countryJson, QCryptographicHash::Sha256));
+    m_countries.insert(country.code(), countryJson);
+  }
+  countries.append(']');
+
+  m_version = QString::fromLatin1(
+      QCryptographicHash::hash(countries, QCryptographicHash::Sha256)
+          .toHex()
+          .left(SERVER_LIST_VERSION_LENGTH));
+
+  // A reload with the same content does not make a new version.
+  m_history.removeIf([this](const Snapshot& snapshot) {
+    return snapshot.m_version == m_version;
+  });
+
+  m_fullResponse =
+      message("servers", "{\"countries\":" + countries + "}", m_version);
+  m_notModifiedResponse = message("notModified", "true", m_version);
+  m_valid = true;
+
+  logger.debug() << "Server list version" << m_version << "with"
+                 << m_countryCodes.length() << "countries";
+}
+
+QByteArray ServerListCache::delta(const QString& version) {
+  auto snapshot = std::find_if(
+      m_history.constBegin(), m_history.constEnd(),
+      [&version](const Snapshot& s) { return s.m_version == version; });
+  if (snapshot == m_history.constEnd()) {
+    return QByteArray();
+  }
+
+  QByteArray countries = "[";
+  bool first = true;
+  for (const QString& code : m_countryCodes) {
+    if (snapshot->m_countryHashes.value(code) == m_countryHashes.value(code)) {
+      continue;
+    }
+
+    if (!first) {
+      countries.append(',');
+    }
+    countries.append(m_countries.value(code));
+    first = false;
+  }
+  countries.append(']');
+
+  QStringList removed;
+  for (auto i = snapshot->m_countryHashes.constBegin();
+       i != snapshot->m_countryHashes.constEnd(); ++i) {
+    if (!m_countryHashes.contains(i.key())) {
+      removed.append(i.key());
+    }
+  }
+  removed.sort();
+
+  // The order of the countries lets the client rebuild the whole list.
+  QByteArray order = QJsonDocument(QJsonArray::fromStringList(m_countryCodes))
+                         .toJson(QJsonDocument::Compact);
+  QByteArray removedCodes =
+      QJsonDocument(QJsonArray::fromStringList(removed))
+          .toJson(QJsonDocument::Compact);
+
+  QByteArray value = "{\"base\":\"" + version.toLatin1() +
+                     "\",\"countries\":" + countries + ",\"order\":" + order +
+                     ",\"removed\":" + removedCodes + "}";
+
+  QByteArray response = message("delta", value, m_version);
+  if (response.length() >= m_fullResponse.length()) {
+    return m_fullResponse;
+  }
+
+  return response;
+}
@@ -0,0 +1,67 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef SERVERLISTCACHE_H
+#define SERVERLISTCACHE_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QStringList>
+
+class ServerCountryModel;
+
+// The response to the "servers" request of the browser extension.
+//
+// The list of countries, cities and servers is serialized once each time the
+// model changes, not for each request. Each serialized list has a version
+// tag, derived from its content. A client which sends back the tag of the
+// list it has receives `notModified`, or a delta with only the countries
+// which changed, when that tag is one of the last few versions.
+class ServerListCache final : public QObject {
+  Q_OBJECT
+  Q_DISABLE_COPY_MOVE(ServerListCache)
+
+ public:
+  explicit ServerListCache(ServerCountryModel* model,
+                           QObject* parent = nullptr);
+  ~ServerListCache();
+
+  // The complete response message for a client which has the list with the
+  // `version` tag. An empty or unknown version gets the whole list.
+  QByteArray response(const QString& version);
+
+  const QString& version();
+
+ private:
+  void invalidate();
+  void rebuild();
+  QByteArray delta(const QString& version);
+
+  struct Snapshot {
+    QString m_version;
+    // Country code -> hash of the serialized country.
+    QHash<QString, QByteArray> m_countryHashes;
+  };
+
+ private:
+  ServerCountryModel* m_model = nullptr;
+
+  bool m_valid = false;
+  QString m_version;
+  QStringList m_countryCodes;
+  QHash<QString, QByteArray> m_countries;
+  QHash<QString, QByteArray> m_countryHashes;
+
+  QByteArray m_fullResponse;
+  QByteArray m_notModifiedResponse;
+
+  // The previous versions, newest first, and the deltas already computed
+  // from them.
+  QList<Snapshot> m_history;
+  QHash<QString, QByteArray> m_deltaResponses;
+};
+
+#endif  // SERVERLISTCACHE_H
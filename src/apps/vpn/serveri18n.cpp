@@ -4,11 +4,13 @@
 
 #include "serveri18n.h"
 
-#include <QFile>
-#include <QHash>
-#include <QJsonArray>
-#include <QJsonDocument>
-#include <QJsonObject>
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QList>
+#include <QResource>
+#include <QStringList>
+#include <QtEndian>
+#include <cstring>
 
 #include "localizer.h"
 #include "logger.h"
@@ -17,115 +19,193 @@
 namespace {
 Logger logger("ServerI18N");
 
-bool s_initialized = false;
-
-QHash<QString, QString> s_items;
-
-QString itemKey(const QString& languageCode, const QString& countryCode,
-                const QString& city = QString()) {
-  return QString("%1^%2^%3").arg(languageCode, countryCode, city);
+// The bundle generated from servers.json by
+// scripts/utils/generate_servers_bundle.py. See there for the format.
+constexpr const char* BUNDLE_PATH = ":/i18n/servers.bin";
+constexpr char BUNDLE_MAGIC[] = {'M', 'Z', 'S', 'I'};
+constexpr quint32 BUNDLE_VERSION = 1;
+constexpr qsizetype BUNDLE_HEADER_SIZE = 24;
+constexpr quint32 BUNDLE_MISSING = 0xFFFFFFFF;
+
+struct Bundle {
+  quint32 m_countryCount = 0;
+  quint32 m_cityCount = 0;
+  quint32 m_languageCount = 0;
+
+  // (code, first city, city count) for each country.
+  const uchar* m_countries = nullptr;
+  // (name) for each city.
+  const uchar* m_cities = nullptr;
+  // (code) for each language.
+  const uchar* m_languages = nullptr;
+  // One string per country and per city, for each language.
+  const uchar* m_translations = nullptr;
+
+  const uchar* m_pool = nullptr;
+  qsizetype m_poolSize = 0;
+
+  quint32 itemCount() const { return m_countryCount + m_cityCount; }
+};
+
+bool s_bundleLoaded = false;
+Bundle s_bundle;
+// Only used if the resource is compressed.
+QByteArray s_bundleCopy;
+
+// The translation of each country and city for the active language, with
+// its fallbacks applied. Rebuilt when the language changes.
+bool s_resolved = false;
+QString s_languageCode;
+QList<quint32> s_items;
+
+quint32 read32(const uchar* table, quint32 index) {
+  return qFromLittleEndian<quint32>(table + index * sizeof(quint32));
 }
 
-void addCity(const QString& countryCode, const QJsonValue& value) {
-  if (!value.isObject()) {
-    return;
+bool isValidString(quint32 offset) {
+  if (offset + 2 > static_cast<quint64>(s_bundle.m_poolSize)) {
+    return false;
   }
 
-  QJsonObject obj = value.toObject();
-
-  QString cityName = obj["city"].toString();
-  if (cityName.isEmpty()) {
-    logger.error() << "Empty city string";
-    return;
-  }
+  quint16 length = qFromLittleEndian<quint16>(s_bundle.m_pool + offset);
+  return offset + 2 + length <= static_cast<quint64>(s_bundle.m_poolSize);
+}
 
-  QJsonValue languages = obj["languages"];
-  if (!languages.isObject()) {
-    logger.error() << "Empty language list";
-    return;
-  }
+QByteArrayView poolString(quint32 offset) {
+  quint16 length = qFromLittleEndian<quint16>(s_bundle.m_pool + offset);
+  return QByteArrayView(s_bundle.m_pool + offset + 2, length);
+}
 
-  QJsonObject languageObj = languages.toObject();
-  for (const QString& languageCode : languageObj.keys()) {
-    s_items.insert(itemKey(languageCode, countryCode, cityName),
-                   languageObj[languageCode].toString());
+int compareUtf8(QByteArrayView a, QByteArrayView b) {
+  int result = memcmp(a.data(), b.data(), qMin(a.size(), b.size()));
+  if (result != 0) {
+    return result;
   }
+  return a.size() < b.size() ? -1 : (a.size() > b.size() ? 1 : 0);
 }
 
-void addCountry(const QJsonValue& value) {
-  if (!value.isObject()) {
-    return;
+// Binary search in a sorted table of strings, of `stride` integers per entry.
+qint64 findString(const uchar* table, quint32 stride, quint32 first,
+                  quint32 count, QByteArrayView value) {
+  quint32 low = first;
+  quint32 high = first + count;
+  while (low < high) {
+    quint32 middle = low + (high - low) / 2;
+    int result = compareUtf8(poolString(read32(table, middle * stride)), value);
+    if (result == 0) {
+      return middle;
+    }
+    if (result < 0) {
+      low = middle + 1;
+    } else {
+      high = middle;
+    }
   }
 
-  QJsonObject obj = value.toObject();
+  return -1;
+}
 
-  QString countryCode = obj["countryCode"].toString();
-  if (countryCode.isEmpty()) {
-    logger.error() << "Empty countryCode string";
-    return;
+bool validateBundle(const uchar* data, qsizetype size) {
+  if (size < BUNDLE_HEADER_SIZE ||
+      memcmp(data, BUNDLE_MAGIC, sizeof(BUNDLE_MAGIC)) != 0) {
+    logger.error() << "Invalid server translation bundle";
+    return false;
   }
 
-  QJsonValue languages = obj["languages"];
-  if (!languages.isObject()) {
-    logger.error() << "Empty language list";
-    return;
+  if (read32(data, 1) != BUNDLE_VERSION) {
+    logger.error() << "Unsupported server translation bundle version";
+    return false;
   }
 
-  QJsonObject languageObj = languages.toObject();
-  for (const QString& languageCode : languageObj.keys()) {
-    s_items.insert(itemKey(languageCode, countryCode),
-                   languageObj[languageCode].toString());
+  Bundle bundle;
+  bundle.m_countryCount = read32(data, 2);
+  bundle.m_cityCount = read32(data, 3);
+  bundle.m_languageCount = read32(data, 4);
+  quint64 poolOffset = read32(data, 5);
+
+  quint64 tablesSize =
+      4 * (3 * static_cast<quint64>(bundle.m_countryCount) +
+           bundle.m_cityCount + bundle.m_languageCount +
+           static_cast<quint64>(bundle.m_languageCount) * bundle.itemCount());
+  if (BUNDLE_HEADER_SIZE + tablesSize != poolOffset ||
+      poolOffset > static_cast<quint64>(size)) {
+    logger.error() << "Truncated server translation bundle";
+    return false;
   }
 
-  QJsonValue cities = obj["cities"];
-  if (!cities.isArray()) {
-    logger.error() << "Empty city list";
-    return;
+  bundle.m_countries = data + BUNDLE_HEADER_SIZE;
+  bundle.m_cities = bundle.m_countries + 12 * bundle.m_countryCount;
+  bundle.m_languages = bundle.m_cities + 4 * bundle.m_cityCount;
+  bundle.m_translations = bundle.m_languages + 4 * bundle.m_languageCount;
+  bundle.m_pool = data + poolOffset;
+  bundle.m_poolSize = size - static_cast<qsizetype>(poolOffset);
+  s_bundle = bundle;
+
+  // Everything is checked once here: lookups do not check anything.
+  bool valid = true;
+  for (quint32 i = 0; i < bundle.m_countryCount && valid; ++i) {
+    valid = isValidString(read32(bundle.m_countries, i * 3)) &&
+            static_cast<quint64>(read32(bundle.m_countries, i * 3 + 1)) +
+                    read32(bundle.m_countries, i * 3 + 2) <=
+                bundle.m_cityCount;
+  }
+  for (quint32 i = 0; i < bundle.m_cityCount && valid; ++i) {
+    valid = isValidString(read32(bundle.m_cities, i));
+  }
+  for (quint32 i = 0; i < bundle.m_languageCount && valid; ++i) {
+    valid = isValidString(read32(bundle.m_languages, i));
+  }
+  quint32 translationCount = bundle.m_languageCount * bundle.itemCount();
+  for (quint32 i = 0; i < translationCount && valid; ++i) {
+    quint32 offset = read32(bundle.m_translations, i);
+    valid = offset == BUNDLE_MISSING || isValidString(offset);
   }
 
-  QJsonArray cityArray = cities.toArray();
-  for (const QJsonValue& city : cityArray) {
-    addCity(countryCode, city);
+  if (!valid) {
+    logger.error() << "Corrupted server translation bundle";
+    s_bundle = Bundle();
+    return false;
   }
+
+  return true;
 }
 
-void maybeInitialize() {
-  if (s_initialized) {
+void maybeLoadBundle() {
+  if (s_bundleLoaded) {
     return;
   }
 
-  s_initialized = true;
+  s_bundleLoaded = true;
 
-  QFile file(":/i18n/servers.json");
-  if (!file.open(QFile::ReadOnly | QFile::Text)) {
-    logger.error() << "Failed to open the servers.json";
+  QResource resource(BUNDLE_PATH);
+  if (!resource.isValid()) {
+    logger.error() << "Failed to open the server translation bundle";
     return;
   }
 
-  QJsonDocument json = QJsonDocument::fromJson(file.readAll());
-  if (!json.isArray()) {
-    logger.error() << "Invalid format (expected array)";
-    return;
+  // The bundle is stored uncompressed, and read in place.
+  const uchar* data = resource.data();
+  qsizetype size = static_cast<qsizetype>(resource.size());
+  if (resource.compressionAlgorithm() != QResource::NoCompression) {
+    s_bundleCopy = resource.uncompressedData();
+    data = reinterpret_cast<const uchar*>(s_bundleCopy.constData());
+    size = s_bundleCopy.size();
   }
 
-  QJsonArray array = json.array();
-  for (const QJsonValue& country : array) {
-    addCountry(country);
+  if (validateBundle(data, size)) {
+    logger.debug() << "Server translations:" << s_bundle.m_countryCount
+                   << "countries," << s_bundle.m_cityCount << "cities,"
+                   << s_bundle.m_languageCount << "languages";
   }
 }
 
-QString translateItemWithLanguage(const QString& languageCode,
-                                  const QString& countryCode,
-                                  const QString& cityName) {
-  QString languageCodeCopy(languageCode);
-
-  QString result = s_items.value(itemKey(languageCode, countryCode, cityName));
-  if (!result.isEmpty()) {
-    return result;
-  }
+// The languages to look for, in order of preference.
+QStringList languageCandidates(const QString& languageCode) {
+  QStringList candidates{languageCode};
 
   // if the language code contains the 'region' part too, we check if we have
   // translations for the whole 'primary language'. Ex: 'de-AT' vs 'de'.
+  QString languageCodeCopy(languageCode);
   bool trimmed = false;
   qsizetype pos = languageCodeCopy.indexOf("-");
   if (pos > 0) {
@@ -140,46 +220,76 @@ QString translateItemWithLanguage(const QString& languageCode,
   }
 
   if (trimmed) {
-    result = s_items.value(itemKey(languageCodeCopy, countryCode, cityName));
-    if (!result.isEmpty()) {
-      return result;
-    }
+    candidates.append(languageCodeCopy);
   } else {
     // If the language code is not trimmed e.g "es" and we did not have a match
     // so far, lets try itself as region e.g es -> es_ES, de -> de_DE
-    QString concat_code = languageCodeCopy + "_" + languageCodeCopy.toUpper();
-    result = s_items.value(itemKey(concat_code, countryCode, cityName));
-    if (!result.isEmpty()) {
-      return result;
-    }
+    candidates.append(languageCodeCopy + "_" + languageCodeCopy.toUpper());
   }
 
-  return QString();
+  if (languageCode != "en") {
+    candidates.append(languageCandidates("en"));
+  }
+
+  return candidates;
+}
+
+void resolve(const QString& languageCode) {
+  s_resolved = true;
+  s_languageCode = languageCode;
+
+  quint32 itemCount = s_bundle.itemCount();
+  s_items.fill(BUNDLE_MISSING, itemCount);
+
+  for (const QString& candidate : languageCandidates(languageCode)) {
+    qint64 language =
+        findString(s_bundle.m_languages, 1, 0, s_bundle.m_languageCount,
+                   candidate.toUtf8());
+    if (language < 0) {
+      continue;
+    }
+
+    const uchar* translations =
+        s_bundle.m_translations +
+        static_cast<quint64>(language) * itemCount * sizeof(quint32);
+    for (quint32 i = 0; i < itemCount; ++i) {
+      if (s_items.at(i) == BUNDLE_MISSING) {
+        s_items[i] = read32(translations, i);
+      }
+    }
+  }
 }
 
-QString translateItem(const QString& countryCode, const QString& cityName,
-                      const QString& fallback) {
-  maybeInitialize();
+void maybeResolve() {
+  maybeLoadBundle();
 
   QString languageCode = SettingsHolder::instance()->languageCode();
   if (languageCode.isEmpty()) {
     languageCode = Localizer::instance()->languageCodeOrSystem();
   }
 
-  QString result =
-      translateItemWithLanguage(languageCode, countryCode, cityName);
-  if (!result.isEmpty()) {
-    return result;
+  if (!s_resolved || languageCode != s_languageCode) {
+    resolve(languageCode);
   }
+}
 
-  if (languageCode != "en") {
-    result = translateItemWithLanguage("en", countryCode, cityName);
-    if (!result.isEmpty()) {
-      return result;
-    }
+qint64 findCountry(const QString& countryCode) {
+  return findString(s_bundle.m_countries, 3, 0, s_bundle.m_countryCount,
+                    countryCode.toUtf8());
+}
+
+QString translation(qint64 item, const QString& fallback) {
+  if (item < 0) {
+    return fallback;
   }
 
-  return fallback;
+  quint32 offset = s_items.at(item);
+  if (offset == BUNDLE_MISSING) {
+    return fallback;
+  }
+
+  QByteArrayView value = poolString(offset);
+  return QString::fromUtf8(value.data(), value.size());
 }
 
 }  // namespace
@@ -187,11 +297,27 @@ QString translateItem(const QString& countryCode, const QString& cityName,
 // static
 QString ServerI18N::translateCountryName(const QString& countryCode,
                                          const QString& countryName) {
-  return translateItem(countryCode, "", countryName);
+  maybeResolve();
+  return translation(findCountry(countryCode), countryName);
 }
 
 // static
 QString ServerI18N::translateCityName(const QString& countryCode,
                                       const QString& cityName) {
-  return translateItem(countryCode, cityName, cityName);
+  maybeResolve();
+
+  qint64 country = findCountry(countryCode);
+  if (country < 0) {
+    return cityName;
+  }
+
+  quint32 firstCity = read32(s_bundle.m_countries, country * 3 + 1);
+  quint32 cityCount = read32(s_bundle.m_countries, country * 3 + 2);
+  qint64 city = findString(s_bundle.m_cities, 1, firstCity, cityCount,
+                           cityName.toUtf8());
+  if (city < 0) {
+    return cityName;
+  }
+
+  return translation(s_bundle.m_countryCount + city, cityName);
 }
@@ -7,6 +7,13 @@
 
 #include <QString>
 
+// The localized names of the countries and cities, from servers.json.
+//
+// servers.json is compiled at build time into a binary bundle of sorted
+// tables and a string pool, embedded uncompressed and read in place: nothing
+// is parsed at startup. The first lookup after a language change resolves,
+// for each country and city, the best available translation, and the
+// lookups which follow are binary searches in the bundle.
 class ServerI18N final {
  public:
   static QString translateCountryName(const QString& countryCode,
@@ -9,7 +9,6 @@
 #include "feature.h"
 #include "leakdetector.h"
 #include "logger.h"
-#include "mfbt/checkedint.h"
 #include "mozillavpn.h"
 #include "pingsenderfactory.h"
 
@@ -19,7 +18,9 @@ constexpr const uint32_t SERVER_LATENCY_INITIAL_MSEC = 1000;
 
 constexpr const uint32_t SERVER_LATENCY_REFRESH_MSEC = 1800000;
 
-constexpr const int SERVER_LATENCY_MAX_PARALLEL = 8;
+// Pings per second. The scan is paced to avoid flooding the local network
+// (and the relays) with hundreds of echo requests at once.
+constexpr const uint32_t SERVER_LATENCY_PACING_RATE = 100;
 
 constexpr const int SERVER_LATENCY_MAX_RETRIES = 2;
 
@@ -27,7 +28,13 @@ namespace {
 Logger logger("ServerLatency");
 }
 
-ServerLatency::ServerLatency() { MZ_COUNT_CTOR(ServerLatency); }
+ServerLatency::ServerLatency() {
+  MZ_COUNT_CTOR(ServerLatency);
+
+  m_scanner.setPacingRate(SERVER_LATENCY_PACING_RATE);
+  m_scanner.setTimeoutMsec(SERVER_LATENCY_TIMEOUT_MSEC);
+  m_scanner.setMaxRetries(SERVER_LATENCY_MAX_RETRIES);
+}
 
 ServerLatency::~ServerLatency() { MZ_COUNT_DTOR(ServerLatency); }
 
@@ -40,12 +47,34 @@ void ServerLatency::initialize() {
   connect(vpn->controller(), &Controller::stateChanged, this,
           &ServerLatency::stateChanged);
 
-  connect(&m_pingTimeout, &QTimer::timeout, this,
-          &ServerLatency::maybeSendPings);
+  connect(&m_scanner, &PingScanner::latencyMeasured, this,
+          &ServerLatency::latencyMeasured);
+  connect(&m_scanner, &PingScanner::pingTimedOut, this,
+          &ServerLatency::pingTimedOut);
+  connect(&m_scanner, &PingScanner::finished, this,
+          &ServerLatency::scanFinished);
 
   connect(&m_refreshTimer, &QTimer::timeout, this, &ServerLatency::start);
 
-  m_refreshTimer.start(SERVER_LATENCY_INITIAL_MSEC);
+  QTimer::singleShot(SERVER_LATENCY_INITIAL_MSEC, this,
+                     &ServerLatency::initialRefresh);
+}
+
+void ServerLatency::initialRefresh() {
+  // The latency history survives restarts: if the last scan is recent
+  // enough, wait for the next regular refresh instead of scanning again.
+  ServerCountryModel* scm = MozillaVPN::instance()->serverCountryModel();
+  qint64 age =
+      QDateTime::currentMSecsSinceEpoch() - scm->latencyHistoryTimestamp();
+  if (age >= 0 && age < SERVER_LATENCY_REFRESH_MSEC) {
+    logger.debug() << "Latency history is still fresh";
+    if (m_pingSender == nullptr && !m_refreshTimer.isActive()) {
+      m_refreshTimer.start(static_cast<int>(SERVER_LATENCY_REFRESH_MSEC - age));
+    }
+    return;
+  }
+
+  start();
 }
 
 void ServerLatency::start() {
@@ -65,94 +94,31 @@ void ServerLatency::start() {
     return;
   }
 
-  m_sequence = 0;
   m_wantRefresh = false;
   m_pingSender = PingSenderFactory::create(QHostAddress(), this);
   ServerCountryModel* scm = vpn->serverCountryModel();
 
-  connect(m_pingSender, SIGNAL(recvPing(quint16)), this,
-          SLOT(recvPing(quint16)));
   connect(m_pingSender, SIGNAL(criticalPingError()), this,
           SLOT(criticalPingError()));
 
-  // Generate a list of servers to ping.
-  // TODO: Could be m_pingSendQueue = scm->m_servers.keys(), but it's private.
+  // Resolve the addresses once, so that neither the scan nor the retries
+  // have to look the servers up again.
+  QList<PingScanner::Target> targets;
   for (const Server& server : scm->servers()) {
-    m_pingSendQueue.append(server.publicKey());
+    targets.append({server.publicKey(), QHostAddress(server.ipv4AddrIn())});
   }
 
   m_refreshTimer.stop();
-  maybeSendPings();
+  m_scanner.start(m_pingSender, targets);
 }
 
-void ServerLatency::maybeSendPings() {
-  quint64 now = QDateTime::currentMSecsSinceEpoch();
-  ServerCountryModel* scm = MozillaVPN::instance()->serverCountryModel();
-  if (m_pingSender == nullptr) {
-    return;
-  }
-
-  // Scan through the reply list, looking for timeouts.
-  while (!m_pingReplyList.isEmpty()) {
-    const ServerPingRecord& record = m_pingReplyList.first();
-    if ((record.timestamp + SERVER_LATENCY_TIMEOUT_MSEC) > now) {
-      break;
-    }
-    logger.debug() << "Server" << logger.keys(record.publicKey) << "timeout"
-                   << record.retries;
-
-    // Send a retry.
-    if (record.retries < SERVER_LATENCY_MAX_RETRIES) {
-      ServerPingRecord retry = record;
-      retry.retries++;
-      retry.sequence = m_sequence++;
-      retry.timestamp = now;
-      m_pingReplyList.append(retry);
-
-      Server server = scm->server(retry.publicKey);
-      m_pingSender->sendPing(QHostAddress(server.ipv4AddrIn()), retry.sequence);
-    }
-
-    // TODO: Mark the server unavailable?
-    m_pingReplyList.removeFirst();
-  }
-
-  // Generate new pings until we reach our max number of parallel pings.
-  while (m_pingReplyList.count() < SERVER_LATENCY_MAX_PARALLEL) {
-    if (m_pingSendQueue.isEmpty()) {
-      break;
-    }
-
-    ServerPingRecord record;
-    record.publicKey = m_pingSendQueue.takeFirst();
-    record.sequence = m_sequence++;
-    record.timestamp = now;
-    record.retries = 0;
-    m_pingReplyList.append(record);
-
-    Server server = scm->server(record.publicKey);
-    m_pingSender->sendPing(QHostAddress(server.ipv4AddrIn()), record.sequence);
-  }
-
-  if (m_pingReplyList.isEmpty()) {
-    // If the ping reply list is empty, then we have nothing left to do.
-    stop();
-  } else {
-    // Otherwise, the list should be sorted by transmit time. Schedule a timer
-    // to cleanup anything that experiences a timeout.
-    const ServerPingRecord& record = m_pingReplyList.first();
-
-    CheckedInt<int> value(SERVER_LATENCY_TIMEOUT_MSEC);
-    value -= static_cast<int>(now - record.timestamp);
-
-    m_pingTimeout.start(value.value());
-  }
+void ServerLatency::scanFinished() {
+  MozillaVPN::instance()->serverCountryModel()->saveLatencyHistory();
+  stop();
 }
 
 void ServerLatency::stop() {
-  m_pingTimeout.stop();
-  m_pingSendQueue.clear();
-  m_pingReplyList.clear();
+  m_scanner.stop();
 
   if (m_pingSender) {
     delete m_pingSender;
@@ -175,26 +141,13 @@ void ServerLatency::stateChanged() {
   }
 }
 
-void ServerLatency::recvPing(quint16 sequence) {
-  qint64 now(QDateTime::currentMSecsSinceEpoch());
-
-  for (auto i = m_pingReplyList.begin(); i != m_pingReplyList.end(); i++) {
-    const ServerPingRecord& record = *i;
-    if (record.sequence != sequence) {
-      continue;
-    }
-
-    ServerCountryModel* scm = MozillaVPN::instance()->serverCountryModel();
-
-    qint64 latency(now - record.timestamp);
-    if (latency <= std::numeric_limits<uint>::max()) {
-      scm->setServerLatency(record.publicKey, static_cast<uint>(latency));
-    }
+void ServerLatency::latencyMeasured(const QString& publicKey, uint msec) {
+  MozillaVPN::instance()->serverCountryModel()->setServerLatency(publicKey,
+                                                                 msec);
+}
 
-    m_pingReplyList.erase(i);
-    maybeSendPings();
-    return;
-  }
+void ServerLatency::pingTimedOut(const QString& publicKey) {
+  MozillaVPN::instance()->serverCountryModel()->setServerLatencyLost(publicKey);
 }
 
 void ServerLatency::criticalPingError() {
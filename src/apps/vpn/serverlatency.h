@@ -8,6 +8,7 @@
 #include <QObject>
 #include <QTimer>
 
+#include "pingscanner.h"
 #include "pingsender.h"
 #include "task.h"
 
@@ -24,27 +25,18 @@ class ServerLatency final : public QObject {
   void stop();
 
  private:
-  void maybeSendPings();
-
- private:
-  struct ServerPingRecord {
-    QString publicKey;
-    quint64 timestamp;
-    quint16 sequence;
-    int retries;
-  };
-  quint16 m_sequence = 0;
   PingSender* m_pingSender = nullptr;
-  QList<QString> m_pingSendQueue;
-  QList<ServerPingRecord> m_pingReplyList;
+  PingScanner m_scanner;
 
-  QTimer m_pingTimeout;
   QTimer m_refreshTimer;
   bool m_wantRefresh = false;
 
  private slots:
+  void initialRefresh();
+  void scanFinished();
   void stateChanged();
-  void recvPing(quint16 sequence);
+  void latencyMeasured(const QString& publicKey, uint msec);
+  void pingTimedOut(const QString& publicKey);
   void criticalPingError();
 };
 
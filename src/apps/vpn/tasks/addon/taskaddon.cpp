@@ -16,6 +16,7 @@ Logger logger("TaskAddon");
 TaskAddon::TaskAddon(const QString& addonId, const QByteArray& sha256)
     : Task("TaskAddon"), m_addonId(addonId), m_sha256(sha256) {
   MZ_COUNT_CTOR(TaskAddon);
+  setPriority(PriorityBackground);
 }
 
 TaskAddon::~TaskAddon() { MZ_COUNT_DTOR(TaskAddon); }
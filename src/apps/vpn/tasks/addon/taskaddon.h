@@ -22,6 +22,8 @@ class TaskAddon final : public Task {
   // downloaded and when they are ready to be loaded.
   DeletePolicy deletePolicy() const override { return Reschedulable; }
 
+  Resources resources() const override { return ResourceAddons; }
+
  private:
   const QString m_addonId;
   const QByteArray m_sha256;
@@ -15,6 +15,7 @@ Logger logger("TaskAddonIndex");
 
 TaskAddonIndex::TaskAddonIndex() : Task("TaskAddonIndex") {
   MZ_COUNT_CTOR(TaskAddonIndex);
+  setPriority(PriorityBackground);
 }
 
 TaskAddonIndex::~TaskAddonIndex() { MZ_COUNT_DTOR(TaskAddonIndex); }
@@ -21,6 +21,8 @@ class TaskAddonIndex final : public Task {
   // If we cancel this task, we have to wait 1 hour before the next fetch.
   DeletePolicy deletePolicy() const override { return Reschedulable; }
 
+  Resources resources() const override { return ResourceAddons; }
+
  private:
   void maybeComplete();
 
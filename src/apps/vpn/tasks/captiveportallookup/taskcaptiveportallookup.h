@@ -20,6 +20,8 @@ class TaskCaptivePortalLookup final : public Task {
 
   void run() override;
 
+  Resources resources() const override { return ResourceNetworkReadOnly; }
+
  private:
   ErrorHandler::ErrorPropagationPolicy m_errorPropagationPolicy =
       ErrorHandler::DoNotPropagateError;
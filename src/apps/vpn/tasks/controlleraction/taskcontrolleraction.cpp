@@ -20,6 +20,7 @@ TaskControllerAction::TaskControllerAction(
       m_action(action),
       m_lastState(Controller::State::StateOff) {
   MZ_COUNT_CTOR(TaskControllerAction);
+  setPriority(PriorityInteractive);
 
   logger.debug() << "TaskControllerAction created" << action;
   connect(&m_timer, &QTimer::timeout, this, &TaskControllerAction::checkStatus);
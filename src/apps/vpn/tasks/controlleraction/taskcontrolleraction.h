@@ -31,7 +31,9 @@ class TaskControllerAction final : public Task {
 
   void run() override;
 
-  virtual DeletePolicy deletePolicy() const { return NonDeletable; }
+  DeletePolicy deletePolicy() const override { return NonDeletable; }
+
+  Resources resources() const override { return ResourceController; }
 
  private slots:
   void stateChanged();
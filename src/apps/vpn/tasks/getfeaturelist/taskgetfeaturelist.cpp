@@ -19,6 +19,7 @@ Logger logger("TaskGetFeatureList");
 
 TaskGetFeatureList::TaskGetFeatureList() : Task("TaskGetFeatureList") {
   MZ_COUNT_CTOR(TaskGetFeatureList);
+  setPriority(PriorityBackground);
 }
 
 TaskGetFeatureList::~TaskGetFeatureList() { MZ_COUNT_DTOR(TaskGetFeatureList); }
@@ -17,6 +17,8 @@ class TaskGetFeatureList final : public Task {
   ~TaskGetFeatureList();
 
   void run() override;
+
+  Resources resources() const override { return ResourceNetworkReadOnly; }
 };
 
 #endif  // TASKGETFEATURELIST_H
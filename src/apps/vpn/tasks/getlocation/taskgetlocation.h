@@ -19,6 +19,8 @@ class TaskGetLocation final : public Task {
 
   void run() override;
 
+  Resources resources() const override { return ResourceNetworkReadOnly; }
+
  private:
   ErrorHandler::ErrorPropagationPolicy m_errorPropagationPolicy =
       ErrorHandler::DoNotPropagateError;
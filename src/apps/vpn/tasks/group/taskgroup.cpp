@@ -84,3 +84,11 @@ Task::DeletePolicy TaskGroup::deletePolicy() const {
 
   return NonDeletable;
 }
+
+Task::Resources TaskGroup::resources() const {
+  Resources resources;
+  for (Task* task : m_tasks) {
+    resources |= task->resources();
+  }
+  return resources;
+}
@@ -18,6 +18,7 @@ Logger logger("TaskHeartbeat");
 
 TaskHeartbeat::TaskHeartbeat() : Task("TaskHeartbeat") {
   MZ_COUNT_CTOR(TaskHeartbeat);
+  setPriority(PriorityBackground);
 }
 
 TaskHeartbeat::~TaskHeartbeat() { MZ_COUNT_DTOR(TaskHeartbeat); }
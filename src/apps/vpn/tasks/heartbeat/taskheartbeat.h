@@ -17,6 +17,8 @@ class TaskHeartbeat final : public Task {
   ~TaskHeartbeat();
 
   void run() override;
+
+  Resources resources() const override { return ResourceNetworkReadOnly; }
 };
 
 #endif  // TASKHEARTBEAT_H
@@ -17,6 +17,8 @@ class TaskProducts final : public Task {
   ~TaskProducts();
 
   void run() override;
+
+  Resources resources() const override { return ResourceNetworkReadOnly; }
 };
 
 #endif  // TASKPRODUCTS_H
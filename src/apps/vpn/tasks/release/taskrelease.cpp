@@ -18,6 +18,9 @@ TaskRelease::TaskRelease(
       m_op(op),
       m_errorPropagationPolicy(errorPropagationPolicy) {
   MZ_COUNT_CTOR(TaskRelease);
+
+  // Update operations are triggered by users.
+  setPriority(op == Update ? PriorityInteractive : PriorityBackground);
 }
 
 TaskRelease::~TaskRelease() { MZ_COUNT_DTOR(TaskRelease); }
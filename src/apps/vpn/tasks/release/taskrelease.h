@@ -31,6 +31,11 @@ class TaskRelease final : public Task {
     return m_op == Update ? NonDeletable : Deletable;
   }
 
+  // An update can replace the app: nothing else should run.
+  Resources resources() const override {
+    return m_op == Check ? ResourceNetworkReadOnly : ResourceAll;
+  }
+
  signals:
   void updateRequired();
   void updateRequiredOrRecommended();
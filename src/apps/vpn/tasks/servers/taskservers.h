@@ -20,6 +20,11 @@ class TaskServers final : public Task {
 
   void run() override;
 
+  // The server list is used by the controller.
+  Resources resources() const override {
+    return ResourceAccount | ResourceController;
+  }
+
  private:
   ErrorHandler::ErrorPropagationPolicy m_errorPropagationPolicy =
       ErrorHandler::DoNotPropagateError;
@@ -18,7 +18,9 @@
 #include "gleandeprecated.h"
 #include "leakdetector.h"
 #include "logger.h"
+#include "networkmanager.h"
 #include "networkrequest.h"
+#include "resumabledownload.h"
 #include "telemetry/gleansample.h"
 
 // Terrible hacking for Windows
@@ -329,74 +331,72 @@ bool Balrog::processData(Task* task, const QByteArray& data) {
     return false;
   }
 
+  if (hashFunction != "sha512") {
+    logger.error() << "Invalid hash function";
+    return false;
+  }
+
   QString hashValue = obj.value("hashValue").toString();
   if (hashValue.isEmpty()) {
     logger.error() << "No hashValue item";
     return false;
   }
 
-  NetworkRequest* request = NetworkRequest::createForGetUrl(task, url);
+  QString filePath = downloadFilePath(url);
+  if (filePath.isEmpty()) {
+    return false;
+  }
 
-  // No timeout for this request.
-  request->disableTimeout();
+  // The installer is streamed to disk and hashed while it arrives. A dropped
+  // connection resumes where it stopped. Like any NetworkRequest, the
+  // download belongs to the task and is counted as pending network activity.
+  ResumableDownload* download = new ResumableDownload(
+      NetworkManager::instance()->networkAccessManager(),
+      NetworkRequest::requestForDownload(task, QUrl(url)), filePath,
+      QCryptographicHash::Sha512, task);
+
+  NetworkManager::instance()->increaseNetworkRequestCount();
+  connect(download, &QObject::destroyed, []() {
+    // During the shutdown, the NetworkManager can be released first.
+    if (NetworkManager::exists()) {
+      NetworkManager::instance()->decreaseNetworkRequestCount();
+    }
+  });
 
-  connect(
-      request, &NetworkRequest::requestFailed, this,
-      [this, request](QNetworkReply::NetworkError error, const QByteArray&) {
-        logger.error() << "Request failed" << error;
-        propagateError(request, error);
-        deleteLater();
-      });
+  connect(download, &ResumableDownload::failed, this,
+          [this](QNetworkReply::NetworkError error, int statusCode) {
+            logger.error() << "Download failed" << error;
+            propagateError(statusCode, error);
+            deleteLater();
+          });
 
-  connect(request, &NetworkRequest::requestCompleted, this,
-          [this, hashValue, hashFunction, url](const QByteArray& data) {
-            logger.debug() << "Request completed";
+  connect(download, &ResumableDownload::completed, this,
+          [this, hashValue, filePath](const QByteArray& hash) {
+            logger.debug() << "Download completed";
 
-            if (!computeHash(url, data, hashValue, hashFunction)) {
+            mozilla::glean::sample::update_step.record(
+                mozilla::glean::sample::UpdateStepExtra{
+                    ._state =
+                        QVariant::fromValue(BalrogFileSaved).toString()});
+            emit GleanDeprecated::instance()->recordGleanEventWithExtraKeys(
+                GleanSample::updateStep,
+                {{"state", QVariant::fromValue(BalrogFileSaved).toString()}});
+
+            if (!checkHash(hash, hashValue) || !install(filePath)) {
               logger.error() << "Ignore failure.";
               deleteLater();
             }
           });
 
+  download->start();
   return true;
 }
 
-bool Balrog::computeHash(const QString& url, const QByteArray& data,
-                         const QString& hashValue,
-                         const QString& hashFunction) {
-  logger.debug() << "Compute the hash";
-
-  if (hashFunction != "sha512") {
-    logger.error() << "Invalid hash function";
-    return false;
-  }
-
-  QCryptographicHash hash(QCryptographicHash::Sha512);
-  hash.addData(data);
-  QByteArray hashHex = hash.result().toHex();
-
-  if (hashHex != hashValue) {
-    logger.error() << "Hash doesn't match";
-    return false;
-  }
-
-  mozilla::glean::sample::update_step.record(
-      mozilla::glean::sample::UpdateStepExtra{
-          ._state = QVariant::fromValue(BalrogValidationCompleted).toString()});
-  emit GleanDeprecated::instance()->recordGleanEventWithExtraKeys(
-      GleanSample::updateStep,
-      {{"state", QVariant::fromValue(BalrogValidationCompleted).toString()}});
-
-  return saveFileAndInstall(url, data);
-}
-
-bool Balrog::saveFileAndInstall(const QString& url, const QByteArray& data) {
-  logger.debug() << "Save the file and install it";
-
+QString Balrog::downloadFilePath(const QString& url) {
   int pos = url.lastIndexOf("/");
   if (pos == -1) {
     logger.error() << "The URL seems to be without /.";
-    return false;
+    return QString();
   }
 
   QString fileName = url.right(url.length() - pos - 1);
@@ -405,34 +405,28 @@ bool Balrog::saveFileAndInstall(const QString& url, const QByteArray& data) {
   if (!m_tmpDir.isValid()) {
     logger.error() << "Cannot create a temporary directory"
                    << m_tmpDir.errorString();
-    return false;
+    return QString();
   }
 
-  QDir dir(m_tmpDir.path());
-  QString tmpFile = dir.filePath(fileName);
+  return QDir(m_tmpDir.path()).filePath(fileName);
+}
 
-  QFile file(tmpFile);
-  if (!file.open(QIODevice::ReadWrite)) {
-    logger.error() << "Unable to create a file in the temporary folder";
-    return false;
-  }
+bool Balrog::checkHash(const QByteArray& hash, const QString& hashValue) {
+  logger.debug() << "Check the hash";
 
-  qint64 written = file.write(data);
-  if (written != data.length()) {
-    logger.error() << "Unable to write the whole configuration file";
+  if (hash.toHex() != hashValue) {
+    logger.error() << "Hash doesn't match";
     return false;
   }
 
-  file.close();
-
   mozilla::glean::sample::update_step.record(
       mozilla::glean::sample::UpdateStepExtra{
-          ._state = QVariant::fromValue(BalrogFileSaved).toString()});
+          ._state = QVariant::fromValue(BalrogValidationCompleted).toString()});
   emit GleanDeprecated::instance()->recordGleanEventWithExtraKeys(
       GleanSample::updateStep,
-      {{"state", QVariant::fromValue(BalrogFileSaved).toString()}});
+      {{"state", QVariant::fromValue(BalrogValidationCompleted).toString()}});
 
-  return install(tmpFile);
+  return true;
 }
 
 bool Balrog::install(const QString& filePath) {
@@ -516,12 +510,10 @@ bool Balrog::install(const QString& filePath) {
   return true;
 }
 
-void Balrog::propagateError(NetworkRequest* request,
+void Balrog::propagateError(int statusCode,
                             QNetworkReply::NetworkError error) {
-  Q_ASSERT(request);
-
   // 451 Unavailable For Legal Reasons
-  if (request->statusCode() == 451) {
+  if (statusCode == 451) {
     logger.debug() << "Geo IP restriction detected";
     REPORTERROR(ErrorHandler::GeoIpRestrictionError, "balrog");
     return;
@@ -36,12 +36,10 @@ class Balrog final : public Updater {
   bool validateSignature(const QByteArray& x5uData,
                          const QByteArray& updateData,
                          const QByteArray& signatureBlob);
-  bool computeHash(const QString& url, const QByteArray& data,
-                   const QString& hashValue, const QString& hashFunction);
-  bool saveFileAndInstall(const QString& url, const QByteArray& data);
+  QString downloadFilePath(const QString& url);
+  bool checkHash(const QByteArray& hash, const QString& hashValue);
   bool install(const QString& filePath);
-  void propagateError(NetworkRequest* request,
-                      QNetworkReply::NetworkError error);
+  void propagateError(int statusCode, QNetworkReply::NetworkError error);
 
  private:
   TemporaryDir m_tmpDir;
@@ -0,0 +1,288 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "resumabledownload.h"
+
+#include <QNetworkAccessManager>
+#include <QRegularExpression>
+#include <algorithm>
+
+#include "leakdetector.h"
+#include "logger.h"
+
+namespace {
+Logger logger("ResumableDownload");
+
+// How much is read from the network at once, and how much the network layer
+// may buffer for us.
+constexpr qint64 DOWNLOAD_CHUNK_SIZE = 64 * 1024;
+constexpr qint64 DOWNLOAD_READ_BUFFER_SIZE = 4 * DOWNLOAD_CHUNK_SIZE;
+
+// The retry delay doubles at each attempt, up to 32 times the initial one.
+constexpr int DOWNLOAD_MAX_BACKOFF_SHIFT = 5;
+}  // namespace
+
+ResumableDownload::ResumableDownload(QNetworkAccessManager* manager,
+                                     const QNetworkRequest& request,
+                                     const QString& filePath,
+                                     QCryptographicHash::Algorithm algorithm,
+                                     QObject* parent)
+    : QObject(parent),
+      m_manager(manager),
+      m_request(request),
+      m_file(filePath),
+      m_hash(algorithm) {
+  MZ_COUNT_CTOR(ResumableDownload);
+
+  // Content-Length and Range are about the bytes we store: no compression.
+  m_request.setRawHeader("Accept-Encoding", "identity");
+
+  m_retryTimer.setSingleShot(true);
+  connect(&m_retryTimer, &QTimer::timeout, this,
+          &ResumableDownload::sendRequest);
+}
+
+ResumableDownload::~ResumableDownload() { MZ_COUNT_DTOR(ResumableDownload); }
+
+void ResumableDownload::start() {
+  Q_ASSERT(!m_reply && !m_done);
+
+  if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+    logger.error() << "Unable to open" << m_file.fileName();
+    fail(QNetworkReply::UnknownContentError, 0);
+    return;
+  }
+
+  sendRequest();
+}
+
+void ResumableDownload::abort() {
+  m_done = true;
+  m_retryTimer.stop();
+
+  if (m_reply) {
+    m_reply->abort();
+  }
+}
+
+void ResumableDownload::sendRequest() {
+  QNetworkRequest request(m_request);
+  if (m_received > 0) {
+    logger.debug() << "Resuming the download at byte" << m_received;
+    request.setRawHeader("Range", QByteArray("bytes=") +
+                                      QByteArray::number(m_received) + "-");
+    if (!m_validator.isEmpty()) {
+      request.setRawHeader("If-Range", m_validator);
+    }
+    ++m_resumeCount;
+  }
+
+  m_headerChecked = false;
+  m_statusCode = 0;
+  m_receivedAtRequest = m_received;
+
+  QNetworkReply* reply = m_manager->get(request);
+  reply->setParent(this);
+  reply->setReadBufferSize(DOWNLOAD_READ_BUFFER_SIZE);
+  m_reply = reply;
+
+  connect(reply, &QNetworkReply::readyRead, this, [this, reply]() {
+    if (!readChunks(reply)) {
+      reply->abort();
+    }
+  });
+  connect(reply, &QNetworkReply::finished, this,
+          [this, reply]() { replyFinished(reply); });
+}
+
+bool ResumableDownload::checkHeader(QNetworkReply* reply) {
+  m_headerChecked = true;
+  m_statusCode =
+      reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+
+  if (m_statusCode == 206) {
+    // Content-Range: bytes <first>-<last>/<total>
+    static const QRegularExpression contentRange(
+        "^bytes (\\d+)-(\\d+)/(\\d+|\\*)$");
+    QByteArray header = reply->rawHeader("Content-Range");
+    QRegularExpressionMatch match =
+        contentRange.match(QString::fromLatin1(header));
+    if (!match.hasMatch() || match.captured(1).toLongLong() != m_received) {
+      logger.warning() << "Unexpected Content-Range" << header;
+      m_statusCode = -1;
+      restart();
+      return false;
+    }
+
+    if (match.captured(3) != "*") {
+      m_total = match.captured(3).toLongLong();
+    }
+    return true;
+  }
+
+  if (m_statusCode == 200) {
+    if (m_received > 0) {
+      logger.debug() << "The file has changed, or ranges are not supported";
+      restart();
+    }
+
+    m_validator = reply->rawHeader("ETag");
+    if (m_validator.isEmpty()) {
+      m_validator = reply->rawHeader("Last-Modified");
+    }
+
+    QVariant length = reply->header(QNetworkRequest::ContentLengthHeader);
+    m_total = length.isValid() ? length.toLongLong() : -1;
+    return true;
+  }
+
+  // Anything else has no body for us.
+  return true;
+}
+
+bool ResumableDownload::readChunks(QNetworkReply* reply) {
+  if (m_done || reply != m_reply) {
+    return true;
+  }
+
+  if (!m_headerChecked && !checkHeader(reply)) {
+    return false;
+  }
+
+  // Error pages, or a response we have dropped.
+  if (m_statusCode != 200 && m_statusCode != 206) {
+    return true;
+  }
+
+  while (reply->bytesAvailable() > 0) {
+    QByteArray chunk = reply->read(DOWNLOAD_CHUNK_SIZE);
+    if (chunk.isEmpty()) {
+      break;
+    }
+
+    if (m_file.write(chunk) != chunk.length()) {
+      logger.error() << "Unable to write" << m_file.fileName();
+      fail(QNetworkReply::UnknownContentError, 0);
+      return false;
+    }
+
+    m_hash.addData(chunk);
+    m_received += chunk.length();
+  }
+
+  emit progressed(m_received, m_total);
+  return true;
+}
+
+void ResumableDownload::replyFinished(QNetworkReply* reply) {
+  reply->deleteLater();
+
+  if (reply != m_reply) {
+    return;
+  }
+  m_reply = nullptr;
+
+  if (m_done) {
+    return;
+  }
+
+  // Whatever arrived before a disconnection is still good.
+  readChunks(reply);
+  if (m_done) {
+    return;
+  }
+
+  // The response was not the continuation of our file, and was dropped.
+  if (m_statusCode < 0) {
+    retry();
+    return;
+  }
+
+  QNetworkReply::NetworkError error = reply->error();
+
+  if (error == QNetworkReply::NoError &&
+      (m_statusCode == 200 || m_statusCode == 206)) {
+    if (m_total >= 0 && m_received != m_total) {
+      logger.warning() << "Truncated download:" << m_received << "of"
+                       << m_total;
+      retry();
+      return;
+    }
+
+    if (!m_file.flush()) {
+      logger.error() << "Unable to flush" << m_file.fileName();
+      fail(QNetworkReply::UnknownContentError, 0);
+      return;
+    }
+
+    m_file.close();
+    m_done = true;
+
+    logger.debug() << "Download completed:" << m_received << "bytes,"
+                   << m_resumeCount << "resumes";
+    emit completed(m_hash.result());
+    return;
+  }
+
+  // 416 Range Not Satisfiable: what we have is not a prefix of the file.
+  if (m_statusCode == 416) {
+    restart();
+    retry();
+    return;
+  }
+
+  // Other HTTP errors are final, except for the server-side ones.
+  if (m_statusCode >= 400 && m_statusCode < 500) {
+    logger.error() << "Download failed with status" << m_statusCode;
+    fail(error, m_statusCode);
+    return;
+  }
+
+  logger.warning() << "Download interrupted:" << error << "status"
+                   << m_statusCode;
+  retry();
+}
+
+void ResumableDownload::restart() {
+  m_file.resize(0);
+  m_file.seek(0);
+  m_hash.reset();
+  m_received = 0;
+  m_receivedAtRequest = 0;
+  m_total = -1;
+  m_validator.clear();
+}
+
+void ResumableDownload::retry() {
+  // An attempt which made some progress does not count.
+  if (m_received > m_receivedAtRequest) {
+    m_retries = 0;
+  }
+
+  if (m_retries >= m_maxRetries) {
+    logger.error() << "Too many failed attempts";
+    fail(QNetworkReply::RemoteHostClosedError, m_statusCode);
+    return;
+  }
+
+  int delay = m_retryDelayMsec
+              << std::min(m_retries, DOWNLOAD_MAX_BACKOFF_SHIFT);
+  ++m_retries;
+
+  logger.debug() << "Retrying in" << delay << "msec";
+  m_retryTimer.start(delay);
+}
+
+void ResumableDownload::fail(QNetworkReply::NetworkError error,
+                             int statusCode) {
+  m_done = true;
+  m_retryTimer.stop();
+  m_file.close();
+
+  if (m_reply) {
+    m_reply->abort();
+  }
+
+  emit failed(error, statusCode);
+}
@@ -0,0 +1,85 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef RESUMABLEDOWNLOAD_H
+#define RESUMABLEDOWNLOAD_H
+
+#include <QCryptographicHash>
+#include <QFile>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QObject>
+#include <QTimer>
+
+class QNetworkAccessManager;
+
+// Downloads a (large) file straight to disk.
+//
+// The body is written to the file in chunks as it arrives, and hashed at the
+// same time: the whole file is never in memory. If the connection drops, the
+// download carries on from the last byte received, with an HTTP Range request
+// (and If-Range, so that a changed file is downloaded again from the start).
+class ResumableDownload final : public QObject {
+  Q_OBJECT
+  Q_DISABLE_COPY_MOVE(ResumableDownload)
+
+ public:
+  ResumableDownload(QNetworkAccessManager* manager,
+                    const QNetworkRequest& request, const QString& filePath,
+                    QCryptographicHash::Algorithm algorithm, QObject* parent);
+  ~ResumableDownload();
+
+  void start();
+  void abort();
+
+  // Attempts in a row without receiving anything, before giving up.
+  void setMaxRetries(int maxRetries) { m_maxRetries = maxRetries; }
+  void setRetryDelay(int msec) { m_retryDelayMsec = msec; }
+
+  const QString& filePath() const { return m_file.fileName(); }
+  qint64 bytesReceived() const { return m_received; }
+  int resumeCount() const { return m_resumeCount; }
+
+ signals:
+  // The file is complete and closed. `hash` is the raw digest.
+  void completed(const QByteArray& hash);
+  void failed(QNetworkReply::NetworkError error, int statusCode);
+  void progressed(qint64 bytesReceived, qint64 bytesTotal);
+
+ private:
+  void sendRequest();
+  bool checkHeader(QNetworkReply* reply);
+  bool readChunks(QNetworkReply* reply);
+  void replyFinished(QNetworkReply* reply);
+  void restart();
+  void retry();
+  void fail(QNetworkReply::NetworkError error, int statusCode);
+
+ private:
+  QNetworkAccessManager* m_manager = nullptr;
+  QNetworkRequest m_request;
+  QFile m_file;
+  QCryptographicHash m_hash;
+
+  QNetworkReply* m_reply = nullptr;
+  bool m_headerChecked = false;
+  int m_statusCode = 0;
+
+  qint64 m_received = 0;
+  qint64 m_receivedAtRequest = 0;
+  qint64 m_total = -1;
+
+  // The ETag, or the Last-Modified date, of the file being downloaded.
+  QByteArray m_validator;
+
+  int m_retries = 0;
+  int m_maxRetries = 5;
+  int m_retryDelayMsec = 1000;
+  int m_resumeCount = 0;
+  QTimer m_retryTimer;
+
+  bool m_done = false;
+};
+
+#endif  // RESUMABLEDOWNLOAD_H
@@ -0,0 +1,287 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "cidrset.h"
+
+#include <QHostAddress>
+
+#include "ipaddress.h"
+
+namespace {
+
+// Returns false if the address is neither IPv4 nor IPv6.
+bool fromHostAddress(const QHostAddress& address, int length,
+                     CidrPrefix& prefix) {
+  prefix = CidrPrefix();
+
+  if (address.protocol() == QAbstractSocket::IPv4Protocol) {
+    prefix.hi = static_cast<quint64>(address.toIPv4Address()) << 32;
+    prefix.length = static_cast<quint8>(qBound(0, length, 32));
+  } else if (address.protocol() == QAbstractSocket::IPv6Protocol) {
+    Q_IPV6ADDR raw = address.toIPv6Address();
+    for (int i = 0; i < 8; ++i) {
+      prefix.hi = (prefix.hi << 8) | raw[i];
+      prefix.lo = (prefix.lo << 8) | raw[i + 8];
+    }
+    prefix.length = static_cast<quint8>(qBound(0, length, 128));
+    prefix.ipv6 = true;
+  } else {
+    return false;
+  }
+
+  // Clear the host bits.
+  if (prefix.length < 64) {
+    prefix.hi &= prefix.length ? ~0ULL << (64 - prefix.length) : 0;
+    prefix.lo = 0;
+  } else if (prefix.length < 128) {
+    prefix.lo &= ~0ULL << (128 - prefix.length);
+  }
+
+  return true;
+}
+
+}  // namespace
+
+// static
+bool CidrPrefix::fromIPAddress(const IPAddress& ip, CidrPrefix& prefix) {
+  return fromHostAddress(ip.address(), ip.prefixLength(), prefix);
+}
+
+IPAddress CidrPrefix::toIPAddress() const {
+  if (!ipv6) {
+    return IPAddress(QHostAddress(static_cast<quint32>(hi >> 32)), length);
+  }
+
+  Q_IPV6ADDR raw;
+  for (int i = 0; i < 8; ++i) {
+    raw[i] = static_cast<quint8>(hi >> (56 - i * 8));
+    raw[i + 8] = static_cast<quint8>(lo >> (56 - i * 8));
+  }
+  return IPAddress(QHostAddress(raw), length);
+}
+
+bool CidrPrefix::bit(int index) const {
+  Q_ASSERT(index >= 0 && index < 128);
+  if (index < 64) {
+    return (hi >> (63 - index)) & 1;
+  }
+  return (lo >> (127 - index)) & 1;
+}
+
+void CidrPrefix::setBit(int index) {
+  Q_ASSERT(index >= 0 && index < 128);
+  if (index < 64) {
+    hi |= 1ULL << (63 - index);
+  } else {
+    lo |= 1ULL << (127 - index);
+  }
+}
+
+CidrSet::CidrSet() {
+  // The roots of the IPv4 and of the IPv6 tries.
+  m_nodes.resize(2);
+}
+
+// static
+CidrSet CidrSet::fromList(const QList<IPAddress>& list) {
+  CidrSet set;
+  for (const IPAddress& ip : list) {
+    set.insert(ip);
+  }
+  return set;
+}
+
+int CidrSet::allocNode() {
+  if (!m_freeNodes.empty()) {
+    int node = m_freeNodes.back();
+    m_freeNodes.pop_back();
+    m_nodes[node] = Node();
+    return node;
+  }
+
+  m_nodes.emplace_back();
+  return static_cast<int>(m_nodes.size() - 1);
+}
+
+void CidrSet::releaseChildren(int node) {
+  for (int b = 0; b < 2; ++b) {
+    int child = m_nodes[node].child[b];
+    if (child >= 0) {
+      releaseChildren(child);
+      m_freeNodes.push_back(child);
+      m_nodes[node].child[b] = -1;
+    }
+  }
+}
+
+bool CidrSet::isEmptyNode(int node) const {
+  const Node& n = m_nodes[node];
+  return !n.full && n.child[0] < 0 && n.child[1] < 0;
+}
+
+void CidrSet::insert(const CidrPrefix& prefix) {
+  insert(root(prefix.ipv6), prefix, 0);
+}
+
+void CidrSet::insert(const IPAddress& ip) {
+  CidrPrefix prefix;
+  if (CidrPrefix::fromIPAddress(ip, prefix)) {
+    insert(prefix);
+  }
+}
+
+void CidrSet::insert(int node, const CidrPrefix& prefix, int depth) {
+  if (m_nodes[node].full) {
+    return;
+  }
+
+  if (depth == prefix.length) {
+    releaseChildren(node);
+    m_nodes[node].full = true;
+    return;
+  }
+
+  int b = prefix.bit(depth);
+  int child = m_nodes[node].child[b];
+  if (child < 0) {
+    // allocNode() may move the nodes: no references across this call.
+    child = allocNode();
+    m_nodes[node].child[b] = child;
+  }
+
+  insert(child, prefix, depth + 1);
+
+  // Two covered halves make a covered node.
+  int sibling = m_nodes[node].child[!b];
+  if (m_nodes[child].full && sibling >= 0 && m_nodes[sibling].full) {
+    releaseChildren(node);
+    m_nodes[node].full = true;
+  }
+}
+
+void CidrSet::remove(const CidrPrefix& prefix) {
+  remove(root(prefix.ipv6), prefix, 0);
+}
+
+void CidrSet::remove(const IPAddress& ip) {
+  CidrPrefix prefix;
+  if (CidrPrefix::fromIPAddress(ip, prefix)) {
+    remove(prefix);
+  }
+}
+
+void CidrSet::remove(int node, const CidrPrefix& prefix, int depth) {
+  if (isEmptyNode(node)) {
+    return;
+  }
+
+  if (depth == prefix.length) {
+    releaseChildren(node);
+    m_nodes[node].full = false;
+    return;
+  }
+
+  if (m_nodes[node].full) {
+    // Split the node in two covered halves, and carry on with one of them.
+    m_nodes[node].full = false;
+    for (int b = 0; b < 2; ++b) {
+      int child = allocNode();
+      m_nodes[child].full = true;
+      m_nodes[node].child[b] = child;
+    }
+  }
+
+  int b = prefix.bit(depth);
+  int child = m_nodes[node].child[b];
+  if (child < 0) {
+    return;
+  }
+
+  remove(child, prefix, depth + 1);
+
+  if (isEmptyNode(child)) {
+    m_freeNodes.push_back(child);
+    m_nodes[node].child[b] = -1;
+  }
+}
+
+void CidrSet::unite(const CidrSet& other) {
+  for (const CidrPrefix& prefix : other.prefixes()) {
+    insert(prefix);
+  }
+}
+
+void CidrSet::subtract(const CidrSet& other) {
+  for (const CidrPrefix& prefix : other.prefixes()) {
+    remove(prefix);
+  }
+}
+
+bool CidrSet::isEmpty() const {
+  return isEmptyNode(root(false)) && isEmptyNode(root(true));
+}
+
+bool CidrSet::contains(const QHostAddress& address) const {
+  CidrPrefix prefix;
+  if (!fromHostAddress(address, 128, prefix)) {
+    return false;
+  }
+
+  int node = root(prefix.ipv6);
+  for (int depth = 0;; ++depth) {
+    if (m_nodes[node].full) {
+      return true;
+    }
+    if (depth == prefix.length) {
+      return false;
+    }
+    node = m_nodes[node].child[prefix.bit(depth)];
+    if (node < 0) {
+      return false;
+    }
+  }
+}
+
+QList<CidrPrefix> CidrSet::prefixes() const {
+  QList<CidrPrefix> list;
+
+  CidrPrefix ipv4;
+  collect(root(false), ipv4, list);
+
+  CidrPrefix ipv6;
+  ipv6.ipv6 = true;
+  collect(root(true), ipv6, list);
+
+  return list;
+}
+
+QList<IPAddress> CidrSet::toList() const {
+  QList<IPAddress> list;
+  for (const CidrPrefix& prefix : prefixes()) {
+    list.append(prefix.toIPAddress());
+  }
+  return list;
+}
+
+void CidrSet::collect(int node, CidrPrefix prefix,
+                      QList<CidrPrefix>& list) const {
+  if (m_nodes[node].full) {
+    list.append(prefix);
+    return;
+  }
+
+  for (int b = 0; b < 2; ++b) {
+    int child = m_nodes[node].child[b];
+    if (child < 0) {
+      continue;
+    }
+
+    CidrPrefix next = prefix;
+    if (b) {
+      next.setBit(prefix.length);
+    }
+    ++next.length;
+    collect(child, next, list);
+  }
+}
@@ -0,0 +1,88 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef CIDRSET_H
+#define CIDRSET_H
+
+#include <QList>
+#include <QtGlobal>
+#include <vector>
+
+class IPAddress;
+class QHostAddress;
+
+// A network prefix as plain data: the address bits are stored most
+// significant first, with IPv4 addresses in the top 32 bits of `hi`. The
+// bits past the prefix length are always zero.
+struct CidrPrefix {
+  quint64 hi = 0;
+  quint64 lo = 0;
+  quint8 length = 0;
+  bool ipv6 = false;
+
+  // Returns false if the address is neither IPv4 nor IPv6.
+  static bool fromIPAddress(const IPAddress& ip, CidrPrefix& prefix);
+  IPAddress toIPAddress() const;
+
+  bool bit(int index) const;
+  void setBit(int index);
+
+  bool operator==(const CidrPrefix& other) const {
+    return hi == other.hi && lo == other.lo && length == other.length &&
+           ipv6 == other.ipv6;
+  }
+};
+
+// A set of IPv4 and IPv6 addresses, stored as a binary radix trie of
+// prefixes.
+//
+// Inserting a prefix merges it with its sibling as soon as both are covered,
+// and removing a prefix splits only the nodes on its path, so the set is
+// always in its minimal form: prefixes() returns the smallest list of CIDR
+// ranges covering exactly the same addresses. Each operation is
+// O(prefix length), whatever the size of the set.
+class CidrSet final {
+ public:
+  CidrSet();
+
+  static CidrSet fromList(const QList<IPAddress>& list);
+
+  // The addresses which are neither IPv4 nor IPv6 are ignored.
+  void insert(const CidrPrefix& prefix);
+  void insert(const IPAddress& ip);
+  void remove(const CidrPrefix& prefix);
+  void remove(const IPAddress& ip);
+
+  void unite(const CidrSet& other);
+  void subtract(const CidrSet& other);
+
+  bool isEmpty() const;
+  bool contains(const QHostAddress& address) const;
+
+  // The minimal list of prefixes, IPv4 first, each family in address order.
+  QList<CidrPrefix> prefixes() const;
+  QList<IPAddress> toList() const;
+
+ private:
+  struct Node {
+    // -1 for a missing child. A node without children is either fully
+    // covered or empty.
+    int child[2] = {-1, -1};
+    bool full = false;
+  };
+
+  int root(bool ipv6) const { return ipv6 ? 1 : 0; }
+  int allocNode();
+  void releaseChildren(int node);
+  bool isEmptyNode(int node) const;
+
+  void insert(int node, const CidrPrefix& prefix, int depth);
+  void remove(int node, const CidrPrefix& prefix, int depth);
+  void collect(int node, CidrPrefix prefix, QList<CidrPrefix>& list) const;
+
+  std::vector<Node> m_nodes;
+  std::vector<int> m_freeNodes;
+};
+
+#endif  // CIDRSET_H
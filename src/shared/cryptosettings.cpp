@@ -4,9 +4,13 @@
 
 #include "cryptosettings.h"
 
+#include <QCryptographicHash>
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QJsonValue>
+#include <QMessageAuthenticationCode>
+#include <QMutex>
+#include <QMutexLocker>
 #include <QRandomGenerator>
 
 #include "hacl-star/Hacl_Chacha20Poly1305_32.h"
@@ -21,10 +25,16 @@ Logger logger("CryptoSettings");
 
 uint64_t lastNonce = 0;
 
+// The settings are written by the SettingsStore thread, while blobs are read
+// and written on the main thread: the key and the nonce are shared.
+QMutex s_mutex;
+
 }  // namespace
 
 // static
 bool CryptoSettings::readFile(QIODevice& device, QSettings::SettingsMap& map) {
+  QMutexLocker lock(&s_mutex);
+
   QByteArray version = device.read(1);
   if (version.length() != 1) {
     logger.error() << "Failed to read the version";
@@ -122,6 +132,7 @@ bool CryptoSettings::readEncryptedChachaPolyV1File(
 bool CryptoSettings::writeFile(QIODevice& device,
                                const QSettings::SettingsMap& map) {
   logger.debug() << "Writing the settings file";
+  QMutexLocker lock(&s_mutex);
 
   Version version = getSupportedVersion();
   if (!writeVersion(device, version)) {
@@ -229,3 +240,118 @@ bool CryptoSettings::writeEncryptedChachaPolyV1File(
 
   return true;
 }
+
+// static
+QByteArray CryptoSettings::blobId(const QByteArray& content) {
+  QMutexLocker lock(&s_mutex);
+
+  uint8_t key[CRYPTO_SETTINGS_KEY_SIZE];
+  if (getSupportedVersion() == EncryptionChachaPolyV1 && getKey(key)) {
+    QByteArray keyData(reinterpret_cast<const char*>(key), sizeof(key));
+    return QMessageAuthenticationCode::hash(content, keyData,
+                                            QCryptographicHash::Sha256)
+        .toHex();
+  }
+
+  return QCryptographicHash::hash(content, QCryptographicHash::Sha256).toHex();
+}
+
+// static
+bool CryptoSettings::readBlob(const QByteArray& id, const char* data,
+                              qint64 size, QByteArray& content) {
+  QMutexLocker lock(&s_mutex);
+
+  if (size < 1) {
+    logger.error() << "Failed to read the blob version";
+    return false;
+  }
+
+  switch ((CryptoSettings::Version)data[0]) {
+    case NoEncryption:
+      content = QByteArray(data + 1, size - 1);
+      if (QCryptographicHash::hash(content, QCryptographicHash::Sha256)
+              .toHex() != id) {
+        logger.error() << "Corrupted blob";
+        return false;
+      }
+      return true;
+
+    case EncryptionChachaPolyV1:
+      break;
+
+    default:
+      logger.error() << "Unsupported blob version";
+      return false;
+  }
+
+  if (size <= 1 + NONCE_SIZE + MAC_SIZE) {
+    logger.error() << "Truncated blob";
+    return false;
+  }
+
+  uint8_t key[CRYPTO_SETTINGS_KEY_SIZE];
+  if (!getKey(key)) {
+    logger.error() << "Something went wrong reading the key";
+    return false;
+  }
+
+  const uint8_t* nonce = reinterpret_cast<const uint8_t*>(data) + 1;
+  const uint8_t* mac = nonce + NONCE_SIZE;
+  const uint8_t* ciphertext = mac + MAC_SIZE;
+  uint32_t length = static_cast<uint32_t>(size - 1 - NONCE_SIZE - MAC_SIZE);
+
+  QByteArray aad = QByteArray(1, EncryptionChachaPolyV1) + id;
+  content = QByteArray(length, 0x00);
+  uint32_t result = Hacl_Chacha20Poly1305_32_aead_decrypt(
+      key, const_cast<uint8_t*>(nonce), static_cast<uint32_t>(aad.length()),
+      (uint8_t*)aad.data(), length, (uint8_t*)content.data(),
+      const_cast<uint8_t*>(ciphertext), const_cast<uint8_t*>(mac));
+  if (result != 0) {
+    logger.error() << "Failed to authenticate the blob";
+    content.clear();
+    return false;
+  }
+
+  return true;
+}
+
+// static
+bool CryptoSettings::writeBlob(QIODevice& device, const QByteArray& id,
+                               const QByteArray& content) {
+  QMutexLocker lock(&s_mutex);
+
+  Version version = getSupportedVersion();
+  if (!writeVersion(device, version)) {
+    logger.error() << "Failed to write the blob version";
+    return false;
+  }
+
+  if (version == NoEncryption) {
+    return device.write(content) == content.length();
+  }
+
+  uint8_t key[CRYPTO_SETTINGS_KEY_SIZE];
+  if (!getKey(key)) {
+    logger.debug() << "Invalid key";
+    return false;
+  }
+
+  // Blobs are written once, and rarely: a random nonce is good enough.
+  QByteArray nonce(NONCE_SIZE, 0x00);
+  QRandomGenerator::system()->fillRange(
+      reinterpret_cast<quint32*>(nonce.data()), NONCE_SIZE / sizeof(quint32));
+
+  QByteArray aad = QByteArray(1, EncryptionChachaPolyV1) + id;
+  QByteArray ciphertext(content.length(), 0x00);
+  QByteArray mac(MAC_SIZE, 0x00);
+
+  Hacl_Chacha20Poly1305_32_aead_encrypt(
+      key, (uint8_t*)nonce.data(), static_cast<uint32_t>(aad.length()),
+      (uint8_t*)aad.data(), static_cast<uint32_t>(content.length()),
+      (uint8_t*)content.data(), (uint8_t*)ciphertext.data(),
+      (uint8_t*)mac.data());
+
+  return device.write(nonce) == nonce.length() &&
+         device.write(mac) == mac.length() &&
+         device.write(ciphertext) == ciphertext.length();
+}
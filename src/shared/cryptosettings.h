@@ -19,6 +19,15 @@ class CryptoSettings final {
   static bool readFile(QIODevice& device, QSettings::SettingsMap& map);
   static bool writeFile(QIODevice& device, const QSettings::SettingsMap& map);
 
+  // Large settings are stored in files of their own, see SettingsBlobStore.
+  // The id of a blob is a keyed hash of its content, and it is authenticated
+  // together with the content.
+  static QByteArray blobId(const QByteArray& content);
+  static bool readBlob(const QByteArray& id, const char* data, qint64 size,
+                       QByteArray& content);
+  static bool writeBlob(QIODevice& device, const QByteArray& id,
+                        const QByteArray& content);
+
  private:
   static void resetKey();
   static bool getKey(uint8_t[CRYPTO_SETTINGS_KEY_SIZE]);
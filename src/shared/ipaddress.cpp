@@ -6,6 +6,7 @@
 
 #include <QtMath>
 
+#include "cidrset.h"
 #include "leakdetector.h"
 
 IPAddress::IPAddress() { MZ_COUNT_CTOR(IPAddress); }
@@ -237,24 +238,11 @@ QList<IPAddress> IPAddress::subnets() const {
 // static
 QList<IPAddress> IPAddress::excludeAddresses(
     const QList<IPAddress>& sourceList, const QList<IPAddress>& excludeList) {
-  QList<IPAddress> results = sourceList;
-
+  CidrSet set = CidrSet::fromList(sourceList);
   for (const IPAddress& exclude : excludeList) {
-    QList<IPAddress> newResults;
-
-    for (const IPAddress& ip : results) {
-      if (ip.overlaps(exclude)) {
-        QList<IPAddress> range = ip.excludeAddresses(exclude);
-        newResults.append(range);
-      } else {
-        newResults.append(ip);
-      }
-    }
-
-    results = newResults;
+    set.remove(exclude);
   }
-
-  return results;
+  return set.toList();
 }
 
 QList<IPAddress> IPAddress::excludeAddresses(const IPAddress& ip) const {
@@ -9,6 +9,8 @@
 
 class IPAddress final {
  public:
+  // Returns the minimal list of prefixes covering the source addresses but
+  // none of the excluded ones. See CidrSet.
   static QList<IPAddress> excludeAddresses(const QList<IPAddress>& sourceList,
                                            const QList<IPAddress>& excludeList);
 
@@ -4,22 +4,107 @@
 
 #include "logger.h"
 
+#include <QHash>
 #include <QJsonDocument>
 #include <QMetaEnum>
+#include <QMutex>
 
 #include "loghandler.h"
 
+namespace {
+
+struct LogLevels {
+  QMutex m_mutex;
+  LogLevel m_global = Trace;
+  QHash<QString, LogLevel> m_classes;
+};
+
+// Loggers are often static objects: let's not depend on the initialization
+// order.
+LogLevels& logLevels() {
+  static LogLevels s_logLevels;
+  return s_logLevels;
+}
+
+}  // namespace
+
+std::atomic<uint32_t> Logger::s_generation{1};
+
 Logger::Logger(const QString& className) : m_className(className) {}
 
+// static
+void Logger::setLogLevel(LogLevel level) {
+  LogLevels& levels = logLevels();
+  {
+    QMutexLocker lock(&levels.m_mutex);
+    levels.m_global = level;
+  }
+  s_generation.fetch_add(1, std::memory_order_acq_rel);
+}
+
+// static
+void Logger::setClassLogLevel(const QString& className, LogLevel level) {
+  LogLevels& levels = logLevels();
+  {
+    QMutexLocker lock(&levels.m_mutex);
+    levels.m_classes.insert(className, level);
+  }
+  s_generation.fetch_add(1, std::memory_order_acq_rel);
+}
+
+// static
+void Logger::clearClassLogLevels() {
+  LogLevels& levels = logLevels();
+  {
+    QMutexLocker lock(&levels.m_mutex);
+    levels.m_classes.clear();
+  }
+  s_generation.fetch_add(1, std::memory_order_acq_rel);
+}
+
+// static
+bool Logger::parseLogLevel(const QString& name, LogLevel& level) {
+  static const QHash<QString, LogLevel> s_names{
+      {"trace", Trace},     {"debug", Debug}, {"info", Info},
+      {"warning", Warning}, {"error", Error},
+  };
+
+  auto it = s_names.find(name.trimmed().toLower());
+  if (it == s_names.end()) {
+    return false;
+  }
+
+  level = it.value();
+  return true;
+}
+
+void Logger::refreshLogLevel() const {
+  LogLevels& levels = logLevels();
+  QMutexLocker lock(&levels.m_mutex);
+
+  // Read the generation first: a change racing with us bumps it again and
+  // the next call refreshes once more.
+  uint32_t generation = s_generation.load(std::memory_order_acquire);
+  m_logLevel.store(levels.m_classes.value(m_className, levels.m_global),
+                   std::memory_order_relaxed);
+  m_generation.store(generation, std::memory_order_release);
+}
+
 Logger::Log Logger::error() { return Log(this, LogLevel::Error); }
 Logger::Log Logger::warning() { return Log(this, LogLevel::Warning); }
 Logger::Log Logger::info() { return Log(this, LogLevel::Info); }
 Logger::Log Logger::debug() { return Log(this, LogLevel::Debug); }
 
 Logger::Log::Log(Logger* logger, LogLevel logLevel)
-    : m_logger(logger), m_logLevel(logLevel), m_data(new Data()) {}
+    : m_logger(logger),
+      m_logLevel(logLevel),
+      m_data(logger->isEnabled(logLevel) ? new Data() : nullptr) {}
 
 Logger::Log::~Log() {
+  if (!m_data) {
+    return;
+  }
+
   LogHandler::messageHandler(m_logLevel, m_logger->className(),
                              m_data->m_buffer.trimmed());
   delete m_data;
@@ -27,7 +112,9 @@ Logger::Log::~Log() {
 
 #define CREATE_LOG_OP_REF(x)                  \
   Logger::Log& Logger::Log::operator<<(x t) { \
-    m_data->m_ts << t << ' ';                 \
+    if (m_data) {                             \
+      m_data->m_ts << t << ' ';               \
+    }                                         \
     return *this;                             \
   }
 
@@ -40,16 +127,25 @@ CREATE_LOG_OP_REF(void*);
 #undef CREATE_LOG_OP_REF
 
 Logger::Log& Logger::Log::operator<<(const QStringList& t) {
+  if (!m_data) {
+    return *this;
+  }
   m_data->m_ts << '[' << t.join(",") << ']' << ' ';
   return *this;
 }
 
 Logger::Log& Logger::Log::operator<<(const QJsonObject& t) {
+  if (!m_data) {
+    return *this;
+  }
   m_data->m_ts << QJsonDocument(t).toJson(QJsonDocument::Indented) << ' ';
   return *this;
 }
 
 Logger::Log& Logger::Log::operator<<(QTextStreamFunction t) {
+  if (!m_data) {
+    return *this;
+  }
   m_data->m_ts << t;
   return *this;
 }
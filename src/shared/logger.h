@@ -9,6 +9,7 @@
 #include <QObject>
 #include <QString>
 #include <QTextStream>
+#include <atomic>
 
 #include "loglevel.h"
 
@@ -17,9 +18,24 @@ class QJsonObject;
 class Logger {
  public:
   Logger(const QString& className);
+  Logger(const Logger&) = delete;
+  Logger& operator=(const Logger&) = delete;
 
   const QString& className() const { return m_className; }
 
+  // Runtime thresholds: entries below the level set for their class, or below
+  // the global level if the class has none, are discarded before anything is
+  // allocated.
+  static void setLogLevel(LogLevel level);
+  static void setClassLogLevel(const QString& className, LogLevel level);
+  static void clearClassLogLevels();
+
+  static bool parseLogLevel(const QString& name, LogLevel& level);
+
+  bool isEnabled(LogLevel level) const {
+    return level >= MZ_LOG_MIN_LEVEL && level >= logLevel();
+  }
+
   class Log {
    public:
     Log(Logger* logger, LogLevel level);
@@ -38,6 +54,9 @@ class Logger {
     template <typename T>
     typename std::enable_if<QtPrivate::IsQEnumHelper<T>::Value, Log&>::type
     operator<<(T t) {
+      if (!m_data) {
+        return *this;
+      }
       const QMetaObject* meta = qt_getEnumMetaObject(t);
       const char* name = qt_getEnumName(t);
       addMetaEnum(typename QFlags<T>::Int(t), meta, name);
@@ -57,6 +76,7 @@ class Logger {
       QTextStream m_ts;
     };
 
+    // Null when the level is disabled.
     Data* m_data;
   };
 
@@ -74,7 +94,24 @@ class Logger {
   QString keys(const QString& input);
 
  private:
+  LogLevel logLevel() const {
+    if (m_generation.load(std::memory_order_acquire) !=
+        s_generation.load(std::memory_order_acquire)) {
+      refreshLogLevel();
+    }
+    return static_cast<LogLevel>(m_logLevel.load(std::memory_order_relaxed));
+  }
+
+  void refreshLogLevel() const;
+
   QString m_className;
+
+  // Cached threshold for this class. It is recomputed when the thresholds
+  // change, which bumps s_generation.
+  mutable std::atomic<int> m_logLevel{Trace};
+  mutable std::atomic<uint32_t> m_generation{0};
+
+  static std::atomic<uint32_t> s_generation;
 };
 
 #endif  // LOGGER_H
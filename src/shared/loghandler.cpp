@@ -9,10 +9,15 @@
 #include <QFile>
 #include <QFileInfo>
 #include <QMessageLogContext>
+#include <QMetaMethod>
 #include <QProcessEnvironment>
 #include <QStandardPaths>
 #include <QString>
 #include <QTextStream>
+#include <QThread>
+#include <QtEndian>
+#include <cstdio>
+#include <cstdlib>
 
 #include "appconstants.h"
 
@@ -20,13 +25,37 @@
 #  include <android/log.h>
 #endif
 
+// The log is split in LOG_MAX_FILES segments: "<name>", "<name>.1", ... When
+// the current one is full, the segments are shifted and the oldest one is
+// dropped, so the budget always holds the most recent entries.
 constexpr qint64 LOG_MAX_FILE_SIZE = 204800;
+constexpr int LOG_MAX_FILES = 4;
+constexpr qint64 LOG_MAX_SEGMENT_SIZE = LOG_MAX_FILE_SIZE / LOG_MAX_FILES;
+
+// Every log file starts with this header, followed by records. A record is a
+// type byte and a little-endian payload:
+// - RecordClassName: class id (u32), name length (u16), UTF-8 name.
+// - RecordLog: timestamp in msecs (i64), class id (u32, 0 if none), level
+//   (u8), message length (u32), UTF-8 message.
+constexpr const char LOG_FILE_MAGIC[] = "MZLOG\x01";
+constexpr qsizetype LOG_FILE_MAGIC_SIZE = sizeof(LOG_FILE_MAGIC) - 1;
+
+constexpr quint8 RecordClassName = 'C';
+constexpr quint8 RecordLog = 'L';
+
+// Number of log entries that can be pending before new ones are dropped.
+constexpr size_t LOG_QUEUE_CAPACITY = 4096;
+
+// The writer thread is woken up by producers, but it also checks the queue
+// periodically in case a wake-up is missed.
+constexpr int LOG_WRITER_IDLE_MSEC = 250;
 
 namespace {
 QMutex s_mutex;
 QString s_location =
     QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
-LogHandler* s_instance = nullptr;
+std::atomic<LogHandler*> s_instance{nullptr};
+bool s_legacyLogFileRemoved = false;
 
 LogLevel qtTypeToLogLevel(QtMsgType type) {
   switch (type) {
@@ -45,10 +74,92 @@ LogLevel qtTypeToLogLevel(QtMsgType type) {
   }
 }
 
+// FNV-1a. The ids must be stable across processes: the client and its
+// helpers can append to the same file.
+quint32 classNameId(const QString& className) {
+  quint32 hash = 2166136261u;
+  for (QChar c : className) {
+    hash = (hash ^ c.unicode()) * 16777619u;
+  }
+  return hash ? hash : 1;
+}
+
+QString messageWithContext(const LogHandler::Log& log) {
+  if (!log.m_fromQT || (log.m_file.isEmpty() && log.m_function.isEmpty())) {
+    return log.m_message;
+  }
+
+  QString message;
+  QTextStream out(&message);
+  out << log.m_message << " (";
+
+  if (!log.m_file.isEmpty()) {
+    qsizetype pos = log.m_file.lastIndexOf("/");
+    out << log.m_file.right(log.m_file.length() - pos - 1);
+
+    if (log.m_line >= 0) {
+      out << ":" << log.m_line;
+    }
+
+    if (!log.m_function.isEmpty()) {
+      out << ", ";
+    }
+  }
+
+  if (!log.m_function.isEmpty()) {
+    out << log.m_function;
+  }
+
+  out << ")";
+  out.flush();
+  return message;
+}
+
+QString logSegmentName(const QString& fileName, int index) {
+  if (index == 0) {
+    return fileName;
+  }
+
+  return QString("%1.%2").arg(fileName).arg(index);
+}
+
+void rotateLogSegments(const QString& fileName) {
+  QFile::remove(logSegmentName(fileName, LOG_MAX_FILES - 1));
+
+  for (int i = LOG_MAX_FILES - 2; i >= 0; --i) {
+    QString segment = logSegmentName(fileName, i);
+    if (QFile::exists(segment)) {
+      QFile::rename(segment, logSegmentName(fileName, i + 1));
+    }
+  }
+}
+
+template <typename T>
+void appendValue(QByteArray& out, T value) {
+  value = qToLittleEndian(value);
+  out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+bool readValue(const QByteArray& data, qsizetype& pos, T& value) {
+  if (pos + static_cast<qsizetype>(sizeof(T)) > data.length()) {
+    return false;
+  }
+
+  value = qFromLittleEndian<T>(data.constData() + pos);
+  pos += sizeof(T);
+  return true;
+}
+
 }  // namespace
 
 // static
 LogHandler* LogHandler::instance() {
+  LogHandler* handler = s_instance.load(std::memory_order_acquire);
+  if (handler) {
+    return handler;
+  }
+
   MutexLocker lock(&s_mutex);
   return maybeCreate(lock);
 }
@@ -57,40 +168,44 @@ LogHandler* LogHandler::instance() {
 void LogHandler::messageQTHandler(QtMsgType type,
                                   const QMessageLogContext& context,
                                   const QString& message) {
-  MutexLocker lock(&s_mutex);
-  maybeCreate(lock)->addLog(Log(qtTypeToLogLevel(type), context.file,
-                                context.function, context.line, message),
-                            lock);
+  instance()->addLog(Log(qtTypeToLogLevel(type), context.file,
+                         context.function, context.line, message));
+
+  // Qt aborts right after a fatal message. Let's write it down first.
+  if (type == QtFatalMsg) {
+    flush();
+  }
 }
 
 // static
 void LogHandler::messageHandler(LogLevel logLevel, const QString& className,
                                 const QString& message) {
-  MutexLocker lock(&s_mutex);
-  maybeCreate(lock)->addLog(Log(logLevel, className, message), lock);
+  instance()->addLog(Log(logLevel, className, message));
 }
 
 // static
 void LogHandler::rustMessageHandler(int32_t logLevel, char* message) {
-  MutexLocker lock(&s_mutex);
-
-  maybeCreate(lock)->addLog(
-      Log(static_cast<LogLevel>(logLevel), "Rust", QString::fromUtf8(message)),
-      lock);
+  instance()->addLog(
+      Log(static_cast<LogLevel>(logLevel), "Rust", QString::fromUtf8(message)));
 }
 
 // static
 LogHandler* LogHandler::maybeCreate(const MutexLocker& proofOfLock) {
-  if (!s_instance) {
-    s_instance = new LogHandler(proofOfLock);
+  LogHandler* handler = s_instance.load(std::memory_order_acquire);
+  if (!handler) {
+    handler = new LogHandler(proofOfLock);
+    s_instance.store(handler, std::memory_order_release);
   }
 
-  return s_instance;
+  return handler;
 }
 
 // static
 void LogHandler::prettyOutput(QTextStream& out, const LogHandler::Log& log) {
-  out << "[" << log.m_dateTime.toString("dd.MM.yyyy hh:mm:ss.zzz") << "] ";
+  out << "["
+      << QDateTime::fromMSecsSinceEpoch(log.m_timestamp)
+             .toString("dd.MM.yyyy hh:mm:ss.zzz")
+      << "] ";
 
   if (!log.m_className.isEmpty()) {
     out << "(" << log.m_className << ") ";
@@ -117,36 +232,83 @@ void LogHandler::prettyOutput(QTextStream& out, const LogHandler::Log& log) {
       break;
   }
 
-  if (log.m_fromQT) {
-    out << log.m_message;
+  out << messageWithContext(log) << Qt::endl;
+}
 
-    if (!log.m_file.isEmpty() || !log.m_function.isEmpty()) {
-      out << " (";
+// static
+void LogHandler::serializeLog(QByteArray& out, const LogHandler::Log& log,
+                              QSet<quint32>& knownClassIds) {
+  quint32 classId = 0;
 
-      if (!log.m_file.isEmpty()) {
-        qsizetype pos = log.m_file.lastIndexOf("/");
-        out << log.m_file.right(log.m_file.length() - pos - 1);
+  if (!log.m_className.isEmpty()) {
+    classId = classNameId(log.m_className);
 
-        if (log.m_line >= 0) {
-          out << ":" << log.m_line;
-        }
+    if (!knownClassIds.contains(classId)) {
+      QByteArray name = log.m_className.toUtf8().left(UINT16_MAX);
+      out.append(static_cast<char>(RecordClassName));
+      appendValue<quint32>(out, classId);
+      appendValue<quint16>(out, static_cast<quint16>(name.length()));
+      out.append(name);
 
-        if (!log.m_function.isEmpty()) {
-          out << ", ";
-        }
-      }
+      knownClassIds.insert(classId);
+    }
+  }
 
-      if (!log.m_function.isEmpty()) {
-        out << log.m_function;
+  QByteArray message = messageWithContext(log).toUtf8();
+  out.append(static_cast<char>(RecordLog));
+  appendValue<qint64>(out, log.m_timestamp);
+  appendValue<quint32>(out, classId);
+  appendValue<quint8>(out, static_cast<quint8>(log.m_logLevel));
+  appendValue<quint32>(out, static_cast<quint32>(message.length()));
+  out.append(message);
+}
+
+// static
+void LogHandler::prettyOutputBinary(QTextStream& out, const QByteArray& data) {
+  if (!data.startsWith(QByteArray(LOG_FILE_MAGIC, LOG_FILE_MAGIC_SIZE))) {
+    return;
+  }
+
+  QHash<quint32, QString> classNames;
+  qsizetype pos = LOG_FILE_MAGIC_SIZE;
+
+  quint8 type;
+  while (readValue(data, pos, type)) {
+    if (type == RecordClassName) {
+      quint32 classId;
+      quint16 length;
+      if (!readValue(data, pos, classId) || !readValue(data, pos, length) ||
+          pos + length > data.length()) {
+        return;
       }
 
-      out << ")";
+      classNames.insert(classId,
+                        QString::fromUtf8(data.constData() + pos, length));
+      pos += length;
+      continue;
     }
-  } else {
-    out << log.m_message;
-  }
 
-  out << Qt::endl;
+    if (type != RecordLog) {
+      return;
+    }
+
+    qint64 timestamp;
+    quint32 classId;
+    quint8 level;
+    quint32 length;
+    if (!readValue(data, pos, timestamp) || !readValue(data, pos, classId) ||
+        !readValue(data, pos, level) || !readValue(data, pos, length) ||
+        pos + length > data.length()) {
+      return;
+    }
+
+    Log log(static_cast<LogLevel>(level), classNames.value(classId),
+            QString::fromUtf8(data.constData() + pos, length));
+    log.m_timestamp = timestamp;
+    pos += length;
+
+    prettyOutput(out, log);
+  }
 }
 
 // static
@@ -155,7 +317,8 @@ void LogHandler::enableStderr() {
   maybeCreate(lock)->m_stderrEnabled = true;
 }
 
-LogHandler::LogHandler(const MutexLocker& proofOfLock) {
+LogHandler::LogHandler(const MutexLocker& proofOfLock)
+    : m_queue(LOG_QUEUE_CAPACITY) {
   Q_UNUSED(proofOfLock);
 
 #if defined(MZ_DEBUG)
@@ -165,55 +328,234 @@ LogHandler::LogHandler(const MutexLocker& proofOfLock) {
   if (!s_location.isEmpty()) {
     openLogFile(proofOfLock);
   }
+
+#ifndef MZ_WASM
+  m_writer = QThread::create([this]() { writerLoop(); });
+  m_writer->setObjectName("LogWriter");
+  m_writer->start(QThread::LowPriority);
+
+  std::atexit(LogHandler::stopWriter);
+#endif
 }
 
-void LogHandler::addLog(const Log& log, const MutexLocker& proofOfLock) {
-  if (m_output) {
-    prettyOutput(*m_output, log);
+void LogHandler::addLog(Log&& log) {
+  if (!m_queue.push(std::move(log))) {
+    // The writer is not keeping up. Let's drop this entry: the writer will
+    // report how many entries have been lost.
+    m_dropped.fetch_add(1, std::memory_order_relaxed);
   }
 
-  if (m_stderrEnabled) {
-    QTextStream out(stderr);
-    prettyOutput(out, log);
+#ifdef MZ_WASM
+  // No threads here: entries are written from the event loop.
+  if (!m_writerSleeping.exchange(true)) {
+    QMetaObject::invokeMethod(
+        this,
+        [this]() {
+          m_writerSleeping.store(false);
+          flush();
+        },
+        Qt::QueuedConnection);
   }
+#else
+  if (m_writerSleeping.exchange(false)) {
+    m_wakeUp.release();
+  }
+#endif
+}
 
-  QByteArray buffer;
-  {
-    QTextStream out(&buffer);
-    prettyOutput(out, log);
+QList<QByteArray> LogHandler::drain(const MutexLocker& proofOfLock) {
+  Q_UNUSED(proofOfLock);
+
+  // Only the file is mandatory. The text format is produced for stderr and
+  // for the logEntryAdded() receivers, if any.
+  bool needsText =
+      m_stderrEnabled ||
+      isSignalConnected(QMetaMethod::fromSignal(&LogHandler::logEntryAdded));
+#if defined(MZ_ANDROID) && defined(MZ_DEBUG)
+  needsText = true;
+#endif
+
+  QList<QByteArray> entries;
+  QByteArray batch;
+  QByteArray textBatch;
+
+  auto process = [&](const Log& log) {
+    if (m_logFile) {
+      serializeLog(batch, log, m_logFileClassIds);
+    }
+
+    if (needsText) {
+      QByteArray buffer;
+      {
+        QTextStream out(&buffer);
+        prettyOutput(out, log);
+      }
+
+      textBatch.append(buffer);
+      entries.append(buffer);
+    }
+  };
+
+  // Another process may have rotated (or removed) the segments since our
+  // last write: our handle is then an older segment, and the class names we
+  // have written so far are not in the current file.
+  if (m_logFile) {
+    QFileInfo current(m_logFile->fileName());
+    if (!current.exists() || current.size() < m_logFile->size()) {
+      closeLogFile(proofOfLock);
+      openLogFile(proofOfLock);
+    }
+  }
+
+  Log log;
+  for (size_t i = 0; i < m_queue.capacity() && m_queue.pop(log); ++i) {
+    process(log);
   }
 
-  emit logEntryAdded(buffer);
+  uint64_t dropped = m_dropped.exchange(0, std::memory_order_relaxed);
+  if (dropped) {
+    process(Log(Warning, "LogHandler",
+                QString("%1 log entries dropped").arg(dropped)));
+  }
+
+  if (m_logFile && !batch.isEmpty()) {
+    m_logFile->write(batch);
+
+    // openLogFile() takes care of the rotation.
+    if (m_logFile->size() >= LOG_MAX_SEGMENT_SIZE) {
+      closeLogFile(proofOfLock);
+      openLogFile(proofOfLock);
+    }
+  }
+
+  if (m_stderrEnabled && !textBatch.isEmpty()) {
+    fwrite(textBatch.constData(), 1, textBatch.length(), stderr);
+    fflush(stderr);
+  }
 
 #if defined(MZ_ANDROID) && defined(MZ_DEBUG)
-  const char* str = buffer.constData();
-  if (str) {
-    __android_log_write(ANDROID_LOG_DEBUG, AppConstants::ANDROID_LOG_NAME, str);
+  for (const QByteArray& entry : entries) {
+    __android_log_write(ANDROID_LOG_DEBUG, AppConstants::ANDROID_LOG_NAME,
+                        entry.constData());
   }
 #endif
+
+  return entries;
+}
+
+void LogHandler::emitEntries(const QList<QByteArray>& entries) {
+  for (const QByteArray& entry : entries) {
+    emit logEntryAdded(entry);
+  }
+}
+
+void LogHandler::writerLoop() {
+  for (;;) {
+    QList<QByteArray> entries;
+    bool pending;
+
+    {
+      MutexLocker lock(&s_mutex);
+      entries = drain(lock);
+
+      m_writerSleeping.store(true);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      pending = !m_queue.isEmpty();
+    }
+
+    // The signal is emitted without the lock: receivers are free to log.
+    emitEntries(entries);
+
+    if (m_writerStopping.load()) {
+      return;
+    }
+
+    if (pending) {
+      m_writerSleeping.store(false);
+      continue;
+    }
+
+    m_wakeUp.tryAcquire(1, LOG_WRITER_IDLE_MSEC);
+  }
 }
 
 // static
-void LogHandler::writeLogs(QTextStream& out) {
+void LogHandler::stopWriter() {
+  LogHandler* handler = s_instance.load(std::memory_order_acquire);
+  if (!handler || !handler->m_writer) {
+    return;
+  }
+
+  handler->m_writerStopping.store(true);
+  handler->m_wakeUp.release();
+  handler->m_writer->wait();
+
+  // Whatever has been logged while the writer was stopping.
   MutexLocker lock(&s_mutex);
+  handler->drain(lock);
+}
 
-  if (!s_instance || !s_instance->m_logFile) {
-    return;
+// static
+void LogHandler::flush() {
+  LogHandler* handler = instance();
+
+  QList<QByteArray> entries;
+  {
+    MutexLocker lock(&s_mutex);
+    entries = handler->drain(lock);
   }
 
-  QString logFileName = s_instance->m_logFile->fileName();
-  s_instance->closeLogFile(lock);
+  handler->emitEntries(entries);
+}
+
+// static
+void LogHandler::writeLogs(QTextStream& out) {
+  LogHandler* handler = instance();
+
+  struct Segment {
+    QFile* m_file;
+    qint64 m_size;
+  };
+  QList<Segment> segments;
 
+  // Only the snapshot is taken with the lock: the writer can keep going (and
+  // even rotate the segments) while we read them.
+  QList<QByteArray> entries;
   {
-    QFile file(logFileName);
-    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-      return;
-    }
+    MutexLocker lock(&s_mutex);
+    entries = handler->drain(lock);
+
+    if (handler->m_logFile) {
+      QString logFileName = handler->m_logFile->fileName();
+
+      for (int i = LOG_MAX_FILES - 1; i >= 0; --i) {
+        QFile* file = new QFile(logSegmentName(logFileName, i));
+        if (!file->open(QIODevice::ReadOnly)) {
+          delete file;
+          continue;
+        }
 
-    out << file.readAll();
+        segments.append(Segment{file, file->size()});
+      }
+    }
   }
 
-  s_instance->openLogFile(lock);
+  handler->emitEntries(entries);
+
+  for (const Segment& segment : segments) {
+    uchar* data =
+        segment.m_size ? segment.m_file->map(0, segment.m_size) : nullptr;
+    if (data) {
+      prettyOutputBinary(
+          out, QByteArray::fromRawData(reinterpret_cast<const char*>(data),
+                                       segment.m_size));
+      segment.m_file->unmap(data);
+    } else {
+      prettyOutputBinary(out, segment.m_file->read(segment.m_size));
+    }
+
+    delete segment.m_file;
+  }
 }
 
 // static
@@ -224,19 +566,22 @@ void LogHandler::cleanupLogs() {
 
 // static
 void LogHandler::cleanupLogFile(const MutexLocker& proofOfLock) {
-  if (!s_instance || !s_instance->m_logFile) {
+  LogHandler* handler = s_instance.load(std::memory_order_acquire);
+  if (!handler || !handler->m_logFile) {
     return;
   }
 
-  QString logFileName = s_instance->m_logFile->fileName();
-  s_instance->closeLogFile(proofOfLock);
+  // Pending entries belong to the file we are about to remove.
+  handler->drain(proofOfLock);
 
-  {
-    QFile file(logFileName);
-    file.remove();
+  QString logFileName = handler->m_logFile->fileName();
+  handler->closeLogFile(proofOfLock);
+
+  for (int i = 0; i < LOG_MAX_FILES; ++i) {
+    QFile::remove(logSegmentName(logFileName, i));
   }
 
-  s_instance->openLogFile(proofOfLock);
+  handler->openLogFile(proofOfLock);
 }
 
 // static
@@ -244,15 +589,21 @@ void LogHandler::setLocation(const QString& path) {
   MutexLocker lock(&s_mutex);
   s_location = path;
 
-  if (s_instance && s_instance->m_logFile) {
+  LogHandler* handler = s_instance.load(std::memory_order_acquire);
+  if (!handler) {
+    return;
+  }
+
+  if (handler->m_logFile) {
     cleanupLogFile(lock);
+  } else if (!s_location.isEmpty()) {
+    handler->openLogFile(lock);
   }
 }
 
 void LogHandler::openLogFile(const MutexLocker& proofOfLock) {
   Q_UNUSED(proofOfLock);
   Q_ASSERT(!m_logFile);
-  Q_ASSERT(!m_output);
 
   QDir appDataLocation(s_location);
   if (!appDataLocation.exists()) {
@@ -267,31 +618,41 @@ void LogHandler::openLogFile(const MutexLocker& proofOfLock) {
   }
 
   QString logFileName = appDataLocation.filePath(AppConstants::LOG_FILE_NAME);
-  m_logFile = new QFile(logFileName);
-  if (m_logFile->size() > LOG_MAX_FILE_SIZE) {
-    m_logFile->remove();
+
+  // The plain-text log of the previous versions is not read anymore.
+  if (!s_legacyLogFileRemoved) {
+    s_legacyLogFileRemoved = true;
+    QFile::remove(appDataLocation.filePath(
+        QFileInfo(logFileName).completeBaseName() + ".txt"));
+  }
+
+  if (QFileInfo(logFileName).size() >= LOG_MAX_SEGMENT_SIZE) {
+    rotateLogSegments(logFileName);
   }
 
+  m_logFile = new QFile(logFileName);
+
+  // Unbuffered: each batch must reach the file with a single write, as other
+  // processes may be appending to it too.
   if (!m_logFile->open(QIODevice::WriteOnly | QIODevice::Append |
-                       QIODevice::Text)) {
+                       QIODevice::Unbuffered)) {
     delete m_logFile;
     m_logFile = nullptr;
     return;
   }
 
-  m_output = new QTextStream(m_logFile);
+  m_logFileClassIds.clear();
+  if (m_logFile->size() == 0) {
+    m_logFile->write(LOG_FILE_MAGIC, LOG_FILE_MAGIC_SIZE);
+  }
 
-  addLog(Log(Debug, "LogHandler", QString("Log file: %1").arg(logFileName)),
-         proofOfLock);
+  addLog(Log(Debug, "LogHandler", QString("Log file: %1").arg(logFileName)));
 }
 
 void LogHandler::closeLogFile(const MutexLocker& proofOfLock) {
   Q_UNUSED(proofOfLock);
 
   if (m_logFile) {
-    delete m_output;
-    m_output = nullptr;
-
     delete m_logFile;
     m_logFile = nullptr;
   }
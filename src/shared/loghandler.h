@@ -8,12 +8,17 @@
 #include <QDateTime>
 #include <QMutexLocker>
 #include <QObject>
+#include <QSemaphore>
+#include <QSet>
 #include <QVector>
+#include <atomic>
 
 #include "loglevel.h"
+#include "mpscqueue.h"
 
 class QFile;
 class QTextStream;
+class QThread;
 
 class LogHandler final : public QObject {
   Q_OBJECT
@@ -30,7 +35,7 @@ class LogHandler final : public QObject {
 
     Log(LogLevel logLevel, const QString& className, const QString& message)
         : m_logLevel(logLevel),
-          m_dateTime(QDateTime::currentDateTime()),
+          m_timestamp(QDateTime::currentMSecsSinceEpoch()),
           m_className(className),
           m_message(message),
           m_fromQT(false) {}
@@ -38,7 +43,7 @@ class LogHandler final : public QObject {
     Log(LogLevel logLevel, const QString& file, const QString& function,
         uint32_t line, const QString& message)
         : m_logLevel(logLevel),
-          m_dateTime(QDateTime::currentDateTime()),
+          m_timestamp(QDateTime::currentMSecsSinceEpoch()),
           m_file(file),
           m_function(function),
           m_message(message),
@@ -46,7 +51,9 @@ class LogHandler final : public QObject {
           m_fromQT(true) {}
 
     LogLevel m_logLevel = LogLevel::Debug;
-    QDateTime m_dateTime;
+    // Milliseconds since epoch. Converting it to a local date is left to
+    // whoever needs to read the log.
+    qint64 m_timestamp = 0;
     QString m_file;
     QString m_function;
     QString m_className;
@@ -68,8 +75,22 @@ class LogHandler final : public QObject {
 
   static void prettyOutput(QTextStream& out, const LogHandler::Log& log);
 
+  // The log file stores binary records. `knownClassIds` tracks the class
+  // names already written in the current file: each one is stored once and
+  // then referenced by id.
+  static void serializeLog(QByteArray& out, const LogHandler::Log& log,
+                           QSet<quint32>& knownClassIds);
+
+  // Pretty-prints the records of a binary log file. Parsing stops at the
+  // first truncated or unknown record.
+  static void prettyOutputBinary(QTextStream& out, const QByteArray& data);
+
   static void writeLogs(QTextStream& out);
 
+  // Synchronously writes any pending log entry. Logs are normally written by
+  // a background thread; call this when the entries must be on disk now.
+  static void flush();
+
   static void cleanupLogs();
 
   static void setLocation(const QString& path);
@@ -84,7 +105,15 @@ class LogHandler final : public QObject {
 
   static LogHandler* maybeCreate(const MutexLocker& proofOfLock);
 
-  void addLog(const Log& log, const MutexLocker& proofOfLock);
+  void addLog(Log&& log);
+
+  QList<QByteArray> drain(const MutexLocker& proofOfLock);
+
+  void emitEntries(const QList<QByteArray>& entries);
+
+  void writerLoop();
+
+  static void stopWriter();
 
   void openLogFile(const MutexLocker& proofOfLock);
 
@@ -95,7 +124,15 @@ class LogHandler final : public QObject {
   bool m_stderrEnabled = false;
 
   QFile* m_logFile = nullptr;
-  QTextStream* m_output = nullptr;
+  QSet<quint32> m_logFileClassIds;
+
+  MpscQueue<Log> m_queue;
+  std::atomic<uint64_t> m_dropped{0};
+
+  QThread* m_writer = nullptr;
+  QSemaphore m_wakeUp;
+  std::atomic<bool> m_writerSleeping{false};
+  std::atomic<bool> m_writerStopping{false};
 };
 
 #endif  // LOGHANDLER_H
@@ -5,6 +5,12 @@
 #ifndef LOGLEVEL_H
 #define LOGLEVEL_H
 
+// Log statements below this level are compiled out: they cost a constant
+// branch. Builds can raise it, e.g. -DMZ_LOG_MIN_LEVEL=2 to drop Debug.
+#ifndef MZ_LOG_MIN_LEVEL
+#  define MZ_LOG_MIN_LEVEL 0
+#endif
+
 enum LogLevel {
   Trace = 0,
   Debug,
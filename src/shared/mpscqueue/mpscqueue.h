@@ -0,0 +1,107 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef MPSCQUEUE_H
+#define MPSCQUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+// A bounded, lock-free, multi-producer single-consumer queue.
+//
+// Each slot carries a sequence number which tells producers and the consumer
+// whether the slot is free or holds a value for the current lap of the ring.
+// Producers claim a slot with a single CAS on the tail; the consumer never
+// blocks them. When the ring is full, push() fails instead of waiting, and it
+// is up to the caller to decide what to do with the value (usually: drop it
+// and count it).
+//
+// The capacity is rounded up to the next power of two.
+template <typename T>
+class MpscQueue final {
+ public:
+  explicit MpscQueue(size_t capacity)
+      : m_capacity(roundUp(capacity)),
+        m_mask(m_capacity - 1),
+        m_slots(new Slot[m_capacity]) {
+    for (size_t i = 0; i < m_capacity; ++i) {
+      m_slots[i].m_sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  MpscQueue(const MpscQueue&) = delete;
+  MpscQueue& operator=(const MpscQueue&) = delete;
+
+  size_t capacity() const { return m_capacity; }
+
+  // Safe to call from any thread. Returns false if the queue is full.
+  bool push(T&& value) {
+    size_t pos = m_tail.load(std::memory_order_relaxed);
+    for (;;) {
+      Slot& slot = m_slots[pos & m_mask];
+      size_t seq = slot.m_sequence.load(std::memory_order_acquire);
+      intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+
+      if (diff == 0) {
+        if (m_tail.compare_exchange_weak(pos, pos + 1,
+                                         std::memory_order_relaxed)) {
+          slot.m_value = std::move(value);
+          slot.m_sequence.store(pos + 1, std::memory_order_release);
+          return true;
+        }
+      } else if (diff < 0) {
+        return false;
+      } else {
+        pos = m_tail.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  // Must only be called by one consumer at a time.
+  bool pop(T& value) {
+    Slot& slot = m_slots[m_head & m_mask];
+    size_t seq = slot.m_sequence.load(std::memory_order_acquire);
+    if (seq != m_head + 1) {
+      return false;
+    }
+
+    value = std::move(slot.m_value);
+    slot.m_value = T();
+    slot.m_sequence.store(m_head + m_capacity, std::memory_order_release);
+    ++m_head;
+    return true;
+  }
+
+  // Only meaningful for the consumer: producers may be racing with it.
+  bool isEmpty() const {
+    const Slot& slot = m_slots[m_head & m_mask];
+    return slot.m_sequence.load(std::memory_order_acquire) != m_head + 1;
+  }
+
+ private:
+  static size_t roundUp(size_t value) {
+    size_t result = 2;
+    while (result < value) {
+      result <<= 1;
+    }
+    return result;
+  }
+
+  struct Slot {
+    std::atomic<size_t> m_sequence{0};
+    T m_value;
+  };
+
+  const size_t m_capacity;
+  const size_t m_mask;
+  std::unique_ptr<Slot[]> m_slots;
+
+  alignas(64) std::atomic<size_t> m_tail{0};
+  alignas(64) size_t m_head = 0;
+};
+
+#endif  // MPSCQUEUE_H
@@ -10,6 +10,8 @@
 #include <QRegularExpression>
 #include <QTest>
 
+#include "qmlpathindex.h"
+
 QmlPath::QmlPath(const QString& path) {
   if (path.isEmpty()) {
     return;
@@ -133,7 +135,8 @@ bool QmlPath::parsePath(const QChar*& input, qsizetype& size,
   return true;
 }
 
-QQuickItem* QmlPath::evaluate(QQmlApplicationEngine* engine) const {
+QQuickItem* QmlPath::evaluate(QQmlApplicationEngine* engine,
+                              const QmlPathIndex* index) const {
   if (!engine) {
     return nullptr;
   }
@@ -142,6 +145,11 @@ QQuickItem* QmlPath::evaluate(QQmlApplicationEngine* engine) const {
     return nullptr;
   }
 
+  return evaluateItems(nullptr, rootItems(engine), m_blocks.cbegin(), index);
+}
+
+// static
+QList<QQuickItem*> QmlPath::rootItems(QQmlApplicationEngine* engine) {
   QList<QQuickItem*> list;
   for (QObject* object : engine->rootObjects()) {
     QQuickItem* item = qobject_cast<QQuickItem*>(object);
@@ -156,13 +164,13 @@ QQuickItem* QmlPath::evaluate(QQmlApplicationEngine* engine) const {
       }
     }
   }
-
-  return evaluateItems(nullptr, list, m_blocks.cbegin());
+  return list;
 }
 
 QQuickItem* QmlPath::evaluateItems(QQuickItem* currentItem,
                                    const QList<QQuickItem*>& items,
-                                   QList<Data>::const_iterator i) const {
+                                   QList<Data>::const_iterator i,
+                                   const QmlPathIndex* index) const {
   if (i == m_blocks.cend()) {
     return currentItem;
   }
@@ -175,7 +183,8 @@ QQuickItem* QmlPath::evaluateItems(QQuickItem* currentItem,
 
   if (i->m_key.isEmpty()) {
     results.append(items);
-  } else {
+  } else if (!i->m_nested || !index ||
+             !findIndexedItems(index, items, *i, results)) {
     for (QQuickItem* item : items) {
       if (item->objectName() == i->m_key) {
         results.append(item);
@@ -202,13 +211,49 @@ QQuickItem* QmlPath::evaluateItems(QQuickItem* currentItem,
   }
 
   for (QQuickItem* result : results) {
-    QQuickItem* item = evaluateItems(result, collectChildItems(result), i + 1);
+    QQuickItem* item =
+        evaluateItems(result, collectChildItems(result), i + 1, index);
     if (item) return item;
   }
 
   return nullptr;
 }
 
+// static
+bool QmlPath::findIndexedItems(const QmlPathIndex* index,
+                               const QList<QQuickItem*>& items,
+                               const Data& data, QList<QQuickItem*>& results) {
+  // The tree walk can find the same item more than once, and in an order the
+  // index does not know: only the tree walk gets the index filters right.
+  for (const Filter& filter : data.m_filters) {
+    if (filter.m_type == Filter::Index) {
+      return false;
+    }
+  }
+
+  QList<QQuickItem*> candidates = index->items(data.m_key);
+  if (candidates.isEmpty()) {
+    return true;
+  }
+
+  // With more items of the same name, the order of the results matters.
+  if (candidates.length() > 1) {
+    return false;
+  }
+
+  // The item is found if it is one of `items`, or one of their descendants.
+  // Otherwise, it could still be reachable through a content item.
+  QQuickItem* candidate = candidates.first();
+  for (QQuickItem* item = candidate; item; item = item->parentItem()) {
+    if (items.contains(item)) {
+      results.append(candidate);
+      return true;
+    }
+  }
+
+  return false;
+}
+
 // static
 QList<QQuickItem*> QmlPath::collectChildItems(QQuickItem* item) {
   Q_ASSERT(item);
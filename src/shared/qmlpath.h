@@ -4,6 +4,7 @@
 
 #include <QObject>
 
+class QmlPathIndex;
 class QQmlApplicationEngine;
 class QQuickItem;
 
@@ -29,6 +30,9 @@ class QQuickItem;
  *   `propertyName` and value set to `propertyValue`.
  *
  * Paths blocks can be concatenated: `/abc//foo[1]{p=42}/bar`
+ *
+ * With a QmlPathIndex, a '//' + objectName search does not walk the tree when
+ * the index can answer it on its own.
  */
 class QmlPath final {
   struct Filter {
@@ -57,7 +61,11 @@ class QmlPath final {
 
   bool isValid() const { return !m_blocks.isEmpty(); }
 
-  QQuickItem* evaluate(QQmlApplicationEngine* engine) const;
+  QQuickItem* evaluate(QQmlApplicationEngine* engine,
+                       const QmlPathIndex* index = nullptr) const;
+
+  // The items a path starts from.
+  static QList<QQuickItem*> rootItems(QQmlApplicationEngine* engine);
 
  private:
   static bool parsePath(const QChar*& input, qsizetype& size,
@@ -65,7 +73,12 @@ class QmlPath final {
 
   QQuickItem* evaluateItems(QQuickItem* currentItem,
                             const QList<QQuickItem*>& items,
-                            QList<Data>::const_iterator i) const;
+                            QList<Data>::const_iterator i,
+                            const QmlPathIndex* index) const;
+
+  static bool findIndexedItems(const QmlPathIndex* index,
+                               const QList<QQuickItem*>& items,
+                               const Data& data, QList<QQuickItem*>& results);
 
   static QList<QQuickItem*> collectChildItems(QQuickItem* item);
 
@@ -0,0 +1,112 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "qmlpathindex.h"
+
+#include <QQmlApplicationEngine>
+#include <QQuickItem>
+
+#include "leakdetector.h"
+#include "logger.h"
+#include "qmlpath.h"
+
+namespace {
+Logger logger("QmlPathIndex");
+}
+
+QmlPathIndex::QmlPathIndex(QQmlApplicationEngine* engine) : QObject(engine) {
+  MZ_COUNT_CTOR(QmlPathIndex);
+  Q_ASSERT(engine);
+
+  for (QQuickItem* item : QmlPath::rootItems(engine)) {
+    addItem(item);
+  }
+
+  connect(engine, &QQmlApplicationEngine::objectCreated, this,
+          [this, engine]() {
+            qsizetype count = m_items.count();
+            for (QQuickItem* item : QmlPath::rootItems(engine)) {
+              addItem(item);
+            }
+            if (m_items.count() != count) {
+              emit changed();
+            }
+          });
+
+  logger.debug() << "Indexed" << m_items.count() << "items";
+}
+
+QmlPathIndex::~QmlPathIndex() { MZ_COUNT_DTOR(QmlPathIndex); }
+
+void QmlPathIndex::addItem(QQuickItem* item) {
+  if (m_items.contains(item)) {
+    return;
+  }
+
+  QString objectName = item->objectName();
+  m_items.insert(item, objectName);
+  if (!objectName.isEmpty()) {
+    m_names[objectName].append(item);
+  }
+
+  connect(item, &QQuickItem::childrenChanged, this, [this, item]() {
+    qsizetype count = m_items.count();
+    addChildItems(item);
+    if (m_items.count() != count) {
+      emit changed();
+    }
+  });
+
+  connect(item, &QObject::objectNameChanged, this,
+          [this, item](const QString& objectName) {
+            renameItem(item, objectName);
+          });
+
+  // The item is only a key here: it is no longer a QQuickItem.
+  connect(item, &QObject::destroyed, this,
+          [this, item]() { removeItem(item); });
+
+  addChildItems(item);
+}
+
+void QmlPathIndex::addChildItems(QQuickItem* item) {
+  for (QQuickItem* child : item->childItems()) {
+    addItem(child);
+  }
+
+  // QmlPath also looks into the children of the content item.
+  QQuickItem* contentItem = item->property("contentItem").value<QQuickItem*>();
+  if (contentItem) {
+    addItem(contentItem);
+  }
+}
+
+void QmlPathIndex::removeItem(QQuickItem* item) {
+  auto i = m_items.find(item);
+  if (i == m_items.end()) {
+    return;
+  }
+
+  if (!i.value().isEmpty()) {
+    auto names = m_names.find(i.value());
+    Q_ASSERT(names != m_names.end());
+    names->removeOne(item);
+    if (names->isEmpty()) {
+      m_names.erase(names);
+    }
+  }
+
+  m_items.erase(i);
+}
+
+void QmlPathIndex::renameItem(QQuickItem* item, const QString& objectName) {
+  removeItem(item);
+
+  m_items.insert(item, objectName);
+  if (!objectName.isEmpty()) {
+    m_names[objectName].append(item);
+  }
+
+  emit changed();
+}
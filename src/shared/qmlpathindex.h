@@ -0,0 +1,58 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef QMLPATHINDEX_H
+#define QMLPATHINDEX_H
+
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QString>
+
+class QQmlApplicationEngine;
+class QQuickItem;
+
+/**
+ * @brief Index of the QML items of an engine by objectName
+ *
+ * The item tree is walked once, then the index follows it: the new child
+ * items are indexed on QQuickItem::childrenChanged, renamed items on
+ * QObject::objectNameChanged, and the destroyed ones are removed. An item
+ * which leaves the tree stays in the index until it is destroyed: the index
+ * may have more items than the tree, never fewer.
+ *
+ * QmlPath uses it to resolve '//' + objectName searches without walking the
+ * tree.
+ */
+class QmlPathIndex final : public QObject {
+  Q_OBJECT
+  Q_DISABLE_COPY_MOVE(QmlPathIndex)
+
+ public:
+  explicit QmlPathIndex(QQmlApplicationEngine* engine);
+  ~QmlPathIndex();
+
+  // The items with this objectName, in no specific order.
+  QList<QQuickItem*> items(const QString& objectName) const {
+    return m_names.value(objectName);
+  }
+
+  qsizetype count() const { return m_items.count(); }
+
+ signals:
+  // Items have been added, or renamed.
+  void changed();
+
+ private:
+  void addItem(QQuickItem* item);
+  void addChildItems(QQuickItem* item);
+  void removeItem(QQuickItem* item);
+  void renameItem(QQuickItem* item, const QString& objectName);
+
+ private:
+  QHash<QQuickItem*, QString> m_items;
+  QHash<QString, QList<QQuickItem*>> m_names;
+};
+
+#endif  // QMLPATHINDEX_H
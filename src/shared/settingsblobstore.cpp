@@ -0,0 +1,126 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "settingsblobstore.h"
+
+#include <QDir>
+#include <QFile>
+#include <QSaveFile>
+#include <cstring>
+
+#include "cryptosettings.h"
+#include "leakdetector.h"
+#include "logger.h"
+
+namespace {
+Logger logger("SettingsBlobStore");
+
+constexpr const char* REFERENCE_PREFIX = "blob:";
+constexpr const char* BLOB_SUFFIX = ".blob";
+}  // namespace
+
+SettingsBlobStore::SettingsBlobStore(const QString& path) : m_path(path) {
+  MZ_COUNT_CTOR(SettingsBlobStore);
+}
+
+SettingsBlobStore::~SettingsBlobStore() { MZ_COUNT_DTOR(SettingsBlobStore); }
+
+// static
+bool SettingsBlobStore::isReference(const QVariant& value) {
+  return value.typeId() == QMetaType::QString &&
+         value.toString().startsWith(REFERENCE_PREFIX);
+}
+
+QString SettingsBlobStore::fileName(const QString& reference) const {
+  Q_ASSERT(isReference(reference));
+  return QDir(m_path).filePath(reference.mid(strlen(REFERENCE_PREFIX)) +
+                               BLOB_SUFFIX);
+}
+
+QString SettingsBlobStore::store(const QByteArray& value) {
+  QByteArray id = CryptoSettings::blobId(value);
+  QString reference = QString(REFERENCE_PREFIX) + QString::fromLatin1(id);
+
+  // Same content, same file: nothing to write.
+  if (m_cache.contains(reference) || QFile::exists(fileName(reference))) {
+    m_cache.insert(reference, value);
+    return reference;
+  }
+
+  if (!QDir().mkpath(m_path)) {
+    logger.error() << "Unable to create the blob directory" << m_path;
+    return QString();
+  }
+
+  QSaveFile file(fileName(reference));
+  if (!file.open(QIODevice::WriteOnly) ||
+      !CryptoSettings::writeBlob(file, id, value) || !file.commit()) {
+    logger.error() << "Unable to write the blob" << file.fileName();
+    return QString();
+  }
+
+  logger.debug() << "Blob stored:" << value.length() << "bytes";
+  m_cache.insert(reference, value);
+  return reference;
+}
+
+bool SettingsBlobStore::load(const QString& reference, QByteArray& value) {
+  auto cached = m_cache.constFind(reference);
+  if (cached != m_cache.constEnd()) {
+    value = cached.value();
+    return true;
+  }
+
+  QFile file(fileName(reference));
+  if (!file.open(QIODevice::ReadOnly)) {
+    logger.error() << "Unable to open the blob" << file.fileName();
+    return false;
+  }
+
+  // Map the file rather than reading it: it is decrypted straight from the
+  // page cache.
+  qint64 size = file.size();
+  const uchar* data = size > 0 ? file.map(0, size) : nullptr;
+  QByteArray buffer;
+  if (!data) {
+    buffer = file.readAll();
+    data = reinterpret_cast<const uchar*>(buffer.constData());
+    size = buffer.size();
+  }
+
+  QByteArray id = reference.mid(strlen(REFERENCE_PREFIX)).toLatin1();
+  if (!CryptoSettings::readBlob(id, reinterpret_cast<const char*>(data), size,
+                                value)) {
+    logger.error() << "Unable to read the blob" << file.fileName();
+    return false;
+  }
+
+  m_cache.insert(reference, value);
+  return true;
+}
+
+void SettingsBlobStore::remove(const QString& reference) {
+  m_cache.remove(reference);
+  QFile::remove(fileName(reference));
+}
+
+void SettingsBlobStore::collectGarbage(const QSet<QString>& references) {
+  m_cache.removeIf([&](const QHash<QString, QByteArray>::iterator i) {
+    return !references.contains(i.key());
+  });
+
+  QDir dir(m_path);
+  const QStringList files =
+      dir.entryList({QString("*") + BLOB_SUFFIX}, QDir::Files);
+  for (const QString& file : files) {
+    QString reference =
+        QString(REFERENCE_PREFIX) + file.chopped(strlen(BLOB_SUFFIX));
+    if (!references.contains(reference)) {
+      logger.debug() << "Removing the unused blob" << file;
+      dir.remove(file);
+    }
+  }
+}
+
+void SettingsBlobStore::clear() { collectGarbage(QSet<QString>()); }
@@ -0,0 +1,49 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef SETTINGSBLOBSTORE_H
+#define SETTINGSBLOBSTORE_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QSet>
+#include <QString>
+#include <QVariant>
+
+// A content-addressed store for the settings which are too large to be
+// rewritten every time another setting changes (the server list, for
+// instance).
+//
+// Each value is encrypted into its own file, named after its id (see
+// CryptoSettings::blobId()). The settings file only keeps a reference to it,
+// so that writing the settings file stays cheap, and the value is only read
+// from the disk the first time it is needed.
+class SettingsBlobStore final {
+ public:
+  explicit SettingsBlobStore(const QString& path);
+  ~SettingsBlobStore();
+
+  static bool isReference(const QVariant& value);
+
+  // Returns the reference to store in the settings file, or an empty string
+  // if the value cannot be written.
+  QString store(const QByteArray& value);
+  bool load(const QString& reference, QByteArray& value);
+  void remove(const QString& reference);
+
+  // Removes the blobs which are not referenced anymore.
+  void collectGarbage(const QSet<QString>& references);
+  void clear();
+
+  const QString& path() const { return m_path; }
+
+ private:
+  QString fileName(const QString& reference) const;
+
+ private:
+  QString m_path;
+  QHash<QString, QByteArray> m_cache;
+};
+
+#endif  // SETTINGSBLOBSTORE_H
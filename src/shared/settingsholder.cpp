@@ -6,6 +6,7 @@
 
 #include <QDir>
 #include <QFile>
+#include <QFileInfo>
 #include <QSettings>
 #include <QStandardPaths>
 
@@ -32,6 +33,11 @@ SettingsHolder* s_instance = nullptr;
 const QSettings::Format MozFormat = QSettings::registerFormat(
     "moz", CryptoSettings::readFile, CryptoSettings::writeFile);
 
+QString blobStorePath(const QString& settingsFileName) {
+  QFileInfo info(settingsFileName);
+  return info.dir().filePath(info.completeBaseName() + ".blobs");
+}
+
 }  // namespace
 
 // static
@@ -41,15 +47,25 @@ SettingsHolder* SettingsHolder::instance() {
 }
 
 SettingsHolder::SettingsHolder()
-    : m_settings(MozFormat, QSettings::UserScope,
+    : m_settings(MozFormat, CryptoSettings::writeFile,
 #ifndef UNIT_TEST
                  "mozilla",
 #else
                  "mozilla_testing",
 #endif
-                 AppConstants::SETTINGS_APP_NAME) {
+                 AppConstants::SETTINGS_APP_NAME),
+      m_blobStore(blobStorePath(m_settings.fileName())) {
   MZ_COUNT_CTOR(SettingsHolder);
 
+#define SETTING(...)
+#undef SETTING_BLOB
+#define SETTING_BLOB(getter, setter, remover, has, key, ...) \
+  m_blobKeys.insert(key);
+
+#include "settingslist.h"
+#undef SETTING_BLOB
+#undef SETTING
+
   // The location changes after the initialization of the app. Let's store the
   // journal file-name in the CTOR to avoid race-conditions.
   m_settingsJournalFileName =
@@ -73,7 +89,7 @@ SettingsHolder::SettingsHolder()
     {
       QSettings journalSettings(journalSettingFile, MozFormat);
       for (const QString& key : journalSettings.allKeys()) {
-        m_settings.setValue(key, journalSettings.value(key));
+        setSettingValue(key, journalSettings.value(key));
       }
     }
 
@@ -89,6 +105,8 @@ SettingsHolder::SettingsHolder()
     logger.info() << "Recovering completed";
   }
 
+  initializeBlobStore();
+
   Q_ASSERT(!s_instance);
   s_instance = this;
 
@@ -102,6 +120,12 @@ SettingsHolder::SettingsHolder()
     setUpdateTime(QDateTime::currentDateTime());
     setInstalledVersion(Env::versionString());
   }
+
+  applyLogLevels();
+  connect(this, &SettingsHolder::logLevelChanged, this,
+          &SettingsHolder::applyLogLevels);
+  connect(this, &SettingsHolder::logLevelOverridesChanged, this,
+          &SettingsHolder::applyLogLevels);
 }
 
 SettingsHolder::~SettingsHolder() {
@@ -113,8 +137,13 @@ SettingsHolder::~SettingsHolder() {
 #ifdef UNIT_TEST
   if (!m_doNotClearOnDTOR) {
     m_settings.clear();
+    m_blobStore.clear();
+    return;
   }
 #endif
+
+  // Write the settings file now, so that the replaced blobs can go.
+  sync();
 }
 
 void SettingsHolder::clear() {
@@ -123,7 +152,7 @@ void SettingsHolder::clear() {
 #define SETTING(type, toType, getter, setter, remover, has, key, defvalue, \
                 userSettings, removeWhenReset)                             \
   if (removeWhenReset) {                                                   \
-    m_settings.remove(key);                                                \
+    removeSettingValue(key);                                               \
     emit getter##Changed();                                                \
   }
 
@@ -131,11 +160,126 @@ void SettingsHolder::clear() {
 #undef SETTING
 }
 
-void SettingsHolder::sync() { m_settings.sync(); }
+void SettingsHolder::sync() {
+  m_settings.sync();
+  removeStaleBlobs();
+}
+
+void SettingsHolder::initializeBlobStore() {
+  QSet<QString> references;
+  for (const QString& key : m_blobKeys) {
+    if (!m_settings.contains(key)) {
+      continue;
+    }
+
+    // Values written by older versions are stored inline.
+    if (!SettingsBlobStore::isReference(m_settings.value(key))) {
+      logger.debug() << "Moving" << key << "to the blob store";
+      setSettingValue(key, m_settings.value(key));
+    }
+
+    QVariant value = m_settings.value(key);
+    if (SettingsBlobStore::isReference(value)) {
+      references.insert(value.toString());
+    }
+  }
+
+  m_blobStore.collectGarbage(references);
+  m_staleBlobs.clear();
+}
+
+void SettingsHolder::removeStaleBlobs() {
+  // The journal, or the file on disk, may still point to them.
+  if (m_settingsJournal || m_settings.status() != QSettings::NoError) {
+    return;
+  }
+
+  QSet<QString> references;
+  for (const QString& key : m_blobKeys) {
+    references.insert(m_settings.value(key).toString());
+  }
+
+  for (const QString& reference : m_staleBlobs) {
+    if (!references.contains(reference)) {
+      m_blobStore.remove(reference);
+    }
+  }
+  m_staleBlobs.clear();
+}
+
+QVariant SettingsHolder::settingValue(const QString& key) const {
+  QVariant value = m_settings.value(key);
+  if (!m_blobKeys.contains(key) || !SettingsBlobStore::isReference(value)) {
+    return value;
+  }
+
+  QByteArray content;
+  if (!m_blobStore.load(value.toString(), content)) {
+    logger.warning() << "Unable to load the setting" << key;
+    return QVariant();
+  }
+  return content;
+}
+
+void SettingsHolder::setSettingValue(const QString& key,
+                                     const QVariant& value) {
+  if (!m_blobKeys.contains(key) || SettingsBlobStore::isReference(value)) {
+    m_settings.setValue(key, value);
+    return;
+  }
+
+  QVariant oldValue = m_settings.value(key);
+
+  QString reference = m_blobStore.store(value.toByteArray());
+  if (reference.isEmpty()) {
+    // Better a large settings file than a lost value.
+    m_settings.setValue(key, value);
+  } else {
+    m_settings.setValue(key, reference);
+  }
+
+  if (SettingsBlobStore::isReference(oldValue) &&
+      oldValue.toString() != reference) {
+    m_staleBlobs.append(oldValue.toString());
+  }
+}
+
+void SettingsHolder::removeSettingValue(const QString& key) {
+  if (m_blobKeys.contains(key)) {
+    QVariant oldValue = m_settings.value(key);
+    if (SettingsBlobStore::isReference(oldValue)) {
+      m_staleBlobs.append(oldValue.toString());
+    }
+  }
+
+  m_settings.remove(key);
+}
+
+void SettingsHolder::applyLogLevels() {
+  LogLevel level = Trace;
+  if (!logLevel().isEmpty() && !Logger::parseLogLevel(logLevel(), level)) {
+    logger.warning() << "Invalid log level" << logLevel();
+  }
+  Logger::setLogLevel(level);
+
+  Logger::clearClassLogLevels();
+  for (const QString& entry : logLevelOverrides()) {
+    QStringList parts = entry.split(':');
+    if (parts.length() != 2 || parts[0].isEmpty() ||
+        !Logger::parseLogLevel(parts[1], level)) {
+      logger.warning() << "Invalid log level override" << entry;
+      continue;
+    }
+
+    Logger::setClassLogLevel(parts[0], level);
+  }
+}
 
 void SettingsHolder::hardReset() {
   logger.debug() << "Hard reset";
   m_settings.clear();
+  m_blobStore.clear();
+  m_staleBlobs.clear();
 
 #define SETTING(type, toType, getter, ...) emit getter##Changed();
 
@@ -148,12 +292,12 @@ QString SettingsHolder::settingsFileName() const {
 }
 
 QVariant SettingsHolder::rawSetting(const QString& key) const {
-  return m_settings.value(key);
+  return settingValue(key);
 }
 
 #ifdef UNIT_TEST
 void SettingsHolder::setRawSetting(const QString& key, const QVariant& value) {
-  m_settings.setValue(key, value);
+  setSettingValue(key, value);
 }
 #endif
 
@@ -180,6 +324,10 @@ QString SettingsHolder::getReport() const {
     }
     out << Qt::endl;
   }
+
+  out << "Settings writes -> " << m_settings.flushCount() << " ("
+      << m_settings.flushesLastMinute() << " in the last minute), "
+      << m_settings.bytesWritten() << " bytes" << Qt::endl;
   return buff;
 }
 
@@ -190,18 +338,18 @@ QString SettingsHolder::getReport() const {
     if (!has()) {                                                          \
       return defvalue;                                                     \
     }                                                                      \
-    return m_settings.value(key).toType();                                 \
+    return settingValue(key).toType();                                     \
   }                                                                        \
   void SettingsHolder::setter(const type& value) {                         \
     if (!has() || getter() != value) {                                     \
       maybeSaveInTransaction(key, getter(), value, #getter "Changed",      \
                              userSettings);                                \
-      m_settings.setValue(key, value);                                     \
+      setSettingValue(key, value);                                         \
       emit getter##Changed();                                              \
     }                                                                      \
   }                                                                        \
   void SettingsHolder::remover() {                                         \
-    m_settings.remove(key);                                                \
+    removeSettingValue(key);                                               \
     emit getter##Changed();                                                \
   }
 
@@ -216,9 +364,7 @@ void SettingsHolder::clearAddonSettings(const QString& group) {
   const QString groupKey(
       QString("%1/%2").arg(Constants::ADDON_SETTINGS_GROUP, group));
 
-  m_settings.beginGroup(groupKey);
-  m_settings.remove("");
-  m_settings.endGroup();
+  m_settings.remove(groupKey);
 
   emit addonSettingsChanged();
 }
@@ -254,16 +400,16 @@ bool SettingsHolder::beginTransaction() {
     return false;
   }
 
-  sync();
-
-  if (!QFile::copy(m_settings.fileName(), m_settingsJournalFileName)) {
+  // The journal is the current content of the settings, written straight
+  // from memory.
+  if (!m_settings.writeCopy(m_settingsJournalFileName)) {
     logger.warning() << "Unable to generate a setting journal file"
                      << m_settingsJournalFileName;
     return false;
   }
 
   m_settingsJournal =
-      new QSettings(m_settingsJournalFileName, m_settings.format(), this);
+      new QSettings(m_settingsJournalFileName, MozFormat, this);
 
   emit transactionBegan();
   return true;
@@ -298,7 +444,7 @@ bool SettingsHolder::rollbackTransaction() {
   QMapIterator<QString, QPair<const char*, QVariant>> i(transactionChanges);
   while (i.hasNext()) {
     i.next();
-    m_settings.setValue(i.key(), i.value().second);
+    setSettingValue(i.key(), i.value().second);
     QMetaObject::invokeMethod(this, i.value().first, Qt::DirectConnection);
   }
 
@@ -9,8 +9,12 @@
 #include <QMap>
 #include <QObject>
 #include <QSettings>
+#include <QSet>
 #include <QStringList>
 
+#include "settingsblobstore.h"
+#include "settingsstore.h"
+
 class SettingsHolder final : public QObject {
   Q_OBJECT
   Q_DISABLE_COPY_MOVE(SettingsHolder)
@@ -99,6 +103,16 @@ class SettingsHolder final : public QObject {
 
   bool finalizeTransaction();
 
+  void applyLogLevels();
+
+  // All the reads and writes go through these, so that the large settings
+  // end up in the blob store.
+  QVariant settingValue(const QString& key) const;
+  void setSettingValue(const QString& key, const QVariant& value);
+  void removeSettingValue(const QString& key);
+  void initializeBlobStore();
+  void removeStaleBlobs();
+
   void maybeSaveInTransaction(const QString& key, const QVariant& oldValue,
                               const QVariant& newValue, const char* signalName,
                               bool userSettings);
@@ -115,9 +129,15 @@ class SettingsHolder final : public QObject {
   void transactionRolledBack();
 
  private:
-  QSettings m_settings;
+  SettingsStore m_settings;
   QString m_settingsJournalFileName;
 
+  QSet<QString> m_blobKeys;
+  mutable SettingsBlobStore m_blobStore;
+  // Blobs replaced since the last sync: the settings file on disk may still
+  // point to them.
+  QStringList m_staleBlobs;
+
   bool m_firstExecution = false;
 
   QSettings* m_settingsJournal = nullptr;
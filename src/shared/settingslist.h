@@ -15,6 +15,12 @@
 #define SETTING_BYTEARRAY(getter, ...) \
   SETTING(QByteArray, toByteArray, getter, __VA_ARGS__)
 
+// A large QByteArray, kept out of the settings file. See SettingsBlobStore.
+#ifndef SETTING_BLOB
+#  define SETTING_BLOB(getter, ...) \
+    SETTING(QByteArray, toByteArray, getter, __VA_ARGS__)
+#endif
+
 #define SETTING_DATETIME(getter, ...) \
   SETTING(QDateTime, toDateTime, getter, __VA_ARGS__)
 
@@ -39,5 +45,29 @@ SETTING_STRING(userEmail,        // getter
                true              // remove when reset
 )
 
+// Global log threshold: trace, debug, info, warning or error. Empty means
+// everything is logged.
+SETTING_STRING(logLevel,        // getter
+               setLogLevel,     // setter
+               removeLogLevel,  // remover
+               hasLogLevel,     // has
+               "logLevel",      // key
+               "",              // default value
+               false,           // user setting
+               false            // remove when reset
+)
+
+// Per-class log thresholds, as "ClassName:level" entries. They win over the
+// global one, so a single subsystem can be debugged.
+SETTING_STRINGLIST(logLevelOverrides,        // getter
+                   setLogLevelOverrides,     // setter
+                   removeLogLevelOverrides,  // remover
+                   hasLogLevelOverrides,     // has
+                   "logLevelOverrides",      // key
+                   QStringList(),            // default value
+                   false,                    // user setting
+                   false                     // remove when reset
+)
+
 // The app must implement its settings list file.
 #include "appsettingslist.h"
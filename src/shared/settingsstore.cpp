@@ -0,0 +1,269 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "settingsstore.h"
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QSaveFile>
+
+#include "leakdetector.h"
+#include "logger.h"
+
+namespace {
+Logger logger("SettingsStore");
+
+constexpr qint64 FLUSH_RATE_WINDOW_MSEC = 60 * 1000;
+}  // namespace
+
+// Lives in the writer thread.
+class SettingsStore::Writer final : public QObject {
+ public:
+  explicit Writer(QSettings::WriteFunc writeFunc) : m_writeFunc(writeFunc) {}
+
+  // Returns the number of bytes written, or -1.
+  qint64 write(const QString& fileName, const QSettings::SettingsMap& map) {
+    if (!QDir().mkpath(QFileInfo(fileName).path())) {
+      logger.error() << "Unable to create the directory for" << fileName;
+      return -1;
+    }
+
+    // QSaveFile writes into a temporary file and renames it on commit: the
+    // settings file is never left half-written.
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly) || !m_writeFunc(file, map)) {
+      logger.error() << "Unable to write" << fileName;
+      return -1;
+    }
+
+    qint64 size = file.pos();
+    if (!file.commit()) {
+      logger.error() << "Unable to commit" << fileName;
+      return -1;
+    }
+
+    return size;
+  }
+
+ private:
+  QSettings::WriteFunc m_writeFunc;
+};
+
+SettingsStore::SettingsStore(QSettings::Format format,
+                             QSettings::WriteFunc writeFunc,
+                             const QString& organization,
+                             const QString& application, QObject* parent)
+    : QObject(parent), m_organizationName(organization) {
+  MZ_COUNT_CTOR(SettingsStore);
+
+  // QSettings knows where the file lives on each platform, and how to read
+  // it. After that, the file is only written by us.
+  {
+    QSettings settings(format, QSettings::UserScope, organization,
+                       application);
+    // Only the keys of our own file: not the organization-wide or the system
+    // ones, which would be copied into it at the first write.
+    settings.setFallbacksEnabled(false);
+    m_fileName = settings.fileName();
+    m_status = settings.status();
+    for (const QString& key : settings.allKeys()) {
+      m_values.insert(key, settings.value(key));
+    }
+  }
+
+  m_clock.start();
+
+  m_flushTimer.setSingleShot(true);
+  connect(&m_flushTimer, &QTimer::timeout, this, &SettingsStore::flush);
+
+  m_writer = new Writer(writeFunc);
+
+#ifndef MZ_WASM
+  m_writer->moveToThread(&m_thread);
+  m_thread.setObjectName("SettingsStore");
+  m_thread.start(QThread::LowPriority);
+#endif
+}
+
+SettingsStore::~SettingsStore() {
+  MZ_COUNT_DTOR(SettingsStore);
+
+  sync();
+
+  m_thread.quit();
+  m_thread.wait();
+  delete m_writer;
+}
+
+void SettingsStore::setValue(const QString& key, const QVariant& value) {
+  auto i = m_values.find(key);
+  if (i != m_values.end() && i.value() == value) {
+    return;
+  }
+
+  m_values.insert(key, value);
+  markDirty();
+}
+
+void SettingsStore::remove(const QString& key) {
+  if (key.isEmpty()) {
+    clear();
+    return;
+  }
+
+  bool removed = m_values.remove(key) > 0;
+
+  QString prefix = key + '/';
+  for (auto i = m_values.lowerBound(prefix);
+       i != m_values.end() && i.key().startsWith(prefix);) {
+    i = m_values.erase(i);
+    removed = true;
+  }
+
+  if (removed) {
+    markDirty();
+  }
+}
+
+void SettingsStore::clear() {
+  if (m_values.isEmpty()) {
+    return;
+  }
+
+  m_values.clear();
+  markDirty();
+}
+
+QStringList SettingsStore::childKeys() const {
+  QStringList keys;
+  for (auto i = m_values.constBegin(); i != m_values.constEnd(); ++i) {
+    if (!i.key().contains('/')) {
+      keys.append(i.key());
+    }
+  }
+  return keys;
+}
+
+void SettingsStore::markDirty() {
+  if (!m_dirty) {
+    m_dirty = true;
+    m_dirtySince.start();
+  }
+
+  // SettingsHolder is created before the application: without an event
+  // dispatcher the timer would not fire. The superseded writes are skipped
+  // by the writer, so a burst of changes (a migration) stays cheap.
+  if (!QCoreApplication::instance()) {
+    flush();
+    return;
+  }
+
+  qint64 delay = std::min<qint64>(
+      FLUSH_DELAY_MSEC, MAX_FLUSH_DELAY_MSEC - m_dirtySince.elapsed());
+  m_flushTimer.start(static_cast<int>(std::max<qint64>(delay, 0)));
+}
+
+void SettingsStore::flush() {
+  m_flushTimer.stop();
+  if (!m_dirty) {
+    return;
+  }
+  m_dirty = false;
+
+  // The snapshot shares the data with m_values until the next change.
+  QSettings::SettingsMap snapshot = m_values;
+  QString fileName = m_fileName;
+  quint64 generation = ++m_generation;
+
+  auto write = [this, fileName, snapshot, generation]() {
+    if (generation != m_generation) {
+      return;
+    }
+    qint64 bytes = m_writer->write(fileName, snapshot);
+    recordWrite(bytes >= 0, bytes);
+  };
+
+  // Without threads (wasm), the write happens here.
+  if (m_writer->thread() == QThread::currentThread()) {
+    write();
+    return;
+  }
+
+  QMetaObject::invokeMethod(m_writer, write, Qt::QueuedConnection);
+}
+
+void SettingsStore::sync() {
+  flush();
+
+  // Wait for the writer to be done with everything queued so far.
+  if (m_writer->thread() != QThread::currentThread()) {
+    QMetaObject::invokeMethod(
+        m_writer, []() {}, Qt::BlockingQueuedConnection);
+  }
+}
+
+bool SettingsStore::writeCopy(const QString& fileName) {
+  QSettings::SettingsMap snapshot = m_values;
+  qint64 bytes = -1;
+
+  auto write = [this, &bytes, &fileName, &snapshot]() {
+    bytes = m_writer->write(fileName, snapshot);
+  };
+
+  if (m_writer->thread() == QThread::currentThread()) {
+    write();
+  } else {
+    QMetaObject::invokeMethod(m_writer, write, Qt::BlockingQueuedConnection);
+  }
+
+  return bytes >= 0;
+}
+
+void SettingsStore::recordWrite(bool ok, qint64 bytes) {
+  QMutexLocker lock(&m_statsMutex);
+
+  if (!ok) {
+    m_status = QSettings::AccessError;
+    return;
+  }
+
+  m_status = QSettings::NoError;
+  m_bytesWritten += bytes;
+  ++m_flushCount;
+
+  qint64 now = m_clock.elapsed();
+  m_recentFlushes.append(now);
+  while (m_recentFlushes.first() < now - FLUSH_RATE_WINDOW_MSEC) {
+    m_recentFlushes.removeFirst();
+  }
+}
+
+QSettings::Status SettingsStore::status() const {
+  QMutexLocker lock(&m_statsMutex);
+  return m_status;
+}
+
+quint64 SettingsStore::bytesWritten() const {
+  QMutexLocker lock(&m_statsMutex);
+  return m_bytesWritten;
+}
+
+quint64 SettingsStore::flushCount() const {
+  QMutexLocker lock(&m_statsMutex);
+  return m_flushCount;
+}
+
+int SettingsStore::flushesLastMinute() const {
+  QMutexLocker lock(&m_statsMutex);
+  qint64 since = m_clock.elapsed() - FLUSH_RATE_WINDOW_MSEC;
+  int count = 0;
+  for (qint64 timestamp : m_recentFlushes) {
+    if (timestamp >= since) {
+      ++count;
+    }
+  }
+  return count;
+}
@@ -0,0 +1,96 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef SETTINGSSTORE_H
+#define SETTINGSSTORE_H
+
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QObject>
+#include <QSettings>
+#include <QThread>
+#include <QTimer>
+#include <atomic>
+
+// The in-memory copy of a settings file, written behind.
+//
+// Reads and writes only touch the in-memory map. Changes are coalesced for a
+// short debounce window (never longer than MAX_FLUSH_DELAY_MSEC after the
+// first one), then a snapshot of the map is serialized by a worker thread
+// and atomically replaces the file. Only sync() and the destructor wait for
+// the file to be written. Before the QCoreApplication exists, there is no
+// event loop to debounce with, and each change is written at once.
+//
+// The API is the subset of QSettings used by SettingsHolder.
+class SettingsStore final : public QObject {
+  Q_OBJECT
+  Q_DISABLE_COPY_MOVE(SettingsStore)
+
+ public:
+  static constexpr int FLUSH_DELAY_MSEC = 500;
+  static constexpr int MAX_FLUSH_DELAY_MSEC = 5000;
+
+  SettingsStore(QSettings::Format format, QSettings::WriteFunc writeFunc,
+                const QString& organization, const QString& application,
+                QObject* parent = nullptr);
+  ~SettingsStore();
+
+  const QString& fileName() const { return m_fileName; }
+  const QString& organizationName() const { return m_organizationName; }
+
+  QVariant value(const QString& key) const { return m_values.value(key); }
+  bool contains(const QString& key) const { return m_values.contains(key); }
+  void setValue(const QString& key, const QVariant& value);
+
+  // Removes the key and all its sub-keys, like QSettings does.
+  void remove(const QString& key);
+  void clear();
+
+  QStringList allKeys() const { return m_values.keys(); }
+  QStringList childKeys() const;
+
+  // The status of the last write.
+  QSettings::Status status() const;
+
+  // Writes the pending changes and waits for the file to be written.
+  void sync();
+
+  // Writes the current content to another file, and waits for it.
+  bool writeCopy(const QString& fileName);
+
+  quint64 bytesWritten() const;
+  quint64 flushCount() const;
+  int flushesLastMinute() const;
+
+ private:
+  class Writer;
+
+  void markDirty();
+  void flush();
+  void recordWrite(bool ok, qint64 bytes);
+
+ private:
+  QString m_fileName;
+  QString m_organizationName;
+  QSettings::SettingsMap m_values;
+
+  bool m_dirty = false;
+  QElapsedTimer m_dirtySince;
+  QTimer m_flushTimer;
+
+  QThread m_thread;
+  Writer* m_writer = nullptr;
+
+  // Writes which are already superseded by a newer snapshot are skipped.
+  std::atomic<quint64> m_generation{0};
+
+  mutable QMutex m_statsMutex;
+  QSettings::Status m_status = QSettings::NoError;
+  quint64 m_bytesWritten = 0;
+  quint64 m_flushCount = 0;
+  QElapsedTimer m_clock;
+  QList<qint64> m_recentFlushes;
+};
+
+#endif  // SETTINGSSTORE_H
@@ -14,9 +14,12 @@ set_property(TARGET shared-sources PROPERTY INTERFACE_INCLUDE_DIRECTORIES
     ${CMAKE_CURRENT_SOURCE_DIR}/shared/glean
     ${CMAKE_CURRENT_BINARY_DIR}
 )
+target_link_libraries(shared-sources INTERFACE mpscqueue)
 
 # Shared components
 target_sources(shared-sources INTERFACE
+    ${CMAKE_CURRENT_SOURCE_DIR}/shared/cidrset.cpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/shared/cidrset.h
     ${CMAKE_CURRENT_SOURCE_DIR}/shared/constants.cpp
     ${CMAKE_CURRENT_SOURCE_DIR}/shared/constants.h
     ${CMAKE_CURRENT_SOURCE_DIR}/shared/cryptosettings.cpp
@@ -56,6 +59,8 @@ target_sources(shared-sources INTERFACE
     ${CMAKE_CURRENT_SOURCE_DIR}/shared/qmlengineholder.h
     ${CMAKE_CURRENT_SOURCE_DIR}/shared/qmlpath.cpp
     ${CMAKE_CURRENT_SOURCE_DIR}/shared/qmlpath.h
+    ${CMAKE_CURRENT_SOURCE_DIR}/shared/qmlpathindex.cpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/shared/qmlpathindex.h
     ${CMAKE_CURRENT_SOURCE_DIR}/shared/rfc/rfc1112.cpp
     ${CMAKE_CURRENT_SOURCE_DIR}/shared/rfc/rfc1112.h
     ${CMAKE_CURRENT_SOURCE_DIR}/shared/rfc/rfc1918.cpp
@@ -66,8 +71,12 @@ target_sources(shared-sources INTERFACE
     ${CMAKE_CURRENT_SOURCE_DIR}/shared/rfc/rfc4291.h
     ${CMAKE_CURRENT_SOURCE_DIR}/shared/rfc/rfc5735.cpp
     ${CMAKE_CURRENT_SOURCE_DIR}/shared/rfc/rfc5735.h
+    ${CMAKE_CURRENT_SOURCE_DIR}/shared/settingsblobstore.cpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/shared/settingsblobstore.h
     ${CMAKE_CURRENT_SOURCE_DIR}/shared/settingsholder.cpp
     ${CMAKE_CURRENT_SOURCE_DIR}/shared/settingsholder.h
+    ${CMAKE_CURRENT_SOURCE_DIR}/shared/settingsstore.cpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/shared/settingsstore.h
     ${CMAKE_CURRENT_SOURCE_DIR}/shared/simplenetworkmanager.cpp
     ${CMAKE_CURRENT_SOURCE_DIR}/shared/simplenetworkmanager.h
     ${CMAKE_CURRENT_SOURCE_DIR}/shared/task.h
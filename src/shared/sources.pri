@@ -3,6 +3,7 @@
 # file, You can obtain one at http://mozilla.org/MPL/2.0/.
 
 SOURCES += \
+        $$PWD/cidrset.cpp \
         $$PWD/constants.cpp \
         $$PWD/cryptosettings.cpp \
         $$PWD/curve25519.cpp \
@@ -24,12 +25,15 @@ SOURCES += \
         $$PWD/networkmanager.cpp \
         $$PWD/qmlengineholder.cpp \
         $$PWD/qmlpath.cpp \
+        $$PWD/qmlpathindex.cpp \
         $$PWD/rfc/rfc1112.cpp \
         $$PWD/rfc/rfc1918.cpp \
         $$PWD/rfc/rfc4193.cpp \
         $$PWD/rfc/rfc4291.cpp \
         $$PWD/rfc/rfc5735.cpp \
+        $$PWD/settingsblobstore.cpp \
         $$PWD/settingsholder.cpp \
+        $$PWD/settingsstore.cpp \
         $$PWD/simplenetworkmanager.cpp \
         $$PWD/taskscheduler.cpp \
         $$PWD/temporarydir.cpp \
@@ -37,6 +41,7 @@ SOURCES += \
         $$PWD/versionutils.cpp
 
 HEADERS += \
+        $$PWD/cidrset.h \
         $$PWD/constants.h \
         $$PWD/cryptosettings.h \
         $$PWD/curve25519.h \
@@ -55,12 +60,15 @@ HEADERS += \
         $$PWD/networkmanager.h \
         $$PWD/qmlengineholder.h \
         $$PWD/qmlpath.h \
+        $$PWD/qmlpathindex.h \
         $$PWD/rfc/rfc1112.h \
         $$PWD/rfc/rfc1918.h \
         $$PWD/rfc/rfc4193.h \
         $$PWD/rfc/rfc4291.h \
         $$PWD/rfc/rfc5735.h \
+        $$PWD/settingsblobstore.h \
         $$PWD/settingsholder.h \
+        $$PWD/settingsstore.h \
         $$PWD/simplenetworkmanager.h \
         $$PWD/task.h \
         $$PWD/taskscheduler.h \
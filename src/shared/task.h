@@ -24,6 +24,35 @@ class Task : public QObject {
     Reschedulable,
   };
 
+  // The resources a task needs. Tasks sharing at least one exclusive
+  // resource run one after the other, in the order they have been scheduled.
+  // The other ones run in parallel.
+  enum Resource {
+    ResourceController = 0x01,
+    ResourceAccount = 0x02,
+    ResourceAddons = 0x04,
+
+    // Shared: any number of read-only tasks run at the same time. Only the
+    // tasks needing every resource take it exclusively.
+    ResourceNetworkReadOnly = 0x08,
+
+    // Conflicts with any other task. This is the default.
+    ResourceAll = 0xFF,
+  };
+  Q_DECLARE_FLAGS(Resources, Resource)
+
+  // Queued tasks are started by priority, then in scheduling order.
+  enum Priority {
+    // Triggered by the user, who is waiting for the result.
+    PriorityInteractive,
+
+    // The default.
+    PriorityForeground,
+
+    // Housekeeping and refreshes.
+    PriorityBackground,
+  };
+
   explicit Task(const QString& name) : m_name(name) {}
   virtual ~Task() = default;
 
@@ -36,6 +65,19 @@ class Task : public QObject {
   // executed.
   virtual DeletePolicy deletePolicy() const { return Deletable; }
 
+  // Overwrite this method if the task can run next to tasks that do not
+  // touch the same resources.
+  virtual Resources resources() const { return ResourceAll; }
+
+  Priority priority() const { return m_priority; }
+  void setPriority(Priority priority) { m_priority = priority; }
+
+  // If set, a task still waiting in the queue after this many msecs is
+  // considered stale and dropped without running, whatever its DeletePolicy.
+  // Only set it on work that is safe to skip, such as periodic refreshes.
+  int deadlineMsec() const { return m_deadlineMsec; }
+  void setDeadlineMsec(int deadlineMsec) { m_deadlineMsec = deadlineMsec; }
+
  signals:
   void completed();
 
@@ -44,6 +86,10 @@ class Task : public QObject {
 
  private:
   QString m_name;
+  Priority m_priority = PriorityForeground;
+  int m_deadlineMsec = 0;
 };
 
+Q_DECLARE_OPERATORS_FOR_FLAGS(Task::Resources)
+
 #endif  // TASK_H
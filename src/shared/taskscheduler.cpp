@@ -5,6 +5,7 @@
 #include "taskscheduler.h"
 
 #include <QCoreApplication>
+#include <QJsonObject>
 #include <QTimer>
 
 #include "leakdetector.h"
@@ -13,6 +14,21 @@
 
 namespace {
 Logger logger("TaskScheduler");
+
+// The resources no other task can use while this one holds them.
+Task::Resources exclusiveResources(const Task* task) {
+  Task::Resources resources = task->resources();
+  if (resources == Task::ResourceAll) {
+    return resources;
+  }
+
+  return resources & ~Task::Resources(Task::ResourceNetworkReadOnly);
+}
+
+bool conflicts(const Task* a, const Task* b) {
+  return (exclusiveResources(a) & b->resources()) ||
+         (exclusiveResources(b) & a->resources());
+}
 }  // namespace
 
 // static
@@ -41,6 +57,28 @@ void TaskScheduler::forceDeleteTasks() {
   maybeCreate()->deleteTasksInternal(/* forced */ true);
 }
 
+// static
+QJsonObject TaskScheduler::metrics() {
+  TaskScheduler* scheduler = maybeCreate();
+
+  QJsonObject obj;
+  for (auto i = scheduler->m_metrics.constBegin();
+       i != scheduler->m_metrics.constEnd(); ++i) {
+    const Metrics& metrics = i.value();
+
+    QJsonObject task;
+    task["count"] = static_cast<qint64>(metrics.m_count);
+    task["queueMsec"] = metrics.m_queueMsec;
+    task["maxQueueMsec"] = metrics.m_maxQueueMsec;
+    task["runMsec"] = metrics.m_runMsec;
+    task["maxRunMsec"] = metrics.m_maxRunMsec;
+    task["dropped"] = static_cast<qint64>(metrics.m_dropped);
+    obj[i.key()] = task;
+  }
+
+  return obj;
+}
+
 // static
 TaskScheduler* TaskScheduler::maybeCreate() {
   static TaskScheduler* s_taskScheduler = nullptr;
@@ -52,48 +90,135 @@ TaskScheduler* TaskScheduler::maybeCreate() {
 
 TaskScheduler::TaskScheduler(QObject* parent) : QObject(parent) {
   MZ_COUNT_CTOR(TaskScheduler);
+  m_clock.start();
 }
 
 TaskScheduler::~TaskScheduler() { MZ_COUNT_DTOR(TaskScheduler); }
 
 void TaskScheduler::scheduleTaskInternal(Task* task) {
-  m_tasks.append(task);
+  // A task moves ahead of the queued tasks with a lower priority, but never
+  // ahead of a task it conflicts with: conflicting tasks always run in their
+  // scheduling order, whatever their priority.
+  qsizetype pos = m_tasks.length();
+  while (pos > 0) {
+    const Task* previous = m_tasks.at(pos - 1);
+    if (previous->priority() <= task->priority() || conflicts(previous, task)) {
+      break;
+    }
+    --pos;
+  }
+  m_tasks.insert(pos, task);
+
+  m_scheduledAt.insert(task, m_clock.elapsed());
   maybeRunTask();
 }
 
 void TaskScheduler::maybeRunTask() {
-  logger.debug() << "Tasks: " << m_tasks.size();
+  logger.debug() << "Tasks: " << m_tasks.size()
+                 << "running:" << m_running_tasks.size();
 
-  if (m_running_task || m_tasks.empty()) {
-    return;
+  dropStaleTasks();
+
+  // Running a task can complete it (and schedule or delete others) before
+  // run() returns. Let's compute the next runnable task every time.
+  while (Task* task = takeNextRunnableTask()) {
+    m_running_tasks.append(task);
+
+    qint64 now = m_clock.elapsed();
+    qint64 queueMsec = now - m_scheduledAt.take(task);
+    m_startedAt.insert(task, now);
+
+    Metrics& metrics = m_metrics[task->name()];
+    metrics.m_queueMsec += queueMsec;
+    metrics.m_maxQueueMsec = qMax(metrics.m_maxQueueMsec, queueMsec);
+
+    QObject::connect(task, &Task::completed, this,
+                     [this, task]() { taskCompleted(task); });
+
+    task->run();
   }
+}
 
-  m_running_task = m_tasks.takeFirst();
-  Q_ASSERT(m_running_task);
+Task* TaskScheduler::takeNextRunnableTask() {
+  // `used` are the resources held in any way, `exclusive` the ones that
+  // nobody else can take.
+  Task::Resources used;
+  Task::Resources exclusive;
+  for (Task* task : m_running_tasks) {
+    used |= task->resources();
+    exclusive |= exclusiveResources(task);
+  }
+
+  // A queued task keeps its resources busy for the tasks behind it: a task
+  // never overtakes a conflicting one scheduled before it.
+  for (qsizetype i = 0; i < m_tasks.length(); ++i) {
+    const Task* task = m_tasks.at(i);
+    if (!(exclusive & task->resources()) &&
+        !(used & exclusiveResources(task))) {
+      return m_tasks.takeAt(i);
+    }
+
+    used |= task->resources();
+    exclusive |= exclusiveResources(task);
+  }
+
+  return nullptr;
+}
+
+void TaskScheduler::dropStaleTasks() {
+  qint64 now = m_clock.elapsed();
+
+  QMutableListIterator<Task*> i(m_tasks);
+  while (i.hasNext()) {
+    Task* task = i.next();
+
+    if (task->deadlineMsec() <= 0 ||
+        now - m_scheduledAt.value(task) < task->deadlineMsec()) {
+      continue;
+    }
 
-  QObject::connect(m_running_task, &Task::completed, this,
-                   &TaskScheduler::taskCompleted);
+    logger.debug() << "Dropping stale task:" << task->name();
+    ++m_metrics[task->name()].m_dropped;
 
-  m_running_task->run();
+    m_scheduledAt.remove(task);
+    task->deleteLater();
+    i.remove();
+  }
 }
 
-void TaskScheduler::taskCompleted() {
-  Q_ASSERT(m_running_task);
+void TaskScheduler::taskCompleted(Task* task) {
+  if (!m_running_tasks.contains(task)) {
+    return;
+  }
+
+  qint64 runMsec = m_clock.elapsed() - m_startedAt.value(task);
+  Metrics& metrics = m_metrics[task->name()];
+  ++metrics.m_count;
+  metrics.m_runMsec += runMsec;
+  metrics.m_maxRunMsec = qMax(metrics.m_maxRunMsec, runMsec);
 
-  logger.debug() << "Task completed:" << m_running_task->name();
-  m_running_task->deleteLater();
-  m_running_task->disconnect();
-  m_running_task = nullptr;
+  logger.debug() << "Task completed:" << task->name() << "in" << runMsec
+                 << "msec";
+  removeRunningTask(task);
 
   maybeRunTask();
 }
 
+void TaskScheduler::removeRunningTask(Task* task) {
+  m_running_tasks.removeOne(task);
+  m_startedAt.remove(task);
+
+  task->deleteLater();
+  task->disconnect();
+}
+
 void TaskScheduler::deleteTasksInternal(bool forced) {
   QMutableListIterator<Task*> i(m_tasks);
   while (i.hasNext()) {
     Task* task = i.next();
 
     if (forced) {
+      m_scheduledAt.remove(task);
       task->deleteLater();
       i.remove();
       continue;
@@ -101,6 +226,7 @@ void TaskScheduler::deleteTasksInternal(bool forced) {
 
     switch (task->deletePolicy()) {
       case Task::Deletable:
+        m_scheduledAt.remove(task);
         task->deleteLater();
         i.remove();
         break;
@@ -110,6 +236,7 @@ void TaskScheduler::deleteTasksInternal(bool forced) {
         break;
 
       case Task::Reschedulable:
+        m_scheduledAt.remove(task);
         QTimer::singleShot(0, this,
                            [this, task]() { scheduleTaskInternal(task); });
         i.remove();
@@ -117,12 +244,11 @@ void TaskScheduler::deleteTasksInternal(bool forced) {
     }
   }
 
-  if (m_running_task) {
-    if (forced || m_running_task->deletePolicy() == Task::Deletable) {
-      m_running_task->cancel();
-      m_running_task->deleteLater();
-      m_running_task->disconnect();
-      m_running_task = nullptr;
+  const QList<Task*> runningTasks = m_running_tasks;
+  for (Task* task : runningTasks) {
+    if (forced || task->deletePolicy() == Task::Deletable) {
+      task->cancel();
+      removeRunningTask(task);
     }
   }
 
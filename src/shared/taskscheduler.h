@@ -5,6 +5,9 @@
 #ifndef TASKSCHEDULER_H
 #define TASKSCHEDULER_H
 
+#include <QElapsedTimer>
+#include <QHash>
+#include <QJsonObject>
 #include <QObject>
 
 class Task;
@@ -21,6 +24,9 @@ class TaskScheduler final : public QObject {
   // that the current tasks do not conflict with this one.
   static void scheduleTaskNow(Task* task);
 
+  // Queue-wait and run time per task name, in msecs.
+  static QJsonObject metrics();
+
  private:
   explicit TaskScheduler(QObject* parent);
   ~TaskScheduler();
@@ -31,12 +37,29 @@ class TaskScheduler final : public QObject {
   void deleteTasksInternal(bool forced);
 
   void maybeRunTask();
+  Task* takeNextRunnableTask();
+  void dropStaleTasks();
 
-  void taskCompleted();
+  void taskCompleted(Task* task);
+  void removeRunningTask(Task* task);
 
  private:
-  Task* m_running_task = nullptr;
+  QList<Task*> m_running_tasks;
   QList<Task*> m_tasks;
+
+  struct Metrics {
+    uint32_t m_count = 0;
+    qint64 m_queueMsec = 0;
+    qint64 m_maxQueueMsec = 0;
+    qint64 m_runMsec = 0;
+    qint64 m_maxRunMsec = 0;
+    uint32_t m_dropped = 0;
+  };
+
+  QElapsedTimer m_clock;
+  QHash<Task*, qint64> m_scheduledAt;
+  QHash<Task*, qint64> m_startedAt;
+  QHash<QString, Metrics> m_metrics;
 };
 
 #endif  // TASKSCHEDULER_H
@@ -26,6 +26,7 @@ unix {
 
 # Cross-platform entries go in here:
 include($$PWD/shared/sources.pri)
+include($$PWD/shared/mpscqueue/mpscqueue.pri)
 include($$PWD/apps/vpn/qmake/sources.pri)
 
 # Platform-specific entries:
@@ -245,6 +245,23 @@ module.exports = {
         `Command failed: ${json.error}`);
   },
 
+  async waitForQueryProperty(id, property, value, timeoutInMilliSecs = 30000) {
+    // The app replies as soon as the property changes, or after a timeout.
+    const deadline = Date.now() + timeoutInMilliSecs;
+    while (Date.now() < deadline) {
+      const json = await this._writeCommand(
+          `wait_for ${id} ${property} ${encodeURIComponent(value)}`);
+      assert(
+          json.type === 'wait_for' && !('error' in json),
+          `Command failed: ${json.error}`);
+      if (json.value) return;
+    }
+
+    const real = await this.getQueryProperty(id, property);
+    throw new Error(`Timeout for waitForQueryProperty - property: ${
+        property} - value: ${real} - expected: ${value}`);
+  },
+
   async waitForVPNProperty(id, property, value) {
     try {
       return this.waitForCondition(async () => {
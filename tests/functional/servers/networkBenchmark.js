@@ -7,6 +7,10 @@ const constants = require('../constants.js');
 
 // Mock server for VPN Network Benchmark:
 // https://github.com/mozilla-services/vpn-network-benchmark
+//
+// It also stands in for the download server.
+const DOWNLOAD_SIZE = 16 * 1024 * 1024;
+
 let server = null;
 module.exports = {
   start() {
@@ -14,6 +18,9 @@ module.exports = {
       'VPN Network Benchmark',
       constants.UPLOAD_BENCHMARK_PORT,
       {
+        GETs: {
+          '/download': {status: 200, bodyRaw: Buffer.alloc(DOWNLOAD_SIZE)},
+        },
         POSTs: {
           '/': {status: 200, body: {}},
         },
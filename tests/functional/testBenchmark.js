@@ -4,8 +4,20 @@
 
 const vpn = require('./helper.js');
 const assert = require('assert');
+const constants = require('./constants.js');
 const queries = require('./queries.js');
 
+// The connection is only as fast as its slowest direction.
+function expectedSpeed(downloadBps, uploadBps) {
+  if (downloadBps >= 25000000 && uploadBps >= 5000000) {
+    return 'SpeedFast';
+  }
+  if (downloadBps >= 10000000 && uploadBps >= 2000000) {
+    return 'SpeedMedium';
+  }
+  return 'SpeedSlow';
+}
+
 describe('Benchmark', function() {
   this.timeout(120000);
   this.ctx.authenticationNeeded = true;
@@ -35,12 +47,53 @@ describe('Benchmark', function() {
     let state = await vpn.getVPNProperty('VPNConnectionBenchmark', 'state');
     assert.strictEqual(state, 'StateReady');
 
+    assert.strictEqual(speed, expectedSpeed(downloadBps, uploadBps));
+
+    // Exit the benchmark
+    await vpn.waitForQueryAndClick(queries.screenHome.CONNECTION_INFO_TOGGLE);
+  });
+
+  it('Multi-stream benchmark on the local server', async () => {
+    await vpn.waitForQuery(queries.screenHome.CONTROLLER_TITLE.visible());
+    await vpn.activate(true);
+
+    // Download from the local stand-in, over 3 streams.
+    await vpn.setVPNProperty(
+        'VPNConnectionBenchmark', 'downloadUrl',
+        `http://localhost:${constants.UPLOAD_BENCHMARK_PORT}/download`);
+    await vpn.setVPNProperty('VPNConnectionBenchmark', 'streams', 3);
+
+    await vpn.waitForQueryAndClick(
+        queries.screenHome.CONNECTION_INFO_TOGGLE.visible());
+    await vpn.waitForCondition(async () => {
+      let state = await vpn.getVPNProperty('VPNConnectionBenchmark', 'state');
+      return state == 'StateRunning';
+    });
+    await vpn.waitForCondition(async () => {
+      let state = await vpn.getVPNProperty('VPNConnectionBenchmark', 'state');
+      return state != 'StateRunning';
+    });
+
+    assert.strictEqual(
+        await vpn.getVPNProperty('VPNConnectionBenchmark', 'state'),
+        'StateReady');
+
+    // The median is between the 10th and the 90th percentiles.
+    let downloadBps = parseInt(
+        await vpn.getVPNProperty('VPNConnectionBenchmark', 'downloadBps'));
+    let downloadBpsP10 = parseInt(
+        await vpn.getVPNProperty('VPNConnectionBenchmark', 'downloadBpsP10'));
+    let downloadBpsP90 = parseInt(
+        await vpn.getVPNProperty('VPNConnectionBenchmark', 'downloadBpsP90'));
+    assert(downloadBps > 0);
+    assert(downloadBpsP10 <= downloadBps);
+    assert(downloadBps <= downloadBpsP90);
+
+    let uploadBps = parseInt(
+        await vpn.getVPNProperty('VPNConnectionBenchmark', 'uploadBps'));
     assert.strictEqual(
-        speed,
-        (downloadBps >= 25000000 && uploadBps > 0) ?
-            'SpeedFast' :
-            ((downloadBps >= 10000000 && uploadBps > 0) ? 'SpeedMedium' :
-                                                          'SpeedSlow'));
+        await vpn.getVPNProperty('VPNConnectionBenchmark', 'speed'),
+        expectedSpeed(downloadBps, uploadBps));
 
     // Exit the benchmark
     await vpn.waitForQueryAndClick(queries.screenHome.CONNECTION_INFO_TOGGLE);
@@ -126,12 +179,7 @@ describe('Benchmark', function() {
     let state = await vpn.getVPNProperty('VPNConnectionBenchmark', 'state');
     assert.strictEqual(state, 'StateReady');
 
-    assert.strictEqual(
-        speed,
-        (downloadBps >= 25000000 && uploadBps > 0) ?
-            'SpeedFast' :
-            ((downloadBps >= 10000000 && uploadBps > 0) ? 'SpeedMedium' :
-                                                          'SpeedSlow'));
+    assert.strictEqual(speed, expectedSpeed(downloadBps, uploadBps));
 
     // Exit the benchmark
     await vpn.waitForQueryAndClick(queries.screenHome.CONNECTION_INFO_TOGGLE);
@@ -32,21 +32,16 @@ describe('Connectivity', function() {
     // await vpn.clickOnQuery(queries.screenHome.CONTROLLER_TOGGLE.visible());
     await vpn.activate();
 
-    await vpn.waitForCondition(async () => {
-      let connectingMsg = await vpn.getQueryProperty(
-          queries.screenHome.CONTROLLER_TITLE, 'text');
-      return connectingMsg === 'Connecting…';
-    });
+    await vpn.waitForQueryProperty(
+        queries.screenHome.CONTROLLER_TITLE, 'text', 'Connecting…');
 
     assert(
         await vpn.getQueryProperty(
             queries.screenHome.CONTROLLER_SUBTITLE, 'text') ===
         'Masking connection and location');
 
-    await vpn.waitForCondition(async () => {
-      return await vpn.getQueryProperty(
-                 queries.screenHome.CONTROLLER_TITLE, 'text') == 'VPN is on';
-    });
+    await vpn.waitForQueryProperty(
+        queries.screenHome.CONTROLLER_TITLE, 'text', 'VPN is on');
 
     assert((await vpn.getQueryProperty(
                 queries.screenHome.SECURE_AND_PRIVATE_SUBTITLE, 'text'))
@@ -65,18 +60,14 @@ describe('Connectivity', function() {
 
     await vpn.setSetting('connectionChangeNotification', 'true');
     await vpn.activate();
-    await vpn.waitForCondition(async () => {
-      return await vpn.getQueryProperty(
-                 queries.screenHome.CONTROLLER_TITLE, 'text') == 'VPN is on';
-    });
+    await vpn.waitForQueryProperty(
+        queries.screenHome.CONTROLLER_TITLE, 'text', 'VPN is on');
     await vpn.deactivate();
 
     // No test for disconnecting because often it's too fast to be tracked.
 
-    await vpn.waitForCondition(async () => {
-      return await vpn.getQueryProperty(
-                 queries.screenHome.CONTROLLER_TITLE, 'text') === 'VPN is off';
-    });
+    await vpn.waitForQueryProperty(
+        queries.screenHome.CONTROLLER_TITLE, 'text', 'VPN is off');
 
     assert(
         await vpn.getQueryProperty(
@@ -149,6 +149,11 @@ void NetworkRequest::sslErrors(const QList<QSslError>& errors) {
 
 void NetworkRequest::disableTimeout() {}
 
+// Any response which arrives is a 200. Its body tells the rest.
+int NetworkRequest::statusCode() const { return 200; }
+
+void NetworkRequest::abort() { m_aborted = true; }
+
 NetworkRequest* NetworkRequest::createForSentry(Task* parent,
                                                 const QByteArray& envelope) {
   Q_UNUSED(envelope);
@@ -6,6 +6,7 @@
 
 #include <QQmlApplicationEngine>
 #include <QTemporaryFile>
+#include <algorithm>
 
 #include "addons/addon.h"
 #include "addons/addonguide.h"
@@ -20,6 +21,7 @@
 #include "addons/conditionwatchers/addonconditionwatchertimeend.h"
 #include "addons/conditionwatchers/addonconditionwatchertimestart.h"
 #include "addons/conditionwatchers/addonconditionwatchertriggertimesecs.h"
+#include "addons/conditionwatchers/addontimerwheel.h"
 #include "feature.h"
 #include "glean/generated/metrics.h"
 #include "glean/glean.h"
@@ -506,6 +508,89 @@ void TestAddon::conditionWatcher_endTime() {
   QVERIFY(!acw->conditionApplied());
 }
 
+void TestAddon::conditionWatcher_timerWheel() {
+  AddonTimerWheel wheel;
+  QSignalSpy pendingSpy(&wheel, &AddonTimerWheel::pendingCountChanged);
+
+  qint64 now = QDateTime::currentSecsSinceEpoch();
+
+  // Deadlines at every level of the wheel, and one far in the future.
+  QList<qint64> deadlines;
+  for (qint64 delta : {1LL, 63LL, 64LL, 4000LL, 4000LL, 300000LL, 20000000LL,
+                       1000000LL, 1LL << 40}) {
+    deadlines.append(now + delta);
+  }
+
+  QList<qint64> fired;
+  for (qint64 deadline : deadlines) {
+    wheel.schedule(deadline, [&fired, deadline]() { fired.append(deadline); });
+  }
+  QCOMPARE(wheel.pendingCount(), deadlines.count());
+  QCOMPARE(pendingSpy.count(), deadlines.count());
+
+  quint64 id = wheel.schedule(now + 10, [&fired]() { fired.append(-1); });
+  wheel.cancel(id);
+  QCOMPARE(wheel.pendingCount(), deadlines.count());
+
+  // Nothing is due yet.
+  wheel.advanceTo(now);
+  QVERIFY(fired.isEmpty());
+
+  // The deadlines fire in order, once, and never early.
+  std::sort(deadlines.begin(), deadlines.end());
+  for (qint64 step : {1, 62, 1, 3000, 1000000, 30000000}) {
+    now += step;
+    wheel.advanceTo(now);
+
+    QList<qint64> expected;
+    for (qint64 deadline : deadlines) {
+      if (deadline <= now) expected.append(deadline);
+    }
+    QCOMPARE(fired, expected);
+  }
+  QCOMPARE(wheel.pendingCount(), 1);
+
+  // A suspended wheel does not fire by itself, but catches up on resume.
+  wheel.setSuspended(true);
+  QVERIFY(wheel.isSuspended());
+
+  bool due = false;
+  wheel.schedule(QDateTime::currentSecsSinceEpoch() - 1,
+                 [&due]() { due = true; });
+  QTest::qWait(100);
+  QVERIFY(!due);
+
+  wheel.setSuspended(false);
+  QVERIFY(due);
+  QCOMPARE(wheel.pendingCount(), 1);
+}
+
+void TestAddon::conditionWatcher_timerWheel_clockChange() {
+  AddonTimerWheel wheel;
+  qint64 now = QDateTime::currentSecsSinceEpoch();
+
+  QList<int> fired;
+  wheel.schedule(now + 100, [&fired]() { fired.append(1); });
+  wheel.schedule(now + 5000, [&fired]() { fired.append(2); });
+
+  // The clock goes forward.
+  wheel.advanceTo(now + 1000);
+  QCOMPARE(fired, QList<int>({1}));
+
+  // Then back: the new deadlines are not due before their time.
+  wheel.advanceTo(now);
+  wheel.schedule(now + 100, [&fired]() { fired.append(3); });
+  wheel.advanceTo(now + 99);
+  QCOMPARE(fired, QList<int>({1}));
+
+  wheel.advanceTo(now + 100);
+  QCOMPARE(fired, QList<int>({1, 3}));
+
+  wheel.advanceTo(now + 5000);
+  QCOMPARE(fired, QList<int>({1, 3, 2}));
+  QCOMPARE(wheel.pendingCount(), 0);
+}
+
 void TestAddon::guide_create_data() {
   QTest::addColumn<QString>("id");
   QTest::addColumn<QJsonObject>("content");
@@ -25,6 +25,8 @@ class TestAddon final : public TestHelper {
   void conditionWatcher_triggerTime();
   void conditionWatcher_startTime();
   void conditionWatcher_endTime();
+  void conditionWatcher_timerWheel();
+  void conditionWatcher_timerWheel_clockChange();
   void conditionWatcher_javascript();
 
   void guide_create_data();
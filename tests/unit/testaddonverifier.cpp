@@ -0,0 +1,159 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "testaddonverifier.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonObject>
+
+#include "addons/manager/addondirectory.h"
+#include "addons/manager/addonverifier.h"
+
+namespace {
+
+QByteArray sha256(const QByteArray& data) {
+  return QCryptographicHash::hash(data, QCryptographicHash::Sha256);
+}
+
+AddonData addonData(const QString& addonId, const QByteArray& data) {
+  return {sha256(data), addonId, nullptr};
+}
+
+}  // namespace
+
+void TestAddonVerifier::verify() {
+  AddonDirectory ad;
+  ad.reset();
+
+  QList<AddonData> addons;
+  for (int i = 0; i < 20; ++i) {
+    QString addonId = QString("addon%1").arg(i);
+    QByteArray data = QString("content of %1").arg(addonId).toUtf8();
+    QVERIFY(ad.writeToFile(AddonVerifier::fileName(addonId), data));
+    addons.append(addonData(addonId, data));
+  }
+
+  // A file with the wrong content and a missing file.
+  QVERIFY(ad.writeToFile(AddonVerifier::fileName("bad"), "bad"));
+  addons.append(addonData("bad", "good"));
+  addons.append(addonData("missing", "missing"));
+
+  AddonVerifier av;
+  QSet<QString> verified = av.verify(addons);
+  QCOMPARE(verified.count(), 20);
+  QVERIFY(verified.contains("addon0"));
+  QVERIFY(verified.contains("addon19"));
+  QVERIFY(!verified.contains("bad"));
+  QVERIFY(!verified.contains("missing"));
+
+  ad.reset();
+}
+
+void TestAddonVerifier::cache() {
+  AddonDirectory ad;
+  ad.reset();
+
+  QByteArray data("some content");
+  QVERIFY(ad.writeToFile(AddonVerifier::fileName("foo"), data));
+
+  QDir dir;
+  QVERIFY(ad.getDirectory(&dir));
+  QString filePath = dir.filePath(AddonVerifier::fileName("foo"));
+
+  {
+    AddonVerifier av;
+    QCOMPARE(av.verify({addonData("foo", data)}).count(), 1);
+  }
+
+  // Change the content in place, keeping the size and the modification time:
+  // the cached result is used, and the file is not read again.
+  QDateTime modified = QFileInfo(filePath).lastModified();
+  {
+    QFile file(filePath);
+    QVERIFY(file.open(QIODevice::ReadWrite));
+    file.write("SOME");
+    QVERIFY(file.flush());
+    QVERIFY(file.setFileTime(modified, QFileDevice::FileModificationTime));
+  }
+
+  {
+    AddonVerifier av;
+    QCOMPARE(av.verify({addonData("foo", data)}).count(), 1);
+  }
+
+  // Once the modification time changes, the file is hashed again.
+  {
+    QFile file(filePath);
+    QVERIFY(file.open(QIODevice::ReadWrite));
+    QVERIFY(file.setFileTime(modified.addSecs(10),
+                             QFileDevice::FileModificationTime));
+  }
+
+  {
+    AddonVerifier av;
+    QCOMPARE(av.verify({addonData("foo", data)}).count(), 0);
+  }
+
+  // A file written by the manager is known without reading it back.
+  QVERIFY(ad.writeToFile(AddonVerifier::fileName("foo"), "new content"));
+  {
+    AddonVerifier av;
+    av.remember("foo", sha256("new content"));
+  }
+
+  {
+    AddonVerifier av;
+    QCOMPARE(av.verify({addonData("foo", "new content")}).count(), 1);
+    av.forget("foo");
+  }
+
+  ad.reset();
+}
+
+void TestAddonVerifier::conditions() {
+  AddonDirectory ad;
+  ad.reset();
+
+  QByteArray data("some content");
+  QVERIFY(ad.writeToFile(AddonVerifier::fileName("foo"), data));
+
+  QJsonObject conditions;
+  conditions["locales"] = QJsonArray{"it"};
+
+  {
+    AddonVerifier av;
+    QCOMPARE(av.verify({addonData("foo", data)}).count(), 1);
+
+    QJsonObject obj;
+    QVERIFY(!av.conditions("foo", sha256(data), &obj));
+
+    av.setConditions("foo", conditions);
+    QVERIFY(av.conditions("foo", sha256(data), &obj));
+    QCOMPARE(obj, conditions);
+  }
+
+  {
+    AddonVerifier av;
+
+    // The conditions are persisted with the hash they belong to.
+    QJsonObject obj;
+    QVERIFY(av.conditions("foo", sha256(data), &obj));
+    QCOMPARE(obj, conditions);
+    QVERIFY(!av.conditions("foo", sha256("other content"), &obj));
+
+    // A new version of the addon has new conditions.
+    QVERIFY(ad.writeToFile(AddonVerifier::fileName("foo"), "other content"));
+    QCOMPARE(av.verify({addonData("foo", "other content")}).count(), 1);
+    QVERIFY(!av.conditions("foo", sha256("other content"), &obj));
+  }
+
+  ad.reset();
+}
+
+static TestAddonVerifier s_testAddonVerifier;
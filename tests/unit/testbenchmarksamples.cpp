@@ -0,0 +1,133 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "testbenchmarksamples.h"
+
+#include "connectionbenchmark/benchmarksamples.h"
+
+void TestBenchmarkSamples::percentile_data() {
+  QTest::addColumn<QList<quint64>>("values");
+  QTest::addColumn<int>("percent");
+  QTest::addColumn<quint64>("expected");
+
+  QList<quint64> values{50, 10, 40, 20, 30, 60, 100, 70, 90, 80};
+
+  QTest::addRow("empty") << QList<quint64>() << 50 << Q_UINT64_C(0);
+  QTest::addRow("single") << QList<quint64>{42} << 90 << Q_UINT64_C(42);
+  QTest::addRow("p0") << values << 0 << Q_UINT64_C(10);
+  QTest::addRow("p10") << values << 10 << Q_UINT64_C(10);
+  QTest::addRow("p11") << values << 11 << Q_UINT64_C(20);
+  QTest::addRow("p50") << values << 50 << Q_UINT64_C(50);
+  QTest::addRow("p90") << values << 90 << Q_UINT64_C(90);
+  QTest::addRow("p100") << values << 100 << Q_UINT64_C(100);
+}
+
+void TestBenchmarkSamples::percentile() {
+  QFETCH(QList<quint64>, values);
+  QFETCH(int, percent);
+  QFETCH(quint64, expected);
+
+  BenchmarkSamples samples;
+  for (quint64 value : values) {
+    samples.add(value);
+  }
+
+  QCOMPARE(samples.count(), static_cast<int>(values.count()));
+  QCOMPARE(samples.percentile(percent), expected);
+}
+
+void TestBenchmarkSamples::warmUp() {
+  BenchmarkThroughput throughput(250, 1000);
+  throughput.start(0);
+
+  // 1 Mbit/s during the warm-up, then 8 Mbit/s.
+  qint64 now = 0;
+  for (; now < 1000; now += 250) {
+    throughput.addBytes(31250);
+    throughput.sample(now + 250);
+  }
+  QVERIFY(throughput.samples().isEmpty());
+
+  for (; now < 3000; now += 250) {
+    throughput.addBytes(250000);
+    throughput.sample(now + 250);
+  }
+
+  QCOMPARE(throughput.samples().count(), 8);
+  QCOMPARE(throughput.bitsPerSec(), Q_UINT64_C(8000000));
+  QCOMPARE(throughput.percentile(10), Q_UINT64_C(8000000));
+  QCOMPARE(throughput.bytes(), static_cast<qint64>(4 * 31250 + 8 * 250000));
+}
+
+void TestBenchmarkSamples::shortIntervals() {
+  BenchmarkThroughput throughput(250, 0);
+  throughput.start(0);
+
+  // A late timer: the short interval is merged into the next one.
+  throughput.addBytes(1000);
+  throughput.sample(100);
+  QVERIFY(throughput.samples().isEmpty());
+
+  throughput.addBytes(1500);
+  throughput.sample(250);
+  QCOMPARE(throughput.samples().count(), 1);
+  QCOMPARE(throughput.bitsPerSec(), Q_UINT64_C(80000));
+
+  // Each sample only counts the bytes of its own interval.
+  throughput.addBytes(5000);
+  throughput.sample(500);
+  throughput.addBytes(2500);
+  throughput.sample(750);
+  QCOMPARE(throughput.samples().count(), 3);
+  QCOMPARE(throughput.percentile(0), Q_UINT64_C(80000));
+  QCOMPARE(throughput.percentile(100), Q_UINT64_C(160000));
+  QCOMPARE(throughput.bitsPerSec(), Q_UINT64_C(80000));
+}
+
+void TestBenchmarkSamples::shortTransfer() {
+  BenchmarkThroughput throughput(250, 2000);
+  throughput.start(1000);
+
+  // Over before the end of the warm-up: the average of the whole transfer.
+  throughput.addBytes(125000);
+  throughput.sample(1500);
+  throughput.addBytes(125000);
+  throughput.sample(1600);
+
+  QVERIFY(throughput.samples().isEmpty());
+  QCOMPARE(throughput.bitsPerSec(), Q_UINT64_C(3333333));
+  QCOMPARE(throughput.percentile(90), Q_UINT64_C(3333333));
+}
+
+void TestBenchmarkSamples::loadedLatency() {
+  BenchmarkLoadedLatency latency;
+
+  // The idle pings, before the transfers, do not count.
+  latency.addPing(20);
+  latency.addPing(20);
+  QCOMPARE(latency.count(), 0);
+  QCOMPARE(latency.median(), quint16(0));
+
+  // Under load, each round-trip time counts as it is: the bufferbloat spikes
+  // are in the p90, where a moving average would have smoothed them out.
+  latency.setLoaded(true);
+  for (qint64 msec : {30, 35, 40, 45, 50, 55, 60, 65, 400, 420}) {
+    latency.addPing(msec);
+  }
+  QCOMPARE(latency.count(), 10);
+  QCOMPARE(latency.median(), quint16(50));
+  QCOMPARE(latency.percentile(90), quint16(400));
+  QCOMPARE(latency.percentile(100), quint16(420));
+
+  // After the transfers.
+  latency.setLoaded(false);
+  latency.addPing(1000);
+  QCOMPARE(latency.count(), 10);
+
+  latency.clear();
+  QVERIFY(!latency.isLoaded());
+  QCOMPARE(latency.count(), 0);
+}
+
+static TestBenchmarkSamples s_testBenchmarkSamples;
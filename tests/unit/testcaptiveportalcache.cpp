@@ -0,0 +1,90 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "testcaptiveportalcache.h"
+
+#include "captiveportal/captiveportal.h"
+#include "captiveportal/captiveportalcache.h"
+
+using Result = CaptivePortalRequest::CaptivePortalResult;
+
+void TestCaptivePortalCache::lookup() {
+  CaptivePortalCache cache;
+  QCOMPARE(cache.lookup("WiFi/A", 0), Result::Failure);
+
+  cache.insert("WiFi/A", Result::NoPortal, 0);
+  cache.insert("WiFi/B", Result::PortalDetected, 0);
+  QCOMPARE(cache.lookup("WiFi/A", 1000), Result::NoPortal);
+  QCOMPARE(cache.lookup("WiFi/B", 1000), Result::PortalDetected);
+  QCOMPARE(cache.lookup("Ethernet/A", 1000), Result::Failure);
+
+  // A new verdict replaces the previous one.
+  cache.insert("WiFi/B", Result::NoPortal, 2000);
+  QCOMPARE(cache.lookup("WiFi/B", 3000), Result::NoPortal);
+  QCOMPARE(cache.count(), 2);
+
+  cache.clear();
+  QCOMPARE(cache.lookup("WiFi/A", 3000), Result::Failure);
+}
+
+void TestCaptivePortalCache::expiration() {
+  CaptivePortalCache cache;
+  cache.insert("WiFi/A", Result::NoPortal, 1000);
+  cache.insert("WiFi/B", Result::PortalDetected, 1000);
+
+  // Portals expire sooner.
+  qint64 now = 1000 + CAPTIVEPORTAL_PORTAL_CACHE_MSEC;
+  QCOMPARE(cache.lookup("WiFi/A", now - 1), Result::NoPortal);
+  QCOMPARE(cache.lookup("WiFi/B", now - 1), Result::PortalDetected);
+  QCOMPARE(cache.lookup("WiFi/A", now), Result::NoPortal);
+  QCOMPARE(cache.lookup("WiFi/B", now), Result::Failure);
+
+  now = 1000 + CAPTIVEPORTAL_NOPORTAL_CACHE_MSEC;
+  QCOMPARE(cache.lookup("WiFi/A", now - 1), Result::NoPortal);
+  QCOMPARE(cache.lookup("WiFi/A", now), Result::Failure);
+
+  // The expired verdicts are dropped when something new is stored.
+  cache.insert("WiFi/C", Result::NoPortal, now);
+  QCOMPARE(cache.count(), 1);
+}
+
+void TestCaptivePortalCache::failure() {
+  CaptivePortalCache cache;
+  cache.insert("WiFi/A", Result::Failure, 0);
+  QCOMPARE(cache.count(), 0);
+
+  // A failure does not invalidate what we knew.
+  cache.insert("WiFi/A", Result::PortalDetected, 0);
+  cache.insert("WiFi/A", Result::Failure, 1000);
+  QCOMPARE(cache.lookup("WiFi/A", 1000), Result::PortalDetected);
+}
+
+void TestCaptivePortalCache::unknownNetwork() {
+  CaptivePortalCache cache;
+  cache.insert(QString(), Result::NoPortal, 0);
+  QCOMPARE(cache.count(), 0);
+  QCOMPARE(cache.lookup(QString(), 0), Result::Failure);
+}
+
+void TestCaptivePortalCache::maxNetworks() {
+  CaptivePortalCache cache;
+  for (int i = 0; i < CAPTIVEPORTAL_CACHE_MAX_NETWORKS; ++i) {
+    cache.insert(QString("WiFi/%1").arg(i), Result::NoPortal, i);
+  }
+  QCOMPARE(cache.count(), CAPTIVEPORTAL_CACHE_MAX_NETWORKS);
+
+  // Updating a known network does not evict anything.
+  cache.insert("WiFi/5", Result::NoPortal, 100);
+  QCOMPARE(cache.count(), CAPTIVEPORTAL_CACHE_MAX_NETWORKS);
+  QCOMPARE(cache.lookup("WiFi/0", 100), Result::NoPortal);
+
+  // A new network evicts the verdict which expires first.
+  cache.insert("WiFi/new", Result::NoPortal, 200);
+  QCOMPARE(cache.count(), CAPTIVEPORTAL_CACHE_MAX_NETWORKS);
+  QCOMPARE(cache.lookup("WiFi/0", 200), Result::Failure);
+  QCOMPARE(cache.lookup("WiFi/1", 200), Result::NoPortal);
+  QCOMPARE(cache.lookup("WiFi/new", 200), Result::NoPortal);
+}
+
+static TestCaptivePortalCache s_testCaptivePortalCache;
@@ -0,0 +1,89 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "testcaptiveportalrequest.h"
+
+#include "captiveportal/captiveportalrequest.h"
+#include "networkrequest.h"
+#include "settingsholder.h"
+#include "tasks/function/taskfunction.h"
+
+using Result = CaptivePortalRequest::CaptivePortalResult;
+
+void TestCaptivePortalRequest::race_data() {
+  // One response per probed address, in the order they arrive. "!" is a
+  // network failure.
+  QTest::addColumn<QStringList>("responses");
+  QTest::addColumn<Result>("result");
+  QTest::addColumn<int>("aborted");
+
+  QTest::addRow("first no portal wins")
+      << QStringList{"success", "!", "!"} << Result::NoPortal << 2;
+  QTest::addRow("no portal after a failure")
+      << QStringList{"!", "success", "login"} << Result::NoPortal << 1;
+  QTest::addRow("first portal wins")
+      << QStringList{"login", "success"} << Result::PortalDetected << 1;
+  QTest::addRow("portal after failures")
+      << QStringList{"!", "!", "login"} << Result::PortalDetected << 0;
+  QTest::addRow("all failures")
+      << QStringList{"!", "!", "!"} << Result::Failure << 0;
+}
+
+void TestCaptivePortalRequest::race() {
+  QFETCH(QStringList, responses);
+  QFETCH(Result, result);
+  QFETCH(int, aborted);
+
+  SettingsHolder settingsHolder;
+
+  QStringList addresses;
+  for (const QString& response : responses) {
+    addresses.append(QString("10.0.0.%1").arg(addresses.count() + 1));
+    if (response == "!") {
+      TestHelper::networkConfig.append(TestHelper::NetworkConfig(
+          TestHelper::NetworkConfig::Failure, QByteArray()));
+    } else {
+      TestHelper::networkConfig.append(TestHelper::NetworkConfig(
+          TestHelper::NetworkConfig::Success, response.toUtf8()));
+    }
+  }
+  settingsHolder.setCaptivePortalIpv4Addresses(addresses);
+  settingsHolder.setCaptivePortalIpv6Addresses(QStringList());
+
+  TaskFunction task([]() {});
+  CaptivePortalRequest* request = new CaptivePortalRequest(&task);
+
+  QList<Result> results;
+  int abortedRequests = -1;
+
+  QEventLoop loop;
+  connect(request, &CaptivePortalRequest::completed, &loop,
+          [&](Result detected) {
+            results.append(detected);
+
+            // The other probes are aborted when the result is known.
+            abortedRequests = 0;
+            for (NetworkRequest* probe :
+                 task.findChildren<NetworkRequest*>()) {
+              if (probe->isAborted()) {
+                ++abortedRequests;
+              }
+            }
+
+            loop.exit();
+          });
+
+  request->run();
+  loop.exec();
+
+  // The responses of the aborted probes do not change anything.
+  QTest::qWait(10);
+
+  QCOMPARE(results.count(), 1);
+  QCOMPARE(results.first(), result);
+  QCOMPARE(abortedRequests, aborted);
+  QVERIFY(TestHelper::networkConfig.isEmpty());
+}
+
+static TestCaptivePortalRequest s_testCaptivePortalRequest;
@@ -0,0 +1,255 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "testcidrset.h"
+
+#include <QRandomGenerator>
+
+#include "cidrset.h"
+#include "helper.h"
+#include "ipaddress.h"
+#include "rfc/rfc1918.h"
+#include "rfc/rfc4193.h"
+
+namespace {
+
+QStringList toStringList(const QList<IPAddress>& list) {
+  QStringList result;
+  for (const IPAddress& ip : list) {
+    result.append(ip.toString());
+  }
+  return result;
+}
+
+// The exclusion as IPAddress used to compute it: one prefix split at a time.
+QList<IPAddress> excludeBySplitting(const QList<IPAddress>& sourceList,
+                                    const QList<IPAddress>& excludeList) {
+  QList<IPAddress> results = sourceList;
+  for (const IPAddress& exclude : excludeList) {
+    QList<IPAddress> newResults;
+    for (const IPAddress& ip : results) {
+      if (!ip.overlaps(exclude)) {
+        newResults.append(ip);
+      } else if (!ip.subnetOf(exclude)) {
+        newResults.append(ip.excludeAddresses(exclude));
+      }
+    }
+    results = newResults;
+  }
+  return results;
+}
+
+QList<IPAddress> randomRanges(int count, bool ipv6) {
+  QRandomGenerator rng(count);
+  QList<IPAddress> list;
+  for (int i = 0; i < count; ++i) {
+    if (ipv6) {
+      Q_IPV6ADDR raw;
+      for (int j = 0; j < 16; ++j) {
+        raw[j] = static_cast<quint8>(rng.bounded(256));
+      }
+      list.append(IPAddress(QHostAddress(raw), 128));
+    } else {
+      list.append(IPAddress(QHostAddress(rng.generate()), 32));
+    }
+  }
+  return list;
+}
+
+}  // namespace
+
+void TestCidrSet::prefix_data() {
+  QTest::addColumn<QString>("input");
+  QTest::addColumn<QString>("output");
+
+  QTest::addRow("ipv4") << "192.168.1.0/24"
+                        << "192.168.1.0/24";
+  QTest::addRow("ipv4 host bits") << "192.168.1.42/24"
+                                  << "192.168.1.0/24";
+  QTest::addRow("ipv4 host") << "10.1.2.3"
+                             << "10.1.2.3/32";
+  QTest::addRow("ipv4 world") << "0.0.0.0/0"
+                              << "0.0.0.0/0";
+  QTest::addRow("ipv6") << "fc00::/7"
+                        << "fc00::/7";
+  QTest::addRow("ipv6 host bits") << "2001:db8::1/64"
+                                  << "2001:db8::/64";
+  QTest::addRow("ipv6 low bits") << "2001:db8::1:2:3/120"
+                                 << "2001:db8::1:2:0/120";
+  QTest::addRow("ipv6 host") << "::1"
+                             << "::1/128";
+}
+
+void TestCidrSet::prefix() {
+  QFETCH(QString, input);
+  QFETCH(QString, output);
+
+  CidrPrefix prefix;
+  QVERIFY(CidrPrefix::fromIPAddress(IPAddress(input), prefix));
+  QCOMPARE(prefix.toIPAddress().toString(), output);
+
+  CidrPrefix copy;
+  QVERIFY(CidrPrefix::fromIPAddress(prefix.toIPAddress(), copy));
+  QVERIFY(copy == prefix);
+}
+
+void TestCidrSet::invalidPrefix() {
+  CidrPrefix prefix;
+  QVERIFY(!CidrPrefix::fromIPAddress(IPAddress(), prefix));
+
+  CidrSet set;
+  set.insert(IPAddress());
+  QVERIFY(set.isEmpty());
+}
+
+void TestCidrSet::exclude_data() {
+  QTest::addColumn<QString>("input");
+  QTest::addColumn<QStringList>("exclude");
+  QTest::addColumn<QStringList>("result");
+
+  QTest::addRow("world vs rfc1918 (part)")
+      << "0.0.0.0/0" << QStringList{"10.0.0.0/8"}
+      << QStringList{"0.0.0.0/5",   "8.0.0.0/7",  "11.0.0.0/8",
+                     "12.0.0.0/6",  "16.0.0.0/4", "32.0.0.0/3",
+                     "64.0.0.0/2",  "128.0.0.0/1"};
+
+  QTest::addRow("overlapping exclusions")
+      << "10.0.0.0/8" << QStringList{"10.0.0.0/9", "10.0.0.0/10"}
+      << QStringList{"10.128.0.0/9"};
+
+  QTest::addRow("disjoint")
+      << "10.0.0.0/8" << QStringList{"192.168.0.0/16", "fc00::/7"}
+      << QStringList{"10.0.0.0/8"};
+
+  QTest::addRow("everything") << "::/0" << QStringList{"::/0"}
+                              << QStringList{};
+
+  QTest::addRow("ipv6 world vs rfc4193")
+      << "::/0" << QStringList{"fc00::/7"}
+      << QStringList{"::/1",    "8000::/2", "c000::/3", "e000::/4",
+                     "f000::/5", "f800::/6", "fe00::/7"};
+}
+
+void TestCidrSet::exclude() {
+  QFETCH(QString, input);
+  QFETCH(QStringList, exclude);
+  QFETCH(QStringList, result);
+
+  QList<IPAddress> excludeList;
+  for (const QString& ip : exclude) {
+    excludeList.append(IPAddress(ip));
+  }
+
+  QList<IPAddress> list =
+      IPAddress::excludeAddresses({IPAddress(input)}, excludeList);
+  QCOMPARE(toStringList(list), result);
+}
+
+void TestCidrSet::aggregation() {
+  CidrSet set;
+  set.insert(IPAddress("10.0.0.0/9"));
+  set.insert(IPAddress("10.192.0.0/10"));
+  QCOMPARE(toStringList(set.toList()),
+           QStringList({"10.0.0.0/9", "10.192.0.0/10"}));
+
+  // The missing quarter completes the /8.
+  set.insert(IPAddress("10.128.0.0/10"));
+  QCOMPARE(toStringList(set.toList()), QStringList({"10.0.0.0/8"}));
+
+  // Smaller prefixes inside a covered one change nothing.
+  set.insert(IPAddress("10.1.2.3"));
+  QCOMPARE(toStringList(set.toList()), QStringList({"10.0.0.0/8"}));
+
+  // Splitting and merging back.
+  set.remove(IPAddress("10.1.2.3"));
+  QCOMPARE(set.toList().count(), 24);
+  set.insert(IPAddress("10.1.2.3"));
+  QCOMPARE(toStringList(set.toList()), QStringList({"10.0.0.0/8"}));
+
+  set.remove(IPAddress("10.0.0.0/8"));
+  QVERIFY(set.isEmpty());
+}
+
+void TestCidrSet::contains() {
+  CidrSet set = CidrSet::fromList(
+      {IPAddress("0.0.0.0/0"), IPAddress("2000::/3")});
+  set.remove(IPAddress("192.168.0.0/16"));
+
+  QVERIFY(set.contains(QHostAddress("1.1.1.1")));
+  QVERIFY(set.contains(QHostAddress("192.167.255.255")));
+  QVERIFY(!set.contains(QHostAddress("192.168.1.1")));
+  QVERIFY(set.contains(QHostAddress("2001:db8::1")));
+  QVERIFY(!set.contains(QHostAddress("fe80::1")));
+  QVERIFY(!set.contains(QHostAddress()));
+}
+
+void TestCidrSet::setOperations() {
+  CidrSet a = CidrSet::fromList({IPAddress("10.0.0.0/8")});
+  CidrSet b = CidrSet::fromList(
+      {IPAddress("10.128.0.0/9"), IPAddress("11.0.0.0/8")});
+
+  CidrSet united = a;
+  united.unite(b);
+  QCOMPARE(toStringList(united.toList()), QStringList({"10.0.0.0/7"}));
+
+  CidrSet subtracted = a;
+  subtracted.subtract(b);
+  QCOMPARE(toStringList(subtracted.toList()), QStringList({"10.0.0.0/9"}));
+
+  // (a ∪ b) - b - a is empty.
+  united.subtract(b);
+  united.subtract(a);
+  QVERIFY(united.isEmpty());
+}
+
+void TestCidrSet::matchesSubnetSplitting() {
+  QList<IPAddress> excludeIPv4 = RFC1918::ipv4();
+  excludeIPv4.append(randomRanges(64, false));
+  QList<IPAddress> excludeIPv6 = RFC4193::ipv6();
+  excludeIPv6.append(randomRanges(64, true));
+
+  QList<IPAddress> source = {IPAddress("0.0.0.0/0"), IPAddress("::/0")};
+  QList<IPAddress> exclude = excludeIPv4 + excludeIPv6;
+
+  // Both ways cover the same addresses, and the set's one is minimal.
+  CidrSet expected = CidrSet::fromList(excludeBySplitting(source, exclude));
+  QList<IPAddress> result = IPAddress::excludeAddresses(source, exclude);
+  QCOMPARE(toStringList(result), toStringList(expected.toList()));
+
+  for (const IPAddress& ip : exclude) {
+    QVERIFY(!expected.contains(ip.address()));
+  }
+}
+
+void TestCidrSet::benchmark_data() {
+  QTest::addColumn<int>("ranges");
+
+  QTest::addRow("16") << 16;
+  QTest::addRow("1024") << 1024;
+  QTest::addRow("4096") << 4096;
+}
+
+void TestCidrSet::benchmark() {
+  QFETCH(int, ranges);
+
+  // The user's exclusions, plus the local networks that Controller always
+  // excludes.
+  QList<IPAddress> excludeIPv4 = RFC1918::ipv4();
+  excludeIPv4.append(randomRanges(ranges / 2, false));
+  QList<IPAddress> excludeIPv6 = RFC4193::ipv6();
+  excludeIPv6.append(randomRanges(ranges / 2, true));
+
+  QList<IPAddress> allowedIPv4 = {IPAddress("0.0.0.0/0")};
+  QList<IPAddress> allowedIPv6 = {IPAddress("::/0")};
+
+  QList<IPAddress> list;
+  QBENCHMARK {
+    list = IPAddress::excludeAddresses(allowedIPv4, excludeIPv4);
+    list.append(IPAddress::excludeAddresses(allowedIPv6, excludeIPv6));
+  }
+
+  QVERIFY(!list.isEmpty());
+}
+
+static TestCidrSet s_testCidrSet;
@@ -0,0 +1,26 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "helper.h"
+
+class TestCidrSet final : public TestHelper {
+  Q_OBJECT
+
+ private slots:
+  void prefix_data();
+  void prefix();
+  void invalidPrefix();
+
+  void exclude_data();
+  void exclude();
+
+  void aggregation();
+  void contains();
+  void setOperations();
+
+  void matchesSubnetSplitting();
+
+  void benchmark_data();
+  void benchmark();
+};
@@ -0,0 +1,123 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "testendpointresolver.h"
+
+#include <QSignalSpy>
+
+#include "daemon/endpointresolver.h"
+
+namespace {
+QHostInfo hostInfo(QHostInfo::HostInfoError error,
+                   const QString& address = QString()) {
+  QHostInfo info;
+  info.setError(error);
+  if (!address.isEmpty()) {
+    info.setAddresses({QHostAddress(address)});
+  }
+  return info;
+}
+}  // namespace
+
+void TestEndpointResolver::retry() {
+  EndpointResolver resolver(nullptr);
+  resolver.testOverrideRetryDelay(1, 5);
+
+  int attempts = 0;
+  resolver.testOverrideLookup([&attempts](const QString&) {
+    // Transient failures first.
+    if (++attempts < 3) {
+      return hostInfo(QHostInfo::UnknownError);
+    }
+    return hostInfo(QHostInfo::NoError, "10.0.0.1");
+  });
+
+  QSignalSpy resolvedSpy(&resolver, &EndpointResolver::resolved);
+  QSignalSpy failedSpy(&resolver, &EndpointResolver::failed);
+
+  resolver.resolve("vpn.example.com");
+  // A second request for the same hostname joins the first one.
+  resolver.resolve("vpn.example.com");
+  QVERIFY(resolver.isResolving("vpn.example.com"));
+
+  QVERIFY(resolvedSpy.wait());
+  QCOMPARE(attempts, 3);
+  QCOMPARE(resolvedSpy.count(), 1);
+  QCOMPARE(resolvedSpy[0][0].toString(), "vpn.example.com");
+  QCOMPARE(resolvedSpy[0][1].value<QHostAddress>(), QHostAddress("10.0.0.1"));
+  QCOMPARE(failedSpy.count(), 0);
+  QVERIFY(!resolver.isResolving("vpn.example.com"));
+}
+
+void TestEndpointResolver::giveUp() {
+  EndpointResolver resolver(nullptr);
+  resolver.testOverrideRetryDelay(1, 5);
+
+  int attempts = 0;
+  resolver.testOverrideLookup([&attempts](const QString&) {
+    ++attempts;
+    return hostInfo(QHostInfo::UnknownError);
+  });
+
+  QSignalSpy resolvedSpy(&resolver, &EndpointResolver::resolved);
+  QSignalSpy failedSpy(&resolver, &EndpointResolver::failed);
+
+  resolver.resolve("vpn.example.com");
+
+  QVERIFY(failedSpy.wait());
+  QCOMPARE(attempts, ENDPOINT_LOOKUP_RETRIES + 1);
+  QCOMPARE(failedSpy.count(), 1);
+  QCOMPARE(failedSpy[0][0].toString(), "vpn.example.com");
+  QCOMPARE(resolvedSpy.count(), 0);
+  QVERIFY(!resolver.isResolving("vpn.example.com"));
+}
+
+void TestEndpointResolver::hostNotFound() {
+  EndpointResolver resolver(nullptr);
+  resolver.testOverrideRetryDelay(1, 5);
+
+  int attempts = 0;
+  resolver.testOverrideLookup([&attempts](const QString&) {
+    ++attempts;
+    return hostInfo(QHostInfo::HostNotFound);
+  });
+
+  QSignalSpy failedSpy(&resolver, &EndpointResolver::failed);
+
+  resolver.resolve("vpn.example.com");
+
+  // There is no point in retrying.
+  QVERIFY(failedSpy.wait());
+  QCOMPARE(attempts, 1);
+  QCOMPARE(failedSpy.count(), 1);
+}
+
+void TestEndpointResolver::cancel() {
+  EndpointResolver resolver(nullptr);
+  resolver.testOverrideRetryDelay(1, 5);
+
+  int attempts = 0;
+  resolver.testOverrideLookup([&attempts](const QString&) {
+    ++attempts;
+    return hostInfo(QHostInfo::UnknownError);
+  });
+
+  QSignalSpy resolvedSpy(&resolver, &EndpointResolver::resolved);
+  QSignalSpy failedSpy(&resolver, &EndpointResolver::failed);
+
+  resolver.resolve("vpn.example.com");
+  QTRY_VERIFY(attempts > 0);
+
+  // Cancelled while waiting to retry: nothing else happens.
+  resolver.cancelAll();
+  QVERIFY(!resolver.isResolving("vpn.example.com"));
+
+  int cancelledAttempts = attempts;
+  QTest::qWait(50);
+  QCOMPARE(attempts, cancelledAttempts);
+  QCOMPARE(resolvedSpy.count(), 0);
+  QCOMPARE(failedSpy.count(), 0);
+}
+
+static TestEndpointResolver s_testEndpointResolver;
@@ -0,0 +1,142 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "testgleanevents.h"
+
+#include <QJsonObject>
+#include <QThread>
+
+#include "glean/eventqueue.h"
+#include "glean/generated/metrics.h"
+#include "glean/glean.h"
+#include "settingsholder.h"
+#include "vpnglean.h"
+
+namespace {
+constexpr int EVENTS_PER_THREAD = 50;
+constexpr int THREADS = 4;
+
+void recordState(const QString& addonId, const QString& state) {
+  mozilla::glean::sample::addon_state_changed.record(
+      mozilla::glean::sample::AddonStateChangedExtra{
+          ._addonId = addonId,
+          ._state = state,
+      });
+}
+}  // namespace
+
+void TestGleanEvents::init() {
+  m_settingsHolder = new SettingsHolder();
+
+  // Note: on tests Glean::initialize clears Glean's storage.
+  VPNGlean::initialize();
+}
+
+void TestGleanEvents::cleanup() { delete m_settingsHolder; }
+
+void TestGleanEvents::order() {
+  recordState("a", "Installed");
+  recordState("a", "Enabled");
+  recordState("b", "Installed");
+
+  // The getters record what is still queued before reading.
+  QList<QJsonObject> values =
+      mozilla::glean::sample::addon_state_changed.testGetValue();
+  QCOMPARE(values.length(), 3);
+
+  QJsonObject extras = values[0]["extra"].toObject();
+  QCOMPARE(extras["addon_id"].toString(), "a");
+  QCOMPARE(extras["state"].toString(), "Installed");
+
+  extras = values[1]["extra"].toObject();
+  QCOMPARE(extras["addon_id"].toString(), "a");
+  QCOMPARE(extras["state"].toString(), "Enabled");
+
+  extras = values[2]["extra"].toObject();
+  QCOMPARE(extras["addon_id"].toString(), "b");
+  QCOMPARE(extras["state"].toString(), "Installed");
+
+  QCOMPARE(mozilla::glean::sample::addon_state_changed.testGetNumRecordedErrors(
+               ErrorType::InvalidValue),
+           0);
+}
+
+void TestGleanEvents::jsonExtras() {
+  // This is what QML does: the keys are interned, the values converted later.
+  mozilla::glean::sample::addon_state_changed.record(
+      QJsonObject{{"addon_id", "json"}, {"state", "Disabled"}});
+
+  const char* key = EventQueue::internKey("addon_id");
+  QVERIFY(EventQueue::internKey("addon_id") == key);
+
+  QList<QJsonObject> values =
+      mozilla::glean::sample::addon_state_changed.testGetValue();
+  QCOMPARE(values.length(), 1);
+
+  QJsonObject extras = values[0]["extra"].toObject();
+  QCOMPARE(extras["addon_id"].toString(), "json");
+  QCOMPARE(extras["state"].toString(), "Disabled");
+}
+
+void TestGleanEvents::threads() {
+  QList<QThread*> threads;
+  for (int t = 0; t < THREADS; ++t) {
+    threads.append(QThread::create([t]() {
+      for (int i = 0; i < EVENTS_PER_THREAD; ++i) {
+        recordState(QString::number(t), QString::number(i));
+      }
+    }));
+  }
+
+  for (QThread* thread : threads) {
+    thread->start();
+  }
+  for (QThread* thread : threads) {
+    QVERIFY(thread->wait());
+    delete thread;
+  }
+
+  QList<QJsonObject> values =
+      mozilla::glean::sample::addon_state_changed.testGetValue();
+  QCOMPARE(values.length(), THREADS * EVENTS_PER_THREAD);
+
+  // Nothing is lost, and the events of each thread keep their order.
+  QList<int> next(THREADS, 0);
+  for (const QJsonObject& value : values) {
+    QJsonObject extras = value["extra"].toObject();
+    int t = extras["addon_id"].toString().toInt();
+    QCOMPARE(extras["state"].toString().toInt(), next[t]);
+    ++next[t];
+  }
+
+  for (int t = 0; t < THREADS; ++t) {
+    QCOMPARE(next[t], EVENTS_PER_THREAD);
+  }
+}
+
+void TestGleanEvents::benchmark_data() {
+  QTest::addColumn<bool>("json");
+
+  QTest::addRow("struct") << false;
+  QTest::addRow("json") << true;
+}
+
+void TestGleanEvents::benchmark() {
+  QFETCH(bool, json);
+
+  // The cost of record() for the caller: the events are recorded later, by
+  // the telemetry thread.
+  QJsonObject jsonExtras{{"addon_id", "benchmark"}, {"state", "Enabled"}};
+  if (json) {
+    QBENCHMARK {
+      mozilla::glean::sample::addon_state_changed.record(jsonExtras);
+    }
+  } else {
+    QBENCHMARK { recordState("benchmark", "Enabled"); }
+  }
+
+  EventQueue::flush();
+}
+
+static TestGleanEvents s_testGleanEvents;
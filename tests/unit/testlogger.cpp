@@ -4,9 +4,16 @@
 
 #include "testlogger.h"
 
+#include <QDir>
+#include <QFile>
+#include <QStandardPaths>
+#include <QTemporaryDir>
+
+#include "appconstants.h"
 #include "helper.h"
 #include "logger.h"
 #include "loghandler.h"
+#include "mpscqueue.h"
 
 void TestLogger::logger() {
   Logger l("class");
@@ -42,4 +49,178 @@ void TestLogger::logHandler() {
   }
 }
 
+void TestLogger::logQueue() {
+  MpscQueue<QString> queue(3);
+  QCOMPARE(queue.capacity(), (size_t)4);
+  QVERIFY(queue.isEmpty());
+
+  for (int i = 0; i < 4; ++i) {
+    QVERIFY(queue.push(QString::number(i)));
+  }
+
+  // Full queue: the entry is rejected.
+  QVERIFY(!queue.push("dropped"));
+
+  QString value;
+  QVERIFY(queue.pop(value));
+  QCOMPARE(value, QString("0"));
+
+  // Room for one more.
+  QVERIFY(queue.push("4"));
+
+  for (int i = 1; i < 5; ++i) {
+    QVERIFY(queue.pop(value));
+    QCOMPARE(value, QString::number(i));
+  }
+
+  QVERIFY(queue.isEmpty());
+  QVERIFY(!queue.pop(value));
+}
+
+void TestLogger::binaryFormat() {
+  QList<LogHandler::Log> logs{
+      LogHandler::Log(Info, "Foo", "First message"),
+      LogHandler::Log(Warning, "Bar", QString::fromUtf8("Second \u00e9")),
+      LogHandler::Log(Error, "Foo", "Third message"),
+      LogHandler::Log(Debug, "file.cpp", "function", 42, "From Qt"),
+  };
+
+  QByteArray data("MZLOG\x01");
+  QSet<quint32> knownClassIds;
+  for (const LogHandler::Log& log : logs) {
+    LogHandler::serializeLog(data, log, knownClassIds);
+  }
+  QCOMPARE(knownClassIds.count(), 2);
+
+  QString expected;
+  {
+    QTextStream out(&expected);
+    for (const LogHandler::Log& log : logs) {
+      LogHandler::prettyOutput(out, log);
+    }
+  }
+
+  QString output;
+  {
+    QTextStream out(&output);
+    LogHandler::prettyOutputBinary(out, data);
+  }
+  QCOMPARE(output, expected);
+
+  // A truncated record is ignored.
+  output.clear();
+  {
+    QTextStream out(&output);
+    LogHandler::prettyOutputBinary(out, data.left(data.length() - 3));
+  }
+  QVERIFY(expected.startsWith(output));
+  QVERIFY(output.length() < expected.length());
+
+  // Not a binary log.
+  output.clear();
+  {
+    QTextStream out(&output);
+    LogHandler::prettyOutputBinary(out, "Hello world");
+  }
+  QVERIFY(output.isEmpty());
+}
+
+void TestLogger::logLevels() {
+  Logger a("classA");
+  Logger b("classB");
+
+  QVERIFY(a.isEnabled(Debug));
+  QVERIFY(b.isEnabled(Debug));
+
+  Logger::setLogLevel(Info);
+  QVERIFY(!a.isEnabled(Debug));
+  QVERIFY(a.isEnabled(Info));
+  QVERIFY(a.isEnabled(Error));
+  QVERIFY(!b.isEnabled(Debug));
+
+  // Disabled entries are discarded.
+  a.debug() << "This is not logged" << 42;
+
+  Logger::setClassLogLevel("classA", Trace);
+  QVERIFY(a.isEnabled(Debug));
+  QVERIFY(!b.isEnabled(Debug));
+
+  Logger::clearClassLogLevels();
+  QVERIFY(!a.isEnabled(Debug));
+
+  Logger::setLogLevel(Trace);
+  QVERIFY(a.isEnabled(Debug));
+  QVERIFY(b.isEnabled(Debug));
+
+  LogLevel level;
+  QVERIFY(Logger::parseLogLevel("Warning", level));
+  QCOMPARE(level, Warning);
+  QVERIFY(!Logger::parseLogLevel("verbose", level));
+}
+
+void TestLogger::logRotation() {
+  QTemporaryDir dir;
+  QVERIFY(dir.isValid());
+  LogHandler::setLocation(dir.path());
+
+  // Roughly 700KB of binary records: way more than the log budget.
+  Logger l("rotation");
+  for (int i = 0; i < 10000; ++i) {
+    l.info() << "Entry" << i << QString(40, 'x');
+
+    if (i % 500 == 0) {
+      LogHandler::flush();
+    }
+  }
+  LogHandler::flush();
+
+  QStringList files = QDir(dir.path()).entryList(QDir::Files);
+  QVERIFY(files.length() > 1);
+  QVERIFY(files.length() <= 4);
+
+  QString buffer;
+  {
+    QTextStream out(&buffer);
+    LogHandler::writeLogs(out);
+  }
+
+  // The oldest entries are gone, the newest ones are still there.
+  QVERIFY(!buffer.contains("Entry 0 x"));
+  QVERIFY(buffer.contains("Entry 9999 x"));
+
+  LogHandler::setLocation(
+      QStandardPaths::writableLocation(QStandardPaths::AppDataLocation));
+}
+
+void TestLogger::logRotationByAnotherProcess() {
+  QTemporaryDir dir;
+  QVERIFY(dir.isValid());
+  LogHandler::setLocation(dir.path());
+
+  Logger l("anotherProcess");
+  l.info() << "Before the rotation";
+  LogHandler::flush();
+
+  // Another process rotates the segments while our file is open.
+  QString fileName = QDir(dir.path()).filePath(AppConstants::LOG_FILE_NAME);
+  QVERIFY(QFile::rename(fileName, fileName + ".1"));
+
+  l.info() << "After the rotation";
+  LogHandler::flush();
+
+  // The new segment has its own copy of the class name.
+  QFile file(fileName);
+  QVERIFY(file.open(QIODevice::ReadOnly));
+  QString buffer;
+  {
+    QTextStream out(&buffer);
+    LogHandler::prettyOutputBinary(out, file.readAll());
+  }
+  QVERIFY(buffer.contains("(anotherProcess) Info: After the rotation"));
+  QVERIFY(!buffer.contains("Before the rotation"));
+
+  LogHandler::setLocation(
+      QStandardPaths::writableLocation(QStandardPaths::AppDataLocation));
+}
+
 static TestLogger s_testLogger;
@@ -11,4 +11,14 @@ class TestLogger final : public TestHelper {
   void logger();
 
   void logHandler();
+
+  void logQueue();
+
+  void binaryFormat();
+
+  void logLevels();
+
+  void logRotation();
+
+  void logRotationByAnotherProcess();
 };
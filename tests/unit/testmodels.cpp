@@ -4,6 +4,7 @@
 
 #include "testmodels.h"
 
+#include <QDataStream>
 #include <QJsonArray>
 #include <QJsonDocument>
 #include <QJsonObject>
@@ -14,11 +15,13 @@
 #include "models/device.h"
 #include "models/devicemodel.h"
 #include "models/keys.h"
+#include "models/location.h"
 #include "models/recentconnections.h"
 #include "models/servercity.h"
 #include "models/servercountry.h"
 #include "models/servercountrymodel.h"
 #include "models/serverdata.h"
+#include "models/serverlatencyhistory.h"
 #include "models/user.h"
 #include "settingsholder.h"
 
@@ -1680,6 +1683,242 @@ void TestModels::serverCountryModelPick() {
   }
 }
 
+void TestModels::serverCountryModelLatencyHistory() {
+  QJsonObject server;
+  server.insert("hostname", "hostname");
+  server.insert("ipv4_addr_in", "ipv4AddrIn");
+  server.insert("ipv4_gateway", "ipv4Gateway");
+  server.insert("ipv6_addr_in", "ipv6AddrIn");
+  server.insert("ipv6_gateway", "ipv6Gateway");
+  server.insert("public_key", "publicKey");
+  server.insert("weight", 1234);
+  server.insert("port_ranges", QJsonArray());
+
+  QJsonArray servers;
+  servers.append(server);
+
+  QJsonObject city;
+  city.insert("code", "serverCityCode");
+  city.insert("name", "serverCityName");
+  city.insert("latitude", 12.34);
+  city.insert("longitude", 34.56);
+  city.insert("servers", servers);
+
+  QJsonObject country;
+  country.insert("name", "serverCountryName");
+  country.insert("code", "serverCountryCode");
+  country.insert("cities", QJsonArray{city});
+
+  QJsonObject obj;
+  obj.insert("countries", QJsonArray{country});
+
+  QByteArray json = QJsonDocument(obj).toJson();
+
+  SettingsHolder settingsHolder;
+  SettingsHolder::instance()->setServers(json);
+
+  {
+    ServerCountryModel m;
+    QVERIFY(m.fromSettings());
+    QCOMPARE(m.latencyHistoryTimestamp(), (qint64)0);
+    QVERIFY(m.serverLatencyHistory("publicKey").isEmpty());
+
+    m.setServerLatency("publicKey", 40);
+    m.setServerLatency("publicKey", 80);
+    m.setServerLatencyLost("publicKey");
+
+    // Unknown servers are ignored.
+    m.setServerLatency("unknown", 10);
+    QVERIFY(m.serverLatencyHistory("unknown").isEmpty());
+
+    QCOMPARE(m.server("publicKey").latency(), (uint32_t)50);
+    QCOMPARE(m.serverLatencyHistory("publicKey").sampleCount(), 3);
+
+    m.saveLatencyHistory();
+    QVERIFY(m.latencyHistoryTimestamp() > 0);
+  }
+
+  // The history is restored before the first scan.
+  {
+    ServerCountryModel m;
+    QVERIFY(m.fromSettings());
+    QVERIFY(m.latencyHistoryTimestamp() > 0);
+    QCOMPARE(m.server("publicKey").latency(), (uint32_t)50);
+
+    ServerLatencyHistory history = m.serverLatencyHistory("publicKey");
+    QCOMPARE(history.sampleCount(), 3);
+    QCOMPARE(history.lossCount(), 1);
+    QCOMPARE(history.p50(), (uint32_t)40);
+    QCOMPARE(history.p95(), (uint32_t)80);
+  }
+
+  // Garbage is ignored.
+  {
+    SettingsHolder::instance()->setServerLatencyHistory("garbage");
+    ServerCountryModel m;
+    QVERIFY(m.fromSettings());
+    QCOMPARE(m.latencyHistoryTimestamp(), (qint64)0);
+    QCOMPARE(m.server("publicKey").latency(), (uint32_t)0);
+  }
+}
+
+void TestModels::serverCountryModelRecommendations() {
+  auto serverObj = [](const QString& publicKey) {
+    QJsonObject server;
+    server.insert("hostname", "hostname");
+    server.insert("ipv4_addr_in", "ipv4AddrIn");
+    server.insert("ipv4_gateway", "ipv4Gateway");
+    server.insert("ipv6_addr_in", "ipv6AddrIn");
+    server.insert("ipv6_gateway", "ipv6Gateway");
+    server.insert("public_key", publicKey);
+    server.insert("weight", 100);
+    server.insert("port_ranges", QJsonArray());
+    return server;
+  };
+
+  auto cityObj = [](const QString& name, double latitude, double longitude,
+                    const QJsonArray& servers) {
+    QJsonObject city;
+    city.insert("code", name.toLower());
+    city.insert("name", name);
+    city.insert("latitude", latitude);
+    city.insert("longitude", longitude);
+    city.insert("servers", servers);
+    return city;
+  };
+
+  QJsonObject de;
+  de.insert("name", "Germany");
+  de.insert("code", "de");
+  de.insert("cities",
+            QJsonArray{cityObj("Berlin", 52.52, 13.40,
+                               QJsonArray{serverObj("b1"), serverObj("b2")})});
+
+  QJsonObject us;
+  us.insert("name", "USA");
+  us.insert("code", "us");
+  us.insert("cities", QJsonArray{cityObj("New York", 40.71, -74.0,
+                                         QJsonArray{serverObj("n1")})});
+
+  QJsonObject obj;
+  obj.insert("countries", QJsonArray{de, us});
+
+  SettingsHolder settingsHolder;
+  Localizer l;
+
+  ServerCountryModel m;
+  QVERIFY(m.fromJson(QJsonDocument(obj).toJson()));
+
+  // Without latencies and without a location, we know nothing.
+  QVERIFY(m.recommendedCities(qQNaN(), qQNaN(), 3).isEmpty());
+  QVERIFY(m.recommendedLocations(3).isEmpty());
+  QCOMPARE(m.pickBest(Location()).length(), 3);
+
+  // Close to Berlin: distance wins.
+  QList<ServerCountryModel::CityRecommendation> list =
+      m.recommendedCities(52.0, 13.0, 3);
+  QCOMPARE(list.length(), 2);
+  QCOMPARE(list[0].cityName, "Berlin");
+  QCOMPARE(list[1].cityName, "New York");
+  QVERIFY(list[0].score < list[1].score);
+
+  Location location;
+  QVERIFY(location.fromJson(
+      "{\"city\":\"Berlin\",\"country\":\"de\",\"subdivision\":\"\","
+      "\"ip\":\"1.2.3.4\",\"lat_long\":\"52.0,13.0\"}"));
+  QCOMPARE(m.pickBest(location), QStringList({"de", "Berlin"}));
+
+  m.setClientLocation(location);
+  QVariantList variants = m.recommendedLocations(1);
+  QCOMPARE(variants.length(), 1);
+  QCOMPARE(variants[0].toMap()["countryCode"].toString(), "de");
+  QCOMPARE(variants[0].toMap()["cityName"].toString(), "Berlin");
+  QCOMPARE(variants[0].toMap()["code"].toString(), "berlin");
+
+  // Measured latencies beat the distance.
+  m.setServerLatency("b1", 200);
+  m.setServerLatency("b2", 200);
+  m.setServerLatency("n1", 10);
+  QCOMPARE(m.pickBest(location), QStringList({"us", "New York"}));
+
+  // Even without a location.
+  list = m.recommendedCities(qQNaN(), qQNaN(), 1);
+  QCOMPARE(list.length(), 1);
+  QCOMPARE(list[0].cityName, "New York");
+
+  // Servers on cooldown are skipped.
+  m.setServerCooldown("n1");
+  QCOMPARE(m.pickBest(location), QStringList({"de", "Berlin"}));
+  QCOMPARE(m.recommendedCities(52.0, 13.0, 3).length(), 1);
+}
+
+// ServerLatencyHistory
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+void TestModels::serverLatencyHistory() {
+  ServerLatencyHistory history;
+  QVERIFY(history.isEmpty());
+  QVERIFY(!history.hasLatency());
+  QCOMPARE(history.ewma(), (uint32_t)0);
+  QCOMPARE(history.p50(), (uint32_t)0);
+  QCOMPARE(history.lossRate(), 0.0);
+
+  history.addSample(100);
+  QCOMPARE(history.ewma(), (uint32_t)100);
+  QCOMPARE(history.p50(), (uint32_t)100);
+  QCOMPARE(history.p95(), (uint32_t)100);
+
+  history.addSample(200);
+  QCOMPARE(history.ewma(), (uint32_t)125);
+
+  // Only losses: the latency stats are unchanged.
+  history.addLoss();
+  history.addLoss();
+  QCOMPARE(history.sampleCount(), 4);
+  QCOMPARE(history.lossCount(), 2);
+  QCOMPARE(history.lossRate(), 0.5);
+  QCOMPARE(history.ewma(), (uint32_t)125);
+
+  // The ring wraps: the oldest samples, and losses, are evicted.
+  for (int i = 1; i <= ServerLatencyHistory::CAPACITY; ++i) {
+    history.addSample(i * 10);
+  }
+  QCOMPARE(history.sampleCount(), ServerLatencyHistory::CAPACITY);
+  QCOMPARE(history.lossCount(), 0);
+  QCOMPARE(history.p50(), (uint32_t)80);
+  QCOMPARE(history.p95(), (uint32_t)160);
+
+  history.addSample(1000);
+  QCOMPARE(history.p50(), (uint32_t)90);
+  QCOMPARE(history.percentile(90), (uint32_t)160);
+  QCOMPARE(history.p95(), (uint32_t)1000);
+
+  // Serialization
+  QByteArray data;
+  {
+    QDataStream stream(&data, QIODevice::WriteOnly);
+    stream << history;
+  }
+
+  ServerLatencyHistory copy;
+  {
+    QDataStream stream(data);
+    stream >> copy;
+    QCOMPARE(stream.status(), QDataStream::Ok);
+  }
+  QCOMPARE(copy.sampleCount(), history.sampleCount());
+  QCOMPARE(copy.ewma(), history.ewma());
+  QCOMPARE(copy.p50(), history.p50());
+  QCOMPARE(copy.p95(), history.p95());
+
+  // Truncated data
+  {
+    QDataStream stream(data.left(5));
+    stream >> copy;
+    QVERIFY(copy.isEmpty());
+  }
+}
+
 // ServerData
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
@@ -44,6 +44,10 @@ class TestModels final : public TestHelper {
   void serverCountryModelFromJson_data();
   void serverCountryModelFromJson();
   void serverCountryModelPick();
+  void serverCountryModelLatencyHistory();
+  void serverCountryModelRecommendations();
+
+  void serverLatencyHistory();
 
   void serverDataBasic();
   void serverDataMigrate();
@@ -0,0 +1,229 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "testpingscanner.h"
+
+#include <QElapsedTimer>
+#include <QSet>
+#include <QSignalSpy>
+#include <QUdpSocket>
+#include <QtEndian>
+
+#include "pingscanner.h"
+#include "pingsender.h"
+
+namespace {
+
+// A ping sender which bounces every ping off a UDP responder bound to the
+// loopback interface. Each datagram carries the destination and the sequence
+// number; the responder echoes it back unless the destination is in the
+// "unreachable" set.
+class LoopbackPingSender final : public PingSender {
+ public:
+  LoopbackPingSender() {
+    m_responder.bind(QHostAddress::LocalHost);
+    m_socket.bind(QHostAddress::LocalHost);
+
+    connect(&m_responder, &QUdpSocket::readyRead, this,
+            &LoopbackPingSender::respond);
+    connect(&m_socket, &QUdpSocket::readyRead, this,
+            &LoopbackPingSender::receive);
+  }
+
+  void sendPing(const QHostAddress& destination, quint16 sequence) override {
+    QByteArray data(6, 0);
+    qToBigEndian<quint32>(destination.toIPv4Address(), data.data());
+    qToBigEndian<quint16>(sequence, data.data() + 4);
+    m_socket.writeDatagram(data, QHostAddress::LocalHost,
+                           m_responder.localPort());
+    ++m_sent;
+  }
+
+  // Like a real sender handing a batch to the kernel, but the loopback
+  // socket buffers are small: pump the responder between chunks so that a
+  // large scan does not overflow them.
+  void sendPings(const QList<PingRequest>& requests) override {
+    for (qsizetype i = 0; i < requests.count(); ++i) {
+      sendPing(requests.at(i).destination, requests.at(i).sequence);
+      if ((i % 32) == 31) {
+        respond();
+        receive();
+      }
+    }
+  }
+
+  void setUnreachable(const QHostAddress& address) {
+    m_unreachable.insert(address);
+  }
+
+  int sent() const { return m_sent; }
+
+ private:
+  void respond() {
+    while (m_responder.hasPendingDatagrams()) {
+      QByteArray data(m_responder.pendingDatagramSize(), 0);
+      QHostAddress sender;
+      quint16 port;
+      m_responder.readDatagram(data.data(), data.size(), &sender, &port);
+
+      quint32 destination = qFromBigEndian<quint32>(data.constData());
+      if (!m_unreachable.contains(QHostAddress(destination))) {
+        m_responder.writeDatagram(data, sender, port);
+      }
+    }
+  }
+
+  void receive() {
+    while (m_socket.hasPendingDatagrams()) {
+      QByteArray data(m_socket.pendingDatagramSize(), 0);
+      m_socket.readDatagram(data.data(), data.size());
+      emit recvPing(qFromBigEndian<quint16>(data.constData() + 4));
+    }
+  }
+
+ private:
+  QUdpSocket m_socket;
+  QUdpSocket m_responder;
+  QSet<QHostAddress> m_unreachable;
+  int m_sent = 0;
+};
+
+QList<PingScanner::Target> generateTargets(int count) {
+  QList<PingScanner::Target> targets;
+  for (int i = 0; i < count; ++i) {
+    targets.append({QString("server-%1").arg(i),
+                    QHostAddress(static_cast<quint32>(0xC0A80000 + i))});
+  }
+  return targets;
+}
+
+}  // namespace
+
+void TestPingScanner::scan() {
+  LoopbackPingSender sender;
+  PingScanner scanner;
+  QSignalSpy latencySpy(&scanner, &PingScanner::latencyMeasured);
+  QSignalSpy timeoutSpy(&scanner, &PingScanner::pingTimedOut);
+  QSignalSpy finishedSpy(&scanner, &PingScanner::finished);
+
+  scanner.start(&sender, generateTargets(300));
+  QVERIFY(scanner.isActive());
+  QVERIFY(finishedSpy.wait());
+
+  QVERIFY(!scanner.isActive());
+  QCOMPARE(latencySpy.count(), 300);
+  QCOMPARE(timeoutSpy.count(), 0);
+  QCOMPARE(sender.sent(), 300);
+
+  QSet<QString> keys;
+  for (const QList<QVariant>& args : latencySpy) {
+    keys.insert(args.at(0).toString());
+  }
+  QCOMPARE(keys.count(), 300);
+
+  // An empty scan completes immediately.
+  scanner.start(&sender, QList<PingScanner::Target>());
+  QCOMPARE(finishedSpy.count(), 2);
+  QVERIFY(!scanner.isActive());
+}
+
+void TestPingScanner::timeouts() {
+  LoopbackPingSender sender;
+  QList<PingScanner::Target> targets = generateTargets(10);
+  sender.setUnreachable(targets.at(3).address);
+
+  PingScanner scanner;
+  scanner.setTimeoutMsec(100);
+  scanner.setMaxRetries(2);
+  QSignalSpy latencySpy(&scanner, &PingScanner::latencyMeasured);
+  QSignalSpy timeoutSpy(&scanner, &PingScanner::pingTimedOut);
+  QSignalSpy finishedSpy(&scanner, &PingScanner::finished);
+
+  scanner.start(&sender, targets);
+  QVERIFY(finishedSpy.wait());
+
+  QCOMPARE(latencySpy.count(), 9);
+  QCOMPARE(timeoutSpy.count(), 3);
+  for (const QList<QVariant>& args : timeoutSpy) {
+    QCOMPARE(args.at(0).toString(), targets.at(3).key);
+  }
+  QCOMPARE(sender.sent(), 12);
+}
+
+void TestPingScanner::pacing() {
+  LoopbackPingSender sender;
+  PingScanner scanner;
+  scanner.setPacingRate(1000);
+  QSignalSpy latencySpy(&scanner, &PingScanner::latencyMeasured);
+  QSignalSpy finishedSpy(&scanner, &PingScanner::finished);
+
+  QElapsedTimer timer;
+  timer.start();
+  scanner.start(&sender, generateTargets(PingScanner::MAX_BURST + 100));
+
+  // Only the burst goes out right away.
+  QCOMPARE(sender.sent(), PingScanner::MAX_BURST);
+
+  QVERIFY(finishedSpy.wait());
+  QCOMPARE(latencySpy.count(), PingScanner::MAX_BURST + 100);
+
+  // 100 more pings at 1000 pings per second.
+  QVERIFY(timer.elapsed() >= 90);
+}
+
+void TestPingScanner::staleReplies() {
+  LoopbackPingSender sender;
+  PingScanner scanner;
+  QSignalSpy latencySpy(&scanner, &PingScanner::latencyMeasured);
+  QSignalSpy finishedSpy(&scanner, &PingScanner::finished);
+
+  // Duplicated and unknown sequence numbers are ignored.
+  scanner.start(&sender, generateTargets(2));
+  emit sender.recvPing(1234);
+  QCOMPARE(latencySpy.count(), 0);
+
+  emit sender.recvPing(0);
+  emit sender.recvPing(0);
+  QCOMPARE(latencySpy.count(), 1);
+
+  // The real replies are still on their way: the first one is now a stale
+  // duplicate.
+  QVERIFY(finishedSpy.wait());
+  QCOMPARE(latencySpy.count(), 2);
+
+  // Replies from a previous scan do not match the new one.
+  scanner.start(&sender, generateTargets(1));
+  emit sender.recvPing(0);
+  QCOMPARE(latencySpy.count(), 2);
+  QVERIFY(finishedSpy.wait());
+  QCOMPARE(latencySpy.count(), 3);
+}
+
+void TestPingScanner::benchmark_data() {
+  QTest::addColumn<int>("servers");
+
+  QTest::addRow("64") << 64;
+  QTest::addRow("512") << 512;
+  QTest::addRow("2048") << 2048;
+}
+
+void TestPingScanner::benchmark() {
+  QFETCH(int, servers);
+
+  LoopbackPingSender sender;
+  PingScanner scanner;
+  QList<PingScanner::Target> targets = generateTargets(servers);
+  QSignalSpy latencySpy(&scanner, &PingScanner::latencyMeasured);
+  QSignalSpy finishedSpy(&scanner, &PingScanner::finished);
+
+  QBENCHMARK {
+    latencySpy.clear();
+    scanner.start(&sender, targets);
+    QVERIFY(finishedSpy.wait());
+  }
+
+  QCOMPARE(latencySpy.count(), servers);
+}
+
+static TestPingScanner s_testPingScanner;
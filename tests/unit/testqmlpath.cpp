@@ -8,6 +8,7 @@
 #include <QQuickItem>
 
 #include "qmlpath.h"
+#include "qmlpathindex.h"
 
 void TestQmlPath::parse_data() {
   QTest::addColumn<QString>("input");
@@ -176,6 +177,57 @@ void TestQmlPath::evaluate() {
     QFETCH(QString, name);
     QCOMPARE(output->objectName(), name);
   }
+
+  // The index gives the same results as the tree walk.
+  QmlPathIndex index(&engine);
+  QCOMPARE(qmlPath.evaluate(&engine, &index), output);
+}
+
+void TestQmlPath::index() {
+  QQmlApplicationEngine engine("qrc:a.qml");
+
+  QmlPathIndex index(&engine);
+  QCOMPARE(index.items("def").count(), 1);
+  QCOMPARE(index.items("rangeA").count(), 2);
+  QCOMPARE(index.items("artichoke").count(), 1);
+  QVERIFY(index.items("new").isEmpty());
+
+  QQuickItem* def = QmlPath("//def").evaluate(&engine, &index);
+  QVERIFY(def);
+
+  // New items are indexed when they are added to the tree.
+  int changed = 0;
+  connect(&index, &QmlPathIndex::changed, &index, [&]() { ++changed; });
+
+  QQuickItem* item = new QQuickItem();
+  item->setParentItem(def);
+  QCOMPARE(changed, 1);
+  QVERIFY(!QmlPath("//new").evaluate(&engine, &index));
+
+  item->setObjectName("new");
+  QCOMPARE(changed, 2);
+  QCOMPARE(index.items("new"), QList<QQuickItem*>{item});
+  QCOMPARE(QmlPath("//new").evaluate(&engine, &index), item);
+  QCOMPARE(QmlPath("/abc//new").evaluate(&engine, &index), item);
+  QCOMPARE(QmlPath("//def//new").evaluate(&engine, &index), item);
+  QVERIFY(!QmlPath("//foo//new").evaluate(&engine, &index));
+
+  // Children of new items too.
+  QQuickItem* child = new QQuickItem(item);
+  child->setObjectName("newChild");
+  QCOMPARE(QmlPath("//new//newChild").evaluate(&engine, &index), child);
+
+  item->setObjectName("renamed");
+  QVERIFY(index.items("new").isEmpty());
+  QVERIFY(!QmlPath("//new").evaluate(&engine, &index));
+  QCOMPARE(QmlPath("//renamed").evaluate(&engine, &index), item);
+
+  qsizetype count = index.count();
+  delete item;
+  QCOMPARE(index.count(), count - 2);
+  QVERIFY(index.items("renamed").isEmpty());
+  QVERIFY(index.items("newChild").isEmpty());
+  QVERIFY(!QmlPath("//renamed").evaluate(&engine, &index));
 }
 
 static TestQmlPath s_testQmlPath;
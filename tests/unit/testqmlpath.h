@@ -13,4 +13,6 @@ class TestQmlPath : public TestHelper {
 
   void evaluate_data();
   void evaluate();
+
+  void index();
 };
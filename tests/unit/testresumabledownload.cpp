@@ -0,0 +1,241 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "testresumabledownload.h"
+
+#include <QCryptographicHash>
+#include <QFile>
+#include <QNetworkAccessManager>
+#include <QRandomGenerator>
+#include <QRegularExpression>
+#include <QSignalSpy>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTemporaryDir>
+
+#include "helper.h"
+#include "update/resumabledownload.h"
+
+namespace {
+
+// A minimal HTTP server for a single file, which can drop the connection in
+// the middle of the body.
+class FileServer final {
+ public:
+  explicit FileServer(const QByteArray& content) : m_content(content) {
+    QObject::connect(&m_server, &QTcpServer::newConnection, &m_server,
+                     [this]() {
+                       while (QTcpSocket* socket =
+                                  m_server.nextPendingConnection()) {
+                         serve(socket);
+                       }
+                     });
+    m_server.listen(QHostAddress::LocalHost);
+  }
+
+  QUrl url() const {
+    return QUrl(QString("http://127.0.0.1:%1/file.bin")
+                    .arg(m_server.serverPort()));
+  }
+
+  // The next `count` responses stop after `bytes` bytes of body.
+  void dropAfter(int count, qint64 bytes) {
+    m_drops = count;
+    m_dropAfter = bytes;
+  }
+
+  bool m_ignoreRange = false;
+  bool m_notFound = false;
+  QList<QByteArray> m_ranges;
+
+ private:
+  void serve(QTcpSocket* socket) {
+    QObject::connect(socket, &QTcpSocket::disconnected, socket,
+                     &QObject::deleteLater);
+    QObject::connect(socket, &QTcpSocket::readyRead, socket, [this, socket]() {
+      m_buffer[socket].append(socket->readAll());
+      if (!m_buffer[socket].contains("\r\n\r\n")) {
+        return;
+      }
+      respond(socket, m_buffer.take(socket));
+    });
+  }
+
+  void respond(QTcpSocket* socket, const QByteArray& request) {
+    static const QRegularExpression rangeHeader(
+        "\r\nRange: bytes=(\\d+)-\r\n",
+        QRegularExpression::CaseInsensitiveOption);
+
+    QByteArray headers = "Connection: close\r\nETag: \"v1\"\r\n";
+
+    if (m_notFound) {
+      socket->write("HTTP/1.1 404 Not Found\r\n" + headers +
+                    "Content-Length: 0\r\n\r\n");
+      socket->disconnectFromHost();
+      return;
+    }
+
+    qint64 start = 0;
+    QRegularExpressionMatch match =
+        rangeHeader.match(QString::fromLatin1(request));
+    if (match.hasMatch()) {
+      m_ranges.append(match.captured(1).toLatin1());
+      if (!m_ignoreRange) {
+        start = match.captured(1).toLongLong();
+      }
+    }
+
+    QByteArray body = m_content.mid(start);
+    if (start > 0) {
+      socket->write("HTTP/1.1 206 Partial Content\r\n" + headers +
+                    "Content-Range: bytes " + QByteArray::number(start) + "-" +
+                    QByteArray::number(m_content.length() - 1) + "/" +
+                    QByteArray::number(m_content.length()) + "\r\n");
+    } else {
+      socket->write("HTTP/1.1 200 OK\r\n" + headers);
+    }
+    socket->write("Content-Length: " + QByteArray::number(body.length()) +
+                  "\r\n\r\n");
+
+    if (m_drops > 0) {
+      --m_drops;
+      body.truncate(m_dropAfter);
+    }
+
+    socket->write(body);
+    socket->disconnectFromHost();
+  }
+
+  QTcpServer m_server;
+  QByteArray m_content;
+  QHash<QTcpSocket*, QByteArray> m_buffer;
+  int m_drops = 0;
+  qint64 m_dropAfter = 0;
+};
+
+QByteArray randomContent(qint64 size) {
+  QByteArray content(size, Qt::Uninitialized);
+  QRandomGenerator generator(42);
+  for (qint64 i = 0; i < size; ++i) {
+    content[i] = static_cast<char>(generator.bounded(256));
+  }
+  return content;
+}
+
+QByteArray readFile(const QString& filePath) {
+  QFile file(filePath);
+  if (!file.open(QIODevice::ReadOnly)) {
+    return QByteArray();
+  }
+  return file.readAll();
+}
+
+}  // namespace
+
+void TestResumableDownload::complete() {
+  QByteArray content = randomContent(3 * 1024 * 1024);
+  FileServer server(content);
+
+  QTemporaryDir dir;
+  QVERIFY(dir.isValid());
+
+  QNetworkAccessManager manager;
+  ResumableDownload download(&manager, QNetworkRequest(server.url()),
+                             dir.filePath("file.bin"),
+                             QCryptographicHash::Sha512, nullptr);
+
+  QSignalSpy completedSpy(&download, &ResumableDownload::completed);
+  QSignalSpy failedSpy(&download, &ResumableDownload::failed);
+  download.start();
+
+  QVERIFY(completedSpy.wait(10000));
+  QCOMPARE(failedSpy.count(), 0);
+  QCOMPARE(completedSpy.at(0).at(0).toByteArray(),
+           QCryptographicHash::hash(content, QCryptographicHash::Sha512));
+  QCOMPARE(readFile(download.filePath()), content);
+  QCOMPARE(download.resumeCount(), 0);
+}
+
+void TestResumableDownload::resume() {
+  QByteArray content = randomContent(3 * 1024 * 1024);
+  FileServer server(content);
+  server.dropAfter(3, 700 * 1024);
+
+  QTemporaryDir dir;
+  QVERIFY(dir.isValid());
+
+  QNetworkAccessManager manager;
+  ResumableDownload download(&manager, QNetworkRequest(server.url()),
+                             dir.filePath("file.bin"),
+                             QCryptographicHash::Sha512, nullptr);
+  download.setRetryDelay(10);
+
+  QSignalSpy completedSpy(&download, &ResumableDownload::completed);
+  QSignalSpy failedSpy(&download, &ResumableDownload::failed);
+  download.start();
+
+  QVERIFY(completedSpy.wait(10000));
+  QCOMPARE(failedSpy.count(), 0);
+  QCOMPARE(completedSpy.at(0).at(0).toByteArray(),
+           QCryptographicHash::hash(content, QCryptographicHash::Sha512));
+  QCOMPARE(readFile(download.filePath()), content);
+
+  // Each drop resumes from where the previous response stopped.
+  QCOMPARE(download.resumeCount(), 3);
+  QCOMPARE(server.m_ranges,
+           QList<QByteArray>({QByteArray::number(700 * 1024),
+                              QByteArray::number(1400 * 1024),
+                              QByteArray::number(2100 * 1024)}));
+}
+
+void TestResumableDownload::rangeIgnored() {
+  QByteArray content = randomContent(1024 * 1024);
+  FileServer server(content);
+  server.m_ignoreRange = true;
+  server.dropAfter(1, 300 * 1024);
+
+  QTemporaryDir dir;
+  QVERIFY(dir.isValid());
+
+  QNetworkAccessManager manager;
+  ResumableDownload download(&manager, QNetworkRequest(server.url()),
+                             dir.filePath("file.bin"),
+                             QCryptographicHash::Sha512, nullptr);
+  download.setRetryDelay(10);
+
+  QSignalSpy completedSpy(&download, &ResumableDownload::completed);
+  download.start();
+
+  // The full response replaces what was received before.
+  QVERIFY(completedSpy.wait(10000));
+  QCOMPARE(completedSpy.at(0).at(0).toByteArray(),
+           QCryptographicHash::hash(content, QCryptographicHash::Sha512));
+  QCOMPARE(readFile(download.filePath()), content);
+  QCOMPARE(download.resumeCount(), 1);
+}
+
+void TestResumableDownload::notFound() {
+  FileServer server(QByteArray("content"));
+  server.m_notFound = true;
+
+  QTemporaryDir dir;
+  QVERIFY(dir.isValid());
+
+  QNetworkAccessManager manager;
+  ResumableDownload download(&manager, QNetworkRequest(server.url()),
+                             dir.filePath("file.bin"),
+                             QCryptographicHash::Sha512, nullptr);
+  download.setRetryDelay(10);
+
+  QSignalSpy completedSpy(&download, &ResumableDownload::completed);
+  QSignalSpy failedSpy(&download, &ResumableDownload::failed);
+  download.start();
+
+  QVERIFY(failedSpy.wait(10000));
+  QCOMPARE(completedSpy.count(), 0);
+  QCOMPARE(failedSpy.at(0).at(1).toInt(), 404);
+  QCOMPARE(server.m_ranges.count(), 0);
+}
+
+static TestResumableDownload s_testResumableDownload;
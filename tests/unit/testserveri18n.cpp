@@ -4,6 +4,7 @@
 
 #include "testserveri18n.h"
 
+#include "collator.h"
 #include "localizer.h"
 #include "serveri18n.h"
 #include "settingsholder.h"
@@ -30,4 +31,53 @@ void TestServerI18n::basic() {
   QCOMPARE(ServerI18N::translateCityName("au", "Sydney"), "Sydney_EN");
 }
 
+void TestServerI18n::regionFallback() {
+  SettingsHolder settingsHolder;
+  Localizer l;
+
+  // The region is dropped: sk-SK -> sk
+  settingsHolder.setLanguageCode("sk-SK");
+  QCOMPARE(ServerI18N::translateCountryName("au", "FOO"), "au_SK");
+  QCOMPARE(ServerI18N::translateCityName("au", "Melbourne"), "Melbourne_SK");
+
+  settingsHolder.setLanguageCode("en");
+  QCOMPARE(ServerI18N::translateCountryName("au", "FOO"), "au_EN");
+  QCOMPARE(ServerI18N::translateCityName("au", "Melbourne"), "Melbourne");
+
+  // Switching back to a language already seen.
+  settingsHolder.setLanguageCode("sk");
+  QCOMPARE(ServerI18N::translateCityName("au", "Sydney"), "Sydney_SK");
+}
+
+void TestServerI18n::collatorSort() {
+  struct Item {
+    QString m_name;
+    int m_id;
+  };
+
+  QList<Item> items{{"delta", 0}, {"Alpha", 1}, {"charlie", 2},
+                    {"bravo", 3}, {"alpha", 4}, {"Bravo", 5}};
+
+  int calls = 0;
+  Collator collator;
+  collator.sort(items, [&calls](const Item& item) {
+    ++calls;
+    return item.m_name;
+  });
+
+  // One name per item, whatever the number of comparisons.
+  QCOMPARE(calls, 6);
+
+  QStringList names;
+  for (const Item& item : items) {
+    names.append(item.m_name.toLower());
+  }
+  QCOMPARE(names, QStringList({"alpha", "alpha", "bravo", "bravo", "charlie",
+                               "delta"}));
+
+  for (int i = 1; i < items.count(); ++i) {
+    QVERIFY(collator.compare(items[i - 1].m_name, items[i].m_name) <= 0);
+  }
+}
+
 static TestServerI18n s_testServerI18n;
@@ -9,4 +9,6 @@ class TestServerI18n : public TestHelper {
 
  private slots:
   void basic();
+  void regionFallback();
+  void collatorSort();
 };
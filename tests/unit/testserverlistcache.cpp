@@ -0,0 +1,177 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "testserverlistcache.h"
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include "helper.h"
+#include "localizer.h"
+#include "models/servercountrymodel.h"
+#include "server/serverlistcache.h"
+#include "settingsholder.h"
+
+namespace {
+
+QJsonObject city(const QString& name, const QString& hostname) {
+  QJsonObject server;
+  server.insert("hostname", hostname);
+  server.insert("ipv4_addr_in", "1.2.3.4");
+  server.insert("ipv4_gateway", "10.0.0.1");
+  server.insert("ipv6_addr_in", "::1");
+  server.insert("ipv6_gateway", "fc00::1");
+  server.insert("public_key", hostname);
+  server.insert("weight", 100);
+  server.insert("port_ranges", QJsonArray());
+
+  QJsonObject obj;
+  obj.insert("code", name.toLower());
+  obj.insert("name", name);
+  obj.insert("latitude", 12.34);
+  obj.insert("longitude", 34.56);
+  obj.insert("servers", QJsonArray{server});
+  return obj;
+}
+
+QJsonObject country(const QString& code, const QJsonArray& cities) {
+  QJsonObject obj;
+  obj.insert("code", code);
+  obj.insert("name", code.toUpper());
+  obj.insert("cities", cities);
+  return obj;
+}
+
+QByteArray serverList(const QJsonArray& countries) {
+  QJsonObject obj;
+  obj.insert("countries", countries);
+  return QJsonDocument(obj).toJson();
+}
+
+QJsonObject parse(const QByteArray& response) {
+  QJsonDocument json = QJsonDocument::fromJson(response);
+  Q_ASSERT(json.isObject());
+  return json.object();
+}
+
+}  // namespace
+
+void TestServerListCache::full() {
+  SettingsHolder settingsHolder;
+  Localizer l;
+
+  ServerCountryModel model;
+  QVERIFY(model.fromJson(serverList(
+      {country("de", {city("Berlin", "de1")}),
+       country("it", {city("Rome", "it1"), city("Milan", "it2")})})));
+
+  ServerListCache cache(&model);
+  QJsonObject obj = parse(cache.response(QString()));
+
+  QCOMPARE(obj["t"].toString(), "servers");
+  QCOMPARE(obj["version"].toString(), cache.version());
+  QVERIFY(!cache.version().isEmpty());
+
+  QJsonArray countries = obj["servers"].toObject()["countries"].toArray();
+  QCOMPARE(countries.count(), 2);
+  QCOMPARE(countries[0].toObject()["code"].toString(), "de");
+  QCOMPARE(countries[1].toObject()["code"].toString(), "it");
+
+  QJsonArray cities = countries[1].toObject()["cities"].toArray();
+  QCOMPARE(cities.count(), 2);
+  QJsonObject server =
+      cities[1].toObject()["servers"].toArray()[0].toObject();
+  QCOMPARE(server["hostname"].toString(), "it2");
+  QCOMPARE(server["ipv4_gateway"].toString(), "10.0.0.1");
+  QCOMPARE(server["ipv6_gateway"].toString(), "fc00::1");
+  QCOMPARE(server["weight"].toInt(), 100);
+
+  // The same bytes are returned until the model changes.
+  QCOMPARE(cache.response(QString()), cache.response(QString()));
+}
+
+void TestServerListCache::notModified() {
+  SettingsHolder settingsHolder;
+  Localizer l;
+
+  ServerCountryModel model;
+  QVERIFY(model.fromJson(serverList({country("de", {city("Berlin", "de1")})})));
+
+  ServerListCache cache(&model);
+  QString version = cache.version();
+
+  QJsonObject obj = parse(cache.response(version));
+  QCOMPARE(obj["t"].toString(), "servers");
+  QCOMPARE(obj["notModified"].toBool(), true);
+  QCOMPARE(obj["version"].toString(), version);
+  QVERIFY(!obj.contains("servers"));
+
+  // A new list with the same content keeps the version.
+  QVERIFY(model.fromJson(serverList({country("de", {city("Berlin", "de1")})})
+                             .replace("\n", "\r\n")));
+  QCOMPARE(cache.version(), version);
+  QCOMPARE(parse(cache.response(version))["notModified"].toBool(), true);
+}
+
+void TestServerListCache::delta() {
+  SettingsHolder settingsHolder;
+  Localizer l;
+
+  ServerCountryModel model;
+  QJsonArray countries;
+  for (const QString& code : {"at", "de", "fr", "it", "nl", "se"}) {
+    countries.append(country(code, {city(code + "city", code + "1")}));
+  }
+  QVERIFY(model.fromJson(serverList(countries)));
+
+  ServerListCache cache(&model);
+  QString oldVersion = cache.version();
+
+  // One country changes, one is removed and one is added.
+  countries.replace(1, country("de", {city("Berlin", "de1"),
+                                      city("Frankfurt", "de2")}));
+  countries.removeAt(4);
+  countries.append(country("ch", {city("Zurich", "ch1")}));
+  QVERIFY(model.fromJson(serverList(countries)));
+
+  QString newVersion = cache.version();
+  QVERIFY(newVersion != oldVersion);
+
+  QJsonObject obj = parse(cache.response(oldVersion));
+  QCOMPARE(obj["t"].toString(), "servers");
+  QCOMPARE(obj["version"].toString(), newVersion);
+  QVERIFY(!obj.contains("servers"));
+
+  QJsonObject delta = obj["delta"].toObject();
+  QCOMPARE(delta["base"].toString(), oldVersion);
+
+  QJsonArray changed = delta["countries"].toArray();
+  QCOMPARE(changed.count(), 2);
+  QCOMPARE(changed[0].toObject()["code"].toString(), "de");
+  QCOMPARE(changed[0].toObject()["cities"].toArray().count(), 2);
+  QCOMPARE(changed[1].toObject()["code"].toString(), "ch");
+
+  QCOMPARE(delta["removed"].toArray(), QJsonArray{"nl"});
+  QCOMPARE(delta["order"].toArray(),
+           QJsonArray({"at", "de", "fr", "it", "se", "ch"}));
+
+  // The current version is not modified.
+  QCOMPARE(parse(cache.response(newVersion))["notModified"].toBool(), true);
+}
+
+void TestServerListCache::unknownVersion() {
+  SettingsHolder settingsHolder;
+  Localizer l;
+
+  ServerCountryModel model;
+  QVERIFY(model.fromJson(serverList({country("de", {city("Berlin", "de1")})})));
+
+  ServerListCache cache(&model);
+  QJsonObject obj = parse(cache.response("0123456789abcdef"));
+  QCOMPARE(obj["version"].toString(), cache.version());
+  QCOMPARE(obj["servers"].toObject()["countries"].toArray().count(), 1);
+}
+
+static TestServerListCache s_testServerListCache;
@@ -4,8 +4,33 @@
 
 #include "testsettings.h"
 
+#include <QDataStream>
+#include <QDir>
+#include <QFileInfo>
+#include <QScopeGuard>
+
 #include "helper.h"
 #include "settingsholder.h"
+#include "settingsstore.h"
+
+namespace {
+
+bool readStoreFile(QIODevice& device, QSettings::SettingsMap& map) {
+  QDataStream stream(&device);
+  stream >> map;
+  return stream.status() == QDataStream::Ok;
+}
+
+bool writeStoreFile(QIODevice& device, const QSettings::SettingsMap& map) {
+  QDataStream stream(&device);
+  stream << map;
+  return stream.status() == QDataStream::Ok;
+}
+
+const QSettings::Format StoreFormat =
+    QSettings::registerFormat("storetest", readStoreFile, writeStoreFile);
+
+}  // namespace
 
 void TestSettings::transactionErrors() {
   SettingsHolder settingsHolder;
@@ -122,4 +147,117 @@ void TestSettings::transactionRollbackStartup() {
   }
 }
 
+void TestSettings::blobStore() {
+  QByteArray servers(256 * 1024, 'x');
+  QString settingsFileName;
+
+  auto blobs = [&]() {
+    QFileInfo info(settingsFileName);
+    return QDir(info.dir().filePath(info.completeBaseName() + ".blobs"))
+        .entryList(QDir::Files);
+  };
+
+  // Large values do not go into the settings file.
+  {
+    SettingsHolder settingsHolder;
+    settingsHolder.doNotClearOnDTOR();
+    settingsFileName = settingsHolder.settingsFileName();
+
+    settingsHolder.setServers(servers);
+    QCOMPARE(settingsHolder.servers(), servers);
+
+    settingsHolder.sync();
+    QVERIFY(QFileInfo(settingsFileName).size() < 4096);
+    QCOMPARE(blobs().count(), 1);
+  }
+
+  // The value is read back from the blob, and the replaced blob is removed
+  // once the settings file is written.
+  {
+    SettingsHolder settingsHolder;
+    settingsHolder.doNotClearOnDTOR();
+    QCOMPARE(settingsHolder.servers(), servers);
+
+    settingsHolder.setServers(QByteArray("new"));
+    settingsHolder.setServers(servers);
+    settingsHolder.setServers(QByteArray("newer"));
+    QCOMPARE(blobs().count(), 3);
+
+    settingsHolder.sync();
+    QCOMPARE(blobs().count(), 1);
+  }
+
+  // Reset removes the blobs too.
+  {
+    SettingsHolder settingsHolder;
+    QCOMPARE(settingsHolder.servers(), QByteArray("newer"));
+  }
+  QCOMPARE(blobs().count(), 0);
+}
+
+void TestSettings::storeWriteBehind() {
+  SettingsStore store(StoreFormat, writeStoreFile, "mozilla_testing",
+                      "settingsstore");
+  auto cleanup = qScopeGuard([&] { QFile::remove(store.fileName()); });
+
+  // A burst of changes is written once, after the debounce window.
+  for (int i = 0; i < 100; ++i) {
+    store.setValue(QString("key%1").arg(i), i);
+  }
+  store.setValue("group/a", 1);
+  store.setValue("group/b", 2);
+  store.remove("key0");
+
+  QCOMPARE(store.flushCount(), (quint64)0);
+  QCOMPARE(store.value("key1"), QVariant(1));
+  QVERIFY(!store.contains("key0"));
+
+  QTRY_COMPARE(store.flushCount(), (quint64)1);
+  QVERIFY(store.bytesWritten() > 0);
+  QCOMPARE(store.flushesLastMinute(), 1);
+  QCOMPARE(store.status(), QSettings::NoError);
+
+  // Setting the same value is not a change.
+  store.setValue("key1", 1);
+  QTest::qWait(SettingsStore::FLUSH_DELAY_MSEC * 2);
+  QCOMPARE(store.flushCount(), (quint64)1);
+
+  // Removing a group removes its keys.
+  QCOMPARE(store.childKeys().count(), 99);
+  store.remove("group");
+  QVERIFY(!store.contains("group/a"));
+  QVERIFY(!store.contains("group/b"));
+  QTRY_COMPARE(store.flushCount(), (quint64)2);
+}
+
+void TestSettings::storeSync() {
+  {
+    SettingsStore store(StoreFormat, writeStoreFile, "mozilla_testing",
+                        "settingsstore");
+    store.clear();
+    store.setValue("a", "A");
+    store.setValue("b/c", "C");
+
+    // sync() does not wait for the debounce window.
+    store.sync();
+    QCOMPARE(store.flushCount(), (quint64)1);
+
+    QString copy = store.fileName() + ".copy";
+    QVERIFY(store.writeCopy(copy));
+    QVERIFY(QFile::exists(copy));
+    QFile::remove(copy);
+
+    store.setValue("d", "D");
+  }
+
+  // The destructor writes the pending changes.
+  SettingsStore store(StoreFormat, writeStoreFile, "mozilla_testing",
+                      "settingsstore");
+  auto cleanup = qScopeGuard([&] { QFile::remove(store.fileName()); });
+  QCOMPARE(store.value("a"), QVariant("A"));
+  QCOMPARE(store.value("b/c"), QVariant("C"));
+  QCOMPARE(store.value("d"), QVariant("D"));
+  QCOMPARE(store.allKeys().count(), 3);
+}
+
 static TestSettings s_testSettings;
@@ -12,4 +12,9 @@ class TestSettings final : public TestHelper {
   void transactionCommit();
   void transactionRollback();
   void transactionRollbackStartup();
+
+  void blobStore();
+
+  void storeWriteBehind();
+  void storeSync();
 };
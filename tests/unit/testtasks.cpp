@@ -4,6 +4,8 @@
 
 #include "testtasks.h"
 
+#include <QJsonObject>
+
 #include "mozillavpn.h"
 #include "tasks/account/taskaccount.h"
 #include "tasks/adddevice/taskadddevice.h"
@@ -320,4 +322,207 @@ void TestTasks::forceDeleteTasks() {
   QCOMPARE(sequence.at(0), "t3");
 }
 
+namespace {
+// Completed by the test, when it calls finish().
+class TaskManual final : public Task {
+ public:
+  TaskManual(Task::Resources resources, QStringList* sequence,
+             const QString& name)
+      : Task("TaskManual"),
+        m_resources(resources),
+        m_sequence(sequence),
+        m_name(name) {}
+
+  void run() override { m_sequence->append(m_name + ":start"); }
+
+  void finish() {
+    m_sequence->append(m_name + ":end");
+    emit completed();
+  }
+
+  Resources resources() const override { return m_resources; }
+
+ private:
+  Task::Resources m_resources;
+  QStringList* m_sequence = nullptr;
+  QString m_name;
+};
+}  // namespace
+
+void TestTasks::resources() {
+  QStringList sequence;
+
+  // An addon task does not block the controller.
+  TaskManual* t1 = new TaskManual(Task::ResourceAddons, &sequence, "t1");
+  TaskScheduler::scheduleTask(t1);
+
+  TaskManual* t2 = new TaskManual(Task::ResourceController, &sequence, "t2");
+  TaskScheduler::scheduleTask(t2);
+
+  // But another controller task waits for t2.
+  TaskManual* t3 = new TaskManual(Task::ResourceController, &sequence, "t3");
+  TaskScheduler::scheduleTask(t3);
+
+  // Read-only tasks run together.
+  TaskManual* t4 =
+      new TaskManual(Task::ResourceNetworkReadOnly, &sequence, "t4");
+  TaskScheduler::scheduleTask(t4);
+
+  TaskManual* t5 =
+      new TaskManual(Task::ResourceNetworkReadOnly, &sequence, "t5");
+  TaskScheduler::scheduleTask(t5);
+
+  // A task without resource declaration waits for everything...
+  TaskManual* t6 = new TaskManual(Task::ResourceAll, &sequence, "t6");
+  TaskScheduler::scheduleTask(t6);
+
+  // ... and the read-only tasks scheduled after it wait for it.
+  TaskManual* t7 =
+      new TaskManual(Task::ResourceNetworkReadOnly, &sequence, "t7");
+  TaskScheduler::scheduleTask(t7);
+
+  QCOMPARE(sequence,
+           QStringList({"t1:start", "t2:start", "t4:start", "t5:start"}));
+  sequence.clear();
+
+  t2->finish();
+  QCOMPARE(sequence, QStringList({"t2:end", "t3:start"}));
+  sequence.clear();
+
+  t4->finish();
+  t5->finish();
+  t3->finish();
+  QCOMPARE(sequence, QStringList({"t4:end", "t5:end", "t3:end"}));
+  sequence.clear();
+
+  t1->finish();
+  QCOMPARE(sequence, QStringList({"t1:end", "t6:start"}));
+  sequence.clear();
+
+  t6->finish();
+  QCOMPARE(sequence, QStringList({"t6:end", "t7:start"}));
+  sequence.clear();
+
+  t7->finish();
+  QCOMPARE(sequence, QStringList({"t7:end"}));
+
+  QJsonObject metrics = TaskScheduler::metrics();
+  QVERIFY(metrics.contains("TaskManual"));
+  QCOMPARE(metrics["TaskManual"].toObject()["count"].toInt(), 7);
+}
+
+namespace {
+class TaskPriority final : public Task {
+ public:
+  TaskPriority(Task::Priority priority, Task::Resources resources,
+               QList<int>* sequence, int id)
+      : Task("TaskPriority"),
+        m_resources(resources),
+        m_sequence(sequence),
+        m_id(id) {
+    setPriority(priority);
+  }
+
+  void run() override {
+    m_sequence->append(m_id);
+    emit completed();
+  }
+
+  Resources resources() const override { return m_resources; }
+
+ private:
+  Task::Resources m_resources;
+  QList<int>* m_sequence = nullptr;
+  int m_id = 0;
+};
+}  // namespace
+
+void TestTasks::priorities() {
+  QList<int> sequence;
+
+  // The tasks are queued behind this one, and do not conflict with each
+  // other, except t2 and t5.
+  TaskFunction* task = new TaskFunction([&]() {
+    TaskScheduler::scheduleTask(new TaskPriority(
+        Task::PriorityBackground, Task::ResourceAddons, &sequence, 1));
+    TaskScheduler::scheduleTask(new TaskPriority(
+        Task::PriorityForeground, Task::ResourceAccount, &sequence, 2));
+    TaskScheduler::scheduleTask(new TaskPriority(
+        Task::PriorityInteractive, Task::ResourceController, &sequence, 3));
+    TaskScheduler::scheduleTask(new TaskPriority(
+        Task::PriorityBackground, Task::ResourceNetworkReadOnly, &sequence,
+        4));
+    TaskScheduler::scheduleTask(new TaskPriority(
+        Task::PriorityForeground, Task::ResourceAccount, &sequence, 5));
+  });
+
+  TaskScheduler::scheduleTask(task);
+
+  QCOMPARE(sequence, QList<int>({3, 2, 5, 1, 4}));
+}
+
+void TestTasks::priorities_conflicts() {
+  QList<int> sequence;
+
+  TaskFunction* task = new TaskFunction([&]() {
+    TaskScheduler::scheduleTask(new TaskPriority(
+        Task::PriorityBackground, Task::ResourceController, &sequence, 1));
+    TaskScheduler::scheduleTask(new TaskPriority(
+        Task::PriorityBackground, Task::ResourceAddons, &sequence, 2));
+
+    // Overtakes t2, but never t1, which uses the same resource.
+    TaskScheduler::scheduleTask(new TaskPriority(
+        Task::PriorityInteractive, Task::ResourceController, &sequence, 3));
+
+    // A task without resource declaration conflicts with everything.
+    TaskScheduler::scheduleTask(new TaskPriority(
+        Task::PriorityInteractive, Task::ResourceAll, &sequence, 4));
+  });
+
+  TaskScheduler::scheduleTask(task);
+
+  QCOMPARE(sequence, QList<int>({1, 3, 2, 4}));
+}
+
+void TestTasks::deadlines() {
+  QStringList sequence;
+
+  class TaskAsync final : public Task {
+   public:
+    TaskAsync(QStringList* sequence, const QString& name)
+        : Task("TaskAsync"), m_sequence(sequence), m_name(name) {}
+
+    void run() override {
+      QTimer::singleShot(200, this, [this]() {
+        m_sequence->append(m_name);
+        emit completed();
+      });
+    }
+
+   private:
+    QStringList* m_sequence = nullptr;
+    QString m_name;
+  };
+
+  Task* t1 = new TaskAsync(&sequence, "t1");
+  TaskScheduler::scheduleTask(t1);
+
+  // Stale by the time t1 completes.
+  Task* t2 = new TaskAsync(&sequence, "t2");
+  t2->setDeadlineMsec(50);
+  TaskScheduler::scheduleTask(t2);
+
+  Task* t3 = new TaskAsync(&sequence, "t3");
+  t3->setDeadlineMsec(10000);
+
+  QEventLoop loop;
+  connect(t3, &Task::completed, [&]() { loop.exit(); });
+  TaskScheduler::scheduleTask(t3);
+  loop.exec();
+
+  QCOMPARE(sequence, QStringList({"t1", "t3"}));
+  QVERIFY(TaskScheduler::metrics()["TaskAsync"].toObject()["dropped"].toInt() >=
+          1);
+}
+
 static TestTasks s_testTasks;
@@ -22,4 +22,10 @@ class TestTasks final : public TestHelper {
 
   void deleteTasks();
   void forceDeleteTasks();
+
+  void resources();
+
+  void priorities();
+  void priorities_conflicts();
+  void deadlines();
 };
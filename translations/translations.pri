@@ -11,6 +11,12 @@ exists($$PWD/generated/translations.qrc) {
 }
 
 INCLUDEPATH += $$PWD/generated
+
+## Compile the server name translations into a binary bundle.
+!system(python3 $$PWD/../scripts/utils/generate_servers_bundle.py \
+        -o $$PWD/generated/servers.bin $$PWD/servers.json) {
+    error("Failed to compile the server name translations")
+}
 RESOURCES += $$PWD/servers.qrc
 SOURCES += $$PWD/l18nstrings.cpp
 
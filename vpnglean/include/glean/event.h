@@ -9,21 +9,14 @@
 #include <QJsonObject>
 #include <QObject>
 
+#include "glean/eventqueue.h"
+
 #if not(defined(__wasm__) || defined(BUILD_QMAKE))
 #  include "vpnglean.h"
 #else
 enum ErrorType {};
 #endif
 
-struct FfiExtra {
-  std::vector<const char*> keys;
-  std::vector<const char*> values;
-
-  FfiExtra() : keys(0), values(0) {}
-
-  FfiExtra(int keysSize, int valuesSize) : keys(keysSize), values(valuesSize) {}
-};
-
 struct EventMetricExtra {
   // This id is meant to be used to validate
   // a static cast of a specific extra struct into an `EventMetricExtra` struct.
@@ -45,15 +38,15 @@ struct EventMetricExtra {
 };
 
 struct EventMetricExtraParser {
-  virtual FfiExtra fromStruct(const EventMetricExtra& extras,
-                              QList<QByteArray>& keepStringsAlive, int id) {
+  // The values are converted to strings later, by the telemetry thread.
+  virtual QList<EventQueue::Extra> fromStruct(const EventMetricExtra& extras,
+                                              int id) {
     Q_UNUSED(extras);
-    Q_UNUSED(keepStringsAlive);
     Q_UNUSED(id);
     Q_ASSERT(false);
     // This function should be overriden.
 
-    return FfiExtra();
+    return QList<EventQueue::Extra>();
   }
 };
 
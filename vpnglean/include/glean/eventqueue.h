@@ -0,0 +1,45 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef EVENT_QUEUE_H
+#define EVENT_QUEUE_H
+
+#include <QList>
+#include <QString>
+#include <QVariant>
+
+// Events are not recorded by the thread which records them.
+//
+// EventMetric::record() only pushes the metric id, the current timestamp and
+// the extras, as they are, into a lock-free queue. A telemetry thread drains
+// the queue in batches: it converts the extra values to UTF-8 and calls into
+// glean-core. The UI thread never pays for the FFI call, nor for the string
+// conversions, and the events keep the time they were recorded at.
+//
+// Everything which reads back what Glean has recorded (the test getters,
+// ping submission, resetting or shutting down Glean) must call flush() first.
+class EventQueue final {
+ public:
+  struct Extra {
+    // A key which outlives the queue: a string literal, or an interned key.
+    const char* m_key = nullptr;
+    // A bool, an int, a double or a QString.
+    QVariant m_value;
+  };
+
+  static void record(int id, QList<Extra>&& extras);
+
+  // Returns a pointer to a copy of `key` which lives as long as the process.
+  // The same key always gives the same pointer.
+  static const char* internKey(const QString& key);
+
+  // Records everything queued so far, on the calling thread.
+  static void flush();
+
+  // Records everything queued so far, and stops the telemetry thread. Events
+  // recorded afterwards are recorded synchronously.
+  static void shutdown();
+};
+
+#endif  // EVENT_QUEUE_H
@@ -11,57 +11,32 @@
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QObject>
-#include <QPair>
+
+#include "glean/eventqueue.h"
 
 EventMetric::EventMetric(int id, EventMetricExtraParser* parser)
     : m_id(id), m_parser(parser) {}
 
-void EventMetric::record() const {
-#if not(defined(__wasm__) || defined(BUILD_QMAKE))
-  glean_event_record_no_extra(m_id);
-#endif
-}
+void EventMetric::record() const { EventQueue::record(m_id, {}); }
 
 void EventMetric::record(const QJsonObject& extras) {
-  // Helper vector to extend the lifetime of the strings
-  // that hold the extra key values until they are used.
-  QList<QByteArray> keepStringsAlive;
-  FfiExtra ffiExtras(extras.count(), extras.count());
-
-  int count = 0;
-  foreach (const QString& key, extras.keys()) {
-    auto rawValue = extras.value(key);
+  QList<EventQueue::Extra> queuedExtras;
+  queuedExtras.reserve(extras.count());
 
-    if (rawValue.isString()) {
-      QByteArray value = rawValue.toString().toUtf8();
-      keepStringsAlive.append(value);
-      ffiExtras.values[count] = value.constData();
-    } else if (rawValue.isBool()) {
-      ffiExtras.values[count] = rawValue.toBool() ? "true" : "false";
-    } else if (rawValue.isDouble()) {
-      QByteArray value = QString::number(rawValue.toDouble()).toUtf8();
-      keepStringsAlive.append(value);
-      ffiExtras.values[count] = value.constData();
-    } else {
+  for (auto i = extras.constBegin(); i != extras.constEnd(); ++i) {
+    QJsonValue rawValue = i.value();
+    if (!rawValue.isString() && !rawValue.isBool() && !rawValue.isDouble()) {
       Q_ASSERT(false);
       // TODO: Record error.
       continue;
     }
 
-    QByteArray k = key.toUtf8();
-    keepStringsAlive.append(k);
-    ffiExtras.keys[count] = k.constData();
-
-    count++;
+    // The values are converted to UTF-8 by the telemetry thread.
+    queuedExtras.append({EventQueue::internKey(i.key()), rawValue.toVariant()});
   }
 
-  ffiExtras.values.resize(count);
-  ffiExtras.keys.resize(count);
-  if (!ffiExtras.keys.empty()) {
-#if not(defined(__wasm__) || defined(BUILD_QMAKE))
-    glean_event_record(m_id, ffiExtras.keys.data(), ffiExtras.values.data(),
-                       ffiExtras.keys.size());
-#endif
+  if (!queuedExtras.isEmpty()) {
+    EventQueue::record(m_id, std::move(queuedExtras));
   } else {
     // As a standalone library, the Logger class isn't available. Use generic
     // logging instead.
@@ -72,16 +47,10 @@ void EventMetric::record(const QJsonObject& extras) {
 }
 
 void EventMetric::record(const EventMetricExtra& extras) {
-  // Helper vector to extend the lifetime of the strings
-  // that hold the extra key values until they are used.
-  QList<QByteArray> keepStringsAlive;
-  FfiExtra ffiExtras = m_parser->fromStruct(extras, keepStringsAlive, m_id);
+  QList<EventQueue::Extra> queuedExtras = m_parser->fromStruct(extras, m_id);
 
-  if (!ffiExtras.keys.empty()) {
-#if not(defined(__wasm__) || defined(BUILD_QMAKE))
-    glean_event_record(m_id, ffiExtras.keys.data(), ffiExtras.values.data(),
-                       ffiExtras.keys.size());
-#endif
+  if (!queuedExtras.isEmpty()) {
+    EventQueue::record(m_id, std::move(queuedExtras));
   } else {
     qWarning() << "Attempted to record an event with extras, but no extras "
                   "were provided. Ignoring.";
@@ -91,6 +60,7 @@ void EventMetric::record(const EventMetricExtra& extras) {
 
 int32_t EventMetric::testGetNumRecordedErrors(ErrorType errorType) const {
 #if not(defined(__wasm__) || defined(BUILD_QMAKE))
+  EventQueue::flush();
   return glean_event_test_get_num_recorded_errors(m_id, errorType);
 #else
   return 0;
@@ -99,6 +69,7 @@ int32_t EventMetric::testGetNumRecordedErrors(ErrorType errorType) const {
 
 QList<QJsonObject> EventMetric::testGetValue(const QString& pingName) const {
 #if not(defined(__wasm__) || defined(BUILD_QMAKE))
+  EventQueue::flush();
   auto value = glean_event_test_get_value(m_id, pingName.toLocal8Bit());
   auto recordedEvents = QJsonDocument::fromJson(value).array();
   QList<QJsonObject> result;
@@ -0,0 +1,215 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "glean/eventqueue.h"
+
+#if not(defined(__wasm__) || defined(BUILD_QMAKE))
+#  include "vpnglean.h"
+#endif
+
+#include <QByteArray>
+#include <QCoreApplication>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThread>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#if not(defined(__wasm__) || defined(BUILD_QMAKE))
+#  include "mpscqueue.h"
+#endif
+
+namespace {
+
+#if not(defined(__wasm__) || defined(BUILD_QMAKE))
+// Enough for the bursts of events of the UI. When the telemetry thread falls
+// behind that much, the producer drains the queue itself.
+constexpr size_t EVENT_QUEUE_CAPACITY = 1024;
+
+struct QueuedEvent {
+  int m_id = 0;
+  // Taken by the caller of record(), not when the event is drained.
+  uint64_t m_timestamp = 0;
+  QList<EventQueue::Extra> m_extras;
+};
+
+MpscQueue<QueuedEvent> s_queue(EVENT_QUEUE_CAPACITY);
+
+// The queue has a single consumer at a time: the telemetry thread, or a
+// thread which flushes.
+QMutex s_consumerLock;
+
+// True when a drain is already scheduled on the telemetry thread: producers
+// do not need to wake it up.
+std::atomic<bool> s_drainScheduled(false);
+
+QMutex s_threadLock;
+QThread* s_thread = nullptr;
+QObject* s_worker = nullptr;
+bool s_shutdown = false;
+
+void recordNow(const QueuedEvent& event) {
+  const QList<EventQueue::Extra>& extras = event.m_extras;
+  if (extras.isEmpty()) {
+    glean_event_record_no_extra(event.m_id, event.m_timestamp);
+    return;
+  }
+
+  // Helper list to extend the lifetime of the converted values until they
+  // are used.
+  QList<QByteArray> keepStringsAlive;
+  keepStringsAlive.reserve(extras.count());
+
+  std::vector<const char*> keys;
+  std::vector<const char*> values;
+  keys.reserve(extras.count());
+  values.reserve(extras.count());
+
+  for (const EventQueue::Extra& extra : extras) {
+    const QVariant& value = extra.m_value;
+    switch (value.typeId()) {
+      case QMetaType::Bool:
+        values.push_back(value.toBool() ? "true" : "false");
+        break;
+
+      case QMetaType::Double:
+        keepStringsAlive.append(QString::number(value.toDouble()).toUtf8());
+        values.push_back(keepStringsAlive.last().constData());
+        break;
+
+      default:
+        keepStringsAlive.append(value.toString().toUtf8());
+        values.push_back(keepStringsAlive.last().constData());
+        break;
+    }
+
+    keys.push_back(extra.m_key);
+  }
+
+  glean_event_record(event.m_id, event.m_timestamp, keys.data(),
+                     values.data(), keys.size());
+}
+
+void drain() {
+  QMutexLocker locker(&s_consumerLock);
+
+  QueuedEvent event;
+  while (s_queue.pop(event)) {
+    recordNow(event);
+  }
+}
+
+// Returns the telemetry thread's worker, starting it the first time. Returns
+// nullptr if events must be recorded synchronously.
+QObject* worker() {
+  QMutexLocker locker(&s_threadLock);
+
+  if (s_worker || s_shutdown) {
+    return s_worker;
+  }
+
+  // Without an application, nobody would stop the thread.
+  if (!QCoreApplication::instance()) {
+    return nullptr;
+  }
+
+  s_thread = new QThread();
+  s_thread->setObjectName("Glean events");
+  s_worker = new QObject();
+  s_worker->moveToThread(s_thread);
+  s_thread->start(QThread::LowPriority);
+
+  qAddPostRoutine(EventQueue::shutdown);
+  return s_worker;
+}
+#endif
+
+QMutex s_keysLock;
+QHash<QString, const char*> s_keys;
+
+}  // namespace
+
+// static
+void EventQueue::record(int id, QList<Extra>&& extras) {
+#if not(defined(__wasm__) || defined(BUILD_QMAKE))
+  QueuedEvent event{id, glean_event_timestamp(), std::move(extras)};
+
+  QObject* target = worker();
+  if (!target) {
+    flush();
+    recordNow(event);
+    return;
+  }
+
+  if (!s_queue.push(std::move(event))) {
+    // The telemetry thread is too slow. Keep the order of the events.
+    flush();
+    if (!s_queue.push(std::move(event))) {
+      recordNow(event);
+      return;
+    }
+  }
+
+  // One wake-up for all the events pushed until the drain starts.
+  if (!s_drainScheduled.exchange(true, std::memory_order_acq_rel)) {
+    QMetaObject::invokeMethod(
+        target,
+        []() {
+          s_drainScheduled.store(false, std::memory_order_release);
+          drain();
+        },
+        Qt::QueuedConnection);
+  }
+#else
+  Q_UNUSED(id);
+  Q_UNUSED(extras);
+#endif
+}
+
+// static
+const char* EventQueue::internKey(const QString& key) {
+  QMutexLocker locker(&s_keysLock);
+
+  const char*& interned = s_keys[key];
+  if (!interned) {
+    // Never freed: the telemetry thread may still be using it.
+    interned = qstrdup(key.toUtf8().constData());
+  }
+  return interned;
+}
+
+// static
+void EventQueue::flush() {
+#if not(defined(__wasm__) || defined(BUILD_QMAKE))
+  drain();
+#endif
+}
+
+// static
+void EventQueue::shutdown() {
+#if not(defined(__wasm__) || defined(BUILD_QMAKE))
+  QThread* thread = nullptr;
+  QObject* target = nullptr;
+
+  {
+    QMutexLocker locker(&s_threadLock);
+    s_shutdown = true;
+    thread = s_thread;
+    target = s_worker;
+    s_thread = nullptr;
+    s_worker = nullptr;
+  }
+
+  if (thread) {
+    thread->quit();
+    thread->wait();
+    delete target;
+    delete thread;
+  }
+
+  flush();
+#endif
+}
@@ -12,9 +12,15 @@ use glean::ErrorType;
 use crate::ffi::helpers::{from_raw_string_array, FallibleToString, RawStringArray};
 use crate::metrics::__generated_metrics as metric_maps;
 
+/// The current time on the clock of the events, for `glean_event_record`.
 #[no_mangle]
-pub extern "C" fn glean_event_record_no_extra(id: u32) {
-    match metric_maps::record_event_by_id_no_extra(id) {
+pub extern "C" fn glean_event_timestamp() -> u64 {
+    glean::get_timestamp_ms()
+}
+
+#[no_mangle]
+pub extern "C" fn glean_event_record_no_extra(id: u32, timestamp: u64) {
+    match metric_maps::record_event_by_id_no_extra(id, timestamp) {
         Ok(()) => {}
         Err(EventRecordingError::InvalidId) => panic!("No event for id {}", id),
         Err(EventRecordingError::InvalidExtraKey) => {
@@ -26,12 +32,13 @@ pub extern "C" fn glean_event_record_no_extra(id: u32) {
 #[no_mangle]
 pub extern "C" fn glean_event_record(
     id: u32,
+    timestamp: u64,
     extra_keys: RawStringArray,
     extra_values: RawStringArray,
     extras_len: i32,
 ) {
     let extras = from_raw_string_array(extra_keys, extra_values, extras_len).unwrap();
-    match metric_maps::record_event_by_id(id, extras.unwrap()) {
+    match metric_maps::record_event_by_id(id, timestamp, extras.unwrap()) {
         Ok(()) => {}
         Err(EventRecordingError::InvalidId) => panic!("No event for id {}", id),
         Err(EventRecordingError::InvalidExtraKey) => {
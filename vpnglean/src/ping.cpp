@@ -3,6 +3,8 @@
  * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
 
 #include "glean/ping.h"
+
+#include "glean/eventqueue.h"
 #if not(defined(__wasm__) || defined(BUILD_QMAKE))
 #  include "vpnglean.h"
 #endif
@@ -11,6 +13,8 @@ Ping::Ping(int aId) : m_id(aId) {}
 
 void Ping::submit() const {
 #if not(defined(__wasm__) || defined(BUILD_QMAKE))
+  // The ping must include the events recorded so far.
+  EventQueue::flush();
   glean_submit_ping_by_id(m_id);
 #endif
 }
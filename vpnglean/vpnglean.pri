@@ -14,9 +14,11 @@ else{
 }
 
 SOURCES += $$PWD/src/event.cpp
+SOURCES += $$PWD/src/eventqueue.cpp
 SOURCES += $$PWD/src/ping.cpp
 
 HEADERS += $$PWD/include/glean/event.h
+HEADERS += $$PWD/include/glean/eventqueue.h
 HEADERS += $$PWD/include/glean/ping.h
 HEADERS += $$PWD/include/glean/metrictypes.h
 INCLUDEPATH += $$PWD/include